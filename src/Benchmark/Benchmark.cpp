@@ -0,0 +1,695 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+// headless benchmark for the search core.
+//
+// usage: grepWinBenchmark [--corpus <dir>] [--seed <n>] [--scale <f>] [--repeat <n>]
+//                         [--filter <text>] [--regenerate] [--csv]
+//
+// generates (or reuses) a deterministic corpus and runs every benchmark case
+// on it, reporting the throughput in MB/s and files/s and the heap
+// allocations per file. The best of --repeat runs is reported to reduce the
+// noise of the file cache.
+
+// the engine settings (regex block sizes, search block size) come from there,
+// so the numbers reflect the real application
+#include "SearchEnginePlatform.h"
+#include "ColumnWidths.h"
+#include "CorpusGenerator.h"
+#include "LinearRegex.h"
+#include "RegexReplaceFormatter.h"
+#include "SearchEngine.h"
+#include "TextOffset.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/regex.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+// every heap allocation of the process: shows the allocations per file.
+// All forms of the global new are replaced, so array and over-aligned
+// allocations are counted as well, and each delete frees the way its new
+// allocated.
+std::atomic<uint64_t> g_heapAllocations = 0;
+
+namespace
+{
+constexpr std::size_t defaultNewAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+void* CountedAlloc(std::size_t size, std::size_t alignment) noexcept
+{
+    g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0)
+        size = 1;
+    if (alignment <= defaultNewAlignment)
+        return std::malloc(size);
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc wants a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void* CountedNew(std::size_t size, std::size_t alignment)
+{
+    if (void* p = CountedAlloc(size, alignment))
+        return p;
+    throw std::bad_alloc();
+}
+
+void CountedFree(void* p, std::size_t alignment) noexcept
+{
+#ifdef _WIN32
+    if (alignment > defaultNewAlignment)
+    {
+        _aligned_free(p);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+    std::free(p);
+}
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    return CountedNew(size, defaultNewAlignment);
+}
+
+void* operator new[](std::size_t size)
+{
+    return CountedNew(size, defaultNewAlignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return CountedNew(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return CountedNew(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size, defaultNewAlignment);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size, defaultNewAlignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept
+{
+    CountedFree(p, defaultNewAlignment);
+}
+
+void operator delete[](void* p) noexcept
+{
+    CountedFree(p, defaultNewAlignment);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    CountedFree(p, defaultNewAlignment);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    CountedFree(p, defaultNewAlignment);
+}
+
+void operator delete(void* p, std::align_val_t alignment) noexcept
+{
+    CountedFree(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* p, std::align_val_t alignment) noexcept
+{
+    CountedFree(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept
+{
+    CountedFree(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t alignment) noexcept
+{
+    CountedFree(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    CountedFree(p, defaultNewAlignment);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    CountedFree(p, defaultNewAlignment);
+}
+
+void operator delete(void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    CountedFree(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    CountedFree(p, static_cast<std::size_t>(alignment));
+}
+
+namespace
+{
+struct BenchResult
+{
+    uint64_t files   = 0;
+    uint64_t bytes   = 0;
+    uint64_t matches = 0;
+};
+
+using BenchFiles = std::vector<std::filesystem::path>;
+
+struct BenchCase
+{
+    std::string                                                          name;
+    CorpusKind                                                           kind;
+    std::function<BenchResult(const CorpusKindInfo&, const BenchFiles&)> run;
+};
+
+BenchFiles ListFiles(const std::filesystem::path& dir)
+{
+    BenchFiles      files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(dir, ec))
+    {
+        if (entry.is_regular_file(ec))
+            files.push_back(entry.path());
+    }
+    // directory order is file system specific
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// the plain text search expression the way the search dialog passes it on
+// to the mapped search for UTF-16 files: the code units as raw bytes
+std::string ToUtf16Bytes(const std::string& ascii, bool bigEndian)
+{
+    std::string bytes;
+    for (char c : ascii)
+    {
+        bytes.push_back(bigEndian ? '\0' : c);
+        bytes.push_back(bigEndian ? c : '\0');
+    }
+    return bytes;
+}
+
+// the block wise search loop over a mapped file, as done for files which are
+// too big or binary. Match offsets are collected if requested, so the line
+// resolution can be measured separately.
+uint64_t ScanMapped(const std::filesystem::path& path, const boost::regex& regEx, std::vector<size_t>* offsets, uint64_t& bytes)
+{
+    boost::iostreams::mapped_file_source inFile(path.string());
+    if (!inFile.is_open())
+        return 0;
+    const char* start  = inFile.data();
+    const char* end    = start + inFile.size();
+    bytes             += inFile.size();
+
+    boost::match_results<const char*> whatC;
+    boost::match_flag_type            mFlags    = boost::match_default | boost::format_all | boost::match_not_dot_newline;
+    size_t                            remainder = inFile.size() % SEARCHBLOCKSIZE;
+    const char*                       startIter = start;
+    const char*                       blockEnd  = start + remainder;
+    uint64_t                          nFound    = 0;
+    do
+    {
+        while ((startIter < blockEnd) && boost::regex_search(startIter, blockEnd, whatC, regEx, mFlags, start))
+        {
+            ++nFound;
+            mFlags |= boost::match_prev_avail;
+            mFlags |= boost::match_not_bob;
+            if (offsets)
+                offsets->push_back(whatC[0].first - start);
+            startIter = whatC[0].second;
+            if (startIter == whatC[0].first)
+            {
+                if (startIter == blockEnd)
+                    break;
+                ++startIter;
+            }
+        }
+        startIter = blockEnd;
+        if (blockEnd < end)
+            blockEnd += SEARCHBLOCKSIZE;
+        else
+            break;
+    } while (true);
+    return nFound;
+}
+
+BenchResult ScanFiles(const BenchFiles& files, const std::string& expr)
+{
+    BenchResult  result;
+    boost::regex regEx(expr, boost::regex::normal);
+    for (const auto& file : files)
+    {
+        result.matches += ScanMapped(file, regEx, nullptr, result.bytes);
+        ++result.files;
+    }
+    return result;
+}
+
+BenchResult ScanFilesWithLines(const BenchFiles& files, const std::string& expr)
+{
+    BenchResult         result;
+    boost::regex        regEx(expr, boost::regex::normal);
+    std::atomic_bool    bCancelled = false;
+    std::vector<size_t> offsets;
+    for (const auto& file : files)
+    {
+        offsets.clear();
+        uint64_t nFound = ScanMapped(file, regEx, &offsets, result.bytes);
+        ++result.files;
+        if (nFound == 0)
+            continue;
+        boost::iostreams::mapped_file_source inFile(file.string());
+        TextOffset<char>                     textOffset;
+        const char*                          start = textOffset.SkipBOM(inFile.data(), inFile.data() + inFile.size());
+        textOffset.CalculateLines(start, inFile.data() + inFile.size(), bCancelled);
+        for (auto pos : offsets)
+        {
+            long line = textOffset.LineFromPosition(static_cast<long>(pos));
+            long col  = textOffset.ColumnFromPosition(static_cast<long>(pos), line);
+            auto se   = textOffset.PositionsFromLine(line);
+            if (col > 0 && std::get<1>(se) >= std::get<0>(se))
+                ++result.matches;
+        }
+    }
+    return result;
+}
+
+BenchResult ReplaceFiles(const BenchFiles& files, const std::string& expr, const std::string& replace)
+{
+    BenchResult  result;
+    boost::regex regEx(expr, boost::regex::normal);
+    std::string  replaced;
+    for (const auto& file : files)
+    {
+        std::ifstream stream(file, std::ios::binary);
+        std::string   content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        result.bytes += content.size();
+        ++result.files;
+
+        RegexReplaceFormatter<char> replaceFmt(replace);
+        replaced.clear();
+        boost::sregex_iterator it(content.cbegin(), content.cend(), regEx);
+        boost::sregex_iterator itEnd;
+        auto                   last = content.cbegin();
+        for (; it != itEnd; ++it)
+        {
+            replaced.append(last, (*it)[0].first);
+            replaced += replaceFmt(*it);
+            last = (*it)[0].second;
+            ++result.matches;
+        }
+        replaced.append(last, content.cend());
+    }
+    return result;
+}
+
+// expressions which make a backtracking engine try every way to split the
+// text among the repeats before it gives up, and lines which almost match
+// them. Each line is searched on its own, like the lines of a file.
+struct PathologicalCase
+{
+    const char* expression;
+    std::string line;
+};
+
+std::vector<PathologicalCase> PathologicalCases()
+{
+    return {
+        {"(a+)+b", std::string(28, 'a')},
+        {"(a|aa)+c", std::string(40, 'a')},
+        {"(.*a){12}", std::string(40, 'a') + "b"},
+        {"(\\w+\\s?)+$", std::string(32, 'w') + "!"},
+        {"(x+x+)+y", std::string(30, 'x')},
+    };
+}
+
+// boost gives up with an exception once it took too many steps, which is
+// counted as no match: that is what the search engine reports then
+BenchResult ScanPathological(bool bLinear)
+{
+    BenchResult result;
+    for (const auto& pathological : PathologicalCases())
+    {
+        const std::string& line  = pathological.line;
+        const char*        first = line.data();
+        const char*        last  = first + line.size();
+        for (int i = 0; i < 20; ++i)
+        {
+            ++result.files;
+            result.bytes += line.size();
+            if (bLinear)
+            {
+                std::wstring expression(pathological.expression, pathological.expression + strlen(pathological.expression));
+                auto         linearRegex = CLinearRegex::Compile(expression, true, false, false);
+                const char*  matchFirst  = nullptr;
+                const char*  matchLast   = nullptr;
+                if (linearRegex && linearRegex->Search(first, last, first, matchFirst, matchLast))
+                    ++result.matches;
+                continue;
+            }
+            try
+            {
+                boost::regex                      regEx(pathological.expression, boost::regex::normal);
+                boost::match_results<const char*> whatC;
+                if (boost::regex_search(first, last, whatC, regEx, boost::match_default | boost::match_not_dot_newline))
+                    ++result.matches;
+            }
+            catch (const std::runtime_error&)
+            {
+            }
+        }
+    }
+    return result;
+}
+
+// measures like a proportional font: capitals wide, punctuation narrow
+class CCharWidthMeasurer : public ITextMeasurer
+{
+public:
+    int TextWidth(std::wstring_view text) override
+    {
+        int width = 0;
+        for (wchar_t c : text)
+            width += (c >= 'A' && c <= 'Z') ? 9 : (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ? 7 : 3;
+        return width;
+    }
+};
+
+// the column widths of the result list as the dialog keeps them, without a
+// window: every line of the files as a row of the content view
+BenchResult TrackColumnWidths(const BenchFiles& files)
+{
+    BenchResult        result;
+    CColumnWidths      widths(5);
+    CCharWidthMeasurer measurer;
+    std::wstring       text;
+    for (const auto& file : files)
+    {
+        boost::iostreams::mapped_file_source inFile(file.string());
+        const char*                          data   = inFile.data();
+        size_t                               size   = inFile.size();
+        auto                                 name   = file.filename().wstring();
+        auto                                 folder = file.parent_path().wstring();
+        widths.Add(0, name, measurer);
+        widths.Add(4, folder, measurer);
+        long line = 0;
+        for (size_t begin = 0; begin < size;)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(data + begin, '\n', size - begin));
+            size_t      end     = lineEnd ? lineEnd - data : size;
+            text.assign(data + begin, data + end);
+            widths.Add(1, std::to_wstring(++line), measurer);
+            widths.Add(3, text, measurer);
+            ++result.matches;
+            begin = end + 1;
+        }
+        ++result.files;
+        result.bytes += size;
+    }
+    return result;
+}
+
+// collects the totals of a search run, called from the engine's worker threads
+class CCountingSink : public ISearchResultSink
+{
+public:
+    void OnSearchStart() override {}
+    void OnFileResult(const CSearchInfo& sInfo, bool bSearched, bool /*bAsResult*/) override
+    {
+        if (!bSearched)
+            return;
+        ++m_files;
+        m_bytes += sInfo.fileSize;
+        m_matches += sInfo.matchCount;
+    }
+    void        OnFileSkipped() override {}
+    void        OnSearchEnd() override {}
+
+    BenchResult Result() const { return {m_files, m_bytes, m_matches}; }
+
+private:
+    std::atomic<uint64_t> m_files   = 0;
+    std::atomic<uint64_t> m_bytes   = 0;
+    std::atomic<uint64_t> m_matches = 0;
+};
+
+// a complete search run over a corpus folder: enumeration, encoding
+// detection, loading and the thread pool, as the search dialog does it
+BenchResult SearchWithEngine(const CorpusKindInfo& kind, const std::wstring& searchString, bool bUseRegex, bool bLinearRegex = false)
+{
+    SearchOptions options;
+    options.searchPaths.push_back(kind.dir.wstring());
+    options.searchString  = searchString;
+    options.useRegex      = bUseRegex;
+    options.includeBinary = true;
+    options.linearRegex   = bLinearRegex;
+
+    CCountingSink      sink;
+    CCancellationToken cancelToken;
+    CSearchEngine      engine(options, sink, cancelToken);
+    engine.Run();
+    return sink.Result();
+}
+
+// the search terms of the multi-pattern cases, like a list of deprecated
+// names: the needle and a few words the source corpus contains, and many
+// identifiers it doesn't
+std::vector<std::wstring> BenchPatterns()
+{
+    std::vector<std::wstring> patterns = {L"" CORPUS_NEEDLE, L"Handler", L"return", L"static"};
+    uint64_t                  state    = 0x6772657057696e; // "grepWin"
+    while (patterns.size() < 2000)
+    {
+        std::wstring identifier = L"Deprecated";
+        for (int i = 0; i < 8; ++i)
+        {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            identifier += static_cast<wchar_t>(L'a' + (state >> 33) % 26);
+        }
+        patterns.push_back(identifier);
+    }
+    return patterns;
+}
+
+BenchResult SearchPatternsWithEngine(const CorpusKindInfo& kind, const std::vector<std::wstring>& patterns)
+{
+    SearchOptions options;
+    options.searchPaths.push_back(kind.dir.wstring());
+    options.searchPatterns = patterns;
+    options.includeBinary  = true;
+
+    CCountingSink      sink;
+    CCancellationToken cancelToken;
+    CSearchEngine      engine(options, sink, cancelToken);
+    engine.Run();
+    return sink.Result();
+}
+
+// the regex alternation which finds the same as the multi-pattern search:
+// the longer patterns first, so that the longest match at a position wins
+std::wstring AlternationOf(std::vector<std::wstring> patterns)
+{
+    std::stable_sort(patterns.begin(), patterns.end(), [](const std::wstring& a, const std::wstring& b) { return a.size() > b.size(); });
+    std::wstring alternation;
+    for (auto& pattern : patterns)
+    {
+        escapeForRegexEx(pattern, 0);
+        if (!alternation.empty())
+            alternation += L'|';
+        alternation += pattern;
+    }
+    return alternation;
+}
+
+std::vector<BenchCase> BuildCases()
+{
+    const std::string  needle      = CORPUS_NEEDLE;
+    const auto         patterns    = BenchPatterns();
+    const std::wstring alternation = AlternationOf(patterns);
+    return {
+        {"scan/source/literal", CorpusKind::Source, [=](const auto&, const auto& f) { return ScanFiles(f, needle); }},
+        {"scan/source/regex", CorpusKind::Source, [](const auto&, const auto& f) { return ScanFiles(f, "\\bclass\\s+C\\w+Handler\\b"); }},
+        {"scan/log/regex", CorpusKind::Log, [](const auto&, const auto& f) { return ScanFiles(f, "\\[(ERROR|WARN )\\].*timeout"); }},
+        {"scan/utf16le/literal", CorpusKind::Utf16Le, [=](const auto&, const auto& f) { return ScanFiles(f, ToUtf16Bytes(needle, false)); }},
+        {"scan/utf16be/literal", CorpusKind::Utf16Be, [=](const auto&, const auto& f) { return ScanFiles(f, ToUtf16Bytes(needle, true)); }},
+        {"scan/binary/literal", CorpusKind::Binary, [=](const auto&, const auto& f) { return ScanFiles(f, needle); }},
+        {"scan/deep/literal", CorpusKind::DeepTree, [=](const auto&, const auto& f) { return ScanFiles(f, needle); }},
+        {"scan/huge/literal", CorpusKind::Huge, [=](const auto&, const auto& f) { return ScanFiles(f, needle); }},
+        {"scan/huge/regex", CorpusKind::Huge, [](const auto&, const auto& f) { return ScanFiles(f, "\\[(ERROR|WARN )\\].*timeout"); }},
+        {"lines/source/textoffset", CorpusKind::Source, [](const auto&, const auto& f) { return ScanFilesWithLines(f, "return"); }},
+        {"lines/huge/textoffset", CorpusKind::Huge, [](const auto&, const auto& f) { return ScanFilesWithLines(f, "ERROR"); }},
+        {"replace/source/formatter", CorpusKind::Source, [](const auto&, const auto& f) { return ReplaceFiles(f, "m_([a-z]+)", "m_${count03(10,5)}_$1"); }},
+        {"engine/source/literal", CorpusKind::Source, [](const auto& k, const auto&) { return SearchWithEngine(k, L"" CORPUS_NEEDLE, false); }},
+        {"engine/source/regex", CorpusKind::Source, [](const auto& k, const auto&) { return SearchWithEngine(k, L"\\bclass\\s+C\\w+Handler\\b", true); }},
+        {"engine/source/regex-linear", CorpusKind::Source, [](const auto& k, const auto&) { return SearchWithEngine(k, L"\\bclass\\s+C\\w+Handler\\b", true, true); }},
+        {"engine/huge/regex", CorpusKind::Huge, [](const auto& k, const auto&) { return SearchWithEngine(k, L"\\[(ERROR|WARN )\\].*timeout", true); }},
+        {"engine/huge/regex-linear", CorpusKind::Huge, [](const auto& k, const auto&) { return SearchWithEngine(k, L"\\[(ERROR|WARN )\\].*timeout", true, true); }},
+        {"pathological/boost", CorpusKind::Source, [](const auto&, const auto&) { return ScanPathological(false); }},
+        {"pathological/linear", CorpusKind::Source, [](const auto&, const auto&) { return ScanPathological(true); }},
+        {"engine/utf16le/literal", CorpusKind::Utf16Le, [](const auto& k, const auto&) { return SearchWithEngine(k, L"" CORPUS_NEEDLE, false); }},
+        {"engine/binary/literal", CorpusKind::Binary, [](const auto& k, const auto&) { return SearchWithEngine(k, L"" CORPUS_NEEDLE, false); }},
+        {"engine/deep/literal", CorpusKind::DeepTree, [](const auto& k, const auto&) { return SearchWithEngine(k, L"" CORPUS_NEEDLE, false); }},
+        {"engine/huge/literal", CorpusKind::Huge, [](const auto& k, const auto&) { return SearchWithEngine(k, L"" CORPUS_NEEDLE, false); }},
+        {"engine/source/patterns", CorpusKind::Source, [=](const auto& k, const auto&) { return SearchPatternsWithEngine(k, patterns); }},
+        {"engine/source/alternation", CorpusKind::Source, [=](const auto& k, const auto&) { return SearchWithEngine(k, alternation, true); }},
+        {"columns/source/widths", CorpusKind::Source, [](const auto&, const auto& f) { return TrackColumnWidths(f); }},
+    };
+}
+
+void PrintUsage()
+{
+    printf("usage: grepWinBenchmark [--corpus <dir>] [--seed <n>] [--scale <f>] [--repeat <n>]\n"
+           "                        [--filter <text>] [--regenerate] [--csv]\n");
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::filesystem::path corpusDir;
+    uint64_t              seed        = 0x67726570576e; // "grepWn"
+    double                scale       = 1.0;
+    int                   repeat      = 3;
+    bool                  bRegenerate = false;
+    bool                  bCsv        = false;
+    std::string           filter;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg     = argv[i];
+        bool        hasNext = i + 1 < argc;
+        if (arg == "--corpus" && hasNext)
+            corpusDir = argv[++i];
+        else if (arg == "--seed" && hasNext)
+            seed = std::strtoull(argv[++i], nullptr, 0);
+        else if (arg == "--scale" && hasNext)
+            scale = std::atof(argv[++i]);
+        else if (arg == "--repeat" && hasNext)
+            repeat = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--filter" && hasNext)
+            filter = argv[++i];
+        else if (arg == "--regenerate")
+            bRegenerate = true;
+        else if (arg == "--csv")
+            bCsv = true;
+        else
+        {
+            PrintUsage();
+            return arg == "--help" || arg == "-h" ? 0 : 2;
+        }
+    }
+    if (corpusDir.empty())
+        corpusDir = std::filesystem::temp_directory_path() / "grepWinBenchCorpus";
+
+    CCorpusGenerator generator(corpusDir, seed, scale);
+    auto             genStart = std::chrono::steady_clock::now();
+    if (!generator.Generate(bRegenerate))
+    {
+        fprintf(stderr, "failed to create the corpus in %s\n", corpusDir.string().c_str());
+        return 1;
+    }
+    double genSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - genStart).count();
+
+    if (!bCsv)
+    {
+        printf("corpus: %s (seed %llu, scale %g, ready in %.2fs)\n", corpusDir.string().c_str(), static_cast<unsigned long long>(seed), scale, genSecs);
+        for (const auto& kind : generator.GetKinds())
+            printf("  %-10s %8llu files %10.1f MB\n", CCorpusGenerator::KindName(kind.kind), static_cast<unsigned long long>(kind.files), kind.bytes / (1024.0 * 1024.0));
+        printf("\n%-28s %8s %10s %9s %10s %12s %10s %12s\n", "case", "files", "MB", "secs", "MB/s", "files/s", "matches", "allocs/file");
+    }
+    else
+    {
+        printf("case,files,bytes,seconds,mb_per_s,files_per_s,matches,allocs_per_file\n");
+    }
+
+    for (const auto& benchCase : BuildCases())
+    {
+        if (!filter.empty() && benchCase.name.find(filter) == std::string::npos)
+            continue;
+        const auto& kinds = generator.GetKinds();
+        auto        kind  = std::find_if(kinds.begin(), kinds.end(), [&](const CorpusKindInfo& k) { return k.kind == benchCase.kind; });
+        auto        files = ListFiles(kind->dir);
+
+        BenchResult result;
+        double      best   = 0.0;
+        uint64_t    allocs = 0;
+        for (int r = 0; r < repeat; ++r)
+        {
+            uint64_t allocStart = g_heapAllocations;
+            auto     start      = std::chrono::steady_clock::now();
+            result              = benchCase.run(*kind, files);
+            double secs         = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (r == 0 || secs < best)
+                best = secs;
+            // the same for every run, apart from the buffers a first run leaves for the next
+            allocs = g_heapAllocations - allocStart;
+        }
+        best                 = std::max(best, 1e-9);
+        double mb            = result.bytes / (1024.0 * 1024.0);
+        double allocsPerFile = result.files ? static_cast<double>(allocs) / result.files : 0.0;
+        if (bCsv)
+            printf("%s,%llu,%llu,%.6f,%.2f,%.2f,%llu,%.1f\n", benchCase.name.c_str(), static_cast<unsigned long long>(result.files), static_cast<unsigned long long>(result.bytes),
+                   best, mb / best, result.files / best, static_cast<unsigned long long>(result.matches), allocsPerFile);
+        else
+            printf("%-28s %8llu %10.1f %9.3f %10.1f %12.1f %10llu %12.1f\n", benchCase.name.c_str(), static_cast<unsigned long long>(result.files), mb,
+                   best, mb / best, result.files / best, static_cast<unsigned long long>(result.matches), allocsPerFile);
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,463 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "CorpusGenerator.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <system_error>
+
+namespace
+{
+// bump whenever the generated content changes, so old corpora get rebuilt
+constexpr int corpusVersion = 1;
+
+const char*   words[]       = {
+    "alpha", "buffer", "cache", "delta", "engine", "folder", "global", "handle", "index", "jobs",
+    "kernel", "length", "match", "needle", "offset", "pattern", "query", "result", "search", "token",
+    "update", "value", "window", "extent", "yield", "zone", "request", "timeout", "replace", "regex"};
+
+const char*   keywords[]    = {"if", "for", "while", "return", "auto", "const", "static", "switch", "case", "break"};
+
+const char*   types[]       = {"int", "size_t", "bool", "std::wstring", "DWORD", "long", "auto", "double"};
+
+// a few non-ASCII words so the UTF-16 files contain surrogate free multi byte text
+const char*   intlWords[]   = {"Gr\xC3\xBC\xC3\x9F" "e", "\xCE\xA9mega", "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E", "na\xC3\xAFve", "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82", "caf\xC3\xA9"};
+
+const char*   levels[]      = {"INFO ", "DEBUG", "INFO ", "TRACE", "INFO ", "WARN ", "INFO ", "ERROR"};
+
+std::u16string Utf8ToUtf16(const std::string& str)
+{
+    std::u16string result;
+    result.reserve(str.size());
+    for (size_t i = 0; i < str.size();)
+    {
+        auto     c  = static_cast<unsigned char>(str[i]);
+        char32_t cp = c;
+        size_t   n  = 1;
+        if (c >= 0xF0)
+        {
+            cp = c & 0x07;
+            n  = 4;
+        }
+        else if (c >= 0xE0)
+        {
+            cp = c & 0x0F;
+            n  = 3;
+        }
+        else if (c >= 0xC0)
+        {
+            cp = c & 0x1F;
+            n  = 2;
+        }
+        for (size_t j = 1; j < n && i + j < str.size(); ++j)
+            cp = (cp << 6) | (static_cast<unsigned char>(str[i + j]) & 0x3F);
+        i += n;
+        if (cp >= 0x10000)
+        {
+            cp -= 0x10000;
+            result.push_back(static_cast<char16_t>(0xD800 + (cp >> 10)));
+            result.push_back(static_cast<char16_t>(0xDC00 + (cp & 0x3FF)));
+        }
+        else
+            result.push_back(static_cast<char16_t>(cp));
+    }
+    return result;
+}
+} // namespace
+
+CCorpusGenerator::CCorpusGenerator(const std::filesystem::path& root, uint64_t seed, double scale)
+    : m_root(root)
+    , m_seed(seed)
+    , m_state(seed)
+    , m_scale(scale > 0.0 ? scale : 1.0)
+{
+    m_kinds = {
+        {CorpusKind::Source, m_root / "source"},
+        {CorpusKind::Log, m_root / "log"},
+        {CorpusKind::Utf16Le, m_root / "utf16le"},
+        {CorpusKind::Utf16Be, m_root / "utf16be"},
+        {CorpusKind::Binary, m_root / "binary"},
+        {CorpusKind::DeepTree, m_root / "deep"},
+        {CorpusKind::Huge, m_root / "huge"},
+    };
+}
+
+const char* CCorpusGenerator::KindName(CorpusKind kind)
+{
+    switch (kind)
+    {
+        case CorpusKind::Source:
+            return "source";
+        case CorpusKind::Log:
+            return "log";
+        case CorpusKind::Utf16Le:
+            return "utf16le";
+        case CorpusKind::Utf16Be:
+            return "utf16be";
+        case CorpusKind::Binary:
+            return "binary";
+        case CorpusKind::DeepTree:
+            return "deep";
+        case CorpusKind::Huge:
+            return "huge";
+    }
+    return "";
+}
+
+std::string CCorpusGenerator::StampText() const
+{
+    std::ostringstream stamp;
+    stamp << "version=" << corpusVersion << "\nseed=" << m_seed << "\nscale=" << m_scale << "\n";
+    return stamp.str();
+}
+
+bool CCorpusGenerator::Generate(bool bForce)
+{
+    std::error_code ec;
+    auto            stampPath = m_root / "corpus.stamp";
+    if (!bForce)
+    {
+        std::ifstream stampFile(stampPath, std::ios::binary);
+        std::string   stamp((std::istreambuf_iterator<char>(stampFile)), std::istreambuf_iterator<char>());
+        if (stamp == StampText())
+        {
+            Measure();
+            return true;
+        }
+    }
+    std::filesystem::remove_all(m_root, ec);
+    std::filesystem::create_directories(m_root, ec);
+    if (ec)
+        return false;
+
+    // every kind starts from its own sub seed, so the content of one kind
+    // does not change if another kind gets tweaked
+    for (auto& info : m_kinds)
+    {
+        m_state = m_seed ^ (0x9E3779B97F4A7C15ull * (static_cast<uint64_t>(info.kind) + 1));
+        std::filesystem::create_directories(info.dir, ec);
+        switch (info.kind)
+        {
+            case CorpusKind::Source:
+                WriteSource(info);
+                break;
+            case CorpusKind::Log:
+                WriteLog(info);
+                break;
+            case CorpusKind::Utf16Le:
+                WriteUtf16(info, false);
+                break;
+            case CorpusKind::Utf16Be:
+                WriteUtf16(info, true);
+                break;
+            case CorpusKind::Binary:
+                WriteBinary(info);
+                break;
+            case CorpusKind::DeepTree:
+                WriteDeepTree(info);
+                break;
+            case CorpusKind::Huge:
+                WriteHuge(info);
+                break;
+        }
+    }
+    Measure();
+
+    std::ofstream stampFile(stampPath, std::ios::binary | std::ios::trunc);
+    stampFile << StampText();
+    return stampFile.good();
+}
+
+void CCorpusGenerator::Measure()
+{
+    for (auto& info : m_kinds)
+    {
+        info.files = 0;
+        info.bytes = 0;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(info.dir, ec))
+        {
+            if (entry.is_regular_file(ec))
+            {
+                ++info.files;
+                info.bytes += entry.file_size(ec);
+            }
+        }
+    }
+}
+
+// splitmix64
+uint64_t CCorpusGenerator::Next()
+{
+    uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+    z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z          = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+uint64_t CCorpusGenerator::Range(uint64_t lo, uint64_t hi)
+{
+    if (hi <= lo)
+        return lo;
+    return lo + Next() % (hi - lo + 1);
+}
+
+bool CCorpusGenerator::Chance(uint32_t perThousand)
+{
+    return Next() % 1000 < perThousand;
+}
+
+size_t CCorpusGenerator::Scaled(size_t count) const
+{
+    return std::max<size_t>(1, static_cast<size_t>(static_cast<double>(count) * m_scale));
+}
+
+std::string CCorpusGenerator::Word()
+{
+    return words[Next() % std::size(words)];
+}
+
+std::string CCorpusGenerator::Identifier()
+{
+    std::string id = Word();
+    auto        w2 = Word();
+    w2[0]          = static_cast<char>(w2[0] - 'a' + 'A');
+    id += w2;
+    if (Chance(300))
+        id += std::to_string(Range(0, 99));
+    return id;
+}
+
+std::string CCorpusGenerator::SourceLine()
+{
+    std::string indent(4 * Range(0, 3), ' ');
+    switch (Next() % 8)
+    {
+        case 0:
+            return indent + "// " + Word() + " " + Word() + " " + Word() + (Chance(50) ? " TODO: " CORPUS_NEEDLE : "");
+        case 1:
+            return indent + types[Next() % std::size(types)] + " " + Identifier() + " = " + Identifier() + "(" + Identifier() + ", " + std::to_string(Range(0, 4096)) + ");";
+        case 2:
+            return indent + keywords[Next() % std::size(keywords)] + " (" + Identifier() + " != nullptr)";
+        case 3:
+            return indent + "{";
+        case 4:
+            return indent + "}";
+        case 5:
+            return indent + "m_" + Identifier() + " = L\"" + Word() + " " + (Chance(80) ? CORPUS_NEEDLE : Word()) + "\";";
+        case 6:
+            return "class C" + Identifier() + "Handler : public C" + Identifier();
+        default:
+            return indent + "return " + Identifier() + "->" + Identifier() + "();";
+    }
+}
+
+std::string CCorpusGenerator::LogLine(uint64_t lineNo)
+{
+    char buf[96] = {0};
+    snprintf(buf, sizeof(buf), "2026-%02d-%02d %02d:%02d:%02d.%03d [%s] worker-%02d ",
+             static_cast<int>(1 + lineNo / 2000000 % 12), static_cast<int>(1 + lineNo / 80000 % 28),
+             static_cast<int>(lineNo / 3600 % 24), static_cast<int>(lineNo / 60 % 60), static_cast<int>(lineNo % 60),
+             static_cast<int>(Range(0, 999)), levels[Next() % std::size(levels)], static_cast<int>(Range(0, 31)));
+    std::string line = buf;
+    line += Word() + " id=" + std::to_string(Next() % 1000000) + " " + Word() + " took " + std::to_string(Range(1, 5000)) + "ms";
+    if (Chance(20))
+        line += " timeout while waiting for " + Word();
+    if (Chance(5))
+        line += " " CORPUS_NEEDLE;
+    return line;
+}
+
+std::string CCorpusGenerator::TextLine()
+{
+    std::string line;
+    auto        count = Range(4, 14);
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        if (i)
+            line += ' ';
+        line += Chance(150) ? intlWords[Next() % std::size(intlWords)] : Word();
+    }
+    if (Chance(30))
+        line += " " CORPUS_NEEDLE;
+    return line;
+}
+
+void CCorpusGenerator::WriteFile(CorpusKindInfo& info, const std::filesystem::path& path, const std::string& content)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    ++info.files;
+    info.bytes += content.size();
+}
+
+void CCorpusGenerator::WriteSource(CorpusKindInfo& info)
+{
+    const char* exts[] = {".cpp", ".h", ".c", ".txt"};
+    auto        count  = Scaled(1500);
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::string content;
+        auto        lines = Range(40, 800);
+        for (uint64_t l = 0; l < lines; ++l)
+        {
+            content += SourceLine();
+            content += (i % 3 == 0) ? "\r\n" : "\n";
+        }
+        char name[32] = {0};
+        snprintf(name, sizeof(name), "file%05d", static_cast<int>(i));
+        WriteFile(info, info.dir / (std::string(name) + exts[i % std::size(exts)]), content);
+    }
+}
+
+void CCorpusGenerator::WriteLog(CorpusKindInfo& info)
+{
+    auto     count  = Scaled(40);
+    uint64_t lineNo = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::string content;
+        auto        targetSize = Range(256 * 1024, 768 * 1024);
+        while (content.size() < targetSize)
+        {
+            content += LogLine(lineNo++);
+            content += "\n";
+        }
+        char name[32] = {0};
+        snprintf(name, sizeof(name), "server%03d.log", static_cast<int>(i));
+        WriteFile(info, info.dir / name, content);
+    }
+}
+
+void CCorpusGenerator::WriteUtf16(CorpusKindInfo& info, bool bigEndian)
+{
+    auto count = Scaled(100);
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::string text;
+        auto        lines = Range(100, 1000);
+        for (uint64_t l = 0; l < lines; ++l)
+        {
+            text += TextLine();
+            text += "\r\n";
+        }
+        std::u16string units = u"\xFEFF" + Utf8ToUtf16(text);
+        std::string    content;
+        content.reserve(units.size() * 2);
+        for (auto u : units)
+        {
+            char lo = static_cast<char>(u & 0xFF);
+            char hi = static_cast<char>(u >> 8);
+            content.push_back(bigEndian ? hi : lo);
+            content.push_back(bigEndian ? lo : hi);
+        }
+        char name[32] = {0};
+        snprintf(name, sizeof(name), "text%04d.txt", static_cast<int>(i));
+        WriteFile(info, info.dir / name, content);
+    }
+}
+
+void CCorpusGenerator::WriteBinary(CorpusKindInfo& info)
+{
+    auto count = Scaled(50);
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::string content;
+        auto        targetSize = Range(64 * 1024, 512 * 1024);
+        content.reserve(targetSize + 64);
+        while (content.size() < targetSize)
+        {
+            auto r = Next();
+            if (r % 64 == 0)
+            {
+                // embedded strings like in real executables and archives
+                content += Chance(100) ? CORPUS_NEEDLE : Identifier();
+                content.push_back('\0');
+            }
+            else if (r % 8 == 0)
+            {
+                content.append(static_cast<size_t>(Range(1, 16)), '\0');
+            }
+            else
+            {
+                for (int b = 0; b < 8; ++b)
+                    content.push_back(static_cast<char>(r >> (b * 8)));
+            }
+        }
+        char name[32] = {0};
+        snprintf(name, sizeof(name), "blob%03d.bin", static_cast<int>(i));
+        WriteFile(info, info.dir / name, content);
+    }
+}
+
+void CCorpusGenerator::WriteDeepTree(CorpusKindInfo& info)
+{
+    // a few wide levels on top of long chains: lots of directories, small files
+    const int depth  = 16;
+    auto      chains = Scaled(24);
+    for (size_t c = 0; c < chains; ++c)
+    {
+        auto dir = info.dir / ("branch" + std::to_string(c % 4)) / ("chain" + std::to_string(c));
+        for (int d = 0; d < depth; ++d)
+        {
+            dir /= "level" + std::to_string(d);
+            std::error_code ec;
+            std::filesystem::create_directories(dir, ec);
+            auto files = Range(1, 4);
+            for (uint64_t f = 0; f < files; ++f)
+            {
+                std::string content;
+                auto        lines = Range(5, 60);
+                for (uint64_t l = 0; l < lines; ++l)
+                {
+                    content += SourceLine();
+                    content += "\n";
+                }
+                WriteFile(info, dir / ("item" + std::to_string(f) + ".cpp"), content);
+            }
+        }
+    }
+}
+
+void CCorpusGenerator::WriteHuge(CorpusKindInfo& info)
+{
+    // bigger than SEARCHBLOCKSIZE, so the block wise search is exercised
+    uint64_t      targetSize = static_cast<uint64_t>(96.0 * 1024 * 1024 * m_scale);
+    auto          path       = info.dir / "huge.log";
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    std::string   chunk;
+    uint64_t      written = 0;
+    uint64_t      lineNo  = 0;
+    while (written < targetSize)
+    {
+        chunk.clear();
+        while (chunk.size() < 1024 * 1024)
+        {
+            chunk += LogLine(lineNo++);
+            chunk += "\n";
+        }
+        file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        written += chunk.size();
+    }
+    ++info.files;
+    info.bytes += written;
+}
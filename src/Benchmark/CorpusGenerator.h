@@ -0,0 +1,93 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// the token every corpus kind contains at a known rate, so that the
+// benchmark cases always have something to find
+#define CORPUS_NEEDLE "grepWinNeedle"
+
+enum class CorpusKind
+{
+    Source,
+    Log,
+    Utf16Le,
+    Utf16Be,
+    Binary,
+    DeepTree,
+    Huge,
+};
+
+struct CorpusKindInfo
+{
+    CorpusKind            kind;
+    std::filesystem::path dir;
+    uint64_t              files = 0;
+    uint64_t              bytes = 0;
+};
+
+/// Writes a synthetic search corpus below a root folder.
+///
+/// The output only depends on the seed and the scale: the generator uses its
+/// own PRNG and never the std distributions (which differ between standard
+/// libraries), so the same arguments produce byte identical files on every
+/// platform. An existing corpus with a matching stamp file is reused.
+class CCorpusGenerator
+{
+public:
+    CCorpusGenerator(const std::filesystem::path& root, uint64_t seed, double scale);
+
+    bool                               Generate(bool bForce);
+    const std::vector<CorpusKindInfo>& GetKinds() const { return m_kinds; }
+
+    static const char*                 KindName(CorpusKind kind);
+
+private:
+    uint64_t    Next();
+    uint64_t    Range(uint64_t lo, uint64_t hi);
+    bool        Chance(uint32_t perThousand);
+    size_t      Scaled(size_t count) const;
+
+    std::string SourceLine();
+    std::string LogLine(uint64_t lineNo);
+    std::string TextLine();
+    std::string Word();
+    std::string Identifier();
+
+    void        WriteSource(CorpusKindInfo& info);
+    void        WriteLog(CorpusKindInfo& info);
+    void        WriteUtf16(CorpusKindInfo& info, bool bigEndian);
+    void        WriteBinary(CorpusKindInfo& info);
+    void        WriteDeepTree(CorpusKindInfo& info);
+    void        WriteHuge(CorpusKindInfo& info);
+    void        WriteFile(CorpusKindInfo& info, const std::filesystem::path& path, const std::string& content);
+    void        Measure();
+
+    std::string StampText() const;
+
+private:
+    std::filesystem::path       m_root;
+    uint64_t                    m_seed;
+    uint64_t                    m_state;
+    double                      m_scale;
+    std::vector<CorpusKindInfo> m_kinds;
+};
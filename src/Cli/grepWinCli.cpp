@@ -0,0 +1,52 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+// console front end for the headless search, for the platforms without the
+// dialog. On Windows, grepWin.exe /headless does the same.
+//
+// usage: grepWinCli [switches] [path ...]
+// with the same switches as grepWin.exe, e.g.
+//        grepWinCli /searchfor:TODO /filemask:*.cpp|*.h /content src
+//        grepWinCli /server
+//        grepWinCli /useserver /searchfor:TODO src
+#include "SearchEnginePlatform.h"
+#include "HeadlessSearch.h"
+#include "UnicodeUtils.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+int wmain(int argc, wchar_t* argv[])
+#else
+int main(int argc, char* argv[])
+#endif
+{
+    std::vector<std::wstring> args;
+    for (int i = 1; i < argc; ++i)
+    {
+#ifdef _WIN32
+        args.push_back(argv[i]);
+#else
+        args.push_back(CUnicodeUtils::StdGetUnicode(argv[i]));
+#endif
+    }
+    return RunHeadlessCommandLine(args, stdout, stderr);
+}
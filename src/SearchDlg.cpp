@@ -24,7 +24,7 @@
 #include "COMPtrs.h"
 #include "DarkModeHelper.h"
 #include "DebugOutput.h"
-#include "DirFileEnum.h"
+#include "DirectoryWatcher.h"
 #include "DPIAware.h"
 #include "DropFiles.h"
 #include "Language.h"
@@ -35,11 +35,12 @@
 #include "OnOutOfScope.h"
 #include "PathUtils.h"
 #include "PreserveChdir.h"
-#include "RegexReplaceFormatter.h"
 #include "RegexTestDlg.h"
 #include "Registry.h"
 #include "resource.h"
 #include "ResString.h"
+#include "ResultDiff.h"
+#include "SearchEngine.h"
 #include "SearchInfo.h"
 #include "Settings.h"
 #include "ShellContextMenu.h"
@@ -49,10 +50,8 @@
 #include "TempFile.h"
 #include "TextFile.h"
 #include "Theme.h"
-#include "ThreadPool.h"
 #include "UnicodeUtils.h"
 #include "version.h"
-#include "TextOffset.h"
 
 #include <algorithm>
 #include <Commdlg.h>
@@ -67,23 +66,131 @@
 #pragma warning(disable : 4996) // warning STL4010: Various members of std::allocator are deprecated in C++17
 
 #include <boost/regex.hpp>
-#include <boost/iostreams/device/mapped_file.hpp>
-#include <boost/filesystem/path.hpp>
 #pragma warning(pop)
 
 #define GREPWIN_DATEBUFFER 100
 #define LABELUPDATETIMER   10
-#define SEARCHBLOCKSIZE    (1 << 26) // 64MB
 
 DWORD WINAPI     SearchThreadEntry(LPVOID lpParam);
 extern HANDLE    hInitProtection;
 extern ULONGLONG g_startTime;
 
+// the result of a watched file which changed, posted to the dialog
+struct WatchUpdate
+{
+    int         generation = 0;
+    bool        bRemoved   = false;
+    bool        bAsResult  = false;
+    CSearchInfo info;
+};
+
+// the order of the results after a click on a column header,
+// left for the dialog by the thread which sorted them
+struct SortedResults
+{
+    std::vector<int>                  itemOrder;
+    // the rows in the new order, unless a filter was still adding them
+    bool                              bRows = false;
+    std::vector<int>                  fileRows;
+    std::vector<std::tuple<int, int>> lineRows;
+};
+
+// the rows of one chunk of the results which pass the quick filter,
+// posted to the dialog by the threads which filter them
+struct FilteredRows
+{
+    int                               generation = 0;
+    size_t                            chunk      = 0;
+    std::vector<int>                  fileRows;
+    std::vector<std::tuple<int, int>> lineRows;
+};
+
+// what a search leaves for the next one, handed to the dialog with
+// WM_GREPWIN_THREADEND. The dialog's thread reads the members these
+// go to while the search runs, so only it assigns them.
+struct SearchThreadEnd
+{
+    SearchOptions                    options;
+    // nullptr after a replace, the files have to be searched again
+    std::shared_ptr<CSearchSnapshot> snapshot;
+    // false if the folder listings are not kept
+    bool                             bDirCache = false;
+    // the folder listings if there were none yet, and the roots loaded
+    std::unique_ptr<CSearchCache>    dirCache;
+    std::set<std::wstring>           dirCacheRoots;
+};
+
+// searches the files of a search again when they change.
+// The results come from the watcher thread and are posted to the dialog,
+// which must not wait for the watcher while it handles its messages.
+class CResultWatcher : public ISearchResultSink
+{
+public:
+    CResultWatcher(HWND hWnd, const SearchOptions& options, int generation)
+        : m_hWnd(hWnd)
+        , m_generation(generation)
+        , m_searchPaths(options.searchPaths)
+        , m_bRecursive(options.includeSubfolders)
+        , m_engine(options, *this, m_cancelled)
+        , m_watcher([this](const std::vector<std::wstring>& paths) { m_engine.SearchChangedFiles(paths); })
+    {
+    }
+
+    ~CResultWatcher() override
+    {
+        m_cancelled.Cancel();
+        m_watcher.Stop();
+    }
+
+    bool Start() { return m_watcher.Start(m_searchPaths, m_bRecursive); }
+
+    void OnSearchStart() override {}
+    void OnFileResult(const CSearchInfo& sInfo, bool /*bSearched*/, bool bAsResult) override
+    {
+        auto update       = std::make_unique<WatchUpdate>();
+        update->bAsResult = bAsResult;
+        update->info      = sInfo;
+        Post(std::move(update));
+    }
+    void OnFileSkipped() override {}
+    void OnSearchEnd() override {}
+    void OnFileRemoved(const std::wstring& path) override
+    {
+        auto update           = std::make_unique<WatchUpdate>();
+        update->bRemoved      = true;
+        update->info.filePath = path;
+        Post(std::move(update));
+    }
+
+private:
+    void Post(std::unique_ptr<WatchUpdate> update)
+    {
+        update->generation = m_generation;
+        if (PostMessage(m_hWnd, SEARCH_WATCHUPDATE, 0, reinterpret_cast<LPARAM>(update.get())))
+            update.release();
+    }
+
+    HWND                      m_hWnd;
+    int                       m_generation;
+    std::vector<std::wstring> m_searchPaths;
+    bool                      m_bRecursive;
+    CCancellationToken        m_cancelled;
+    CSearchEngine             m_engine;
+    // the last member: it is stopped before the engine goes away
+    CDirectoryWatcher         m_watcher;
+};
+
 namespace
 {
 
 constexpr auto SearchEditSubclassID = 4321;
 
+// the results a filter thread takes at once
+constexpr size_t FilterChunkSize = 4096;
+
+// the steps of the progress bar while exporting
+constexpr int ExportProgressRange = 1000;
+
 void           drawRedEditBox(HWND hWnd, WPARAM wParam)
 {
     // make the border of the edit control red in case
@@ -181,92 +288,119 @@ LRESULT CALLBACK FileNameMatchEditWndProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
     return DefSubclassProc(hWnd, uMsg, wParam, lParam);
 }
 
-void escapeForRegexEx(std::wstring& str, int type)
+void removeGrepWinExtVariables(std::wstring& str)
 {
-    const wchar_t* specialChar[17] = {
-        // oringinal
-        L"\\",
-        // regex special chars, current and future
-        L"^", L"$", L".", L"?", L"*", L"+", L"[", L"]", L"(", L")", L"{", L"}", L"|",
-        // command line special chars
-        L"\"", L" ", L"\t"};
-    const wchar_t* specialEscaped[17] = {
-        L"\\x5c",
-        L"\\^", L"\\$", L"\\.", L"\\?", L"\\*", L"\\+", L"\\[", L"\\]", L"\\(", L"\\)", L"\\{", L"\\}", L"\\|",
-        L"\\x22", L"\\x20", L"\\x09"};
-    int count;
-    switch (type)
-    {
-        case 1: // one line string as process argv
-            count = _countof(specialChar);
-            break;
-        default: // regex safe as text
-            count = 14;
-            break;
-    }
-    for (int i = 0; i < count; ++i)
+    for (const auto& s : {L"${filepath}", L"${filename}", L"${fileext}"})
     {
-        SearchReplace(str, specialChar[i], specialEscaped[i]);
+        SearchReplace(str, s, L"");
     }
 }
 
-void escapeForReplaceText(std::wstring& str)
+bool isRegexValid(const std::wstring& searchString)
 {
-    const wchar_t* specialChar[6]    = {L"\\", L"$", L"(", L")", L"?", L","};
-    const wchar_t* specialEscaped[6] = {L"\\x5c", L"\\$", L"\\(", L"\\)", L"\\?", L"\\,"};
-    for (int i = 0; i < _countof(specialChar); ++i)
+    bool bValid = true;
+    try
+    {
+        boost::wregex expression = boost::wregex(searchString);
+    }
+    catch (const std::exception&)
     {
-        SearchReplace(str, specialChar[i], specialEscaped[i]);
+        bValid = false;
     }
+    return bValid;
 }
 
-void removeGrepWinExtVariables(std::wstring& str)
+// the time zone the dates of the list are shown in, read once
+const TIME_ZONE_INFORMATION& localTimeZone()
 {
-    for (const auto& s : {L"${filepath}", L"${filename}", L"${fileext}"})
+    static const TIME_ZONE_INFORMATION timeZone = [] {
+        TIME_ZONE_INFORMATION tzi{};
+        GetTimeZoneInformation(&tzi);
+        return tzi;
+    }();
+    return timeZone;
+}
+
+// copies text to the buffer of a list view item, as much of it as fits.
+// The list shows single lines: tabs and line breaks become spaces.
+void copyListText(LPWSTR dest, int destSize, std::wstring_view text)
+{
+    if (destSize <= 0)
+        return;
+    size_t count = min(text.size(), static_cast<size_t>(destSize) - 1);
+    for (size_t i = 0; i < count; ++i)
     {
-        SearchReplace(str, s, L"");
+        wchar_t c = text[i];
+        dest[i]   = (c == '\t' || c == '\n' || c == '\r') ? ' ' : c;
     }
+    dest[count] = 0;
 }
 
-void replaceGrepWinFilePathVariables(std::wstring& str, std::wstring& filePath)
+// measures texts with a font of the result list, in a device context
+// of its own
+class CListTextMeasurer : public ITextMeasurer
 {
-    // those variables are for regex mode only
-    std::wstring fullPath = filePath;
-    escapeForRegexEx(fullPath, 0);
-
-    std::wstring fileNameFull = fullPath.substr(fullPath.rfind(L"\\x5c") + 4);
-    std::wstring filename;
-    std::wstring fileExt;
-    auto         dotPos = fileNameFull.find_last_of(L'.');
-    if (dotPos != std::string::npos)
+public:
+    CListTextMeasurer()
+        : m_hdc(CreateCompatibleDC(nullptr))
+        , m_hDefaultFont(nullptr)
     {
-        filename = fileNameFull.substr(0, dotPos - 1);
-        if (fileNameFull.size() > dotPos)
-        {
-            fileExt = fileNameFull.substr(dotPos + 1);
-        }
     }
-    else
+    ~CListTextMeasurer() override
     {
-        filename = fileNameFull;
+        SetFont(nullptr);
+        DeleteDC(m_hdc);
     }
-    SearchReplace(str, L"${filepath}", fullPath);
-    SearchReplace(str, L"${filename}", filename);
-    SearchReplace(str, L"${fileext}", fileExt);
-}
 
-bool isRegexValid(const std::wstring& searchString)
-{
-    bool bValid = true;
-    try
+    // nullptr selects the font the context came with again, so the
+    // font of the list is not kept selected once it is destroyed
+    void SetFont(HFONT hFont)
     {
-        boost::wregex expression = boost::wregex(searchString);
+        auto hOldFont = SelectObject(m_hdc, hFont ? hFont : m_hDefaultFont);
+        if (m_hDefaultFont == nullptr)
+            m_hDefaultFont = hOldFont;
     }
-    catch (const std::exception&)
+
+    int TextWidth(std::wstring_view text) override
     {
-        bValid = false;
+        SIZE textSize{};
+        GetTextExtentPoint32(m_hdc, text.data(), static_cast<int>(text.size()), &textSize);
+        return textSize.cx;
     }
-    return bValid;
+
+private:
+    HDC     m_hdc;
+    HGDIOBJ m_hDefaultFont;
+};
+
+// the mark of a changed line when results are compared, see CResultDiff
+const wchar_t* changeMark(MatchChange change)
+{
+    switch (change)
+    {
+        case MatchChange::Added:
+            return L"+";
+        case MatchChange::Removed:
+            return L"-";
+        case MatchChange::Moved:
+            return L"~";
+    }
+    return L"";
+}
+
+const std::wstring& encodingName(CTextFile::UnicodeType type)
+{
+    static const std::wstring names[] = {
+        CTextFile::GetEncodingString(CTextFile::AutoType),
+        CTextFile::GetEncodingString(CTextFile::Binary),
+        CTextFile::GetEncodingString(CTextFile::Ansi),
+        CTextFile::GetEncodingString(CTextFile::Unicode_Le),
+        CTextFile::GetEncodingString(CTextFile::Unicode_Be),
+        CTextFile::GetEncodingString(CTextFile::UTF8),
+    };
+    if (static_cast<size_t>(type) < std::size(names))
+        return names[type];
+    return names[CTextFile::AutoType];
 }
 } // namespace
 
@@ -276,7 +410,6 @@ UINT CSearchDlg::m_grepwinStartupmsg = RegisterWindowMessage(L"grepWin_StartupMe
 CSearchDlg::CSearchDlg(HWND hParent)
     : m_hParent(hParent)
     , m_dwThreadRunning(FALSE)
-    , m_cancelled(FALSE)
     , m_bBlockUpdate(false)
     , m_bookmarksDlg(nullptr)
     , m_patternRegexC(false)
@@ -326,9 +459,27 @@ CSearchDlg::CSearchDlg(HWND hParent)
     , m_bConfirmationOnReplace(true)
     , m_showContent(false)
     , m_showContentSet(false)
+    , m_bRefresh(false)
+    , m_bFullWalk(false)
+    , m_bWatch(false)
+    , m_watchGeneration(0)
+    , m_bRefine(false)
+    , m_bCompareResults(false)
+    , m_bOpenExport(false)
+    , m_exportGeneration(0)
+    , m_sortGeneration(0)
+    , m_fileColumnWidths(7)
+    , m_lineColumnWidths(5)
+    , m_columnWidthChanges(0)
+    , m_filterCancelled(false)
+    , m_filterNextChunk(0)
+    , m_filterChunkCount(0)
+    , m_filterShownChunks(0)
+    , m_filterGeneration(0)
     , m_totalItems(0)
     , m_searchedItems(0)
     , m_totalMatches(0)
+    , m_timedOutItems(0)
     , m_selectedItems(0)
     , m_bAscending(true)
     , m_hasSearchDir(false)
@@ -472,6 +623,7 @@ LRESULT CSearchDlg::DlgFunc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
             AddToolTip(IDC_EDITMULTILINE1, TranslatedString(hResource, IDS_EDITMULTILINE_TT).c_str());
             AddToolTip(IDC_EDITMULTILINE2, TranslatedString(hResource, IDS_EDITMULTILINE_TT).c_str());
             AddToolTip(IDC_EXPORT, TranslatedString(hResource, IDS_EXPORT_TT).c_str());
+            SendDlgItemMessage(hwndDlg, IDC_RESULTFILTER, EM_SETCUEBANNER, TRUE, reinterpret_cast<LPARAM>(TranslatedString(hResource, IDS_RESULTFILTER_CUE).c_str()));
             AddToolTip(IDC_SEARCHPATHMULTILINEEDIT, TranslatedString(hResource, IDS_EDITMULTILINE_TT).c_str());
             AddToolTip(IDOK, TranslatedString(hResource, IDS_SHIFT_NOTSEARCH).c_str());
             AddToolTip(IDC_PATHMRU, TranslatedString(hResource, IDS_OPEN_MRU).c_str());
@@ -786,6 +938,7 @@ LRESULT CSearchDlg::DlgFunc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
             m_resizer.AddControl(hwndDlg, IDC_REPLACE, RESIZER_TOPRIGHT);
             m_resizer.AddControl(hwndDlg, IDOK, RESIZER_TOPRIGHT);
             m_resizer.AddControl(hwndDlg, IDC_GROUPSEARCHRESULTS, RESIZER_TOPLEFTBOTTOMRIGHT);
+            m_resizer.AddControl(hwndDlg, IDC_RESULTFILTER, RESIZER_TOPLEFTRIGHT);
             m_resizer.AddControl(hwndDlg, IDC_RESULTLIST, RESIZER_TOPLEFTBOTTOMRIGHT);
             m_resizer.AddControl(hwndDlg, IDC_SEARCHINFOLABEL, RESIZER_BOTTOMLEFTRIGHT);
             m_resizer.AddControl(hwndDlg, IDC_EXPORT, RESIZER_BOTTOMRIGHT);
@@ -865,7 +1018,7 @@ LRESULT CSearchDlg::DlgFunc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
             if (m_updateCheckThread.joinable())
                 m_updateCheckThread.join();
             if (m_dwThreadRunning)
-                m_cancelled = true;
+                m_cancelled.Cancel();
             else
             {
                 SaveSettings();
@@ -882,6 +1035,10 @@ LRESULT CSearchDlg::DlgFunc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
         }
         break;
         case WM_DESTROY:
+            StopWatching();
+            FinishSorting();
+            StopFiltering();
+            FinishExport(true);
             RemoveWindowSubclass(*this, SearchEditWndProc, SearchEditSubclassID);
             CTheme::Instance().RemoveRegisteredCallback(m_themeCallbackId);
             break;
@@ -940,7 +1097,16 @@ LRESULT CSearchDlg::DlgFunc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
                                 auto sCaptureSearch      = TranslatedString(hResource, IDS_CAPTURESEARCH);
                                 AppendMenu(hSplitMenu, bIsDir ? MF_STRING : MF_STRING | MF_DISABLED, IDC_INVERSESEARCH, sInverseSearch.c_str());
                                 AppendMenu(hSplitMenu, m_items.empty() ? MF_STRING | MF_DISABLED : MF_STRING, IDC_SEARCHINFOUNDFILES, sSearchInFoundFiles.c_str());
+                                auto sPreviousResults = TranslatedString(hResource, IDS_PREVIOUSRESULTS);
+                                AppendMenu(hSplitMenu, m_previousResults.empty() ? MF_STRING | MF_DISABLED : MF_STRING, IDC_PREVIOUSRESULTS, sPreviousResults.c_str());
+                                auto sOpenResults = TranslatedString(hResource, IDS_OPENRESULTS);
+                                AppendMenu(hSplitMenu, MF_STRING, IDC_OPENRESULTS, sOpenResults.c_str());
+                                auto sCompareResults = TranslatedString(hResource, IDS_COMPARERESULTS);
+                                AppendMenu(hSplitMenu, m_items.empty() ? MF_STRING | MF_DISABLED : MF_STRING, IDC_COMPARERESULTS, sCompareResults.c_str());
                                 AppendMenu(hSplitMenu, m_bUseRegex && GetDlgItemTextLength(IDC_REPLACETEXT) ? MF_STRING : MF_STRING | MF_DISABLED, IDC_CAPTURESEARCH, sCaptureSearch.c_str());
+                                auto sWatchResults = TranslatedString(hResource, IDS_WATCHRESULTS);
+                                AppendMenu(hSplitMenu, MF_SEPARATOR, 0, nullptr);
+                                AppendMenu(hSplitMenu, m_bWatch ? MF_STRING | MF_CHECKED : MF_STRING, IDC_WATCHRESULTS, sWatchResults.c_str());
                             }
                             // Display the menu.
                             TrackPopupMenu(hSplitMenu, TPM_LEFTALIGN | TPM_TOPALIGN, pt.x, pt.y, 0, *this, nullptr);
@@ -1024,7 +1190,11 @@ LRESULT CSearchDlg::DlgFunc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
             m_totalItems    = 0;
             m_searchedItems = 0;
             m_totalMatches  = 0;
+            m_timedOutItems = 0;
             m_selectedItems = 0;
+            m_pendingSort.reset();
+            m_fileColumnWidths.Reset();
+            m_lineColumnWidths.Reset();
             UpdateInfoLabel();
             // reset the sort indicator
             HDITEM hd         = {0};
@@ -1044,11 +1214,18 @@ LRESULT CSearchDlg::DlgFunc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
         break;
         case SEARCH_FOUND:
         {
-            auto searchInfo = reinterpret_cast<CSearchInfo*>(lParam);
-            m_totalMatches += static_cast<int>(searchInfo->matchCount);
-            if ((wParam != 0) || m_searchString.empty() || searchInfo->readError || !searchInfo->exception.empty() || m_bNotSearch)
+            AddSearchResult(*reinterpret_cast<const CSearchInfo*>(lParam), wParam != 0);
+        }
+        break;
+        case SEARCH_FOUNDBATCH:
+        {
+            // the progress and the results of a batch of small files
+            for (const auto& result : *reinterpret_cast<const std::vector<SearchFileResult>*>(lParam))
             {
-                AddFoundEntry(searchInfo);
+                if (result.bSearched)
+                    m_searchedItems++;
+                m_totalItems++;
+                AddSearchResult(result.sInfo, result.bAsResult);
             }
         }
         break;
@@ -1067,6 +1244,7 @@ LRESULT CSearchDlg::DlgFunc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
             ::SetDlgItemText(*this, IDOK, TranslatedString(hResource, IDS_SEARCH).c_str());
             DialogEnableWindow(IDC_RESULTFILES, true);
             DialogEnableWindow(IDC_RESULTCONTENT, true);
+            DialogEnableWindow(IDC_RESULTFILTER, true);
             ShowWindow(GetDlgItem(*this, IDC_PROGRESS), SW_HIDE);
             SendDlgItemMessage(*this, IDC_PROGRESS, PBM_SETMARQUEE, 0, 0);
             if (m_pTaskbarList)
@@ -1080,6 +1258,9 @@ LRESULT CSearchDlg::DlgFunc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
             if (wParam == LABELUPDATETIMER)
             {
                 AddFoundEntry(nullptr, true);
+                // the columns grow with the results which arrived
+                if (m_fileColumnWidths.Changes() + m_lineColumnWidths.Changes() != m_columnWidthChanges)
+                    AutoSizeAllColumns();
                 UpdateInfoLabel();
             }
         }
@@ -1192,8 +1373,91 @@ LRESULT CSearchDlg::DlgFunc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
         }
         case WM_GREPWIN_THREADEND:
         {
+            // the search is over once the dialog has what it left, so
+            // that a new one can't start from the state of an older one
+            std::unique_ptr<SearchThreadEnd> threadEnd(reinterpret_cast<SearchThreadEnd*>(lParam));
+            m_dwThreadRunning = false;
+            m_bFullWalk       = false;
+            // refresh cursor
+            POINT pt;
+            GetCursorPos(&pt);
+            SetCursorPos(pt.x, pt.y);
+            if (threadEnd)
+            {
+                m_lastSearchOptions = std::move(threadEnd->options);
+                m_snapshot          = std::move(threadEnd->snapshot);
+                if (!threadEnd->bDirCache)
+                {
+                    m_dirCache.reset();
+                    m_dirCacheRoots.clear();
+                }
+                else
+                {
+                    if (threadEnd->dirCache)
+                        m_dirCache = std::move(threadEnd->dirCache);
+                    m_dirCacheRoots.merge(threadEnd->dirCacheRoots);
+                }
+            }
             if (m_endDialog)
+            {
                 EndDialog(m_hwnd, IDOK);
+                break;
+            }
+            if (m_pendingSort)
+            {
+                // the sort asked for while the search ran
+                auto column = *m_pendingSort;
+                m_pendingSort.reset();
+                SortResults(column, m_bAscending);
+            }
+            if (m_bWatch)
+                StartWatching();
+        }
+        break;
+        case SEARCH_WATCHUPDATE:
+        {
+            std::unique_ptr<WatchUpdate> update(reinterpret_cast<WatchUpdate*>(lParam));
+            if (update->generation == m_watchGeneration && m_resultWatcher && !m_dwThreadRunning)
+                UpdateWatchedEntry(*update);
+        }
+        break;
+        case SEARCH_SORTED:
+        {
+            if (static_cast<int>(wParam) == m_sortGeneration)
+                FinishSorting();
+        }
+        break;
+        case SEARCH_EXPORTPROGRESS:
+        {
+            if (static_cast<int>(lParam) == m_exportGeneration && m_exportThread.joinable())
+            {
+                SendDlgItemMessage(*this, IDC_PROGRESS, PBM_SETPOS, wParam, 0);
+                if (m_pTaskbarList)
+                    m_pTaskbarList->SetProgressValue(*this, wParam, ExportProgressRange);
+            }
+        }
+        break;
+        case SEARCH_EXPORTED:
+        {
+            if (static_cast<int>(lParam) != m_exportGeneration)
+                break;
+            FinishExport(false);
+            if (wParam && m_bOpenExport)
+            {
+                SHELLEXECUTEINFO sei = {0};
+                sei.cbSize           = sizeof(SHELLEXECUTEINFO);
+                sei.lpVerb           = TEXT("open");
+                sei.lpFile           = m_exportPath.c_str();
+                sei.nShow            = SW_SHOWNORMAL;
+                ShellExecuteEx(&sei);
+            }
+        }
+        break;
+        case SEARCH_FILTERED:
+        {
+            std::unique_ptr<FilteredRows> rows(reinterpret_cast<FilteredRows*>(lParam));
+            if (rows->generation == m_filterGeneration)
+                ShowFilteredRows(std::move(rows));
         }
         break;
         case WM_BOOKMARK:
@@ -1268,7 +1532,7 @@ LRESULT CSearchDlg::DoCommand(int id, int msg)
         {
             if (m_dwThreadRunning)
             {
-                m_cancelled = true;
+                m_cancelled.Cancel();
             }
             else
             {
@@ -1298,30 +1562,45 @@ LRESULT CSearchDlg::DoCommand(int id, int msg)
                     }
                 }
 
-                if ((id == IDC_SEARCHINFOUNDFILES) && (!m_items.empty()))
+                ShowWindow(GetDlgItem(*this, IDC_EXPORT), SW_HIDE);
+                FinishSorting();
+                StopFiltering();
+                FinishExport(true);
+                // the files of the results are searched again, without
+                // listing the folders. The results stay for IDC_PREVIOUSRESULTS.
+                m_bRefine = (id == IDC_SEARCHINFOUNDFILES) && (!m_items.empty());
+                if (m_bRefine)
                 {
-                    m_searchPath.clear();
-                    for (const auto& item : m_items)
-                    {
-                        if (!m_searchPath.empty())
-                            m_searchPath += L"|";
-                        m_searchPath += item.filePath;
-                    }
+                    ResultGeneration previous;
+                    previous.items            = std::move(m_items);
+                    previous.options          = m_lastSearchOptions;
+                    previous.totalItems       = m_totalItems;
+                    previous.searchedItems    = m_searchedItems;
+                    previous.totalMatches     = m_totalMatches;
+                    previous.timedOutItems    = m_timedOutItems;
+                    previous.fileColumnWidths = m_fileColumnWidths.Widths();
+                    previous.lineColumnWidths = m_lineColumnWidths.Widths();
+                    previous.itemOrder        = std::move(m_itemOrder);
+                    m_previousResults.push_back(std::move(previous));
                 }
+                else
+                    m_previousResults.clear();
 
                 m_searchedItems = 0;
                 m_totalItems    = 0;
 
-                ShowWindow(GetDlgItem(*this, IDC_EXPORT), SW_HIDE);
                 m_items.clear();
+                m_itemOrder.clear();
                 m_listItems.clear();
+                m_fileListItems.clear();
                 m_listItems.reserve(500000);
-                m_backupAndTempFiles.clear();
 
                 HWND hListControl = GetDlgItem(*this, IDC_RESULTLIST);
                 ListView_SetItemCount(hListControl, 0);
                 DialogEnableWindow(IDC_RESULTFILES, false);
                 DialogEnableWindow(IDC_RESULTCONTENT, false);
+                // the filter stays, new results are filtered as they arrive
+                DialogEnableWindow(IDC_RESULTFILTER, false);
 
                 m_autoCompleteFilePatterns.AddEntry(m_patternRegex.c_str());
                 m_autoCompleteExcludeDirsPatterns.AddEntry(m_excludeDirsPatternRegex.c_str());
@@ -1396,31 +1675,13 @@ LRESULT CSearchDlg::DoCommand(int id, int msg)
                     InitResultList();
                 }
 
-                m_dwThreadRunning = true;
-                m_cancelled       = false;
-                SetDlgItemText(*this, IDOK, TranslatedString(hResource, IDS_STOP).c_str());
-                ShowWindow(GetDlgItem(*this, IDC_PROGRESS), SW_SHOW);
-                SendDlgItemMessage(*this, IDC_PROGRESS, PBM_SETMARQUEE, 1, 0);
-                if (m_pTaskbarList)
-                    m_pTaskbarList->SetProgressState(*this, TBPF_INDETERMINATE);
-                // now start the thread which does the searching
-                DWORD  dwThreadId = 0;
-                HANDLE hThread    = CreateThread(nullptr, // no security attribute
-                                                 0,       // default stack size
-                                                 SearchThreadEntry,
-                                                 static_cast<LPVOID>(this), // thread parameter
-                                                 0,                         // not suspended
-                                                 &dwThreadId);              // returns thread ID
-                if (hThread != nullptr)
-                {
-                    // Closing the handle of a running thread just decreases
-                    // the ref count for the thread object.
-                    CloseHandle(hThread);
-                }
-                else
-                {
-                    SendMessage(*this, SEARCH_END, 0, 0);
-                }
+                // a refresh reuses the results of the last search
+                // for the files which did not change since
+                if (!m_bRefresh)
+                    m_snapshot.reset();
+                StopWatching();
+
+                StartSearchThread();
             }
         }
         break;
@@ -1434,7 +1695,7 @@ LRESULT CSearchDlg::DoCommand(int id, int msg)
             if (escClose)
             {
                 if (m_dwThreadRunning)
-                    m_cancelled = true;
+                    m_cancelled.Cancel();
                 else
                 {
                     SaveSettings();
@@ -1451,6 +1712,39 @@ LRESULT CSearchDlg::DoCommand(int id, int msg)
             }
         }
         break;
+        case IDC_WATCHRESULTS:
+        {
+            m_bWatch = !m_bWatch;
+            if (!m_bWatch)
+                StopWatching();
+            else if (!m_dwThreadRunning)
+                StartWatching();
+        }
+        break;
+        case IDC_PREVIOUSRESULTS:
+        {
+            if (!m_dwThreadRunning)
+                ShowPreviousResults();
+        }
+        break;
+        case IDC_OPENRESULTS:
+        {
+            if (m_dwThreadRunning)
+                break;
+            auto path = AskForResultsFile();
+            if (!path.empty())
+                LoadResults(path);
+        }
+        break;
+        case IDC_COMPARERESULTS:
+        {
+            if (m_dwThreadRunning || m_items.empty())
+                break;
+            auto path = AskForResultsFile();
+            if (!path.empty())
+                CompareResults(path);
+        }
+        break;
         case IDC_RADIO_DATE_ALL:
         case IDC_RADIO_DATE_NEWER:
         case IDC_RADIO_DATE_OLDER:
@@ -1693,6 +1987,25 @@ LRESULT CSearchDlg::DoCommand(int id, int msg)
             }
         }
         break;
+        case IDC_RESULTFILTER:
+        {
+            if (msg == EN_CHANGE)
+            {
+                auto buf = GetDlgItemText(IDC_RESULTFILTER);
+                StopFiltering();
+                if (wcslen(buf.get()))
+                    m_resultFilter = std::make_unique<CResultFilter>(buf.get());
+                else
+                    m_resultFilter.reset();
+                RebuildListItems();
+
+                HWND hListControl = GetDlgItem(*this, IDC_RESULTLIST);
+                bool fileList     = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
+                ListView_SetItemCountEx(hListControl, ListRowCount(fileList), LVSICF_NOSCROLL);
+                InvalidateRect(hListControl, nullptr, FALSE);
+            }
+        }
+        break;
         case IDC_SIZEEDIT:
         {
             if (msg == EN_CHANGE)
@@ -1863,6 +2176,28 @@ LRESULT CSearchDlg::DoCommand(int id, int msg)
                 pfdCustomize->AddCheckButton(103, TranslatedString(hResource, IDS_EXPORTMATCHLINECONTENT).c_str(), exportlinecontent);
             }
 
+            // the formats in the order of the file types
+            constexpr ExportFormat exportFormats[] = {ExportFormat::Text, ExportFormat::Csv, ExportFormat::JsonLines, ExportFormat::Binary};
+            auto                   sTextFiles      = TranslatedString(hResource, IDS_EXPORTTEXTFILES);
+            auto                   sCsvFiles       = TranslatedString(hResource, IDS_EXPORTCSVFILES);
+            auto                   sJsonLinesFiles = TranslatedString(hResource, IDS_EXPORTJSONLINESFILES);
+            auto                   sBinaryFiles    = TranslatedString(hResource, IDS_EXPORTBINARYFILES);
+            auto                   sSavedResults   = TranslatedString(hResource, IDS_EXPORTSAVEDRESULTS);
+            // the last one saves the results to be opened again, see LoadResults()
+            COMDLG_FILTERSPEC      fileTypes[]     = {{sTextFiles.c_str(), L"*.txt"},
+                                                      {sCsvFiles.c_str(), L"*.csv"},
+                                                      {sJsonLinesFiles.c_str(), L"*.jsonl"},
+                                                      {sBinaryFiles.c_str(), L"*.gwr"},
+                                                      {sSavedResults.c_str(), L"*.gwresults"}};
+            hr = pfd->SetFileTypes(_countof(fileTypes), fileTypes);
+            if (FailedShowMessage(hr))
+                break;
+            auto exportFileType = bPortable ? _wtoi(g_iniFile.GetValue(L"export", L"format", L"1"))
+                                            : static_cast<int>(static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\export_format", 1)));
+            pfd->SetFileTypeIndex(std::clamp(exportFileType, 1, static_cast<int>(_countof(fileTypes))));
+            // the extension follows the file type chosen
+            pfd->SetDefaultExtension(L"txt");
+
             // Show the save file dialog
             hr = pfd->Show(*this);
             if (hr == HRESULT_FROM_WIN32(ERROR_CANCELLED))
@@ -1898,81 +2233,49 @@ LRESULT CSearchDlg::DoCommand(int id, int msg)
             if (!includePaths && !includeMatchLineNumbers && !includeMatchLineTexts)
                 includePaths = true;
 
-            bool onlyPaths = !includeMatchLineNumbers && !includeMatchLineTexts;
             if (!path.empty())
             {
-                std::ofstream file;
-                file.open(path);
+                UINT fileTypeIndex = 1;
+                pfd->GetFileTypeIndex(&fileTypeIndex);
 
-                if (file.is_open())
+                if (bPortable)
                 {
-                    if (onlyPaths)
-                    {
-                        for (const auto& item : m_items)
-                        {
-                            file << CUnicodeUtils::StdGetUTF8(item.filePath) << std::endl;
-                        }
-                    }
-                    else
-                    {
-                        constexpr char separator = '*';
-                        for (const auto& item : m_items)
-                        {
-                            for (size_t i = 0; i < item.matchLinesNumbers.size(); ++i)
-                            {
-                                bool needSeparator = false;
-                                if (includePaths)
-                                {
-                                    file << CUnicodeUtils::StdGetUTF8(item.filePath);
-                                    needSeparator = true;
-                                }
-                                if (includeMatchLineNumbers)
-                                {
-                                    if (needSeparator)
-                                        file << separator;
-                                    file << CStringUtils::Format("%lu", item.matchLinesNumbers[i]);
-                                    needSeparator = true;
-                                }
-                                if (includeMatchLineTexts)
-                                {
-                                    if (needSeparator)
-                                        file << separator;
-                                    auto line = item.matchLines[i];
-                                    CStringUtils::rtrim(line, L"\r\n");
-                                    file << CUnicodeUtils::StdGetUTF8(line);
-                                }
-                                file << std::endl;
-                            }
-                        }
-                    }
-
-                    file.close();
+                    g_iniFile.SetValue(L"export", L"paths", includePaths ? L"1" : L"0");
+                    g_iniFile.SetValue(L"export", L"linenumbers", includeMatchLineNumbers ? L"1" : L"0");
+                    g_iniFile.SetValue(L"export", L"linecontent", includeMatchLineTexts ? L"1" : L"0");
+                    g_iniFile.SetValue(L"export", L"format", std::to_wstring(fileTypeIndex).c_str());
+                }
+                else
+                {
+                    // ReSharper disable CppEntityAssignedButNoRead
+                    auto exportPaths       = CRegStdDWORD(L"Software\\grepWin\\export_paths");
+                    auto exportLineNumbers = CRegStdDWORD(L"Software\\grepWin\\export_linenumbers");
+                    auto exportLineContent = CRegStdDWORD(L"Software\\grepWin\\export_linecontent");
+                    auto exportFormat      = CRegStdDWORD(L"Software\\grepWin\\export_format");
+                    // ReSharper restore CppEntityAssignedButNoRead
+
+                    exportPaths            = includePaths ? 1 : 0;
+                    exportLineNumbers      = includeMatchLineNumbers ? 1 : 0;
+                    exportLineContent      = includeMatchLineTexts ? 1 : 0;
+                    exportFormat           = fileTypeIndex;
+                }
 
-                    if (bPortable)
-                    {
-                        g_iniFile.SetValue(L"export", L"paths", includePaths ? L"1" : L"0");
-                        g_iniFile.SetValue(L"export", L"linenumbers", includeMatchLineNumbers ? L"1" : L"0");
-                        g_iniFile.SetValue(L"export", L"linecontent", includeMatchLineTexts ? L"1" : L"0");
-                    }
-                    else
-                    {
-                        // ReSharper disable CppEntityAssignedButNoRead
-                        auto exportPaths       = CRegStdDWORD(L"Software\\grepWin\\export_paths");
-                        auto exportLineNumbers = CRegStdDWORD(L"Software\\grepWin\\export_linenumbers");
-                        auto exportLineContent = CRegStdDWORD(L"Software\\grepWin\\export_linecontent");
-                        // ReSharper restore CppEntityAssignedButNoRead
-
-                        exportPaths            = includePaths ? 1 : 0;
-                        exportLineNumbers      = includeMatchLineNumbers ? 1 : 0;
-                        exportLineContent      = includeMatchLineTexts ? 1 : 0;
-                    }
-                    SHELLEXECUTEINFO sei = {0};
-                    sei.cbSize           = sizeof(SHELLEXECUTEINFO);
-                    sei.lpVerb           = TEXT("open");
-                    sei.lpFile           = path.c_str();
-                    sei.nShow            = SW_SHOWNORMAL;
-                    ShellExecuteEx(&sei);
+                if (fileTypeIndex > _countof(exportFormats))
+                {
+                    SavedSearchInfo info;
+                    info.searchPath   = m_searchPath;
+                    info.searchString = m_lastSearchOptions ? m_lastSearchOptions->searchString : m_searchString;
+                    info.useRegex     = m_lastSearchOptions ? m_lastSearchOptions->useRegex : m_bUseRegex;
+                    StartExport(path, std::bind_front(&CResultArchive::Save, info), false);
+                    break;
                 }
+                ExportFormat  format = exportFormats[std::max<UINT>(fileTypeIndex, 1) - 1];
+                ExportColumns columns;
+                columns.paths       = includePaths;
+                columns.lineNumbers = includeMatchLineNumbers;
+                columns.lineTexts   = includeMatchLineTexts;
+                // the binary format is for tools, there's nothing to open it with
+                StartExport(path, std::bind_front(&CResultExporter::Export, CResultExporter(format, columns)), format != ExportFormat::Binary);
             }
         }
         break;
@@ -2038,6 +2341,11 @@ void CSearchDlg::UpdateInfoLabel()
                        m_searchedItems, m_totalItems - m_searchedItems, m_totalMatches, m_items.size());
     }
     sText = buf;
+    if (m_timedOutItems > 0)
+    {
+        swprintf_s(buf, _countof(buf), TranslatedString(hResource, IDS_INFOLABELTIMEDOUT).c_str(), m_timedOutItems);
+        sText += buf;
+    }
 
     SetDlgItemText(*this, IDC_SEARCHINFOLABEL, sText.c_str());
 }
@@ -2117,71 +2425,617 @@ bool CSearchDlg::InitResultList()
     return true;
 }
 
-bool CSearchDlg::AddFoundEntry(const CSearchInfo* pInfo, bool bOnlyListControl)
+void CSearchDlg::RebuildListItems()
 {
-    if (!bOnlyListControl)
+    FinishSorting();
+    // while a search adds results, m_items must not be read by other threads
+    if (m_resultFilter && !m_dwThreadRunning)
     {
-        m_items.push_back(*pInfo);
-        int index    = static_cast<int>(m_items.size() - 1);
-        int subIndex = 0;
-        for (const auto& lineNumber : pInfo->matchLinesNumbers)
-        {
-            UNREFERENCED_PARAMETER(lineNumber);
-            m_listItems.push_back(std::make_tuple(index, subIndex));
-            ++subIndex;
-        }
+        StartFiltering();
+        return;
     }
+    StopFiltering();
+    auto size = m_listItems.size();
+    m_listItems.clear();
+    m_listItems.reserve(size);
+    m_fileListItems.clear();
+    m_fileListItems.reserve(m_items.size());
+    if (m_resultFilter)
+        m_resultFilter->AddRows(m_items, m_itemOrder, 0, m_itemOrder.size(), m_fileListItems, m_listItems);
     else
+        CResultFilter::AddAllRows(m_items, m_itemOrder, 0, m_itemOrder.size(), m_fileListItems, m_listItems);
+}
+
+void CSearchDlg::StartFiltering()
+{
+    StopFiltering();
+    m_fileListItems.clear();
+    m_listItems.clear();
+    m_filterShownChunks = 0;
+    m_filterChunkCount  = (m_itemOrder.size() + FilterChunkSize - 1) / FilterChunkSize;
+    m_filterNextChunk   = 0;
+    size_t threadCount  = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+    if (threadCount > m_filterChunkCount)
+        threadCount = m_filterChunkCount;
+    for (size_t i = 0; i < threadCount; ++i)
+        m_filterThreads.emplace_back(&CSearchDlg::FilterChunks, this, m_filterGeneration);
+}
+
+void CSearchDlg::StopFiltering()
+{
+    m_filterCancelled = true;
+    for (auto& thread : m_filterThreads)
+        thread.join();
+    m_filterThreads.clear();
+    m_filterCancelled = false;
+    m_filteredChunks.clear();
+    ++m_filterGeneration;
+}
+
+void CSearchDlg::FilterChunks(int generation)
+{
+    for (size_t chunk = m_filterNextChunk++; chunk < m_filterChunkCount && !m_filterCancelled; chunk = m_filterNextChunk++)
     {
-        HWND hListControl = GetDlgItem(*this, IDC_RESULTLIST);
-        bool fileList     = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
-        auto count        = ListView_GetItemCount(hListControl);
-        if (count != static_cast<int>(fileList ? m_items.size() : m_listItems.size()))
-            ListView_SetItemCountEx(hListControl, fileList ? m_items.size() : m_listItems.size(), LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
+        auto   rows      = std::make_unique<FilteredRows>();
+        size_t first     = chunk * FilterChunkSize;
+        rows->generation = generation;
+        rows->chunk      = chunk;
+        m_resultFilter->AddRows(m_items, m_itemOrder, first, min(first + FilterChunkSize, m_itemOrder.size()), rows->fileRows, rows->lineRows);
+        if (PostMessage(m_hwnd, SEARCH_FILTERED, 0, reinterpret_cast<LPARAM>(rows.get())))
+            rows.release();
     }
-    return true;
 }
 
-void CSearchDlg::FillResultList()
+void CSearchDlg::ShowFilteredRows(std::unique_ptr<FilteredRows> rows)
 {
-    ProfileTimer profile(L"FillResultList");
-    SetCursor(LoadCursor(nullptr, IDC_APPSTARTING));
-    // refresh cursor
-    POINT pt;
-    GetCursorPos(&pt);
-    SetCursorPos(pt.x, pt.y);
+    m_filteredChunks[rows->chunk] = std::move(rows);
+    bool bShown                   = false;
+    for (auto it = m_filteredChunks.find(m_filterShownChunks); it != m_filteredChunks.end(); it = m_filteredChunks.find(m_filterShownChunks))
+    {
+        m_fileListItems.insert(m_fileListItems.end(), it->second->fileRows.begin(), it->second->fileRows.end());
+        m_listItems.insert(m_listItems.end(), it->second->lineRows.begin(), it->second->lineRows.end());
+        m_filteredChunks.erase(it);
+        ++m_filterShownChunks;
+        bShown = true;
+    }
+    if (!bShown)
+        return;
+    if (m_filterShownChunks == m_filterChunkCount)
+    {
+        // all threads are done
+        StopFiltering();
+    }
+
+    HWND hListControl = GetDlgItem(*this, IDC_RESULTLIST);
+    bool fileList     = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
+    ListView_SetItemCountEx(hListControl, ListRowCount(fileList), LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
+}
+
+void CSearchDlg::SortResults(ResultSortColumn column, bool bAscending)
+{
+    // the search still adds to m_items, which the sort reads
+    if (m_dwThreadRunning)
+    {
+        m_pendingSort = column;
+        return;
+    }
+    FinishSorting();
+    // a filter which was stopped halfway filters the sorted results again
+    bool bFiltering = !m_filterThreads.empty();
+    StopFiltering();
+    m_sortedResults = std::make_unique<SortedResults>();
+    // m_items and the rows do not change until the thread is done, see FinishSorting()
+    m_sortThread    = std::thread([this, column, bAscending, bFiltering, hWnd = m_hwnd, generation = ++m_sortGeneration]() {
+        CResultOrder order(m_items, m_itemOrder, column, bAscending);
+        order.Sort(std::thread::hardware_concurrency());
+        auto& sorted = *m_sortedResults;
+        if (!bFiltering)
+            order.SortRows(m_fileListItems, m_listItems, sorted.fileRows, sorted.lineRows);
+        sorted.bRows     = !bFiltering;
+        sorted.itemOrder = order.Order();
+        PostMessage(hWnd, SEARCH_SORTED, generation, 0);
+    });
+}
+
+void CSearchDlg::FinishSorting()
+{
+    if (!m_sortThread.joinable())
+        return;
+    m_sortThread.join();
+    auto sorted = std::move(m_sortedResults);
+    m_itemOrder = std::move(sorted->itemOrder);
+    if (sorted->bRows)
+    {
+        m_fileListItems = std::move(sorted->fileRows);
+        m_listItems     = std::move(sorted->lineRows);
+    }
+    else
+        RebuildListItems();
 
-    bool filelist     = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
     HWND hListControl = GetDlgItem(*this, IDC_RESULTLIST);
+    bool fileList     = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
     SendMessage(hListControl, WM_SETREDRAW, FALSE, 0);
-    ListView_SetItemCountEx(hListControl, filelist ? m_items.size() : m_listItems.size(), LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
-    AutoSizeAllColumns();
+    ListView_SetItemCountEx(hListControl, ListRowCount(fileList), LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
     SendMessage(hListControl, WM_SETREDRAW, TRUE, 0);
-    SetCursor(LoadCursor(nullptr, IDC_ARROW));
-    // refresh cursor
-    GetCursorPos(&pt);
-    SetCursorPos(pt.x, pt.y);
-
     RedrawWindow(hListControl, nullptr, nullptr, RDW_ERASE | RDW_FRAME | RDW_INVALIDATE | RDW_ALLCHILDREN);
 }
 
-void CSearchDlg::ShowContextMenu(HWND hWnd, int x, int y)
+void CSearchDlg::ShowPreviousResults()
 {
-    HWND hListControl = GetDlgItem(*this, IDC_RESULTLIST);
-    if (hWnd != GetDlgItem(*this, IDC_RESULTLIST))
+    if (m_previousResults.empty())
         return;
-    bool  fileList = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
-    // check if clicked on a header
-    POINT pt       = {x, y};
-    auto  hHeader  = ListView_GetHeader(hListControl);
-    RECT  headerRc{};
-    GetWindowRect(hHeader, &headerRc);
-    if (PtInRect(&headerRc, pt))
+    FinishSorting();
+    StopFiltering();
+    FinishExport(false);
+    auto& previous      = m_previousResults.back();
+    m_items             = std::move(previous.items);
+    m_itemOrder         = std::move(previous.itemOrder);
+    m_lastSearchOptions = std::move(previous.options);
+    m_totalItems        = previous.totalItems;
+    m_searchedItems     = previous.searchedItems;
+    m_totalMatches      = previous.totalMatches;
+    m_timedOutItems     = previous.timedOutItems;
+    m_fileColumnWidths.Reset(previous.fileColumnWidths);
+    m_lineColumnWidths.Reset(previous.lineColumnWidths);
+    m_previousResults.pop_back();
+
+    // the search text goes back with the results it found
+    m_searchString = m_lastSearchOptions ? m_lastSearchOptions->searchString : std::wstring();
+    SetDlgItemText(*this, IDC_SEARCHTEXT, m_searchString.c_str());
+
+    InitResultList();
+    RebuildListItems();
+    FillResultList();
+    ShowWindow(GetDlgItem(*this, IDC_EXPORT), m_items.empty() ? SW_HIDE : SW_SHOW);
+    UpdateInfoLabel();
+    // the watch follows the files of the results shown
+    if (m_resultWatcher)
+        StartWatching();
+}
+
+void CSearchDlg::StartSearchThread()
+{
+    m_listTextState   = CurrentListTextState();
+    m_dwThreadRunning = true;
+    m_cancelled.Reset();
+    SetDlgItemText(*this, IDOK, TranslatedString(hResource, IDS_STOP).c_str());
+    ShowWindow(GetDlgItem(*this, IDC_PROGRESS), SW_SHOW);
+    SendDlgItemMessage(*this, IDC_PROGRESS, PBM_SETMARQUEE, 1, 0);
+    if (m_pTaskbarList)
+        m_pTaskbarList->SetProgressState(*this, TBPF_INDETERMINATE);
+    // now start the thread which does the searching
+    DWORD  dwThreadId = 0;
+    HANDLE hThread    = CreateThread(nullptr, // no security attribute
+                                     0,       // default stack size
+                                     SearchThreadEntry,
+                                     static_cast<LPVOID>(this), // thread parameter
+                                     0,                         // not suspended
+                                     &dwThreadId);              // returns thread ID
+    if (hThread != nullptr)
     {
-        int colCount   = Header_GetItemCount(hHeader);
-        int clickedCol = -1;
-        for (int i = 0; i < colCount; ++i)
-        {
+        // Closing the handle of a running thread just decreases
+        // the ref count for the thread object.
+        CloseHandle(hThread);
+    }
+    else
+    {
+        m_savedResults.reset();
+        m_bCompareResults = false;
+        SendMessage(*this, SEARCH_END, 0, 0);
+    }
+}
+
+void CSearchDlg::LoadResults(const std::wstring& path)
+{
+    auto archive = std::make_unique<CResultArchive>();
+    if (!archive->Open(path))
+    {
+        auto sErr = CStringUtils::Format(TranslatedString(hResource, IDS_ERR_RESULTSFILE).c_str(), path.c_str());
+        ::MessageBox(*this, sErr.c_str(), L"grepWin", MB_ICONERROR);
+        return;
+    }
+    ShowWindow(GetDlgItem(*this, IDC_EXPORT), SW_HIDE);
+    FinishSorting();
+    StopFiltering();
+    FinishExport(true);
+    StopWatching();
+    // there is no search behind the results to watch, refresh or go back from
+    m_previousResults.clear();
+    m_snapshot.reset();
+    m_lastSearchOptions.reset();
+    m_bRefine        = false;
+    m_bReplace       = false;
+    m_bNotSearch     = false;
+    m_bCaptureSearch = false;
+
+    // the search the results are from
+    const auto& info = archive->Info();
+    m_searchPath     = info.searchPath;
+    m_searchString   = info.searchString;
+    m_bUseRegex      = info.useRegex;
+    SetDlgItemText(*this, IDC_SEARCHPATH, m_searchPath.c_str());
+    SetDlgItemText(*this, IDC_SEARCHTEXT, m_searchString.c_str());
+    CheckRadioButton(*this, IDC_REGEXRADIO, IDC_TEXTRADIO, m_bUseRegex ? IDC_REGEXRADIO : IDC_TEXTRADIO);
+
+    m_items.clear();
+    m_itemOrder.clear();
+    m_listItems.clear();
+    m_fileListItems.clear();
+    m_listItems.reserve(archive->Size());
+    ListView_SetItemCount(GetDlgItem(*this, IDC_RESULTLIST), 0);
+    DialogEnableWindow(IDC_RESULTFILES, false);
+    DialogEnableWindow(IDC_RESULTCONTENT, false);
+    DialogEnableWindow(IDC_RESULTFILTER, false);
+
+    m_savedResults = std::move(archive);
+    StartSearchThread();
+}
+
+void CSearchDlg::CompareResults(const std::wstring& path)
+{
+    auto archive = std::make_unique<CResultArchive>();
+    if (!archive->Open(path))
+    {
+        auto sErr = CStringUtils::Format(TranslatedString(hResource, IDS_ERR_RESULTSFILE).c_str(), path.c_str());
+        ::MessageBox(*this, sErr.c_str(), L"grepWin", MB_ICONERROR);
+        return;
+    }
+    ShowWindow(GetDlgItem(*this, IDC_EXPORT), SW_HIDE);
+    FinishSorting();
+    StopFiltering();
+    FinishExport(true);
+    StopWatching();
+    // the compared results stay for IDC_PREVIOUSRESULTS, the changes
+    // are not a search to watch or refresh
+    ResultGeneration current;
+    current.items            = std::move(m_items);
+    current.options          = m_lastSearchOptions;
+    current.totalItems       = m_totalItems;
+    current.searchedItems    = m_searchedItems;
+    current.totalMatches     = m_totalMatches;
+    current.timedOutItems    = m_timedOutItems;
+    current.fileColumnWidths = m_fileColumnWidths.Widths();
+    current.lineColumnWidths = m_lineColumnWidths.Widths();
+    current.itemOrder        = std::move(m_itemOrder);
+    m_previousResults.push_back(std::move(current));
+    m_lastSearchOptions.reset();
+    m_bRefine = false;
+
+    m_items.clear();
+    m_itemOrder.clear();
+    m_listItems.clear();
+    m_fileListItems.clear();
+    ListView_SetItemCount(GetDlgItem(*this, IDC_RESULTLIST), 0);
+    DialogEnableWindow(IDC_RESULTFILES, false);
+    DialogEnableWindow(IDC_RESULTCONTENT, false);
+    DialogEnableWindow(IDC_RESULTFILTER, false);
+
+    m_savedResults    = std::move(archive);
+    m_bCompareResults = true;
+    StartSearchThread();
+}
+
+std::wstring CSearchDlg::AskForResultsFile()
+{
+    PreserveChdir      keepCwd;
+    IFileOpenDialogPtr pfd;
+
+    HRESULT            hr = pfd.CreateInstance(CLSID_FileOpenDialog, nullptr, CLSCTX_INPROC_SERVER);
+    if (FailedShowMessage(hr))
+        return {};
+    DWORD dwOptions;
+    hr = pfd->GetOptions(&dwOptions);
+    if (FailedShowMessage(hr))
+        return {};
+    hr = pfd->SetOptions(dwOptions | FOS_FORCEFILESYSTEM | FOS_FILEMUSTEXIST);
+    if (FailedShowMessage(hr))
+        return {};
+    auto              sSavedResults = TranslatedString(hResource, IDS_EXPORTSAVEDRESULTS);
+    COMDLG_FILTERSPEC fileTypes[]   = {{sSavedResults.c_str(), L"*.gwresults"}};
+    hr = pfd->SetFileTypes(_countof(fileTypes), fileTypes);
+    if (FailedShowMessage(hr))
+        return {};
+
+    hr = pfd->Show(*this);
+    if (hr == HRESULT_FROM_WIN32(ERROR_CANCELLED))
+        return {};
+    if (FailedShowMessage(hr))
+        return {};
+    IShellItemPtr psiResult = nullptr;
+    hr                      = pfd->GetResult(&psiResult);
+    if (FailedShowMessage(hr))
+        return {};
+    PWSTR pszPath = nullptr;
+    hr            = psiResult->GetDisplayName(SIGDN_FILESYSPATH, &pszPath);
+    if (FailedShowMessage(hr))
+        return {};
+    std::wstring path = pszPath;
+    CoTaskMemFree(pszPath);
+    return path;
+}
+
+void CSearchDlg::StartExport(const std::wstring& path, ExportFunction exportFunction, bool bOpen)
+{
+    FinishExport(true);
+    m_exportCancelled.Reset();
+    m_exportPath  = path;
+    m_bOpenExport = bOpen;
+    ++m_exportGeneration;
+
+    DialogEnableWindow(IDC_EXPORT, false);
+    // the progress bar shows a marquee while searching, and the position here
+    HWND hProgress = GetDlgItem(*this, IDC_PROGRESS);
+    SetWindowLongPtr(hProgress, GWL_STYLE, GetWindowLongPtr(hProgress, GWL_STYLE) & ~PBS_MARQUEE);
+    SendMessage(hProgress, PBM_SETRANGE32, 0, ExportProgressRange);
+    SendMessage(hProgress, PBM_SETPOS, 0, 0);
+    ShowWindow(hProgress, SW_SHOW);
+    if (m_pTaskbarList)
+        m_pTaskbarList->SetProgressState(*this, TBPF_NORMAL);
+
+    // m_items does not change until the thread is done, see FinishExport().
+    // The order of the list does when a sort is done, the thread has its own
+    m_exportThread = std::thread([this, exportFunction = std::move(exportFunction), path, itemOrder = m_itemOrder, hWnd = m_hwnd, generation = m_exportGeneration]() {
+        size_t total     = itemOrder.size();
+        WPARAM lastPos   = 0;
+        bool   bExported = exportFunction(m_items, itemOrder, path, m_exportCancelled, [&](size_t done) {
+            WPARAM pos = total ? static_cast<WPARAM>(done * ExportProgressRange / total) : ExportProgressRange;
+            if (pos != lastPos)
+            {
+                lastPos = pos;
+                PostMessage(hWnd, SEARCH_EXPORTPROGRESS, pos, generation);
+            }
+        });
+        PostMessage(hWnd, SEARCH_EXPORTED, bExported, generation);
+    });
+}
+
+void CSearchDlg::FinishExport(bool bCancel)
+{
+    if (!m_exportThread.joinable())
+        return;
+    if (bCancel)
+        m_exportCancelled.Cancel();
+    m_exportThread.join();
+
+    HWND hProgress = GetDlgItem(*this, IDC_PROGRESS);
+    ShowWindow(hProgress, SW_HIDE);
+    SetWindowLongPtr(hProgress, GWL_STYLE, GetWindowLongPtr(hProgress, GWL_STYLE) | PBS_MARQUEE);
+    if (m_pTaskbarList)
+        m_pTaskbarList->SetProgressState(*this, TBPF_NOPROGRESS);
+    DialogEnableWindow(IDC_EXPORT, true);
+}
+
+void CSearchDlg::StartWatching()
+{
+    StopWatching();
+    // a replace is not repeated when the files change
+    if (!m_lastSearchOptions || m_lastSearchOptions->replace)
+        return;
+    m_resultWatcher = std::make_unique<CResultWatcher>(*this, *m_lastSearchOptions, ++m_watchGeneration);
+    if (!m_resultWatcher->Start())
+        m_resultWatcher.reset();
+}
+
+void CSearchDlg::StopWatching()
+{
+    m_resultWatcher.reset();
+}
+
+void CSearchDlg::UpdateWatchedEntry(const WatchUpdate& update)
+{
+    FinishSorting();
+    StopFiltering();
+    FinishExport(false);
+    const auto& info = update.info;
+    if (update.bRemoved)
+    {
+        // a folder takes everything below it along
+        RemoveItems([&](const CSearchInfo& item) {
+            if (!item.filePath.starts_with(info.filePath) ||
+                (item.filePath.size() != info.filePath.size() && item.filePath[info.filePath.size()] != '\\'))
+                return false;
+            // the counts go along with the results
+            m_totalMatches -= static_cast<int>(item.matchCount);
+            if (item.timedOut)
+                --m_timedOutItems;
+            return true;
+        });
+    }
+    else
+    {
+        bool bShow = IsListedResult(info, update.bAsResult);
+        auto it    = std::ranges::find_if(m_items, [&](const CSearchInfo& item) { return item.filePath == info.filePath; });
+        if (it != m_items.end())
+        {
+            m_totalMatches -= static_cast<int>(it->matchCount);
+            if (it->timedOut)
+                --m_timedOutItems;
+            if (bShow)
+            {
+                *it = info;
+                it->SetPathOffsets();
+            }
+            else
+            {
+                const CSearchInfo* removed = &*it;
+                RemoveItems([removed](const CSearchInfo& item) { return &item == removed; });
+            }
+        }
+        else if (bShow)
+        {
+            m_items.push_back(info);
+            m_items.back().SetPathOffsets();
+            m_itemOrder.push_back(static_cast<int>(m_items.size() - 1));
+        }
+        if (bShow)
+        {
+            m_totalMatches += static_cast<int>(info.matchCount);
+            MeasureResult(info, CurrentListTextState());
+        }
+        if (bShow && info.timedOut)
+            ++m_timedOutItems;
+    }
+    RebuildListItems();
+
+    HWND hListControl = GetDlgItem(*this, IDC_RESULTLIST);
+    bool fileList     = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
+    ListView_SetItemCountEx(hListControl, ListRowCount(fileList), LVSICF_NOSCROLL);
+    InvalidateRect(hListControl, nullptr, FALSE);
+    ShowWindow(GetDlgItem(*this, IDC_EXPORT), m_items.empty() ? SW_HIDE : SW_SHOW);
+    UpdateInfoLabel();
+}
+
+void CSearchDlg::RemoveItems(const std::function<bool(const CSearchInfo&)>& remove)
+{
+    // the results which stay move up, their indexes in m_itemOrder with them
+    std::vector<int> newIndexes(m_items.size(), -1);
+    size_t           kept = 0;
+    for (size_t index = 0; index < m_items.size(); ++index)
+    {
+        if (remove(m_items[index]))
+            continue;
+        if (kept != index)
+            m_items[kept] = std::move(m_items[index]);
+        newIndexes[index] = static_cast<int>(kept++);
+    }
+    m_items.erase(m_items.begin() + kept, m_items.end());
+    std::vector<int> itemOrder;
+    itemOrder.reserve(kept);
+    for (int index : m_itemOrder)
+    {
+        if (newIndexes[index] >= 0)
+            itemOrder.push_back(newIndexes[index]);
+    }
+    m_itemOrder.swap(itemOrder);
+}
+
+void CSearchDlg::AddSearchResult(const CSearchInfo& info, bool bAsResult)
+{
+    m_totalMatches += static_cast<int>(info.matchCount);
+    if (info.timedOut)
+        ++m_timedOutItems;
+    // the search thread measured it already
+    if (IsListedResult(info, bAsResult))
+        AddFoundEntry(&info);
+}
+
+bool CSearchDlg::IsListedResult(const CSearchInfo& info, bool bAsResult) const
+{
+    return IsListedResult(info, bAsResult, m_searchString.empty() || m_bNotSearch);
+}
+
+bool CSearchDlg::IsListedResult(const CSearchInfo& info, bool bAsResult, bool bListAll)
+{
+    return bAsResult || bListAll || info.readError || !info.exception.empty();
+}
+
+ListTextState CSearchDlg::CurrentListTextState() const
+{
+    ListTextState state;
+    state.searchPath = m_searchPath;
+    state.timeZone   = localTimeZone();
+    state.font       = reinterpret_cast<HFONT>(SendDlgItemMessage(*this, IDC_RESULTLIST, WM_GETFONT, 0, 0));
+    state.bListAll   = m_searchString.empty() || m_bNotSearch;
+    return state;
+}
+
+void CSearchDlg::MeasureResult(const CSearchInfo& info, const ListTextState& state)
+{
+    // one for each search thread, a device context is not to be shared
+    thread_local CListTextMeasurer measurer;
+    wchar_t                        textBuf[MAX_PATH] = {0};
+    measurer.SetFont(state.font);
+    auto addText = [&](CColumnWidths& widths, bool fileList, int subIndex, int column) {
+        ListItemText(info, state.searchPath, state.timeZone, fileList, subIndex, column, textBuf, _countof(textBuf));
+        widths.Add(column, textBuf, measurer);
+    };
+    for (int col = 0; col < static_cast<int>(m_fileColumnWidths.ColumnCount()); ++col)
+        addText(m_fileColumnWidths, true, 0, col);
+    if (!info.matchLinesNumbers.empty())
+    {
+        // the name and the folder are the same in all lines of the file
+        addText(m_lineColumnWidths, false, 0, 0);
+        addText(m_lineColumnWidths, false, 0, 4);
+        if (info.encoding == CTextFile::Binary)
+            addText(m_lineColumnWidths, false, 0, 1);
+        else
+        {
+            for (int subIndex = 0; subIndex < static_cast<int>(info.matchLinesNumbers.size()); ++subIndex)
+            {
+                for (int col = 1; col <= 3; ++col)
+                    addText(m_lineColumnWidths, false, subIndex, col);
+            }
+        }
+    }
+    measurer.SetFont(nullptr);
+}
+
+bool CSearchDlg::AddFoundEntry(const CSearchInfo* pInfo, bool bOnlyListControl)
+{
+    if (!bOnlyListControl)
+    {
+        m_items.push_back(*pInfo);
+        m_items.back().SetPathOffsets();
+        m_itemOrder.push_back(static_cast<int>(m_items.size() - 1));
+        size_t position = m_itemOrder.size() - 1;
+        if (m_resultFilter)
+            m_resultFilter->AddRows(m_items, m_itemOrder, position, position + 1, m_fileListItems, m_listItems);
+        else
+            CResultFilter::AddAllRows(m_items, m_itemOrder, position, position + 1, m_fileListItems, m_listItems);
+    }
+    else
+    {
+        HWND hListControl = GetDlgItem(*this, IDC_RESULTLIST);
+        bool fileList     = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
+        auto count        = ListView_GetItemCount(hListControl);
+        if (count != static_cast<int>(ListRowCount(fileList)))
+            ListView_SetItemCountEx(hListControl, ListRowCount(fileList), LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
+    }
+    return true;
+}
+
+void CSearchDlg::FillResultList()
+{
+    ProfileTimer profile(L"FillResultList");
+    SetCursor(LoadCursor(nullptr, IDC_APPSTARTING));
+    // refresh cursor
+    POINT pt;
+    GetCursorPos(&pt);
+    SetCursorPos(pt.x, pt.y);
+
+    bool filelist     = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
+    HWND hListControl = GetDlgItem(*this, IDC_RESULTLIST);
+    SendMessage(hListControl, WM_SETREDRAW, FALSE, 0);
+    ListView_SetItemCountEx(hListControl, ListRowCount(filelist), LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
+    AutoSizeAllColumns();
+    SendMessage(hListControl, WM_SETREDRAW, TRUE, 0);
+    SetCursor(LoadCursor(nullptr, IDC_ARROW));
+    // refresh cursor
+    GetCursorPos(&pt);
+    SetCursorPos(pt.x, pt.y);
+
+    RedrawWindow(hListControl, nullptr, nullptr, RDW_ERASE | RDW_FRAME | RDW_INVALIDATE | RDW_ALLCHILDREN);
+}
+
+void CSearchDlg::ShowContextMenu(HWND hWnd, int x, int y)
+{
+    HWND hListControl = GetDlgItem(*this, IDC_RESULTLIST);
+    if (hWnd != GetDlgItem(*this, IDC_RESULTLIST))
+        return;
+    bool  fileList = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
+    // check if clicked on a header
+    POINT pt       = {x, y};
+    auto  hHeader  = ListView_GetHeader(hListControl);
+    RECT  headerRc{};
+    GetWindowRect(hHeader, &headerRc);
+    if (PtInRect(&headerRc, pt))
+    {
+        int colCount   = Header_GetItemCount(hHeader);
+        int clickedCol = -1;
+        for (int i = 0; i < colCount; ++i)
+        {
             RECT iRc{};
             Header_GetItemRect(hHeader, i, &iRc);
             MapWindowPoints(hHeader, nullptr, reinterpret_cast<LPPOINT>(&iRc), 2);
@@ -2279,7 +3133,7 @@ void CSearchDlg::ShowContextMenu(HWND hWnd, int x, int y)
                                 case 6: // modification date
                                 {
                                     wchar_t buf[1024]{};
-                                    formatDate(buf, pInfo->modifiedTime, true);
+                                    formatDate(buf, pInfo->modifiedTime, localTimeZone(), true);
                                     copyText += buf;
                                 }
                                 break;
@@ -2509,6 +3363,28 @@ bool CSearchDlg::PreTranslateMessage(MSG* pMsg)
                 }
             }
             break;
+            case VK_F5:
+            {
+                if (!bCtrl && !bShift && !bAlt && !m_dwThreadRunning)
+                {
+                    // search again, but only the files changed since the last search
+                    m_bRefresh = true;
+                    DoCommand(IDOK, 0);
+                    m_bRefresh = false;
+                    return true;
+                }
+                if (bCtrl && !bShift && !bAlt && !m_dwThreadRunning)
+                {
+                    // search again, and list all folders instead of using the cached listings.
+                    // The search thread reads the flag, so it's reset when the search ends
+                    m_bFullWalk = true;
+                    DoCommand(IDOK, 0);
+                    if (!m_dwThreadRunning)
+                        m_bFullWalk = false;
+                    return true;
+                }
+            }
+            break;
             case 'O':
             {
                 if (bCtrl && !bShift && !bAlt)
@@ -2520,7 +3396,7 @@ bool CSearchDlg::PreTranslateMessage(MSG* pMsg)
                         int selIndex = GetSelectedListIndex(fileList, iItem);
                         if ((selIndex < 0) || (selIndex >= static_cast<int>(m_items.size())))
                             continue;
-                        OpenFileAtListIndex(selIndex);
+                        OpenFileAtListIndex(iItem);
                     }
                 }
             }
@@ -2569,66 +3445,54 @@ LRESULT CSearchDlg::ColorizeMatchResultProc(LPNMLVCUSTOMDRAW lpLVCD)
                     // no those details for large files
                     break;
                 }
-                int   lenText           = static_cast<int>(pInfo->matchLines[subIndex].length());
+                // LV_ITEM: Allows any length string to be stored as item text, only the first 259 TCHARs are displayed.
+                // 259, I counted it, not 260.
+                DWORD lenText           = min(static_cast<DWORD>(pInfo->matchLines[subIndex].length()), static_cast<DWORD>(MAX_PATH - 1));
 
-                auto  colMatch          = pInfo->matchColumnsNumbers[subIndex];
+                // the column in the text of the line, which is an excerpt of long lines
+                DWORD colMatch          = pInfo->MatchTextColumn(subIndex);
                 WCHAR textBuf[MAX_PATH] = {0};
-                if (colMatch + pInfo->matchLengths[subIndex] >= MAX_PATH)
+                if (colMatch == 0 || colMatch > lenText)
                 {
-                    // LV_ITEM: Allows any length string to be stored as item text, only the first 259 TCHARs are displayed.
-                    // 259, I counted it, not 260.
+                    // the match is not displayed
                     break;
                 }
+                // only the displayed part of the match
+                DWORD lenMatch = min(pInfo->matchLengths[subIndex], lenText - (colMatch - 1));
+
+                copyListText(textBuf, _countof(textBuf), pInfo->matchLines[subIndex]);
+                LPWSTR pMatch   = textBuf + colMatch - 1;
+                SIZE   textSize = {0, 0};
 
-                HWND   hListControl = GetDlgItem(*this, IDC_RESULTLIST);
-                LVITEM lv           = {0};
-                lv.iItem            = iRow;
-                lv.iSubItem         = 3;
-                lv.mask             = LVIF_TEXT;
-                lv.pszText          = textBuf;
-                if (lenText + 1 > _countof(textBuf))
+                rc.left += 6;
+                rc.right -= 6;
+
+                // Not precise sometimes.
+                // We keep the text and draw a transparent rectangle only. So, will not break the text.
+                GetTextExtentPoint32(hdc, textBuf, colMatch - 1, &textSize);
+                rc.left += textSize.cx;
+                if (rc.left >= rc.right)
                 {
-                    lv.cchTextMax = _countof(textBuf);
+                    break;
                 }
-                else
+                GetTextExtentPoint32(hdc, pMatch, lenMatch, &textSize);
+                if (rc.right > rc.left + textSize.cx)
                 {
-                    lv.cchTextMax = lenText + 1;
+                    rc.right = rc.left + textSize.cx;
                 }
-                if (ListView_GetItem(hListControl, &lv))
-                {
-                    LPWSTR pMatch   = lv.pszText + colMatch - 1;
-                    SIZE   textSize = {0, 0};
 
-                    rc.left += 6;
-                    rc.right -= 6;
-
-                    // Not precise sometimes.
-                    // We keep the text and draw a transparent rectangle only. So, will not break the text.
-                    GetTextExtentPoint32(hdc, lv.pszText, colMatch - 1, &textSize);
-                    rc.left += textSize.cx;
-                    if (rc.left >= rc.right)
-                    {
-                        break;
-                    }
-                    GetTextExtentPoint32(hdc, pMatch, pInfo->matchLengths[subIndex], &textSize);
-                    if (rc.right > rc.left + textSize.cx)
-                    {
-                        rc.right = rc.left + textSize.cx;
-                    }
-
-                    LONG          width   = rc.right - rc.left;
-                    LONG          height  = rc.bottom - rc.top;
-                    HDC           hcdc    = CreateCompatibleDC(hdc);
-                    BITMAPINFO    bmi     = {{sizeof(BITMAPINFOHEADER), width, height, 1, 32, BI_RGB, static_cast<DWORD>(width * height * 4u), 0, 0, 0, 0}, {{0, 0, 0, 0}}};
-                    BLENDFUNCTION blend   = {AC_SRC_OVER, 0, 92, 0}; // 36%
-                    HBITMAP       hBitmap = CreateDIBSection(hcdc, &bmi, DIB_RGB_COLORS, nullptr, nullptr, 0x0);
-                    RECT          rc2     = {0, 0, width, height};
-                    SelectObject(hcdc, hBitmap);
-                    FillRect(hcdc, &rc2, CreateSolidBrush(RGB(255, 255, 0)));
-                    AlphaBlend(hdc, rc.left, rc.top, width, height, hcdc, 0, 0, width, height, blend);
-                    DeleteObject(hBitmap);
-                    DeleteDC(hcdc);
-                }
+                LONG          width   = rc.right - rc.left;
+                LONG          height  = rc.bottom - rc.top;
+                HDC           hcdc    = CreateCompatibleDC(hdc);
+                BITMAPINFO    bmi     = {{sizeof(BITMAPINFOHEADER), width, height, 1, 32, BI_RGB, static_cast<DWORD>(width * height * 4u), 0, 0, 0, 0}, {{0, 0, 0, 0}}};
+                BLENDFUNCTION blend   = {AC_SRC_OVER, 0, 92, 0}; // 36%
+                HBITMAP       hBitmap = CreateDIBSection(hcdc, &bmi, DIB_RGB_COLORS, nullptr, nullptr, 0x0);
+                RECT          rc2     = {0, 0, width, height};
+                SelectObject(hcdc, hBitmap);
+                FillRect(hcdc, &rc2, CreateSolidBrush(RGB(255, 255, 0)));
+                AlphaBlend(hdc, rc.left, rc.top, width, height, hcdc, 0, 0, width, height, blend);
+                DeleteObject(hBitmap);
+                DeleteDC(hcdc);
             }
         }
         default:
@@ -2691,97 +3555,44 @@ void CSearchDlg::DoListNotify(LPNMITEMACTIVATE lpNMItemActivate)
     }
     else if (lpNMItemActivate->hdr.code == LVN_COLUMNCLICK)
     {
-        bool fileList = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
-        m_bAscending  = !m_bAscending;
-        bool bDidSort = false;
+        bool                            fileList = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
+        std::optional<ResultSortColumn> column;
+        m_bAscending = !m_bAscending;
         switch (lpNMItemActivate->iSubItem)
         {
             case 0:
-                if (m_bAscending)
-                    std::ranges::sort(m_items, CSearchInfo::NameCompareAsc);
-                else
-                    std::ranges::sort(m_items, CSearchInfo::NameCompareDesc);
-                bDidSort = true;
+                column = ResultSortColumn::Name;
                 break;
             case 1:
                 if (fileList)
-                {
-                    if (m_bAscending)
-                        std::ranges::sort(m_items, CSearchInfo::SizeCompareAsc);
-                    else
-                        std::ranges::sort(m_items, CSearchInfo::SizeCompareDesc);
-                    bDidSort = true;
-                }
+                    column = ResultSortColumn::Size;
                 break;
             case 2:
                 if (fileList)
-                {
-                    if (m_bAscending)
-                        std::ranges::sort(m_items, CSearchInfo::MatchesCompareAsc);
-                    else
-                        std::ranges::sort(m_items, CSearchInfo::MatchesCompareDesc);
-                    bDidSort = true;
-                }
+                    column = ResultSortColumn::Matches;
                 break;
             case 3:
                 if (fileList)
-                {
-                    if (m_bAscending)
-                        std::ranges::sort(m_items, CSearchInfo::PathCompareAsc);
-                    else
-                        std::ranges::sort(m_items, CSearchInfo::PathCompareDesc);
-                    bDidSort = true;
-                }
+                    column = ResultSortColumn::Path;
                 break;
             case 4:
-                if (m_bAscending)
-                    std::ranges::sort(m_items, CSearchInfo::ExtCompareAsc);
-                else
-                    std::ranges::sort(m_items, CSearchInfo::ExtCompareDesc);
-                bDidSort = true;
+                column = ResultSortColumn::Extension;
                 break;
             case 5:
-                if (m_bAscending)
-                    std::ranges::sort(m_items, CSearchInfo::EncodingCompareAsc);
-                else
-                    std::ranges::sort(m_items, CSearchInfo::EncodingCompareDesc);
-                bDidSort = true;
+                column = ResultSortColumn::Encoding;
                 break;
             case 6:
-                if (m_bAscending)
-                    std::ranges::sort(m_items, CSearchInfo::ModifiedTimeCompareAsc);
-                else
-                    std::ranges::sort(m_items, CSearchInfo::ModifiedTimeCompareDesc);
-                bDidSort = true;
+                column = ResultSortColumn::ModifiedTime;
                 break;
             default:
                 break;
         }
+        bool bDidSort = column.has_value();
         if (bDidSort)
-        {
-            auto size = m_listItems.size();
-            m_listItems.clear();
-            m_listItems.reserve(size);
-
-            int index = 0;
-            for (const auto& item : m_items)
-            {
-                int subIndex = 0;
-                for (const auto& lineNumber : item.matchLinesNumbers)
-                {
-                    UNREFERENCED_PARAMETER(lineNumber);
-                    m_listItems.push_back(std::make_tuple(index, subIndex));
-                    ++subIndex;
-                }
-                ++index;
-            }
-        }
+            SortResults(*column, m_bAscending);
 
         HWND hListControl = GetDlgItem(*this, IDC_RESULTLIST);
         SendMessage(hListControl, WM_SETREDRAW, FALSE, 0);
-        ListView_SetItemCountEx(hListControl, fileList ? m_items.size() : m_listItems.size(), LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
-
-        AutoSizeAllColumns();
         HDITEM hd    = {0};
         hd.mask      = HDI_FORMAT;
         HWND hHeader = ListView_GetHeader(hListControl);
@@ -2811,7 +3622,7 @@ void CSearchDlg::DoListNotify(LPNMITEMACTIVATE lpNMItemActivate)
 
         if (fileList)
         {
-            pInfo = &m_items[listIndex];
+            pInfo = &m_items[m_fileListItems[listIndex]];
         }
         else
         {
@@ -2829,189 +3640,184 @@ void CSearchDlg::DoListNotify(LPNMITEMACTIVATE lpNMItemActivate)
         }
 
         std::wstring sFormat = TranslatedString(hResource, IDS_CONTEXTLINE);
-        int          leftMax = static_cast<int>(pInfo->matchLines.size());
-        int          showMax = min(leftMax, subIndex + 5);
-        for (; subIndex < showMax; ++subIndex)
+        if (!fileList && !pInfo->contextRanges.empty() && static_cast<size_t>(subIndex) < pInfo->matchLinesNumbers.size())
         {
-            std::wstring matchText = pInfo->matchLines[subIndex];
-            CStringUtils::rtrim(matchText);
-            DWORD iShow = 0;
-            if (pInfo->matchColumnsNumbers[subIndex] > 8)
-            {
-                // 6 + 1 prefix chars would give a context
-                iShow = pInfo->matchColumnsNumbers[subIndex] - 8;
-            }
-            if (iShow < matchText.size()) // tricky including binary files that with leading L'\x00'
+            // the context lines kept around the match line, which is one of them
+            constexpr DWORD   maxTipLines    = 5;
+            std::wstring      sContextFormat = TranslatedString(hResource, IDS_SURROUNDINGLINE);
+            DWORD             matchLine      = pInfo->matchLinesNumbers[subIndex];
+            DWORD             firstLine      = matchLine;
+            DWORD             lastLine       = matchLine;
+            std::wstring_view lineText;
+            while (firstLine > 1 && matchLine - firstLine < maxTipLines && pInfo->ContextLine(firstLine - 1, lineText))
+                --firstLine;
+            while (lastLine - matchLine < maxTipLines && pInfo->ContextLine(lastLine + 1, lineText))
+                ++lastLine;
+            for (DWORD line = firstLine; line <= lastLine; ++line)
             {
-                matchText = matchText.substr(iShow, 50);
+                std::wstring text;
+                if (pInfo->ContextLine(line, lineText))
+                    text = lineText.substr(0, 80);
+                CStringUtils::rtrim(text);
+                matchString += CStringUtils::Format((line == matchLine ? sFormat : sContextFormat).c_str(), line, text.c_str());
             }
-            matchString += CStringUtils::Format(sFormat.c_str(), pInfo->matchLinesNumbers[subIndex], matchText.c_str());
         }
-        leftMax -= subIndex;
-        if (leftMax > 0)
+        else
         {
-            std::wstring sx  = TranslatedString(hResource, IDS_XMOREMATCHES);
-            std::wstring ssx = CStringUtils::Format(sx.c_str(), leftMax);
-            matchString += ssx;
+            int leftMax = static_cast<int>(pInfo->matchLines.size());
+            int showMax = min(leftMax, subIndex + 5);
+            for (; subIndex < showMax; ++subIndex)
+            {
+                std::wstring matchText = pInfo->matchLines[subIndex];
+                CStringUtils::rtrim(matchText);
+                DWORD iShow    = 0;
+                DWORD colMatch = pInfo->MatchTextColumn(subIndex);
+                if (colMatch > 8)
+                {
+                    // 6 + 1 prefix chars would give a context
+                    iShow = colMatch - 8;
+                }
+                if (iShow < matchText.size()) // tricky including binary files that with leading L'\x00'
+                {
+                    matchText = matchText.substr(iShow, 50);
+                }
+                matchString += CStringUtils::Format(sFormat.c_str(), pInfo->matchLinesNumbers[subIndex], matchText.c_str());
+            }
+            leftMax -= subIndex;
+            if (leftMax > 0)
+            {
+                std::wstring sx  = TranslatedString(hResource, IDS_XMOREMATCHES);
+                std::wstring ssx = CStringUtils::Format(sx.c_str(), leftMax);
+                matchString += ssx;
+            }
         }
         wcsncpy_s(pInfoTip->pszText, pInfoTip->cchTextMax, matchString.c_str(), pInfoTip->cchTextMax - 1LL);
     }
     else if (lpNMItemActivate->hdr.code == LVN_GETDISPINFO)
     {
-        static const std::wstring sBinary         = TranslatedString(hResource, IDS_BINARY);
-        static const std::wstring sReadError      = TranslatedString(hResource, IDS_READERROR);
-        static const std::wstring sRegexException = TranslatedString(hResource, IDS_REGEXEXCEPTION);
-
-        NMLVDISPINFO*             pDispInfo       = reinterpret_cast<NMLVDISPINFO*>(lpNMItemActivate);
-        LV_ITEM*                  pItem           = &(pDispInfo)->item;
+        NMLVDISPINFO* pDispInfo = reinterpret_cast<NMLVDISPINFO*>(lpNMItemActivate);
+        LV_ITEM*      pItem     = &(pDispInfo)->item;
 
-        int                       iItem           = pItem->iItem;
-        bool                      fileList        = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
+        int           iItem     = pItem->iItem;
+        bool          fileList  = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
 
+        int           index     = 0;
+        int           subIndex  = 0;
         if (fileList)
-        {
-            const auto& pInfo = &m_items[iItem];
-            if (pItem->mask & LVIF_TEXT)
-            {
-                switch (pItem->iSubItem)
-                {
-                    case 0: // name of the file
-                        wcsncpy_s(pItem->pszText, pItem->cchTextMax, pInfo->filePath.substr(pInfo->filePath.find_last_of('\\') + 1).c_str(), pItem->cchTextMax - 1LL);
-                        break;
-                    case 1: // file size
-                        if (!pInfo->folder)
-                            StrFormatByteSizeW(pInfo->fileSize, pItem->pszText, pItem->cchTextMax);
-                        break;
-                    case 2: // match count or read error
-                        if (pInfo->readError)
-                            wcsncpy_s(pItem->pszText, pItem->cchTextMax, sReadError.c_str(), pItem->cchTextMax - 1LL);
-                        else if (!pInfo->exception.empty())
-                            wcsncpy_s(pItem->pszText, pItem->cchTextMax, sRegexException.c_str(), pItem->cchTextMax - 1LL);
-                        else
-                            swprintf_s(pItem->pszText, pItem->cchTextMax, L"%lld", pInfo->matchCount);
-                        break;
-                    case 3: // path
-                        if (m_searchPath.find('|') != std::wstring::npos)
-                            wcsncpy_s(pItem->pszText, pItem->cchTextMax, pInfo->filePath.substr(0, pInfo->filePath.size() - pInfo->filePath.substr(pInfo->filePath.find_last_of('\\')).size()).c_str(), pItem->cchTextMax - 1LL);
-                        else
-                        {
-                            auto filePart = pInfo->filePath.substr(pInfo->filePath.find_last_of('\\'));
-                            auto len      = pInfo->filePath.size() - m_searchPath.size() - filePart.size();
-                            if (len > 0)
-                                --len;
-                            if (m_searchPath.size() < pInfo->filePath.size())
-                            {
-                                wcsncpy_s(pItem->pszText, pItem->cchTextMax, pInfo->filePath.substr(m_searchPath.size() + 1, len).c_str(), pItem->cchTextMax - 1LL);
-                                if (pItem->pszText[0] == 0)
-                                    wcscpy_s(pItem->pszText, pItem->cchTextMax, L"\\.");
-                            }
-                            else
-                                wcsncpy_s(pItem->pszText, pItem->cchTextMax, pInfo->filePath.c_str(), pItem->cchTextMax - 1LL);
-                        }
-                        break;
-                    case 4: // extension of the file
-                    {
-                        pItem->pszText[0] = 0;
-                        if (!pInfo->folder)
-                        {
-                            auto dotPos = pInfo->filePath.find_last_of('.');
-                            if (dotPos != std::wstring::npos)
-                            {
-                                if (pInfo->filePath.find('\\', dotPos) == std::wstring::npos)
-                                    wcsncpy_s(pItem->pszText, pItem->cchTextMax, pInfo->filePath.substr(dotPos + 1).c_str(), pItem->cchTextMax - 1LL);
-                            }
-                        }
-                    }
-                    break;
-                    case 5: // encoding
-                        wcsncpy_s(pItem->pszText, pItem->cchTextMax, CTextFile::GetEncodingString(pInfo->encoding).c_str(), pItem->cchTextMax - 1LL);
-                        break;
-                    case 6: // modification date
-                        formatDate(pItem->pszText, pInfo->modifiedTime, true);
-                        break;
-                    default:
-                        pItem->pszText[0] = 0;
-                        break;
-                }
-            }
-            if (pItem->mask & LVIF_IMAGE)
-            {
-                pItem->iImage = pInfo->folder ? CSysImageList::GetInstance().GetDirIconIndex() : CSysImageList::GetInstance().GetFileIconIndex(pInfo->filePath);
-            }
-        }
+            index = m_fileListItems[iItem];
         else
+            std::tie(index, subIndex) = m_listItems[iItem];
+
+        const auto& item = m_items[index];
+        if (pItem->mask & LVIF_TEXT)
+            ListItemText(item, m_searchPath, localTimeZone(), fileList, subIndex, pItem->iSubItem, pItem->pszText, pItem->cchTextMax);
+        if (pItem->mask & LVIF_IMAGE)
         {
-            auto        tup      = m_listItems[iItem];
-            auto        index    = std::get<0>(tup);
-            auto        subIndex = std::get<1>(tup);
+            pItem->iImage = item.folder ? CSysImageList::GetInstance().GetDirIconIndex() : CSysImageList::GetInstance().GetFileIconIndex(item.filePath);
+        }
+    }
+}
 
-            const auto& item     = m_items[index];
-            const auto& pInfo    = &item;
-            if (item.encoding == CTextFile::Binary)
-            {
-                if (pItem->mask & LVIF_TEXT)
-                {
-                    switch (pItem->iSubItem)
-                    {
-                        case 0: // name of the file
-                            wcsncpy_s(pItem->pszText, pItem->cchTextMax, pInfo->filePath.substr(pInfo->filePath.find_last_of('\\') + 1).c_str(), pItem->cchTextMax - 1LL);
-                            break;
-                        case 1: // binary
-                            wcsncpy_s(pItem->pszText, pItem->cchTextMax, sBinary.c_str(), pItem->cchTextMax);
-                            break;
-                        case 4: // path
-                            wcsncpy_s(pItem->pszText, pItem->cchTextMax, pInfo->filePath.substr(0, pInfo->filePath.size() - pInfo->filePath.substr(pInfo->filePath.find_last_of('\\') + 1).size() - 1).c_str(), pItem->cchTextMax - 1LL);
-                            break;
-                        default:
-                            pItem->pszText[0] = 0;
-                            break;
-                    }
-                }
-                if (pItem->mask & LVIF_IMAGE)
+void CSearchDlg::ListItemText(const CSearchInfo& info, const std::wstring& searchPath, const TIME_ZONE_INFORMATION& timeZone, bool fileList, int subIndex, int column, LPWSTR text, int textSize)
+{
+    static const std::wstring sBinary         = TranslatedString(hResource, IDS_BINARY);
+    static const std::wstring sReadError      = TranslatedString(hResource, IDS_READERROR);
+    static const std::wstring sRegexException = TranslatedString(hResource, IDS_REGEXEXCEPTION);
+
+    if (textSize <= 0)
+        return;
+    text[0] = 0;
+    if (fileList)
+    {
+        switch (column)
+        {
+            case 0: // name of the file
+                copyListText(text, textSize, info.Name());
+                break;
+            case 1: // file size
+                if (!info.folder)
+                    StrFormatByteSizeW(info.fileSize, text, textSize);
+                break;
+            case 2: // match count or read error
+                if (info.readError)
+                    wcsncpy_s(text, textSize, sReadError.c_str(), textSize - 1LL);
+                else if (!info.exception.empty())
+                    wcsncpy_s(text, textSize, sRegexException.c_str(), textSize - 1LL);
+                else
+                    swprintf_s(text, textSize, L"%lld", info.matchCount);
+                break;
+            case 3: // path
+                if (searchPath.find('|') != std::wstring::npos)
+                    copyListText(text, textSize, info.Folder());
+                else if (searchPath.size() < info.filePath.size())
                 {
-                    pItem->iImage = pInfo->folder ? CSysImageList::GetInstance().GetDirIconIndex() : CSysImageList::GetInstance().GetFileIconIndex(pInfo->filePath);
+                    // relative to the search path
+                    size_t len = info.Folder().size() - searchPath.size();
+                    if (len > 0)
+                        --len;
+                    copyListText(text, textSize, std::wstring_view(info.filePath).substr(searchPath.size() + 1, len));
+                    if (text[0] == 0)
+                        wcscpy_s(text, textSize, L"\\.");
                 }
-            }
-            else
-            {
-                if (pItem->mask & LVIF_TEXT)
-                {
-                    switch (pItem->iSubItem)
-                    {
-                        case 0: // name of the file
-                            wcsncpy_s(pItem->pszText, pItem->cchTextMax, pInfo->filePath.substr(pInfo->filePath.find_last_of('\\') + 1).c_str(), pItem->cchTextMax - 1LL);
-                            break;
-                        case 1: // line number
-                            swprintf_s(pItem->pszText, pItem->cchTextMax, L"%ld", pInfo->matchLinesNumbers[subIndex]);
-                            break;
-                        case 2: // column number
-                            swprintf_s(pItem->pszText, pItem->cchTextMax, L"%ld", pInfo->matchColumnsNumbers[subIndex]);
-                            break;
-                        case 3: // line
-                        {
-                            std::wstring line;
-                            if (pInfo->matchLines.size() > static_cast<size_t>(subIndex))
-                                line = pInfo->matchLines[subIndex];
-                            std::ranges::replace(line, '\t', ' ');
-                            std::ranges::replace(line, '\n', ' ');
-                            std::ranges::replace(line, '\r', ' ');
-                            wcsncpy_s(pItem->pszText, pItem->cchTextMax, line.c_str(), pItem->cchTextMax - 1LL);
-                        }
-                        break;
-                        case 4: // path
-                            wcsncpy_s(pItem->pszText, pItem->cchTextMax, pInfo->filePath.substr(0, pInfo->filePath.size() - pInfo->filePath.substr(pInfo->filePath.find_last_of('\\') + 1).size() - 1).c_str(), pItem->cchTextMax - 1LL);
-                            break;
-                        default:
-                            pItem->pszText[0] = 0;
-                            break;
-                    }
-                }
-
-                if (pItem->mask & LVIF_IMAGE)
-                {
-                    pItem->iImage = pInfo->folder ? CSysImageList::GetInstance().GetDirIconIndex() : CSysImageList::GetInstance().GetFileIconIndex(pInfo->filePath);
-                }
-            }
+                else
+                    copyListText(text, textSize, info.filePath);
+                break;
+            case 4: // extension of the file
+                if (!info.folder)
+                    copyListText(text, textSize, info.Extension());
+                break;
+            case 5: // encoding
+                copyListText(text, textSize, encodingName(info.encoding));
+                break;
+            case 6: // modification date
+                formatDate(text, info.modifiedTime, timeZone, true);
+                break;
+            default:
+                break;
+        }
+    }
+    else if (info.encoding == CTextFile::Binary)
+    {
+        switch (column)
+        {
+            case 0: // name of the file
+                copyListText(text, textSize, info.Name());
+                break;
+            case 1: // binary
+                copyListText(text, textSize, sBinary);
+                break;
+            case 4: // path
+                copyListText(text, textSize, info.Folder());
+                break;
+            default:
+                break;
+        }
+    }
+    else
+    {
+        switch (column)
+        {
+            case 0: // name of the file
+                copyListText(text, textSize, info.Name());
+                break;
+            case 1: // line number, marked with how it changed when results are compared
+                if (info.matchChanges.size() > static_cast<size_t>(subIndex))
+                    swprintf_s(text, textSize, L"%s%ld", changeMark(info.matchChanges[subIndex]), info.matchLinesNumbers[subIndex]);
+                else
+                    swprintf_s(text, textSize, L"%ld", info.matchLinesNumbers[subIndex]);
+                break;
+            case 2: // column number
+                swprintf_s(text, textSize, L"%ld", info.matchColumnsNumbers[subIndex]);
+                break;
+            case 3: // line
+                if (info.matchLines.size() > static_cast<size_t>(subIndex))
+                    copyListText(text, textSize, info.matchLines[subIndex]);
+                break;
+            case 4: // path
+                copyListText(text, textSize, info.Folder());
+                break;
+            default:
+                break;
         }
     }
 }
@@ -3034,7 +3840,7 @@ void CSearchDlg::OpenFileAtListIndex(int listIndex)
     bool         fileList = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
     if (fileList)
     {
-        pInfo = &m_items[listIndex];
+        pInfo = &m_items[m_fileListItems[listIndex]];
     }
     else
     {
@@ -3141,7 +3947,10 @@ void CSearchDlg::OpenFileAtListIndex(int listIndex)
         if (pInfo->matchLines.size() > 0)
         {
             // not binary
-            match = pInfo->matchLines[subIndex].substr(pInfo->matchColumnsNumbers[subIndex] - 1, pInfo->matchLengths[subIndex]);
+            // the column in the text, which is an excerpt of long lines
+            size_t textPos = pInfo->MatchTextColumn(subIndex) - 1;
+            if (textPos < pInfo->matchLines[subIndex].size())
+                match = pInfo->matchLines[subIndex].substr(textPos, pInfo->matchLengths[subIndex]);
             escapeForRegexEx(match, 1);
             if (match.length() > 32767 - 1 - 2 - 2 - 13 - pInfo->filePath.length() - reservedLength)
             {
@@ -3201,32 +4010,7 @@ bool CSearchDlg::SaveSettings()
     buf                       = GetDlgItemText(IDC_PATTERN);
     m_patternRegex            = buf.get();
 
-    // split the pattern string into single patterns and
-    // add them to an array
-    auto   pBuf               = buf.get();
-    size_t pos                = 0;
-    m_patterns.clear();
-    do
-    {
-        pos            = wcscspn(pBuf, L"|");
-        std::wstring s = std::wstring(pBuf, pos);
-        if (!s.empty())
-        {
-            std::ranges::transform(s, s.begin(), ::towlower);
-            m_patterns.push_back(s);
-            auto endPart = s.rbegin();
-            if (*endPart == '*' && s.size() > 2)
-            {
-                ++endPart;
-                if (*endPart == '.')
-                {
-                    m_patterns.push_back(s.substr(0, s.size() - 2));
-                }
-            }
-        }
-        pBuf += pos;
-        pBuf++;
-    } while (*pBuf && (*(pBuf - 1)));
+    m_patterns = CSearchEngine::SplitFilePatterns(m_patternRegex);
 
     m_bUseRegex = (IsDlgButtonChecked(*this, IDC_REGEXRADIO) == BST_CHECKED);
     if (m_bUseRegex)
@@ -3380,235 +4164,183 @@ bool CSearchDlg::SaveSettings()
     return true;
 }
 
-// matches the whole of the input
-bool grepWinMatchI(const std::wstring& theRegex, const wchar_t* pText)
+DWORD CSearchDlg::SearchThread()
 {
-    try
+    // the changes from saved results to the results before them
+    if (m_savedResults && m_bCompareResults)
     {
-        boost::wregex  expression = boost::wregex(theRegex, boost::regex::normal | boost::regbase::icase);
-        boost::wcmatch whatc;
-        if (boost::regex_match(pText, whatc, expression))
+        std::vector<CSearchInfo> before;
+        CResultDiff              diff;
+        OnSearchStart();
+        if (m_savedResults->ReadAll(before, m_cancelled) && diff.Compare(before, m_previousResults.back().items, m_cancelled))
         {
-            return true;
+            std::vector<SearchFileResult> batch;
+            for (auto& change : diff.Changes())
+            {
+                SearchFileResult result;
+                result.sInfo     = std::move(change);
+                result.bSearched = true;
+                result.bAsResult = true;
+                batch.push_back(std::move(result));
+                if (batch.size() >= 1024)
+                {
+                    OnFileResults(batch);
+                    batch.clear();
+                }
+            }
+            if (!batch.empty())
+                OnFileResults(batch);
         }
+        OnSearchEnd();
+        m_savedResults.reset();
+        m_bCompareResults = false;
+        PostMessage(m_hwnd, WM_GREPWIN_THREADEND, 0, 0);
+        return 0L;
     }
-    catch (const std::exception&)
+    // the results of a saved search are shown as they are, without searching
+    if (m_savedResults)
     {
+        m_savedResults->Replay(*this, m_cancelled);
+        m_savedResults.reset();
+        PostMessage(m_hwnd, WM_GREPWIN_THREADEND, 0, 0);
+        return 0L;
     }
-    return false;
-}
 
-/* rules:
-    1. treat dir as special file
-    2. no limits on user specified files
-    3. search empty means counting only mode
-    4. real search/replace does not check dir size nor date
-*/
-DWORD CSearchDlg::SearchThread()
-{
-    ProfileTimer              profile(L"SearchThread");
-
-    auto                      pathBuf        = std::make_unique<wchar_t[]>(MAX_PATH_NEW);
-
-    // split the path string into single paths and
-    // add them to an array
-    const auto*               pBufSearchPath = m_searchPath.c_str();
-    size_t                    pos            = 0;
-    std::vector<std::wstring> pathVector;
-    do
+    SearchOptions options;
+    // a search within the results has their files as search paths, which
+    // the watch and the snapshot use. They are searched without listing.
+    const std::vector<CSearchInfo>* refineFiles = m_bRefine ? &m_previousResults.back().items : nullptr;
+    if (refineFiles)
     {
-        pos            = wcscspn(pBufSearchPath, L"|");
-        std::wstring s = std::wstring(pBufSearchPath, pos);
-        // pre-cleaned for history
-        if (!s.empty() && PathFileExists(s.c_str()))
-        {
-            pathVector.push_back(s);
-        }
-        pBufSearchPath += pos;
-        pBufSearchPath++;
-    } while (*pBufSearchPath && (*(pBufSearchPath - 1)));
-
-    if (!m_bUseRegex)
+        options.searchPaths.reserve(refineFiles->size());
+        for (const auto& item : *refineFiles)
+            options.searchPaths.push_back(item.filePath);
+    }
+    else
+        stringtok(options.searchPaths, m_searchPath, true);
+    options.searchString      = m_searchString;
+    options.replaceString     = m_replaceString;
+    options.filePatterns      = m_patterns;
+    options.fileNameRegex     = m_patternRegex;
+    options.excludeDirsRegex  = m_excludeDirsPatternRegex;
+    options.useRegex          = m_bUseRegex;
+    options.useRegexForPaths  = m_bUseRegexForPaths;
+    options.caseSensitive     = m_bCaseSensitive;
+    options.dotMatchesNewline = m_bDotMatchesNewline;
+    options.wholeWords        = m_bWholeWords;
+    options.allSize           = m_bAllSize;
+    options.size              = m_lSize;
+    options.sizeCmp           = static_cast<SizeCompare>(m_sizeCmp);
+    options.dateLimit         = static_cast<DateLimit>(m_dateLimit);
+    options.date1             = m_date1;
+    options.date2             = m_date2;
+    options.includeSystem     = m_bIncludeSystem;
+    options.includeHidden     = m_bIncludeHidden;
+    options.includeSubfolders = m_bIncludeSubfolders;
+    options.includeSymLinks   = m_bIncludeSymLinks;
+    options.includeBinary     = m_bIncludeBinary;
+    options.createBackup      = m_bCreateBackup;
+    options.backupInFolder    = bPortable ? (_wtoi(g_iniFile.GetValue(L"settings", L"backupinfolder", L"0")) != 0)
+                                          : (static_cast<DWORD>(m_regBackupInFolder) != 0);
+    options.keepFileDate      = m_bKeepFileDate;
+    options.utf8              = m_bUTF8;
+    options.forceBinary       = m_bForceBinary;
+    options.notSearch         = m_bNotSearch;
+    options.captureSearch     = m_bCaptureSearch;
+    options.replace           = m_bReplace;
+    options.nullBytes         = bPortable ? _wtoi(g_iniFile.GetValue(L"settings", L"nullbytes", L"0"))
+                                          : static_cast<int>(static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\nullbytes", 0)));
+
+    options.forceFullWalk     = m_bFullWalk;
+    options.regexTimeout      = bPortable ? static_cast<unsigned int>(std::max(_wtoi(g_iniFile.GetValue(L"settings", L"regextimeout", L"0")), 0))
+                                          : static_cast<unsigned int>(static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\regextimeout", 0)));
+    options.contextLines      = bPortable ? static_cast<unsigned int>(std::max(_wtoi(g_iniFile.GetValue(L"settings", L"contextlines", L"0")), 0))
+                                          : static_cast<unsigned int>(static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\contextlines", 0)));
+    options.linearRegex       = bPortable ? (_wtoi(g_iniFile.GetValue(L"settings", L"linearregex", L"0")) != 0)
+                                          : (static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\linearregex", FALSE)) != 0);
+
+    // m_dirCache, m_dirCacheRoots and m_snapshot only change when the
+    // dialog gets threadEnd, until then they are only used here
+    auto         threadEnd = std::make_unique<SearchThreadEnd>();
+    std::wstring dirCacheDir;
+    if (bPortable ? (_wtoi(g_iniFile.GetValue(L"settings", L"dircache", L"0")) != 0) : (static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\dircache", FALSE)) != 0))
+        dirCacheDir = CSearchCache::DefaultPersistentDirectory();
+    threadEnd->bDirCache   = !dirCacheDir.empty();
+    CSearchCache* dirCache = threadEnd->bDirCache ? m_dirCache.get() : nullptr;
+    if (threadEnd->bDirCache && !refineFiles)
     {
-        if (!m_searchString.empty())
+        if (!dirCache)
         {
-            escapeForRegexEx(m_searchString, 0);
-            SearchReplace(m_searchString, L"\r\n", L"(?:\\n|\\r|\\r\\n)"); // multi-line
+            threadEnd->dirCache = std::make_unique<CSearchCache>();
+            dirCache            = threadEnd->dirCache.get();
         }
-        if (m_bReplace && !m_replaceString.empty())
+        for (const auto& path : options.searchPaths)
         {
-            escapeForReplaceText(m_replaceString);
+            // a full walk lists every folder again anyway
+            if (PathIsDirectory(path.c_str()) && !m_dirCacheRoots.contains(path) && threadEnd->dirCacheRoots.insert(path).second && !options.forceFullWalk)
+                dirCache->Load(dirCacheDir, path);
         }
     }
 
-    SendMessage(*this, SEARCH_START, 0, 0);
-
-    // use a thread pool:
-    // use 2 threads less than processors are available,
-    // because we already have two threads in use:
-    // the UI thread and this one.
-    ThreadPool tp(max(std::thread::hardware_concurrency() - 2, 1));
-
-    bool       bCountingOnly = m_searchString.empty();
-
-    for (const auto& cSearchPath : pathVector)
+    auto          snapshot = std::make_shared<CSearchSnapshot>(options);
+    CSearchEngine engine(options, *this, m_cancelled, dirCache);
+    engine.SetSnapshots(m_snapshot.get(), snapshot.get());
+    if (refineFiles)
+        engine.SearchFiles(*refineFiles);
+    else
+        engine.Run();
+    if (dirCache && !refineFiles && !m_cancelled.IsCancelled())
     {
-        bool         bHasLimits;
-        std::wstring searchRoot;
-        if (PathIsDirectory(cSearchPath.c_str()))
+        for (const auto& path : options.searchPaths)
         {
-            bHasLimits = true;
-            searchRoot = cSearchPath;
+            if (PathIsDirectory(path.c_str()))
+                dirCache->Save(dirCacheDir, path);
         }
-        else
-        {
-            bHasLimits = false;
-            searchRoot = cSearchPath.substr(0, cSearchPath.find_last_of('\\'));
-        }
-
-        CDirFileEnum fileEnumerator(cSearchPath.c_str());
-        if (!m_bIncludeSymLinks)
-            fileEnumerator.SetAttributesToIgnore(FILE_ATTRIBUTE_REPARSE_POINT);
-        bool         bRecurse     = bHasLimits && m_bIncludeSubfolders;
-        bool         bIsDirectory = false;
-        std::wstring sPath;
-
-        while ((fileEnumerator.NextFile(sPath, &bIsDirectory, bRecurse)) && !m_cancelled)
-        {
-            if (m_backupAndTempFiles.contains(sPath))
-                continue;
+    }
+    // after a replace, the files have to be searched again
+    if (!options.replace)
+        threadEnd->snapshot = snapshot;
+    threadEnd->options = std::move(options);
 
-            wcscpy_s(pathBuf.get(), MAX_PATH_NEW, sPath.c_str());
-            const WIN32_FIND_DATA* pFindData    = fileEnumerator.GetFileInfo();
-            FILETIME               fileTime     = pFindData->ftLastWriteTime;
-            uint64_t               fullFileSize = (static_cast<uint64_t>(pFindData->nFileSizeHigh) << 32) | pFindData->nFileSizeLow;
+    if (PostMessage(m_hwnd, WM_GREPWIN_THREADEND, 0, reinterpret_cast<LPARAM>(threadEnd.get())))
+        threadEnd.release();
 
-            bool                   bSearch      = true;
+    return 0L;
+}
 
-            if (bHasLimits)
-            {
-                bSearch = (m_bIncludeHidden || ((pFindData->dwFileAttributes & FILE_ATTRIBUTE_HIDDEN) == 0)) &&
-                          (m_bIncludeSystem || ((pFindData->dwFileAttributes & FILE_ATTRIBUTE_SYSTEM) == 0));
-                if (bSearch)
-                {
-                    if (bIsDirectory)
-                    {
-                        if (m_bIncludeSubfolders)
-                        {
-                            // dir not excluded
-                            bSearch = m_excludeDirsPatternRegex.empty();
-                            if (!bSearch)
-                            {
-                                bool bExcluded = grepWinMatchI(m_excludeDirsPatternRegex, pFindData->cFileName) ||
-                                                 grepWinMatchI(m_excludeDirsPatternRegex, pathBuf.get());
-                                if (!bExcluded)
-                                {
-                                    std::wstring relPath = pathBuf.get() + cSearchPath.size() + 1;
-                                    if (relPath.find(L'\\') != std::wstring::npos)
-                                    {
-                                        bExcluded = grepWinMatchI(m_excludeDirsPatternRegex, relPath.c_str());
-                                    }
-                                }
-                                bSearch = !bExcluded;
-                            }
-                        }
-                        else
-                        {
-                            bSearch = false;
-                        }
-                        bRecurse = bSearch;
-                        if (bSearch && !m_patternRegex.empty())
-                        {
-                            bSearch = false;
-                        }
-                    }
-                    else
-                    {
-                        // name match
-                        bSearch  = MatchPath(pathBuf.get());
-                        bRecurse = false;
-                    }
+void CSearchDlg::OnSearchStart()
+{
+    SendMessage(*this, SEARCH_START, 0, 0);
+}
 
-                    if (bSearch && (!bIsDirectory || bCountingOnly))
-                    {
-                        if (!m_bAllSize)
-                        {
-                            switch (m_sizeCmp)
-                            {
-                                case 0: // less than
-                                    bSearch &= fullFileSize < m_lSize;
-                                    break;
-                                case 1: // equal
-                                    bSearch &= fullFileSize == m_lSize;
-                                    break;
-                                case 2: // greater than
-                                    bSearch &= fullFileSize > m_lSize;
-                                    break;
-                                default:
-                                    break;
-                            }
-                        }
-                        if (bSearch)
-                        {
-                            switch (m_dateLimit + IDC_RADIO_DATE_ALL)
-                            {
-                                default:
-                                case IDC_RADIO_DATE_ALL:
-                                    break;
-                                case IDC_RADIO_DATE_NEWER:
-                                    bSearch &= CompareFileTime(&fileTime, &m_date1) >= 0;
-                                    break;
-                                case IDC_RADIO_DATE_OLDER:
-                                    bSearch &= CompareFileTime(&fileTime, &m_date1) <= 0;
-                                    break;
-                                case IDC_RADIO_DATE_BETWEEN:
-                                    bSearch &= CompareFileTime(&fileTime, &m_date1) >= 0 &&
-                                               CompareFileTime(&fileTime, &m_date2) <= 0;
-                                    break;
-                            }
-                        }
-                    }
-                }
-            }
+void CSearchDlg::OnFileResult(const CSearchInfo& sInfo, bool bSearched, bool bAsResult)
+{
+    // measured here so the dialog only has to list it
+    if (IsListedResult(sInfo, bAsResult, m_listTextState.bListAll))
+        MeasureResult(sInfo, m_listTextState);
+    SendMessage(*this, SEARCH_PROGRESS, bSearched, 0);
+    SendMessage(*this, SEARCH_FOUND, bAsResult, reinterpret_cast<LPARAM>(&sInfo));
+}
 
-            if (bSearch)
-            {
-                CSearchInfo sInfo(pathBuf.get());
-                sInfo.modifiedTime = fileTime;
-                sInfo.folder       = bIsDirectory;
-                sInfo.fileSize     = fullFileSize;
-                if (bCountingOnly)
-                {
-                    SendMessage(*this, SEARCH_FOUND, 1, reinterpret_cast<LPARAM>(&sInfo));
-                    SendMessage(*this, SEARCH_PROGRESS, 1, 0);
-                }
-                else if (!bIsDirectory)
-                {
-                    auto searchFn = [=]() {
-                        SearchFile(sInfo, searchRoot);
-                    };
-                    tp.enqueueWait(searchFn);
-                }
-            }
-            else if (!bIsDirectory || (bCountingOnly && m_patternRegex.empty()))
-            {
-                SendMessage(*this, SEARCH_PROGRESS, 0, 0);
-            }
-        }
+void CSearchDlg::OnFileResults(const std::vector<SearchFileResult>& results)
+{
+    for (const auto& result : results)
+    {
+        if (IsListedResult(result.sInfo, result.bAsResult, m_listTextState.bListAll))
+            MeasureResult(result.sInfo, m_listTextState);
     }
+    // one message for the whole batch instead of two per file
+    SendMessage(*this, SEARCH_FOUNDBATCH, 0, reinterpret_cast<LPARAM>(&results));
+}
 
-    tp.waitFinished();
-    SendMessage(*this, SEARCH_END, 0, 0);
-    m_dwThreadRunning = false;
-
-    // refresh cursor
-    POINT pt;
-    GetCursorPos(&pt);
-    SetCursorPos(pt.x, pt.y);
-
-    PostMessage(m_hwnd, WM_GREPWIN_THREADEND, 0, 0);
+void CSearchDlg::OnFileSkipped()
+{
+    SendMessage(*this, SEARCH_PROGRESS, 0, 0);
+}
 
-    return 0L;
+void CSearchDlg::OnSearchEnd()
+{
+    SendMessage(*this, SEARCH_END, 0, 0);
 }
 
 void CSearchDlg::SetSearchPath(const std::wstring& path)
@@ -3796,738 +4528,6 @@ void CSearchDlg::SetDateLimit(int dateLimit, FILETIME t1, FILETIME t2)
     m_date2       = t2;
 }
 
-bool CSearchDlg::MatchPath(LPCTSTR pathBuf) const
-{
-    if (m_patterns.empty())
-        return true;
-
-    bool        bPattern = false;
-    // find start of pathname
-    const auto* pName    = wcsrchr(pathBuf, '\\');
-    if (pName == nullptr)
-        pName = pathBuf;
-    else
-        pName++; // skip the last '\\' char
-    if (m_bUseRegexForPaths)
-    {
-        if (grepWinMatchI(m_patternRegex, pName))
-            bPattern = true;
-        // for a regex check, also test with the full path
-        else if (grepWinMatchI(m_patternRegex, pathBuf))
-            bPattern = true;
-    }
-    else
-    {
-        if (m_patterns[0].size() && (m_patterns[0][0] == '-'))
-            bPattern = true;
-
-        std::wstring fName = pName;
-        std::ranges::transform(fName, fName.begin(), ::towlower);
-
-        for (const auto& pattern : m_patterns)
-        {
-            if (!pattern.empty() && pattern.at(0) == '-')
-                bPattern = bPattern && !wcswildcmp(&(pattern)[1], fName.c_str());
-            else
-                bPattern = bPattern || wcswildcmp(pattern.c_str(), fName.c_str());
-        }
-    }
-    return bPattern;
-}
-
-std::wstring CSearchDlg::BackupFile(const std::wstring& destParentDir, const std::wstring& filePath, bool bMove)
-{
-    std::wstring backupFile;
-    bool         backupInFolder = bPortable
-                                      ? (_wtoi(g_iniFile.GetValue(L"settings", L"backupinfolder", L"0")) != 0)
-                                      : (static_cast<DWORD>(m_regBackupInFolder) != 0);
-    if (backupInFolder)
-    {
-        std::wstring backupFolder = destParentDir + L"\\grepWin_backup\\";
-        backupFolder += filePath.substr(destParentDir.size() + 1);
-        backupFolder = CPathUtils::GetParentDirectory(backupFolder);
-        CPathUtils::CreateRecursiveDirectory(backupFolder);
-        backupFile = backupFolder + L"\\" + CPathUtils::GetFileName(filePath);
-    }
-    else
-    {
-        backupFile = filePath + L".bak";
-    }
-    SetFileAttributes(backupFile.c_str(), 0);
-    bool bOk = false;
-    if (bMove)
-    {
-        bOk = MoveFileEx(filePath.c_str(), backupFile.c_str(), MOVEFILE_REPLACE_EXISTING);
-    }
-    else
-    {
-        bOk = CopyFile(filePath.c_str(), backupFile.c_str(), FALSE);
-    }
-    if (!bOk)
-    {
-        return L"";
-    }
-    m_backupAndTempFiles.insert(backupFile);
-
-    return backupFile;
-}
-
-int CSearchDlg::AdoptTempResultFile(CSearchInfo& sInfo, const std::wstring& searchRoot, const std::wstring& tempFilePath)
-{
-    FILETIME creationTime{};
-    FILETIME lastAccessTime{};
-    FILETIME lastWriteTime{};
-    if (m_bKeepFileDate)
-    {
-        HANDLE hFile = CreateFile(sInfo.filePath.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
-        if (hFile == INVALID_HANDLE_VALUE)
-        {
-            return -1;
-        }
-        bool bOk = GetFileTime(hFile, &creationTime, &lastAccessTime, &lastWriteTime);
-        CloseHandle(hFile);
-        if (!bOk)
-        {
-            return -1;
-        }
-    }
-    DWORD origAttributes = GetFileAttributes(sInfo.filePath.c_str());
-    bool  bIsShr         = (origAttributes & (FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_READONLY | FILE_ATTRIBUTE_SYSTEM)) != 0;
-    if (bIsShr)
-    {
-        SetFileAttributes(sInfo.filePath.c_str(), 0);
-    }
-    if (m_bCreateBackup && !sInfo.hasBackedup)
-    {
-        if (BackupFile(searchRoot, sInfo.filePath, true).empty())
-        {
-            return -1;
-        }
-        sInfo.hasBackedup = true;
-    }
-    if (!MoveFileEx(tempFilePath.c_str(), sInfo.filePath.c_str(), MOVEFILE_REPLACE_EXISTING))
-    {
-        return -1;
-    }
-    if (m_bKeepFileDate)
-    {
-        int countDown = 5;
-        do
-        {
-            HANDLE hFile = CreateFile(sInfo.filePath.c_str(), FILE_WRITE_ATTRIBUTES, FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
-            bool   bOk   = hFile != INVALID_HANDLE_VALUE;
-            if (bOk)
-            {
-                // The NTFS file system delays updates to the last access time for a file by up to 1 hour after the last access.
-                bOk = SetFileTime(hFile, &creationTime, &lastAccessTime, &lastWriteTime);
-                CloseHandle(hFile);
-            }
-            if (bOk)
-            {
-                break;
-            }
-            else
-            {
-                Sleep(50);
-            }
-            --countDown;
-        } while (countDown > 0);
-        // if (countDown <= 0), main change has been made, still return succeeded.
-    }
-    if (bIsShr)
-    {
-        SetFileAttributes(sInfo.filePath.c_str(), origAttributes);
-    }
-
-    return 1;
-}
-
-int CSearchDlg::SearchOnTextFile(CSearchInfo& sInfo, const std::wstring& searchRoot, const std::wstring& searchExpression, const std::wstring& replaceExpression, UINT syntaxFlags, UINT matchFlags, CTextFile& textFile)
-{
-    int          nFound = 0;
-
-    std::wstring expr   = searchExpression;
-    if (!m_bUseRegex && m_bWholeWords)
-    {
-        expr = L"\\b" + expr + L"\\b";
-    }
-
-    std::wstring::const_iterator start, end;
-    start = textFile.GetFileString().begin();
-    end   = textFile.GetFileString().end();
-    boost::match_results<std::wstring::const_iterator> whatC;
-    boost::wregex                                      wRegEx = boost::wregex(expr, syntaxFlags);
-    boost::match_flag_type                             mFlags = static_cast<boost::match_flag_type>(matchFlags);
-
-    size_t                       count     = textFile.GetFileString().size();
-    size_t                       remainder = count % (SEARCHBLOCKSIZE / 2);
-    std::wstring::const_iterator startIter = start;
-    std::wstring::const_iterator blockEnd  = start + remainder;
-
-    std::wstring                   filePathTemp = sInfo.filePath + L".grepwinreplaced";
-    RegexReplaceFormatter<wchar_t> replaceFmt(replaceExpression);
-    std::wstring                   replaced;
-    auto                           replacedIter = std::back_inserter(replaced);
-    if (m_bReplace) // synchronize Replace and Search for cancellation and reducing repetitive work on huge files
-    {
-        m_backupAndTempFiles.insert(filePathTemp);
-    }
-    do
-    {
-        while (!m_cancelled && (startIter < blockEnd) && regex_search(startIter, blockEnd, whatC, wRegEx, mFlags, start))
-        {
-            nFound++;
-            if (m_bNotSearch)
-                break;
-            //
-            mFlags |= boost::match_prev_avail;
-            mFlags |= boost::match_not_bob;
-            //
-            long posMatchHead = static_cast<long>(whatC[0].first - textFile.GetFileString().begin());
-            long posMatchTail = static_cast<long>(whatC[0].second - textFile.GetFileString().begin());
-            if (whatC[0].first < whatC[0].second) // m[0].second is not part of the match
-                --posMatchTail;
-            long lineStart = textFile.LineFromPosition(posMatchHead);
-            long lineEnd   = textFile.LineFromPosition(posMatchTail);
-            long colMatch  = textFile.ColumnFromPosition(posMatchHead, lineStart);
-            long lenMatch  = static_cast<long>(whatC[0].length());
-            if (m_bCaptureSearch)
-            {
-                auto out = whatC.format(m_replaceString, mFlags);
-                sInfo.matchLines.push_back(out);
-                sInfo.matchLinesNumbers.push_back(lineStart);
-                sInfo.matchColumnsNumbers.push_back(colMatch);
-                sInfo.matchLengths.push_back(static_cast<long>(out.length()));
-            }
-            else
-            {
-                for (long l = lineStart; l <= lineEnd; ++l)
-                {
-                    auto sLine        = textFile.GetLineString(l);
-                    long lenLineMatch = static_cast<long>(sLine.length()) - colMatch + 1;
-                    if (lenMatch < lenLineMatch)
-                    {
-                        lenLineMatch = lenMatch;
-                    }
-                    sInfo.matchLines.push_back(std::move(sLine));
-                    sInfo.matchLinesNumbers.push_back(l);
-                    sInfo.matchColumnsNumbers.push_back(colMatch);
-                    sInfo.matchLengths.push_back(lenLineMatch);
-                    if (lenMatch > lenLineMatch)
-                    {
-                        colMatch = 1;
-                        lenMatch -= lenLineMatch;
-                    }
-                }
-            }
-            ++sInfo.matchCount;
-            if (m_bReplace)
-            {
-                std::copy(startIter, whatC[0].first, replacedIter);
-                regex_replace(replacedIter, whatC[0].first, whatC[0].second, wRegEx, replaceFmt, mFlags);
-            }
-            //
-            startIter = whatC[0].second;
-            if (startIter == whatC[0].first) // ^$
-            {
-                if (startIter == blockEnd)
-                    break;
-                if (m_bReplace)
-                    std::copy(startIter, startIter + 1, replacedIter);
-                ++startIter;
-            }
-        }
-        if (startIter < blockEnd) // not found
-        {
-            if (m_bReplace)
-                std::copy(startIter, blockEnd, replacedIter);
-            startIter = blockEnd;
-        }
-        if (blockEnd < end)
-            blockEnd += SEARCHBLOCKSIZE / 2;
-        else
-            break;
-    } while (!m_cancelled);
-
-    if (!m_bReplace || m_cancelled || nFound == 0)
-    {
-        return nFound;
-    }
-
-    textFile.SetFileContent(replaced);
-    if (!textFile.Save(filePathTemp.c_str(), false))
-    {
-        return -1;
-    }
-
-    if (AdoptTempResultFile(sInfo, searchRoot, filePathTemp) <= 0)
-    {
-        return -1;
-    }
-
-    return nFound;
-}
-
-namespace
-{
-std::wstring utf16Swap(const std::wstring& str)
-{
-    std::wstring swapped = str;
-    for (size_t i = 0; i < swapped.length(); ++i)
-    {
-        swapped[i] = swapped[i] << 8 | (swapped[i] >> 8 & 0xff);
-    }
-    return swapped;
-}
-
-std::wstring ConvertToWstring(const std::string& str, CTextFile::UnicodeType encoding)
-{
-    std::wstring strW;
-    switch (encoding)
-    {
-        case CTextFile::Ansi:
-            strW = MultibyteToWide(str);
-            break;
-        case CTextFile::UTF8:
-            strW = UTF8ToWide(str);
-            break;
-        default:
-        {
-            strW = std::wstring(reinterpret_cast<const wchar_t*>(str.c_str()), str.length() / 2);
-            if (encoding == CTextFile::Unicode_Be)
-                strW = utf16Swap(strW);
-        }
-        break;
-    }
-    return strW;
-}
-}
-
-template <typename CharT = char>
-std::basic_string<CharT> ConvertToString(const std::wstring& /*str*/, CTextFile::UnicodeType /*encoding*/, CharT* /*dummy*/ = nullptr)
-{
-    return {};
-};
-
-template <>
-std::basic_string<char> ConvertToString<char>(const std::wstring& str, CTextFile::UnicodeType encoding, char*)
-{
-    switch (encoding)
-    {
-        case CTextFile::Unicode_Le:
-            return std::basic_string<char>(reinterpret_cast<const char*>(str.c_str()), 2 * str.length());
-        case CTextFile::Unicode_Be:
-        {
-            std::wstring strBe = utf16Swap(str);
-            return std::basic_string<char>(reinterpret_cast<const char*>(strBe.c_str()), 2 * strBe.length());
-        }
-        case CTextFile::Ansi:
-            return CUnicodeUtils::StdGetANSI(str);
-        case CTextFile::UTF8:
-            return CUnicodeUtils::StdGetUTF8(str);
-        default:
-            return "";
-    }
-};
-
-template <>
-std::basic_string<wchar_t> ConvertToString<wchar_t>(const std::wstring& str, CTextFile::UnicodeType encoding, wchar_t*)
-{
-    if (encoding == CTextFile::Unicode_Be)
-        return utf16Swap(str);
-    return str;
-};
-
-template <typename CharT>
-int CSearchDlg::SearchByFilePath(CSearchInfo& sInfo, const std::wstring& searchRoot, const std::wstring& searchExpression, const std::wstring& replaceExpression, UINT syntaxFlags, UINT matchFlags, bool misaligned, CharT*)
-{
-
-    boost::iostreams::mapped_file_source inFile(boost::filesystem::path(sInfo.filePath));
-    if (!inFile.is_open())
-        return -1;
-
-    const char*       inData   = inFile.data();
-    size_t            inSize   = inFile.size();
-    size_t            skipSize = 0;
-    size_t            workSize = inSize;
-    size_t            dropSize = 0;
-    const CharT*      fBeg     = reinterpret_cast<const CharT*>(inData);
-    const CharT*      start    = fBeg;
-    const CharT*      end      = fBeg + inSize / sizeof(CharT);
-
-    TextOffset<CharT> textOffset;
-    if ((sInfo.encoding == CTextFile::UTF8) || (sInfo.encoding == CTextFile::Unicode_Le) || (sInfo.encoding == CTextFile::Unicode_Be))
-    {
-        start = textOffset.SkipBOM(fBeg, end);
-    }
-    else
-        start = fBeg;
-
-    skipSize = reinterpret_cast<const char*>(start) - inData;
-    workSize = inSize - skipSize;
-    if (sizeof(CharT) > 1)
-    {
-        if (misaligned && skipSize < inSize)
-        {
-            ++skipSize;
-            --workSize;
-            const char* p = reinterpret_cast<const char*>(start);
-            ++p;
-            start = reinterpret_cast<const CharT*>(p);
-        }
-        dropSize = workSize % sizeof(CharT);
-        if (dropSize > 0)
-            workSize -= dropSize;
-    }
-    if (workSize == 0)
-    {
-        inFile.close();
-        return 0;
-    }
-    end                           = reinterpret_cast<const CharT*>(inData + skipSize + workSize);
-
-    std::basic_string<CharT> expr = ConvertToString<CharT>(searchExpression, sInfo.encoding);
-
-    if (!m_bUseRegex && m_bWholeWords)
-    {
-        const CharT boundary[] = {'\\', 'b', 0};
-        expr                   = boundary + expr + boundary;
-    }
-
-    boost::match_results<const CharT*>         whatC;
-    boost::basic_regex<CharT>                  regEx        = boost::basic_regex<CharT>(expr, syntaxFlags);
-    boost::match_flag_type                     mFlags       = static_cast<boost::match_flag_type>(matchFlags);
-
-    size_t                                     count        = workSize / sizeof(CharT);
-    size_t                                     remainder    = count % (SEARCHBLOCKSIZE / sizeof(CharT));
-    const CharT*                               startIter    = start;
-    const CharT*                               blockEnd     = start + remainder;
-
-    int                                        nFound       = 0;
-    std::wstring                               filePathTemp = sInfo.filePath + L".grepwinreplaced";
-    std::basic_filebuf<char>                   outFileBufA;
-    std::basic_string<CharT>                   repl         = ConvertToString<CharT>(replaceExpression, sInfo.encoding);
-    RegexReplaceFormatter<CharT, const CharT*> replaceFmt(repl);
-    if (m_bReplace) // synchronize Replace and Search for cancellation and reducing repetitive work on huge files
-    {
-        m_backupAndTempFiles.insert(filePathTemp);
-
-        outFileBufA.open(filePathTemp, std::ios::out | std::ios::trunc | std::ios::binary); // overwrite
-        if (!outFileBufA.is_open())
-        {
-            inFile.close();
-            return -1;
-        }
-        outFileBufA.sputn(inData, skipSize);
-    }
-
-    do
-    {
-        while (!m_cancelled && (startIter < blockEnd) && boost::regex_search(startIter, blockEnd, whatC, regEx, mFlags, start))
-        {
-            nFound++;
-            if (m_bNotSearch)
-                break;
-            //
-            mFlags |= boost::match_prev_avail;
-            mFlags |= boost::match_not_bob;
-            //
-            sInfo.matchLinesNumbers.push_back(static_cast<DWORD>(whatC[0].first - fBeg));
-            sInfo.matchColumnsNumbers.push_back(static_cast<DWORD>(whatC[0].length()));
-            ++sInfo.matchCount;
-            if (m_bReplace)
-            {
-                if constexpr (sizeof(CharT) > 1)
-                {
-                    std::wstring replaced;
-                    auto         replacedIter = std::back_inserter(replaced);
-                    outFileBufA.sputn(reinterpret_cast<const char*>(startIter), (whatC[0].first - startIter) * 2);
-                    regex_replace(replacedIter, whatC[0].first, whatC[0].second, regEx, replaceFmt, mFlags);
-                    outFileBufA.sputn(reinterpret_cast<const char*>(replaced.c_str()), replaced.length() * 2);
-                }
-                else
-                {
-                    std::ostreambuf_iterator<char> outIter(&outFileBufA);
-                    outFileBufA.sputn(startIter, whatC[0].first - startIter);
-                    regex_replace(outIter, whatC[0].first, whatC[0].second, regEx, replaceFmt, mFlags);
-                }
-            }
-            //
-            startIter = whatC[0].second;
-            if (startIter == whatC[0].first) // ^$
-            {
-                if (startIter == blockEnd)
-                    break;
-                if (m_bReplace)
-                {
-                    if constexpr (sizeof(CharT) > 1)
-                        outFileBufA.sputn(reinterpret_cast<const char*>(startIter), 2);
-                    else
-                        outFileBufA.sputc(*startIter);
-                }
-                ++startIter;
-            }
-        }
-        if (startIter < blockEnd) // not found
-        {
-            if (m_bReplace)
-            {
-                if constexpr (sizeof(CharT) > 1)
-                    outFileBufA.sputn(reinterpret_cast<const char*>(startIter), (blockEnd - startIter) * 2);
-                else
-                    outFileBufA.sputn(startIter, blockEnd - startIter);
-            }
-            startIter = blockEnd;
-        }
-        if (blockEnd < end)
-            blockEnd += SEARCHBLOCKSIZE / sizeof(CharT);
-        else
-            break;
-    } while (!m_cancelled);
-
-    bool bAdopt = false;
-    if (m_bReplace)
-    {
-        if (nFound > 0)
-        {
-            bAdopt = true;
-            if (dropSize > 0 && !m_cancelled)
-            {
-                outFileBufA.sputc(inData[inSize - 2]);
-            }
-        }
-        outFileBufA.close(); // reduce memory ASAP for huge files
-        if (!bAdopt)
-        {
-            // if cancelled or failed but found any, keep `filePathTemp` to give some hints
-            DeleteFile(filePathTemp.c_str());
-        }
-    }
-    if (nFound > 0)
-    {
-        if ((sInfo.encoding != CTextFile::Binary) && !m_bNotSearch)
-        {
-            if (blockEnd - start < 4 * SEARCHBLOCKSIZE)
-                textOffset.CalculateLines(start, blockEnd, false);
-            else
-                textOffset.CalculateLines(start, blockEnd, m_cancelled);
-            for (size_t mp = 0; mp < sInfo.matchLinesNumbers.size(); ++mp)
-            {
-                // return the nearest position to give some hints when cancelled
-                auto pos                      = sInfo.matchLinesNumbers[mp];
-                sInfo.matchLinesNumbers[mp]   = textOffset.LineFromPosition(pos);
-                auto lenMatchLength           = sInfo.matchColumnsNumbers[mp];
-                sInfo.matchColumnsNumbers[mp] = textOffset.ColumnFromPosition(pos, sInfo.matchLinesNumbers[mp]);
-                auto linePos                  = textOffset.PositionsFromLine(sInfo.matchLinesNumbers[mp]);
-                auto lineStart                = std::get<0>(linePos);
-                auto lineEnd                  = std::get<1>(linePos);
-                auto lineLength               = lineEnd - lineStart;
-                if (lineLength > 0 && lineLength < 4096) // ignore lines longer than 4kb
-                {
-                    if constexpr (std::is_same_v<CharT, wchar_t>)
-                    {
-                        auto sLine = std::basic_string<CharT>(static_cast<const CharT*>(start + lineStart), lineLength);
-                        if (sInfo.encoding == CTextFile::Unicode_Be)
-                            sLine = utf16Swap(sLine);
-                        lenMatchLength = min(lenMatchLength, static_cast<DWORD>(sLine.length() - sInfo.matchColumnsNumbers[mp]));
-                        sInfo.matchLines.push_back(std::move(sLine));
-                        sInfo.matchLengths.push_back(lenMatchLength);
-                    }
-                    else
-                    {
-                        auto         p = start + lineStart;
-                        auto         sLineAL = std::basic_string<CharT>(static_cast<const CharT*>(p), sInfo.matchColumnsNumbers[mp] - 1);
-                        p += sInfo.matchColumnsNumbers[mp] - 1;
-                        auto         sLineAM = std::basic_string<CharT>(static_cast<const CharT*>(p), lenMatchLength);
-                        p += lenMatchLength;
-                        auto         sLineAR = std::basic_string<CharT>(static_cast<const CharT*>(p), start + lineEnd - p);
-                        std::wstring sLineWL = ConvertToWstring(sLineAL, sInfo.encoding);
-                        sInfo.matchColumnsNumbers[mp] = static_cast<long>(sLineWL.length());
-                        if (sInfo.matchColumnsNumbers[mp] == 0)
-                            ++sInfo.matchColumnsNumbers[mp];
-                        std::wstring sLineWM = ConvertToWstring(sLineAM, sInfo.encoding);
-                        lenMatchLength = static_cast<long>(sLineWM.length());
-                        sInfo.matchLines.push_back(sLineWL + sLineWM + ConvertToWstring(sLineAR, sInfo.encoding));
-                        sInfo.matchLengths.push_back(lenMatchLength);
-                    }
-                }
-                else
-                {
-                    sInfo.matchLines.push_back(L"");
-                    sInfo.matchLengths.push_back(0);
-                }
-            }
-        }
-    }
-
-    inFile.close();
-    if (bAdopt && !m_cancelled)
-    {
-        AdoptTempResultFile(sInfo, searchRoot, filePathTemp);
-    }
-
-    return nFound;
-}
-
-void CSearchDlg::SendResult(const CSearchInfo& sInfo, const int nCount)
-{
-    SendMessage(*this, SEARCH_PROGRESS, (nCount >= 0), 0);
-    bool bAsResult = m_bNotSearch ? (nCount <= 0) : (nCount > 0);
-    SendMessage(*this, SEARCH_FOUND, bAsResult, reinterpret_cast<LPARAM>(&sInfo));
-}
-
-void CSearchDlg::SearchFile(CSearchInfo sInfo, const std::wstring& searchRoot)
-{
-    CTextFile              textFile;
-    CTextFile::UnicodeType type        = CTextFile::AutoType;
-    bool                   bLoadResult = false;
-    if (m_bForceBinary)
-    {
-        type = CTextFile::Binary;
-    }
-    else
-    {
-        ProfileTimer profile((L"file load and parse: " + sInfo.filePath).c_str());
-        auto         nNullCount = bPortable ? _wtoi(g_iniFile.GetValue(L"settings", L"nullbytes", L"0"))
-                                            : static_cast<int>(static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\nullbytes", 0)));
-        if (nNullCount > 0)
-        {
-            constexpr __int64 oneMB = 1024 * 1024;
-            auto              megs  = sInfo.fileSize / oneMB;
-            textFile.SetNullbyteCountForBinary(nNullCount * (static_cast<int>(megs) + 1));
-        }
-        bLoadResult = textFile.Load(sInfo.filePath.c_str(), type, m_bUTF8, m_cancelled);
-    }
-
-    sInfo.encoding                 = type;
-    int          nCount            = -1; // >= 0: got results; -1: skipped
-    if (m_cancelled) // big file
-    {
-        SendResult(sInfo, nCount);
-        return;
-    }
-
-    std::wstring searchExpression  = m_searchString;
-    std::wstring replaceExpression = m_replaceString;
-    if (m_bUseRegex)
-    {
-        replaceGrepWinFilePathVariables(searchExpression, sInfo.filePath);
-        if (m_bReplace)
-        {
-            replaceGrepWinFilePathVariables(replaceExpression, sInfo.filePath);
-        }
-    }
-
-    UINT syntaxFlags = boost::regex::normal;
-    if (!m_bCaseSensitive)
-        syntaxFlags |= boost::regbase::icase;
-    boost::match_flag_type matchFlags = boost::match_default | boost::format_all;
-    if (!m_bDotMatchesNewline)
-        matchFlags |= boost::match_not_dot_newline;
-
-    if (type == CTextFile::AutoType) // reading the file failed
-    {
-        sInfo.readError = true;
-    }
-    else if (bLoadResult && ((type != CTextFile::Binary) || m_bIncludeBinary)) // transcoded
-    {
-        // for unrecognized, only `Binary` returns true and treated as UTF-16LE, the same as app internal
-        try
-        {
-            nCount = SearchOnTextFile(sInfo, searchRoot, searchExpression, replaceExpression, syntaxFlags, matchFlags, textFile);
-        }
-        catch (const std::exception& ex)
-        {
-            sInfo.exception = CUnicodeUtils::StdGetUnicode(ex.what());
-            nCount          = 1;
-        }
-    }
-    else if ((type != CTextFile::Binary) || m_bIncludeBinary || m_bForceBinary)
-    {
-        // file is either too big or binary.
-        // types: Ansi, UTF8, Unicode_Le, Unicode_Be and Binary
-        std::vector<CTextFile::UnicodeType> encodingTries;
-        if (!m_bUseRegex || type == CTextFile::Binary)
-        {
-            // Treating a multi-byte char as single byte chars:
-            //  yields part of it may be matched as a standalone char,
-            //  so requires it grouped for repeats to get accurate results.
-            //  Unicode_Le and Unicode_Be in Regex mode are turned into wchar_t branch. UTF8 is still here.
-            // Without transcoding the file, transcoding the input to other encoding is a trick, to get a bit more outcome.
-            // It only works for raw data, not escaped sequence, that is pure ASCII char!
-            switch (type)
-            {
-                case CTextFile::Binary:
-                {
-                    if (m_bUseRegex)
-                        encodingTries = {CTextFile::Ansi, CTextFile::UTF8};
-                    else
-                        encodingTries = {CTextFile::Ansi, CTextFile::UTF8, CTextFile::Unicode_Le, CTextFile::Unicode_Be};
-                }
-                break;
-                case CTextFile::Ansi:
-                case CTextFile::UTF8:
-                case CTextFile::Unicode_Le:
-                case CTextFile::Unicode_Be:
-                default:
-                    encodingTries = {type};
-                    break;
-            }
-            for (auto assumption : encodingTries)
-            {
-                sInfo.encoding = assumption;
-                try
-                {
-                    nCount = SearchByFilePath<char>(sInfo, searchRoot, searchExpression, replaceExpression, syntaxFlags, matchFlags, false);
-                }
-                catch (...)
-                {
-                    // regex error
-                }
-                if (nCount > 0)
-                {
-                    break; // try all is consuming
-                }
-            }
-        }
-        if (m_bUseRegex && nCount <= 0 && (type == CTextFile::Unicode_Le || type == CTextFile::Unicode_Be || type == CTextFile::Binary))
-        {
-            switch (type)
-            {
-                case CTextFile::Binary:
-                    encodingTries = {CTextFile::Unicode_Le, CTextFile::Unicode_Be};
-                    break;
-                case CTextFile::Unicode_Le:
-                case CTextFile::Unicode_Be:
-                default:
-                    encodingTries = {type};
-                    break;
-            }
-            for (auto assumption : encodingTries)
-            {
-                sInfo.encoding = assumption;
-                try
-                {
-                    nCount += SearchByFilePath<wchar_t>(sInfo, searchRoot, searchExpression, replaceExpression, syntaxFlags, matchFlags, false);
-                    if (type == CTextFile::Binary)
-                        nCount += SearchByFilePath<wchar_t>(sInfo, searchRoot, searchExpression, replaceExpression, syntaxFlags, matchFlags, true);
-                }
-                catch (...)
-                {
-                    // regex error
-                }
-                if (nCount > 0)
-                {
-                    break; // try all is consuming
-                }
-            }
-        }
-        // sInfo.encoding = type; // show the matched encoding
-    }
-
-    SendResult(sInfo, nCount);
-}
-
 DWORD WINAPI SearchThreadEntry(LPVOID lpParam)
 {
     CSearchDlg* pThis = static_cast<CSearchDlg*>(lpParam);
@@ -4536,7 +4536,7 @@ DWORD WINAPI SearchThreadEntry(LPVOID lpParam)
     return 0L;
 }
 
-void CSearchDlg::formatDate(wchar_t dateNative[], const FILETIME& fileTime, bool forceShortFmt)
+void CSearchDlg::formatDate(wchar_t dateNative[], const FILETIME& fileTime, const TIME_ZONE_INFORMATION& timeZone, bool forceShortFmt)
 {
     dateNative[0] = '\0';
 
@@ -4544,10 +4544,6 @@ void CSearchDlg::formatDate(wchar_t dateNative[], const FILETIME& fileTime, bool
     SYSTEMTIME systemTime;
     FileTimeToSystemTime(&fileTime, &systemTime);
 
-    static TIME_ZONE_INFORMATION timeZone = {-1};
-    if (timeZone.Bias == -1)
-        GetTimeZoneInformation(&timeZone);
-
     SYSTEMTIME localSystime;
     SystemTimeToTzSpecificLocalTime(&timeZone, &systemTime, &localSystime);
 
@@ -4573,7 +4569,10 @@ void CSearchDlg::AutoSizeAllColumns()
     auto             headerCtrl        = ListView_GetHeader(hListControl);
     int              nItemCount        = ListView_GetItemCount(hListControl);
     wchar_t          textBuf[MAX_PATH] = {0};
+    bool             fileList          = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
+    const auto&      widths            = fileList ? m_fileColumnWidths : m_lineColumnWidths;
     std::vector<int> colWidths;
+    m_columnWidthChanges = m_fileColumnWidths.Changes() + m_lineColumnWidths.Changes();
     if (headerCtrl)
     {
         int  maxCol   = Header_GetItemCount(headerCtrl) - 1;
@@ -4592,14 +4591,13 @@ void CSearchDlg::AutoSizeAllColumns()
             hdi.pszText    = textBuf;
             hdi.cchTextMax = _countof(textBuf);
             Header_GetItem(headerCtrl, col, &hdi);
-            int cx  = ListView_GetStringWidth(hListControl, hdi.pszText) + 20; // 20 pixels for col separator and margin
+            int cx = ListView_GetStringWidth(hListControl, hdi.pszText) + 20; // 20 pixels for col separator and margin
 
-            int inc = max(1, nItemCount / 1000);
-            for (int index = 0; index < nItemCount; index = index + inc)
+            if (nItemCount > 0 && col < static_cast<int>(widths.ColumnCount()))
             {
-                // get the width of the string and add 14 pixels for the column separator and margins
-                ListView_GetItemText(hListControl, index, col, textBuf, _countof(textBuf));
-                int lineWidth = ListView_GetStringWidth(hListControl, textBuf) + CDPIAware::Instance().Scale(*this, 14);
+                // the widest text of the column, measured as the results arrived,
+                // and 14 pixels for the column separator and margins
+                int lineWidth = widths.Width(col) + CDPIAware::Instance().Scale(*this, 14);
                 // add the image size
                 if (col == 0)
                     lineWidth += imgWidth;
@@ -4609,7 +4607,6 @@ void CSearchDlg::AutoSizeAllColumns()
             colWidths.push_back(cx);
         }
     }
-    bool fileList = (IsDlgButtonChecked(*this, IDC_RESULTFILES) == BST_CHECKED);
     if (!fileList)
     {
         RECT rc{};
@@ -4656,7 +4653,7 @@ int CSearchDlg::GetSelectedListIndex(int index)
 int CSearchDlg::GetSelectedListIndex(bool fileList, int index) const
 {
     if (fileList)
-        return index;
+        return m_fileListItems[index];
     auto tup = m_listItems[index];
     return std::get<0>(tup);
 }
@@ -18,7 +18,17 @@
 //
 #pragma once
 #include "BaseDialog.h"
+#include "CancellationToken.h"
+#include "ColumnWidths.h"
+#include "ResultArchive.h"
+#include "ResultExport.h"
+#include "ResultFilter.h"
+#include "ResultOrder.h"
+#include "SearchCache.h"
 #include "SearchInfo.h"
+#include "SearchOptions.h"
+#include "SearchResultSink.h"
+#include "SearchSnapshot.h"
 #include "BookmarksDlg.h"
 #include "DlgResizer.h"
 #include "FileDropTarget.h"
@@ -26,6 +36,10 @@
 #include "Registry.h"
 #include "EditDoubleClick.h"
 #include "InfoRtfDialog.h"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <optional>
 #include <string>
 #include <vector>
 #include <set>
@@ -35,15 +49,26 @@
 
 using namespace Microsoft::WRL;
 
-#define SEARCH_FOUND         (WM_APP + 1)
-#define SEARCH_START         (WM_APP + 2)
-#define SEARCH_PROGRESS      (WM_APP + 3)
-#define SEARCH_END           (WM_APP + 4)
-#define WM_GREPWIN_THREADEND (WM_APP + 5)
+#define SEARCH_FOUND          (WM_APP + 1)
+#define SEARCH_START          (WM_APP + 2)
+#define SEARCH_PROGRESS       (WM_APP + 3)
+#define SEARCH_END            (WM_APP + 4)
+#define WM_GREPWIN_THREADEND  (WM_APP + 5)
+#define SEARCH_WATCHUPDATE    (WM_APP + 6)
+#define SEARCH_FOUNDBATCH     (WM_APP + 7)
+#define SEARCH_SORTED         (WM_APP + 8)
+#define SEARCH_FILTERED       (WM_APP + 9)
+#define SEARCH_EXPORTPROGRESS (WM_APP + 10)
+#define SEARCH_EXPORTED       (WM_APP + 11)
 
 #define ID_ABOUTBOX          0x0010
 #define ID_CLONE             0x0011
 
+class CResultWatcher;
+struct WatchUpdate;
+struct SortedResults;
+struct FilteredRows;
+
 enum class ExecuteAction
 {
     None,
@@ -52,10 +77,40 @@ enum class ExecuteAction
     Capture
 };
 
+// writes the results to a file, like CResultExporter::Export()
+using ExportFunction = std::function<bool(const std::vector<CSearchInfo>& items, const std::vector<int>& order, const std::wstring& path, const CCancellationToken& cancelToken, const std::function<void(size_t)>& progress)>;
+
+// the results of a search which were searched within, to show them again
+struct ResultGeneration
+{
+    std::vector<CSearchInfo>     items;
+    std::optional<SearchOptions> options;
+    int                          totalItems    = 0;
+    int                          searchedItems = 0;
+    int                          totalMatches  = 0;
+    int                          timedOutItems = 0;
+    std::vector<int>             fileColumnWidths;
+    std::vector<int>             lineColumnWidths;
+    std::vector<int>             itemOrder;
+};
+
+// what the texts of the result list depend on besides the results. The
+// search threads measure the results they find with the one taken when
+// the search starts, the dialog can change its own meanwhile.
+struct ListTextState
+{
+    std::wstring          searchPath;
+    TIME_ZONE_INFORMATION timeZone{};
+    HFONT                 font     = nullptr;
+    // results without matches are listed too
+    bool                  bListAll = false;
+};
+
 /**
  * search dialog.
  */
 class CSearchDlg : public CDialog
+    , public ISearchResultSink
 {
 public:
           CSearchDlg(HWND hParent);
@@ -103,18 +158,70 @@ protected:
     LRESULT             DoCommand(int id, int msg);
     bool                PreTranslateMessage(MSG* pMsg) override;
 
-    std::wstring        BackupFile(const std::wstring& destParentDir, const std::wstring& filePath, bool bMove);
-    int                 AdoptTempResultFile(CSearchInfo& sInfo, const std::wstring& searchRoot, const std::wstring& tempFilePath);
-    int                 SearchOnTextFile(CSearchInfo& sInfo, const std::wstring& searchRoot, const std::wstring& searchExpression, const std::wstring& replaceExpression, UINT syntaxFlags, UINT matchFlags, CTextFile& textFile);
-    template<typename CharT = char>
-    int                 SearchByFilePath(CSearchInfo& sInfo, const std::wstring& searchRoot, const std::wstring& searchExpression, const std::wstring& replaceExpression, UINT syntaxFlags, UINT matchFlags, bool misaligned, CharT* dummy = nullptr);
-    void                SendResult(const CSearchInfo& sInfo, const int nCount);
-    void                SearchFile(CSearchInfo sInfo, const std::wstring& searchRoot);
+    // ISearchResultSink: called from the search threads
+    void                OnSearchStart() override;
+    void                OnFileResult(const CSearchInfo& sInfo, bool bSearched, bool bAsResult) override;
+    void                OnFileResults(const std::vector<SearchFileResult>& results) override;
+    void                OnFileSkipped() override;
+    void                OnSearchEnd() override;
 
     bool                InitResultList();
     void                FillResultList();
     void                SetSearchModeUI(bool isTextMode);
     bool                AddFoundEntry(const CSearchInfo* pInfo, bool bOnlyListControl = false);
+    // counts a result the search reported, and lists it if it is one
+    void                AddSearchResult(const CSearchInfo& info, bool bAsResult);
+    // whether a result the search reported is listed
+    bool                IsListedResult(const CSearchInfo& info, bool bAsResult) const;
+    static bool         IsListedResult(const CSearchInfo& info, bool bAsResult, bool bListAll);
+    // the texts of the list as the dialog shows them now
+    ListTextState       CurrentListTextState() const;
+    // the text of a column of the file list, or of a line of info in the
+    // content list
+    static void         ListItemText(const CSearchInfo& info, const std::wstring& searchPath, const TIME_ZONE_INFORMATION& timeZone, bool fileList, int subIndex, int column, LPWSTR text, int textSize);
+    // adds the texts info shows in both lists to m_fileColumnWidths and
+    // m_lineColumnWidths. Called on the search threads too, everything
+    // the texts depend on comes from state.
+    void                MeasureResult(const CSearchInfo& info, const ListTextState& state);
+    void                RebuildListItems();
+    // sorts the rows of the list on another thread, the list shows the new
+    // order once SEARCH_SORTED arrives. While a search runs, the sort waits
+    // until it is done.
+    void                SortResults(ResultSortColumn column, bool bAscending);
+    // must be called before m_items or the rows are changed while a sort
+    // may run: waits until it is done, and shows the new order
+    void                FinishSorting();
+    // removes the results remove() returns true for, which is called once
+    // for every result in the order of m_items
+    void                RemoveItems(const std::function<bool(const CSearchInfo&)>& remove);
+    // filters the rows of the list with m_resultFilter on other threads.
+    // The rows are shown as each chunk of m_items is done.
+    void                StartFiltering();
+    // must be called before m_items is changed while a filter may run
+    void                StopFiltering();
+    void                FilterChunks(int generation);
+    void                ShowFilteredRows(std::unique_ptr<FilteredRows> rows);
+    size_t              ListRowCount(bool fileList) const { return fileList ? m_fileListItems.size() : m_listItems.size(); }
+    void                StartWatching();
+    void                StopWatching();
+    void                UpdateWatchedEntry(const WatchUpdate& update);
+    // goes back from a search within the results to the results before
+    void                ShowPreviousResults();
+    // shows the results saved in a results file instead of searching
+    void                LoadResults(const std::wstring& path);
+    // shows what changed from the results saved in a results file to the
+    // current results, which stay for ShowPreviousResults()
+    void                CompareResults(const std::wstring& path);
+    // asks for a results file to open, empty if none was chosen
+    std::wstring        AskForResultsFile();
+    // runs SearchThread(), with the stop button and the progress of a search
+    void                StartSearchThread();
+    // writes m_items to path on another thread, with the progress in the
+    // progress bar. bOpen: open the file once it is written.
+    void                StartExport(const std::wstring& path, ExportFunction exportFunction, bool bOpen);
+    // must be called before m_items is changed while an export may run:
+    // waits until it is done, or stops it first with bCancel
+    void                FinishExport(bool bCancel);
     void                ShowContextMenu(HWND hWnd, int x, int y);
     LRESULT             ColorizeMatchResultProc(LPNMLVCUSTOMDRAW lpLVCD);
     void                DoListNotify(LPNMITEMACTIVATE lpNMItemActivate);
@@ -122,8 +229,7 @@ protected:
     void                UpdateInfoLabel();
     bool                SaveSettings();
     void                SaveWndPosition();
-    static void         formatDate(wchar_t dateNative[], const FILETIME& fileTime, bool forceShortFmt);
-    bool                MatchPath(LPCTSTR pathBuf) const;
+    static void         formatDate(wchar_t dateNative[], const FILETIME& fileTime, const TIME_ZONE_INFORMATION& timeZone, bool forceShortFmt);
     void                AutoSizeAllColumns();
     int                 GetSelectedListIndex(int index);
     int                 GetSelectedListIndex(bool fileList, int index) const;
@@ -137,7 +243,7 @@ protected:
 private:
     HWND                              m_hParent;
     std::atomic_bool                  m_dwThreadRunning;
-    std::atomic_bool                  m_cancelled;
+    CCancellationToken                m_cancelled;
     bool                              m_bBlockUpdate;
 
     std::unique_ptr<CBookmarksDlg>    m_bookmarksDlg;
@@ -196,12 +302,76 @@ private:
     bool                              m_bConfirmationOnReplace;
     bool                              m_showContent;
     bool                              m_showContentSet;
+    // the results of the last search, for a refresh (F5)
+    std::shared_ptr<CSearchSnapshot>  m_snapshot;
+    bool                              m_bRefresh;
+    // the folder listings kept on disk between searches, and in memory
+    // while the dialog is open. Ctrl+F5 lists all folders again.
+    std::unique_ptr<CSearchCache>     m_dirCache;
+    std::set<std::wstring>            m_dirCacheRoots;
+    bool                              m_bFullWalk;
+    // watch mode: the files of the last search which change are searched
+    // again, and their results updated in place
+    bool                              m_bWatch;
+    std::optional<SearchOptions>      m_lastSearchOptions;
+    std::unique_ptr<CResultWatcher>   m_resultWatcher;
+    // updates of an earlier watch which arrive late are dropped
+    int                               m_watchGeneration;
+    // "search in found files" searches the files of the last results, which
+    // are kept here until the next search that is not within them
+    std::vector<ResultGeneration>     m_previousResults;
+    bool                              m_bRefine;
+    // the results file SearchThread() shows instead of searching
+    std::unique_ptr<CResultArchive>   m_savedResults;
+    // SearchThread() compares m_savedResults with the last previous results
+    bool                              m_bCompareResults;
+    std::thread                       m_exportThread;
+    CCancellationToken                m_exportCancelled;
+    std::wstring                      m_exportPath;
+    bool                              m_bOpenExport;
+    // progress of an earlier export which arrives late is dropped
+    int                               m_exportGeneration;
     std::vector<CSearchInfo>          m_items;
+    // the index in m_items of every result, in the order of the list:
+    // results added since the last sort are at the end
+    std::vector<int>                  m_itemOrder;
     std::vector<std::tuple<int, int>> m_listItems;
-    std::set<std::wstring>            m_backupAndTempFiles;
+    // the index in m_items of every row of the file list
+    std::vector<int>                  m_fileListItems;
+    // the sort thread reads m_items and the rows until it is done,
+    // and leaves the new order in m_sortedResults
+    std::thread                       m_sortThread;
+    std::unique_ptr<SortedResults>    m_sortedResults;
+    // SEARCH_SORTED of an earlier sort which arrives late is dropped
+    int                               m_sortGeneration;
+    // the column of a sort asked for while a search runs
+    std::optional<ResultSortColumn>   m_pendingSort;
+    // the widths of the texts of the columns of m_items, for
+    // AutoSizeAllColumns(). The search threads add the results they find
+    CColumnWidths                     m_fileColumnWidths;
+    CColumnWidths                     m_lineColumnWidths;
+    // taken by StartSearchThread(), the search threads only read it
+    ListTextState                     m_listTextState;
+    // the changes of the widths the columns were last sized for
+    uint64_t                          m_columnWidthChanges;
+
+    // the quick filter over the results, nullptr without one
+    std::unique_ptr<CResultFilter>                  m_resultFilter;
+    std::vector<std::thread>                        m_filterThreads;
+    std::atomic_bool                                m_filterCancelled;
+    std::atomic<size_t>                             m_filterNextChunk;
+    size_t                                          m_filterChunkCount;
+    // chunks are shown in order, the ones which arrive early wait here
+    size_t                                          m_filterShownChunks;
+    std::map<size_t, std::unique_ptr<FilteredRows>> m_filteredChunks;
+    // rows of an earlier filter which arrive late are dropped
+    int                                             m_filterGeneration;
+
     int                               m_totalItems;
     int                               m_searchedItems;
     int                               m_totalMatches;
+    // files whose search was stopped by SearchOptions::regexTimeout
+    int                               m_timedOutItems;
     int                               m_selectedItems;
     bool                              m_bAscending;
     std::wstring                      m_resultString;
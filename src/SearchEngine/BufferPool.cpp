@@ -0,0 +1,80 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "BufferPool.h"
+
+namespace
+{
+// a buffer bigger than this after a file is released instead of kept
+constexpr size_t maxKeptBytes = 4 * 1024 * 1024;
+
+template <typename T>
+void ClearBuffer(std::vector<T>& buffer)
+{
+    if (buffer.capacity() * sizeof(T) > maxKeptBytes)
+        std::vector<T>().swap(buffer);
+    else
+        buffer.clear();
+}
+} // namespace
+
+CBufferPool::CBufferPool()
+    : m_regexFlags(0)
+    , m_bRegexValid(false)
+{
+}
+
+CBufferPool& CBufferPool::ForThisThread()
+{
+    thread_local CBufferPool pool;
+    return pool;
+}
+
+void CBufferPool::Reset()
+{
+    ClearBuffer(m_readBuffer);
+    ClearBuffer(m_lineBuffer);
+}
+
+const boost::regex& CBufferPool::Regex(const std::string& expr, UINT flags)
+{
+    if (!m_bRegexValid || m_regexFlags != flags || m_regexExpr != expr)
+    {
+        // if compiling throws, the last expression must not be used for this one
+        m_bRegexValid = false;
+        m_regex.assign(expr, flags);
+        m_regexExpr   = expr;
+        m_regexFlags  = flags;
+        m_bRegexValid = true;
+    }
+    return m_regex;
+}
+
+CLinearRegex* CBufferPool::LinearRegex(const std::wstring& expr, bool bCaseSensitive, bool bDotMatchesNewline, bool bWide)
+{
+    LinearRegexEntry& entry = m_linearRegex[bWide ? 1 : 0];
+    int               flags = (bCaseSensitive ? 1 : 0) | (bDotMatchesNewline ? 2 : 0);
+    if (entry.flags != flags || entry.expr != expr)
+    {
+        entry.regex = CLinearRegex::Compile(expr, bCaseSensitive, bDotMatchesNewline, bWide);
+        entry.expr  = expr;
+        entry.flags = flags;
+    }
+    return entry.regex.get();
+}
@@ -0,0 +1,76 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+#include "LinearRegex.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/regex.hpp>
+
+// what the search of a single file needs besides its results, kept by each
+// worker thread and reused for the next file: the read buffer, the line
+// index, the match results and the compiled search expression. Searching many small files
+// then doesn't go to the heap for each of them.
+class CBufferPool
+{
+public:
+    // the pool of the calling thread
+    static CBufferPool&                ForThisThread();
+
+    // empties the buffers for the next file, but keeps their memory unless
+    // a big file made them grow beyond what is worth keeping
+    void                               Reset();
+
+    std::vector<char>&                 ReadBuffer() { return m_readBuffer; }
+    std::vector<size_t>&               LineBuffer() { return m_lineBuffer; }
+    // holds all files of a batch of small files, Reset() leaves it alone
+    std::vector<char>&                 BatchBuffer() { return m_batchBuffer; }
+    boost::match_results<const char*>& Matches() { return m_matches; }
+
+    // the expression compiled with flags, compiled again only if it is not
+    // the one of the last file. Throws like the boost::regex constructor.
+    const boost::regex&                Regex(const std::string& expr, UINT flags);
+    // the same for the linear time engine, which keeps the DFA states it
+    // built for the next file. nullptr if it does not support expr.
+    CLinearRegex*                      LinearRegex(const std::wstring& expr, bool bCaseSensitive, bool bDotMatchesNewline, bool bWide);
+
+private:
+    CBufferPool();
+
+    struct LinearRegexEntry
+    {
+        std::wstring                  expr;
+        int                           flags = -1;
+        std::unique_ptr<CLinearRegex> regex;
+    };
+
+    std::vector<char>                 m_readBuffer;
+    std::vector<size_t>               m_lineBuffer;
+    std::vector<char>                 m_batchBuffer;
+    boost::match_results<const char*> m_matches;
+    std::string                       m_regexExpr;
+    UINT                              m_regexFlags;
+    bool                              m_bRegexValid;
+    boost::regex                      m_regex;
+    // narrow and wide
+    LinearRegexEntry                  m_linearRegex[2];
+};
@@ -0,0 +1,86 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "CachedDirFileEnum.h"
+
+#include <iterator>
+
+CCachedDirFileEnum::CCachedDirFileEnum(CSearchCache& cache, const std::wstring& dirPath, bool bForceList)
+    : m_cache(cache)
+    , m_startPath(dirPath)
+    , m_findData{}
+    , m_attributesToIgnore(0)
+    , m_bForceList(bForceList)
+    , m_bStarted(false)
+    , m_bLastWasDirectory(false)
+{
+    // keep the separator of a root folder
+    while (m_startPath.size() > 1 && m_startPath.back() == PathSeparator && m_startPath[m_startPath.size() - 2] != L':')
+        m_startPath.pop_back();
+}
+
+void CCachedDirFileEnum::PushLevel(const std::wstring& path)
+{
+    auto listing = m_cache.GetListing(path, m_bForceList);
+    if (listing)
+        m_stack.push_back({std::move(listing), 0, path});
+}
+
+bool CCachedDirFileEnum::NextFile(std::wstring& result, bool* pbIsDirectory, bool bRecurse)
+{
+    if (!m_bStarted)
+    {
+        m_bStarted = true;
+        PushLevel(m_startPath);
+    }
+    else if (m_bLastWasDirectory && bRecurse)
+    {
+        PushLevel(m_lastPath);
+    }
+    m_bLastWasDirectory = false;
+
+    while (!m_stack.empty())
+    {
+        auto& level = m_stack.back();
+        if (level.index >= level.listing->entries.size())
+        {
+            m_stack.pop_back();
+            continue;
+        }
+        const auto& entry = level.listing->entries[level.index++];
+        if (entry.attributes & m_attributesToIgnore)
+            continue;
+
+        m_findData                  = {};
+        m_findData.dwFileAttributes = entry.attributes;
+        m_findData.ftLastWriteTime  = entry.lastWriteTime;
+        m_findData.nFileSizeHigh    = static_cast<DWORD>(entry.size >> 32);
+        m_findData.nFileSizeLow     = static_cast<DWORD>(entry.size & 0xFFFFFFFF);
+        wcscpy_s(m_findData.cFileName, std::size(m_findData.cFileName), entry.name.c_str());
+
+        bool bIsDir         = (entry.attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        m_bLastWasDirectory = bIsDir;
+        m_lastPath          = level.path.back() == PathSeparator ? level.path + entry.name : level.path + PathSeparator + entry.name;
+        result              = m_lastPath;
+        if (pbIsDirectory)
+            *pbIsDirectory = bIsDir;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,59 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+#include "SearchCache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// enumerates a directory tree like CDirFileEnum, but takes the listings
+// from a CSearchCache so unchanged directories are not read again.
+// With bForceList, every directory is read again and the cache updated.
+// Only for directories: the start path must not be a file.
+class CCachedDirFileEnum
+{
+public:
+    CCachedDirFileEnum(CSearchCache& cache, const std::wstring& dirPath, bool bForceList = false);
+
+    bool                   NextFile(std::wstring& result, bool* pbIsDirectory, bool bRecurse = true);
+    const WIN32_FIND_DATA* GetFileInfo() const { return &m_findData; }
+    void                   SetAttributesToIgnore(DWORD attributes) { m_attributesToIgnore = attributes; }
+
+private:
+    struct Level
+    {
+        std::shared_ptr<const CachedDirListing> listing;
+        size_t                                  index;
+        std::wstring                            path;
+    };
+
+    void               PushLevel(const std::wstring& path);
+
+    CSearchCache&      m_cache;
+    std::wstring       m_startPath;
+    std::vector<Level> m_stack;
+    WIN32_FIND_DATA    m_findData;
+    DWORD              m_attributesToIgnore;
+    bool               m_bForceList;
+    bool               m_bStarted;
+    bool               m_bLastWasDirectory;
+    std::wstring       m_lastPath;
+};
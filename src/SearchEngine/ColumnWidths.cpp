@@ -0,0 +1,80 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "ColumnWidths.h"
+
+#include <algorithm>
+
+CColumnWidths::CColumnWidths(size_t columnCount)
+    : m_columnCount(columnCount)
+    , m_columns(std::make_unique<Column[]>(columnCount))
+    , m_changes(0)
+    , m_measured(0)
+{
+    Reset();
+}
+
+void CColumnWidths::Add(size_t column, std::wstring_view text, ITextMeasurer& measurer)
+{
+    if (column >= m_columnCount || text.empty())
+        return;
+    auto&  col    = m_columns[column];
+    size_t length = std::min(text.size(), maxShownLength);
+    if (col.samples[length].load(std::memory_order_relaxed) >= samplesPerLength)
+        return;
+    if (col.samples[length].fetch_add(1, std::memory_order_relaxed) >= samplesPerLength)
+        return;
+    int width = measurer.TextWidth(text.substr(0, length));
+    ++m_measured;
+    int current = col.width.load(std::memory_order_relaxed);
+    while (width > current)
+    {
+        if (col.width.compare_exchange_weak(current, width, std::memory_order_relaxed))
+        {
+            ++m_changes;
+            break;
+        }
+    }
+}
+
+int CColumnWidths::Width(size_t column) const
+{
+    return column < m_columnCount ? m_columns[column].width.load(std::memory_order_relaxed) : 0;
+}
+
+std::vector<int> CColumnWidths::Widths() const
+{
+    std::vector<int> widths;
+    widths.reserve(m_columnCount);
+    for (size_t column = 0; column < m_columnCount; ++column)
+        widths.push_back(Width(column));
+    return widths;
+}
+
+void CColumnWidths::Reset(const std::vector<int>& widths)
+{
+    for (size_t column = 0; column < m_columnCount; ++column)
+    {
+        auto& col = m_columns[column];
+        col.width = column < widths.size() ? widths[column] : 0;
+        for (auto& samples : col.samples)
+            samples = 0;
+    }
+    ++m_changes;
+}
@@ -0,0 +1,84 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// measures how wide a text is drawn, in pixels: with the font of the result
+// list in the dialog, or anything else where there is no window
+class ITextMeasurer
+{
+public:
+    virtual ~ITextMeasurer() = default;
+
+    virtual int TextWidth(std::wstring_view text) = 0;
+};
+
+// the widths the texts of the columns of the result list need, kept up to
+// date while the results arrive, so the columns can be sized without
+// measuring the texts of all rows again.
+// Measuring is what takes the time, so only the first few texts of each
+// length are measured. Any other text of a length is taken to be no wider
+// than the column already is, which is close enough for all but the most
+// uneven fonts. Texts longer than the list shows count as the length it shows.
+// Add() can be called from several threads at the same time, each with
+// its own measurer: the search threads of the dialog each measure the
+// results they find.
+class CColumnWidths
+{
+public:
+    explicit CColumnWidths(size_t columnCount);
+
+    void                  Add(size_t column, std::wstring_view text, ITextMeasurer& measurer);
+    // the width of the widest text of the column, 0 if it has none
+    int                   Width(size_t column) const;
+    std::vector<int>      Widths() const;
+    size_t                ColumnCount() const { return m_columnCount; }
+    // goes up whenever a column gets wider, to find out if the list has to be sized again
+    uint64_t              Changes() const { return m_changes; }
+    // how many texts were measured, of all the texts added
+    uint64_t              Measured() const { return m_measured; }
+
+    // starts over with the widths, for results measured before.
+    // Not while Add() runs on other threads.
+    void                  Reset(const std::vector<int>& widths = {});
+
+private:
+    // the list control only shows the first 259 characters of a text
+    static constexpr size_t maxShownLength   = 259;
+    // how many texts of each length are measured
+    static constexpr int    samplesPerLength = 4;
+
+    struct Column
+    {
+        std::atomic<int>      width;
+        // how many texts of each length were measured
+        std::atomic<uint32_t> samples[maxShownLength + 1];
+    };
+
+    size_t                    m_columnCount;
+    std::unique_ptr<Column[]> m_columns;
+    std::atomic<uint64_t>     m_changes;
+    std::atomic<uint64_t>     m_measured;
+};
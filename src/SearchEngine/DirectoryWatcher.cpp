@@ -0,0 +1,380 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "DirectoryWatcher.h"
+#include "UnicodeUtils.h"
+
+#include <algorithm>
+
+#ifndef _WIN32
+#    include <cerrno>
+#    include <fcntl.h>
+#    include <poll.h>
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#    include "DirFileEnum.h"
+#endif
+
+namespace
+{
+// changes which keep coming are reported at least that often
+constexpr int maxDebounceFactor = 5;
+
+#ifdef _WIN32
+constexpr DWORD changeBufferSize = 64 * 1024;
+constexpr DWORD notifyFilter     = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+#else
+constexpr uint32_t watchMask = IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+#endif
+} // namespace
+
+CDirectoryWatcher::CDirectoryWatcher(ChangeCallback callback, std::chrono::milliseconds debounce)
+    : m_callback(std::move(callback))
+    , m_debounce(debounce)
+    , m_bRecursive(false)
+#ifdef _WIN32
+    , m_hStopEvent(nullptr)
+#else
+    , m_inotifyFd(-1)
+    , m_stopPipe{-1, -1}
+#endif
+{
+}
+
+CDirectoryWatcher::~CDirectoryWatcher()
+{
+    Stop();
+}
+
+bool CDirectoryWatcher::Start(const std::vector<std::wstring>& searchPaths, bool bRecursive)
+{
+    Stop();
+    m_bRecursive = bRecursive;
+    m_pending.clear();
+
+    // files are watched through their folder, which is watched only once
+    std::set<std::wstring> dirPaths;
+    std::set<std::wstring> recursiveDirPaths;
+    for (const auto& searchPath : searchPaths)
+    {
+        if (searchPath.empty())
+            continue;
+        if (PathIsDirectory(searchPath.c_str()))
+            recursiveDirPaths.insert(searchPath);
+        else
+            dirPaths.insert(searchPath.substr(0, searchPath.find_last_of(PathSeparator)));
+    }
+
+#ifdef _WIN32
+    m_hStopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    if (m_hStopEvent == nullptr)
+        return false;
+    auto addDir = [&](const std::wstring& dirPath, bool bSubtree) {
+        // one wait handle is the stop event
+        if (m_dirs.size() + 1 >= MAXIMUM_WAIT_OBJECTS)
+            return;
+        auto dir  = std::make_unique<WatchedDir>();
+        dir->path = dirPath;
+        dir->hDir = CreateFile(dirPath.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                               nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        if (dir->hDir == INVALID_HANDLE_VALUE)
+            return;
+        dir->overlapped        = {};
+        dir->overlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        dir->buffer.resize(changeBufferSize);
+        dir->bSubtree = bSubtree;
+        if (dir->overlapped.hEvent == nullptr || !ReadChanges(*dir))
+        {
+            if (dir->overlapped.hEvent)
+                CloseHandle(dir->overlapped.hEvent);
+            CloseHandle(dir->hDir);
+            return;
+        }
+        m_dirs.push_back(std::move(dir));
+    };
+    for (const auto& dirPath : recursiveDirPaths)
+        addDir(dirPath, bRecursive);
+    for (const auto& dirPath : dirPaths)
+    {
+        if (!recursiveDirPaths.contains(dirPath))
+            addDir(dirPath, false);
+    }
+    if (m_dirs.empty())
+    {
+        Stop();
+        return false;
+    }
+#else
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0 || pipe2(m_stopPipe, O_CLOEXEC) != 0)
+    {
+        Stop();
+        return false;
+    }
+    for (const auto& dirPath : recursiveDirPaths)
+    {
+        if (bRecursive)
+            AddWatches(dirPath);
+        else
+            AddWatch(dirPath);
+    }
+    for (const auto& dirPath : dirPaths)
+        AddWatch(dirPath);
+    if (m_watches.empty())
+    {
+        Stop();
+        return false;
+    }
+#endif
+    m_thread = std::thread(&CDirectoryWatcher::WatchThread, this);
+    return true;
+}
+
+void CDirectoryWatcher::Stop()
+{
+#ifdef _WIN32
+    if (m_hStopEvent)
+        SetEvent(m_hStopEvent);
+#else
+    if (m_stopPipe[1] >= 0)
+    {
+        char stop = 0;
+        while (write(m_stopPipe[1], &stop, 1) < 0 && errno == EINTR)
+        {
+        }
+    }
+#endif
+    if (m_thread.joinable())
+        m_thread.join();
+
+#ifdef _WIN32
+    for (auto& dir : m_dirs)
+    {
+        CancelIo(dir->hDir);
+        CloseHandle(dir->hDir);
+        CloseHandle(dir->overlapped.hEvent);
+    }
+    m_dirs.clear();
+    if (m_hStopEvent)
+        CloseHandle(m_hStopEvent);
+    m_hStopEvent = nullptr;
+#else
+    // closing the inotify descriptor removes all of its watches
+    if (m_inotifyFd >= 0)
+        close(m_inotifyFd);
+    m_inotifyFd = -1;
+    m_watches.clear();
+    for (int& fd : m_stopPipe)
+    {
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+void CDirectoryWatcher::AddChange(const std::wstring& path)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (m_pending.empty())
+        m_firstChange = now;
+    m_lastChange = now;
+    m_pending.insert(path);
+}
+
+int CDirectoryWatcher::MillisecondsUntilDue() const
+{
+    if (m_pending.empty())
+        return -1;
+    auto due = std::min(m_lastChange + m_debounce, m_firstChange + maxDebounceFactor * m_debounce);
+    auto ms  = std::chrono::duration_cast<std::chrono::milliseconds>(due - std::chrono::steady_clock::now()).count();
+    return static_cast<int>(std::max<long long>(ms, 0));
+}
+
+void CDirectoryWatcher::ReportChanges()
+{
+    // a folder which is reported anyway covers everything below it
+    std::vector<std::wstring> paths;
+    for (const auto& path : m_pending)
+    {
+        bool bCovered = false;
+        for (auto pos = path.find_last_of(PathSeparator); pos != std::wstring::npos && pos > 0 && !bCovered; pos = path.find_last_of(PathSeparator, pos - 1))
+            bCovered = m_pending.contains(path.substr(0, pos));
+        if (!bCovered)
+            paths.push_back(path);
+    }
+    m_pending.clear();
+    m_callback(paths);
+}
+
+#ifdef _WIN32
+bool CDirectoryWatcher::ReadChanges(WatchedDir& dir) const
+{
+    return ReadDirectoryChangesW(dir.hDir, dir.buffer.data(), static_cast<DWORD>(dir.buffer.size()), dir.bSubtree,
+                                 notifyFilter, nullptr, &dir.overlapped, nullptr) != FALSE;
+}
+
+void CDirectoryWatcher::WatchThread()
+{
+    std::vector<HANDLE> handles;
+    handles.push_back(m_hStopEvent);
+    for (const auto& dir : m_dirs)
+        handles.push_back(dir->overlapped.hEvent);
+
+    for (;;)
+    {
+        int   timeout = MillisecondsUntilDue();
+        DWORD result  = WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(), FALSE, timeout < 0 ? INFINITE : static_cast<DWORD>(timeout));
+        if (result == WAIT_OBJECT_0 || result == WAIT_FAILED)
+            break;
+        if (result == WAIT_TIMEOUT)
+        {
+            ReportChanges();
+            continue;
+        }
+        auto& dir   = *m_dirs[result - WAIT_OBJECT_0 - 1];
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(dir.hDir, &dir.overlapped, &bytes, FALSE) || bytes == 0)
+        {
+            // the buffer overflowed: everything below may have changed
+            AddChange(dir.path);
+        }
+        else
+        {
+            const BYTE* pData = dir.buffer.data();
+            for (;;)
+            {
+                const auto*  pInfo = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(pData);
+                std::wstring name(pInfo->FileName, pInfo->FileNameLength / sizeof(wchar_t));
+                AddChange(dir.path + PathSeparator + name);
+                if (pInfo->NextEntryOffset == 0)
+                    break;
+                pData += pInfo->NextEntryOffset;
+            }
+        }
+        if (!ReadChanges(dir))
+            AddChange(dir.path);
+    }
+}
+#else
+bool CDirectoryWatcher::AddWatch(const std::wstring& dirPath)
+{
+    int wd = inotify_add_watch(m_inotifyFd, PlatformPath(dirPath).c_str(), watchMask);
+    if (wd < 0)
+        return false;
+    m_watches[wd] = dirPath;
+    return true;
+}
+
+void CDirectoryWatcher::AddWatches(const std::wstring& dirPath)
+{
+    if (!AddWatch(dirPath))
+        return;
+    // symbolic links to folders are not followed, like the search does
+    // by default
+    CDirFileEnum fileEnumerator(dirPath.c_str());
+    fileEnumerator.SetAttributesToIgnore(FILE_ATTRIBUTE_REPARSE_POINT);
+    bool         bIsDirectory = false;
+    std::wstring sPath;
+    while (fileEnumerator.NextFile(sPath, &bIsDirectory, false))
+    {
+        if (bIsDirectory)
+            AddWatches(sPath);
+    }
+}
+
+void CDirectoryWatcher::RemoveWatches(const std::wstring& dirPath)
+{
+    // a folder which was moved away is still watched, under its old path
+    std::erase_if(m_watches, [&](const auto& watch) {
+        const auto& path = watch.second;
+        if (!path.starts_with(dirPath) || (path.size() > dirPath.size() && path[dirPath.size()] != PathSeparator))
+            return false;
+        inotify_rm_watch(m_inotifyFd, watch.first);
+        return true;
+    });
+}
+
+void CDirectoryWatcher::ReadEvents()
+{
+    alignas(inotify_event) char buffer[64 * 1024];
+    for (;;)
+    {
+        ssize_t length = read(m_inotifyFd, buffer, sizeof(buffer));
+        if (length < 0 && errno == EINTR)
+            continue;
+        if (length <= 0)
+            break;
+        for (const char* pData = buffer; pData < buffer + length;)
+        {
+            const auto* pEvent = reinterpret_cast<const inotify_event*>(pData);
+            pData += sizeof(inotify_event) + pEvent->len;
+
+            if (pEvent->mask & IN_Q_OVERFLOW)
+            {
+                // events were dropped: everything may have changed
+                for (const auto& [wd, path] : m_watches)
+                    AddChange(path);
+                continue;
+            }
+            auto it = m_watches.find(pEvent->wd);
+            if (it == m_watches.end())
+                continue;
+            if (pEvent->mask & IN_IGNORED)
+            {
+                // the folder is gone, its parent reports that
+                m_watches.erase(it);
+                continue;
+            }
+            if (pEvent->len == 0)
+                continue;
+            std::wstring path = it->second + PathSeparator + CUnicodeUtils::StdGetUnicode(pEvent->name);
+            if ((pEvent->mask & IN_ISDIR) && (pEvent->mask & IN_MOVED_FROM))
+                RemoveWatches(path);
+            if ((pEvent->mask & IN_ISDIR) && (pEvent->mask & (IN_CREATE | IN_MOVED_TO)) && m_bRecursive)
+                AddWatches(path);
+            AddChange(path);
+        }
+    }
+}
+
+void CDirectoryWatcher::WatchThread()
+{
+    for (;;)
+    {
+        pollfd fds[2] = {};
+        fds[0].fd     = m_stopPipe[0];
+        fds[0].events = POLLIN;
+        fds[1].fd     = m_inotifyFd;
+        fds[1].events = POLLIN;
+        int result    = poll(fds, 2, MillisecondsUntilDue());
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result < 0 || fds[0].revents)
+            break;
+        if (result == 0)
+        {
+            ReportChanges();
+            continue;
+        }
+        if (fds[1].revents & POLLIN)
+            ReadEvents();
+    }
+}
+#endif
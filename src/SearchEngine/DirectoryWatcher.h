@@ -0,0 +1,97 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// reports the files and folders which changed below a set of search paths:
+// ReadDirectoryChangesW on Windows, inotify on Linux.
+//
+// Changes are collected until nothing changed for the debounce delay (but
+// at most for a few of them while changes keep coming), then the callback
+// gets every touched path once. A path can be a file or a folder and may not
+// exist anymore. If the system dropped events, the watched path itself is
+// reported. The callback runs on the thread of the watcher.
+class CDirectoryWatcher
+{
+public:
+    using ChangeCallback = std::function<void(const std::vector<std::wstring>& paths)>;
+
+    explicit CDirectoryWatcher(ChangeCallback callback, std::chrono::milliseconds debounce = std::chrono::milliseconds(300));
+    ~CDirectoryWatcher();
+
+    CDirectoryWatcher(const CDirectoryWatcher&)            = delete;
+    CDirectoryWatcher& operator=(const CDirectoryWatcher&) = delete;
+
+    // starts watching the search paths: folders with bRecursive also all
+    // folders below them, files through their parent folder.
+    // Returns false if nothing could be watched.
+    bool               Start(const std::vector<std::wstring>& searchPaths, bool bRecursive);
+    // blocks until the callback returned, if it is running.
+    // Must not be called from the callback.
+    void               Stop();
+
+private:
+    void               WatchThread();
+    void               AddChange(const std::wstring& path);
+    // the time until the pending changes are due, or -1 without any
+    int                MillisecondsUntilDue() const;
+    void               ReportChanges();
+
+    ChangeCallback                        m_callback;
+    std::chrono::milliseconds             m_debounce;
+    bool                                  m_bRecursive;
+    std::thread                           m_thread;
+
+    std::set<std::wstring>                m_pending;
+    std::chrono::steady_clock::time_point m_firstChange;
+    std::chrono::steady_clock::time_point m_lastChange;
+
+#ifdef _WIN32
+    struct WatchedDir
+    {
+        std::wstring      path;
+        bool              bSubtree;
+        HANDLE            hDir;
+        OVERLAPPED        overlapped;
+        std::vector<BYTE> buffer;
+    };
+    bool               ReadChanges(WatchedDir& dir) const;
+
+    std::vector<std::unique_ptr<WatchedDir>> m_dirs;
+    HANDLE                                   m_hStopEvent;
+#else
+    bool               AddWatch(const std::wstring& dirPath);
+    void               AddWatches(const std::wstring& dirPath);
+    void               RemoveWatches(const std::wstring& dirPath);
+    void               ReadEvents();
+
+    int                                      m_inotifyFd;
+    int                                      m_stopPipe[2];
+    std::map<int, std::wstring>              m_watches;
+#endif
+};
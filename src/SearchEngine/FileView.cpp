@@ -0,0 +1,99 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "FileView.h"
+#include "BufferPool.h"
+
+#include <fstream>
+
+namespace
+{
+// below that, copying the few pages of a file is cheaper than mapping it
+constexpr size_t maxReadSize = 256 * 1024;
+
+// appends the fileSize bytes of the opened file to buffer
+bool AppendFile(std::ifstream& file, std::streamoff fileSize, std::vector<char>& buffer)
+{
+    size_t offset = buffer.size();
+    buffer.resize(offset + static_cast<size_t>(fileSize));
+    file.seekg(0);
+    if (fileSize > 0 && !file.read(buffer.data() + offset, fileSize))
+    {
+        buffer.resize(offset);
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+bool CFileView::Open(const std::wstring& path)
+{
+    m_data = nullptr;
+    m_size = 0;
+    if (m_mappedFile.is_open())
+        m_mappedFile.close();
+
+    // the data goes straight to the pool's buffer, the stream needs none of its own
+    std::ifstream file;
+    file.rdbuf()->pubsetbuf(nullptr, 0);
+    file.open(PlatformPath(path), std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+    auto fileSize = static_cast<std::streamoff>(file.tellg());
+    if (fileSize < 0)
+        return false;
+    if (static_cast<size_t>(fileSize) > maxReadSize)
+    {
+        file.close();
+        try
+        {
+            m_mappedFile.open(PlatformPath(path));
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+        if (!m_mappedFile.is_open())
+            return false;
+        m_data = m_mappedFile.data();
+        m_size = m_mappedFile.size();
+        return true;
+    }
+
+    std::vector<char>& readBuffer = CBufferPool::ForThisThread().ReadBuffer();
+    readBuffer.clear();
+    if (!AppendFile(file, fileSize, readBuffer))
+        return false;
+    m_data = readBuffer.data();
+    m_size = readBuffer.size();
+    return true;
+}
+
+bool CFileView::ReadAll(const std::wstring& path, std::vector<char>& buffer)
+{
+    std::ifstream file;
+    file.rdbuf()->pubsetbuf(nullptr, 0);
+    file.open(PlatformPath(path), std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+    auto fileSize = static_cast<std::streamoff>(file.tellg());
+    if (fileSize < 0)
+        return false;
+    return AppendFile(file, fileSize, buffer);
+}
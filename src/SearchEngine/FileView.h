@@ -0,0 +1,52 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+
+#include <string>
+#include <vector>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+// the contents of a file, without any conversion: small files are read into
+// the read buffer of the thread's CBufferPool, bigger ones are mapped.
+// The data of a read file stays valid until the same thread opens the next
+// file, so a thread must only use one CFileView at a time.
+class CFileView
+{
+public:
+    CFileView()                            = default;
+    CFileView(const CFileView&)            = delete;
+    CFileView& operator=(const CFileView&) = delete;
+
+    // false if the file can't be read
+    bool        Open(const std::wstring& path);
+
+    // appends the whole file to buffer, without mapping it.
+    // False if the file can't be read, buffer is unchanged then.
+    static bool ReadAll(const std::wstring& path, std::vector<char>& buffer);
+
+    const char* Data() const { return m_data; }
+    size_t      Size() const { return m_size; }
+
+private:
+    boost::iostreams::mapped_file_source m_mappedFile;
+    const char*                          m_data = nullptr;
+    size_t                               m_size = 0;
+};
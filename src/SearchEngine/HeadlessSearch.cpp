@@ -0,0 +1,925 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "HeadlessSearch.h"
+#include "CancellationToken.h"
+#include "DirectoryWatcher.h"
+#include "MultiPatternMatcher.h"
+#include "ResultDiff.h"
+#include "ResultExport.h"
+#include "SearchCache.h"
+#include "SearchEngine.h"
+#include "SearchInfo.h"
+#include "SearchServer.h"
+#include "SearchSnapshot.h"
+#include "StringUtils.h"
+#include "UnicodeUtils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cwctype>
+#include <filesystem>
+#include <memory>
+#include <set>
+#include <system_error>
+#include <thread>
+
+#include <boost/regex.hpp>
+
+namespace
+{
+// the switches of grepWin.exe which configure a search
+const std::set<std::wstring> searchSwitches = {
+    L"searchpath", L"searchfor", L"replacewith", L"filemask", L"filemaskregex", L"filemaskexclude",
+    L"direxcluderegex", L"regex", L"i", L"n", L"k", L"keepfiledate", L"wholewords", L"utf8", L"binary",
+    L"size", L"sizecmp", L"s", L"h", L"u", L"l", L"b", L"datelimit", L"date1", L"date2",
+    L"execute", L"executesearch", L"executereplace", L"executecapture", L"content",
+    // without a dialog these have nothing to do, but are accepted so the
+    // same command line works with and without /headless
+    L"headless", L"closedialog", L"nosavesettings", L"new", L"portable", L"inipath",
+    // only for the headless mode
+    L"format", L"threads", L"refresh", L"watch", L"dircache", L"fullwalk", L"server", L"useserver", L"stopserver",
+    L"endpoint", L"patternfile", L"regexengine", L"regextimeout",
+    L"listonly", L"maxcount", L"maxresults", L"output", L"save", L"load", L"diff", L"context"};
+
+// switches which need the settings or the bookmarks of the application
+const std::set<std::wstring> dialogOnlySwitches = {L"preset", L"searchini"};
+
+std::wstring AbsolutePath(const std::wstring& path, const std::wstring& baseDir)
+{
+    std::error_code       ec;
+    std::filesystem::path fsPath(PlatformPath(path));
+    if (!baseDir.empty() && fsPath.is_relative())
+        fsPath = std::filesystem::path(PlatformPath(baseDir)) / fsPath;
+    auto absPath = std::filesystem::absolute(fsPath, ec).lexically_normal();
+    if (ec)
+        return path;
+#ifdef _WIN32
+    std::wstring result = absPath.wstring();
+#else
+    std::wstring result = CUnicodeUtils::StdGetUnicode(absPath.string());
+#endif
+    // the engine expects folders without a trailing separator,
+    // except for a root folder
+    while (result.size() > 1 && result.back() == PathSeparator && result[result.size() - 2] != L':')
+        result.pop_back();
+    return result;
+}
+
+// parses a date in the format the dialog uses on the command line: yyyy:mm:dd
+bool ParseDate(const std::wstring& str, FILETIME& fileTime)
+{
+    std::vector<std::wstring> parts;
+    stringtok(parts, str, false, L":");
+    if (parts.size() != 3)
+        return false;
+    const int year  = _wtoi(parts[0].c_str());
+    const int month = _wtoi(parts[1].c_str());
+    const int day   = _wtoi(parts[2].c_str());
+    const std::chrono::year_month_day date{std::chrono::year{year}, std::chrono::month{static_cast<unsigned>(month)}, std::chrono::day{static_cast<unsigned>(day)}};
+    if (!date.ok())
+        return false;
+    // FILETIME counts 100ns intervals since 1601-01-01
+    constexpr int64_t secondsFrom1601To1970 = 11644473600LL;
+    const int64_t     days                  = std::chrono::sys_days{date}.time_since_epoch().count();
+    const uint64_t    ticks                 = static_cast<uint64_t>(days * 86400LL + secondsFrom1601To1970) * 10000000ULL;
+    fileTime.dwLowDateTime                  = static_cast<DWORD>(ticks & 0xFFFFFFFF);
+    fileTime.dwHighDateTime                 = static_cast<DWORD>(ticks >> 32);
+    return true;
+}
+
+bool IsRegexValid(std::wstring searchString)
+{
+    // the file path variables are replaced per file
+    for (const auto& s : {L"${filepath}", L"${filename}", L"${fileext}"})
+        SearchReplace(searchString, s, L"");
+    try
+    {
+        boost::wregex expression = boost::wregex(searchString);
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+    return true;
+}
+
+// a matched line on a single output line
+std::string ToSingleLine(const std::wstring& line)
+{
+    std::string text = CUnicodeUtils::StdGetUTF8(line);
+    std::ranges::replace_if(text, [](char c) { return c == '\r' || c == '\n'; }, ' ');
+    while (!text.empty() && text.back() == ' ')
+        text.pop_back();
+    return text;
+}
+
+// what the text format writes in front of a changed line, see /diff
+const char* ChangePrefix(MatchChange change)
+{
+    switch (change)
+    {
+        case MatchChange::Added:
+            return "+ ";
+        case MatchChange::Removed:
+            return "- ";
+        case MatchChange::Moved:
+            return "~ ";
+    }
+    return "";
+}
+
+// /output: the results go to the file, the errors where they go without it
+class CExportFileOutput : public IHeadlessOutput
+{
+public:
+    CExportFileOutput(CExportFile& file, IHeadlessOutput& errorOutput)
+        : m_file(file)
+        , m_errorOutput(errorOutput)
+    {
+    }
+
+    void WriteOut(const std::string& text) override { m_file.Write(text); }
+    void WriteErr(const std::string& text) override { m_errorOutput.WriteErr(text); }
+
+private:
+    CExportFile&     m_file;
+    IHeadlessOutput& m_errorOutput;
+};
+} // namespace
+
+CFileHeadlessOutput::CFileHeadlessOutput(FILE* out, FILE* err)
+    : m_out(out)
+    , m_err(err)
+{
+}
+
+void CFileHeadlessOutput::WriteOut(const std::string& text)
+{
+    fwrite(text.data(), 1, text.size(), m_out);
+    // a consumer reading a pipe gets each file as soon as it is done
+    fflush(m_out);
+}
+
+void CFileHeadlessOutput::WriteErr(const std::string& text)
+{
+    fwrite(text.data(), 1, text.size(), m_err);
+    fflush(m_err);
+}
+
+CStreamResultSink::CStreamResultSink(IHeadlessOutput& output, HeadlessFormat format, bool bShowContent)
+    : m_output(output)
+    , m_format(format)
+    , m_bShowContent(bShowContent)
+    , m_bReportRemoved(false)
+    , m_exporter(format == HeadlessFormat::Binary ? ExportFormat::Binary : ExportFormat::Csv)
+    , m_archive(nullptr)
+    , m_bDiff(false)
+{
+}
+
+void CStreamResultSink::SetDiffBase(std::vector<CSearchInfo> before)
+{
+    m_diffBefore = std::move(before);
+    m_bDiff      = true;
+}
+
+void CStreamResultSink::OnSearchStart()
+{
+    if (m_format != HeadlessFormat::Csv && m_format != HeadlessFormat::Binary)
+        return;
+    std::string text;
+    m_exporter.AppendBegin(text);
+    std::lock_guard lock(m_writeMutex);
+    m_output.WriteOut(text);
+}
+
+void CStreamResultSink::OnFileResult(const CSearchInfo& sInfo, bool bSearched, bool bAsResult)
+{
+    if (bSearched)
+        ++m_filesSearched;
+    else
+        ++m_filesSkipped;
+
+    // the same results the dialog lists
+    if ((m_archive || m_bDiff) && (bAsResult || sInfo.readError || !sInfo.exception.empty()))
+    {
+        std::lock_guard lock(m_writeMutex);
+        if (m_archive)
+            m_archive->Add(sInfo);
+        if (m_bDiff)
+            m_diffAfter.push_back(sInfo);
+    }
+
+    std::string text;
+    if (sInfo.readError || !sInfo.exception.empty())
+    {
+        ++m_errors;
+        if (sInfo.timedOut)
+            ++m_timeouts;
+        if (m_format == HeadlessFormat::Json)
+        {
+            text = "{\"type\":\"error\",\"path\":";
+            AppendJsonString(text, sInfo.filePath);
+            if (sInfo.timedOut)
+                text += ",\"reason\":\"timeout\"";
+            text += ",\"message\":";
+            AppendJsonString(text, sInfo.readError ? L"the file could not be read" : sInfo.exception);
+            text += "}\n";
+            std::lock_guard lock(m_writeMutex);
+            m_output.WriteOut(text);
+        }
+        else
+        {
+            text = "grepWin: " + CUnicodeUtils::StdGetUTF8(sInfo.filePath) + ": ";
+            text += sInfo.readError ? "the file could not be read" : CUnicodeUtils::StdGetUTF8(sInfo.exception);
+            text += '\n';
+            std::lock_guard lock(m_writeMutex);
+            m_output.WriteErr(text);
+        }
+        // the matches found before the time ran out are reported as well
+        if (!sInfo.timedOut || sInfo.matchCount <= 0)
+            return;
+    }
+    if (!bAsResult)
+    {
+        if (m_bReportRemoved)
+            WriteRemoved(sInfo.filePath);
+        return;
+    }
+    // with /diff, the results are only written once they are compared
+    if (!m_bDiff)
+        WriteResult(sInfo);
+}
+
+void CStreamResultSink::WriteResult(const CSearchInfo& sInfo)
+{
+    ++m_filesMatched;
+    m_matches += static_cast<uint64_t>(std::max<__int64>(sInfo.matchCount, 0));
+    // format outside the lock, so the workers only wait for the actual write
+    std::string text;
+    if (m_format == HeadlessFormat::Json)
+        AppendJsonResult(text, sInfo, m_patterns);
+    else if (m_format == HeadlessFormat::Text)
+        FormatText(sInfo, text);
+    else
+        m_exporter.Append(sInfo, text);
+    std::lock_guard lock(m_writeMutex);
+    m_output.WriteOut(text);
+}
+
+void CStreamResultSink::OnFileSkipped()
+{
+    ++m_filesSkipped;
+}
+
+void CStreamResultSink::OnSearchEnd()
+{
+    if (m_bDiff)
+    {
+        CResultDiff diff;
+        diff.Compare(m_diffBefore, m_diffAfter, CCancellationToken());
+        for (const auto& change : diff.Changes())
+            WriteResult(change);
+        m_added   = diff.Added();
+        m_removed = diff.Removed();
+        m_moved   = diff.Moved();
+    }
+    if (m_format != HeadlessFormat::Json)
+        return;
+    std::string text = "{\"type\":\"summary\"";
+    text += ",\"searched\":" + std::to_string(m_filesSearched.load());
+    text += ",\"matched\":" + std::to_string(m_filesMatched.load());
+    text += ",\"skipped\":" + std::to_string(m_filesSkipped.load());
+    text += ",\"matches\":" + std::to_string(m_matches.load());
+    text += ",\"errors\":" + std::to_string(m_errors.load());
+    text += ",\"timeouts\":" + std::to_string(m_timeouts.load());
+    if (m_bDiff)
+    {
+        text += ",\"added\":" + std::to_string(m_added);
+        text += ",\"removed\":" + std::to_string(m_removed);
+        text += ",\"moved\":" + std::to_string(m_moved);
+    }
+    text += "}\n";
+    std::lock_guard lock(m_writeMutex);
+    m_output.WriteOut(text);
+}
+
+void CStreamResultSink::OnFileRemoved(const std::wstring& path)
+{
+    if (m_bReportRemoved)
+        WriteRemoved(path);
+}
+
+void CStreamResultSink::WriteRemoved(const std::wstring& path)
+{
+    if (m_format != HeadlessFormat::Json)
+        return;
+    std::string text = "{\"type\":\"removed\",\"path\":";
+    AppendJsonString(text, path);
+    text += "}\n";
+    std::lock_guard lock(m_writeMutex);
+    m_output.WriteOut(text);
+}
+
+void CStreamResultSink::FormatText(const CSearchInfo& sInfo, std::string& text) const
+{
+    const std::string path = CUnicodeUtils::StdGetUTF8(sInfo.filePath);
+    if (!m_bShowContent || sInfo.matchLines.empty())
+    {
+        // with /diff, a file whose lines changed in different ways is '*'
+        if (!sInfo.matchChanges.empty())
+        {
+            bool bSame = std::ranges::all_of(sInfo.matchChanges, [&](MatchChange change) { return change == sInfo.matchChanges.front(); });
+            text       = bSame ? ChangePrefix(sInfo.matchChanges.front()) : "* ";
+        }
+        text += path + '\n';
+        return;
+    }
+    auto appendMatch = [&](size_t i) {
+        if (i < sInfo.matchChanges.size())
+            text += ChangePrefix(sInfo.matchChanges[i]);
+        text += path;
+        if (i < sInfo.matchLinesNumbers.size())
+            text += ':' + std::to_string(sInfo.matchLinesNumbers[i]);
+        text += ':';
+        text += ToSingleLine(sInfo.matchLines[i]);
+        text += '\n';
+    };
+    if (sInfo.contextRanges.empty())
+    {
+        for (size_t i = 0; i < sInfo.matchLines.size(); ++i)
+            appendMatch(i);
+        return;
+    }
+    // like grep: "path-line-text" for the context lines, and "--" between
+    // the lines which do not follow each other
+    auto appendContext = [&](DWORD line, std::wstring_view lineText) {
+        text += path + '-' + std::to_string(line) + '-';
+        text += ToSingleLine(std::wstring(lineText));
+        text += '\n';
+    };
+    ForEachResultLine(sInfo, appendMatch, appendContext, [&]() { text += "--\n"; });
+}
+
+CHeadlessSearch::CHeadlessSearch()
+    : m_format(HeadlessFormat::Text)
+    , m_bShowContent(false)
+{
+}
+
+bool CHeadlessSearch::SplitSwitch(const std::wstring& arg, std::wstring& key, std::wstring& value)
+{
+    size_t prefix = 0;
+    if (arg.starts_with(L"--"))
+        prefix = 2;
+    else if (!arg.empty() && (arg[0] == L'/' || arg[0] == L'-'))
+        prefix = 1;
+    if (prefix == 0)
+        return false;
+    auto sep = arg.find_first_of(L":=", prefix);
+    key      = arg.substr(prefix, sep == std::wstring::npos ? std::wstring::npos : sep - prefix);
+    value    = sep == std::wstring::npos ? std::wstring() : arg.substr(sep + 1);
+    std::ranges::transform(key, key.begin(), ::towlower);
+    return true;
+}
+
+bool CHeadlessSearch::Parse(const std::vector<std::wstring>& args, std::wstring& error, const std::wstring& baseDir)
+{
+    for (const auto& arg : args)
+    {
+        std::wstring key;
+        std::wstring value;
+        if (SplitSwitch(arg, key, value))
+        {
+            if (searchSwitches.contains(key))
+            {
+                m_switches[key] = value;
+                continue;
+            }
+            if (dialogOnlySwitches.contains(key))
+            {
+                error = L"/" + key + L" is not supported without the dialog";
+                return false;
+            }
+            // on platforms where paths start with a '/', an unknown switch is a path
+            if (arg[0] != PathSeparator)
+            {
+                error = L"unknown switch: " + arg;
+                return false;
+            }
+        }
+        m_paths.push_back(arg);
+    }
+
+    if (HasVal(L"searchpath"))
+        stringtok(m_paths, GetVal(L"searchpath"), true);
+    if (m_paths.empty())
+        m_paths.push_back(L".");
+    for (const auto& path : m_paths)
+    {
+        auto absPath = AbsolutePath(path, baseDir);
+        if (!PathFileExists(absPath.c_str()))
+        {
+            error = L"the search path does not exist: " + path;
+            return false;
+        }
+        m_options.searchPaths.push_back(absPath);
+    }
+
+    m_options.searchString = GetVal(L"searchfor");
+    if (HasVal(L"regex"))
+        m_options.useRegex = IsYes(L"regex");
+    else if (HasVal(L"searchfor"))
+        m_options.useRegex = true;
+    if (m_options.useRegex && !m_options.searchString.empty() && !IsRegexValid(m_options.searchString))
+    {
+        error = L"invalid regular expression: " + m_options.searchString;
+        return false;
+    }
+    if (HasVal(L"patternfile"))
+    {
+        if (!m_options.searchString.empty())
+        {
+            error = L"/patternfile and /searchfor can not be used together";
+            return false;
+        }
+        if (!CMultiPatternMatcher::ReadPatternFile(AbsolutePath(GetVal(L"patternfile"), baseDir), m_options.searchPatterns))
+        {
+            error = L"the pattern file can not be read: " + GetVal(L"patternfile");
+            return false;
+        }
+        if (m_options.searchPatterns.empty())
+        {
+            error = L"the pattern file is empty: " + GetVal(L"patternfile");
+            return false;
+        }
+    }
+
+    if (HasKey(L"filemaskregex"))
+    {
+        m_options.fileNameRegex    = GetVal(L"filemaskregex");
+        m_options.useRegexForPaths = true;
+        if (!m_options.fileNameRegex.empty() && !IsRegexValid(m_options.fileNameRegex))
+        {
+            error = L"invalid file name regular expression: " + m_options.fileNameRegex;
+            return false;
+        }
+    }
+    else if (HasKey(L"filemask"))
+    {
+        m_options.fileNameRegex = GetVal(L"filemask");
+        m_options.filePatterns  = CSearchEngine::SplitFilePatterns(m_options.fileNameRegex);
+    }
+    m_options.excludeDirsRegex = HasKey(L"direxcluderegex") ? GetVal(L"direxcluderegex") : GetVal(L"filemaskexclude");
+    if (!m_options.excludeDirsRegex.empty() && !IsRegexValid(m_options.excludeDirsRegex))
+    {
+        error = L"invalid exclude regular expression: " + m_options.excludeDirsRegex;
+        return false;
+    }
+
+    if (HasVal(L"i"))
+        m_options.caseSensitive = !IsYes(L"i");
+    if (HasVal(L"n"))
+        m_options.dotMatchesNewline = IsYes(L"n");
+    if (HasVal(L"k"))
+        m_options.createBackup = IsYes(L"k");
+    if (HasVal(L"keepfiledate"))
+        m_options.keepFileDate = IsYes(L"keepfiledate");
+    if (HasVal(L"wholewords"))
+        m_options.wholeWords = IsYes(L"wholewords");
+    else if (HasKey(L"wholewords"))
+        m_options.wholeWords = true;
+    if (HasVal(L"utf8"))
+        m_options.utf8 = IsYes(L"utf8");
+    if (HasVal(L"binary"))
+        m_options.forceBinary = IsYes(L"binary");
+    if (HasVal(L"size"))
+    {
+        // the size is in KB, like in the dialog
+        m_options.allSize = false;
+        m_options.size    = static_cast<uint64_t>(std::max(_wtoi(GetVal(L"size").c_str()), 0)) * 1024;
+        if (HasVal(L"sizecmp"))
+            m_options.sizeCmp = static_cast<SizeCompare>(std::clamp(_wtoi(GetVal(L"sizecmp").c_str()), 0, 2));
+    }
+    if (HasVal(L"s"))
+        m_options.includeSystem = IsYes(L"s");
+    if (HasVal(L"h"))
+        m_options.includeHidden = IsYes(L"h");
+    if (HasVal(L"u"))
+        m_options.includeSubfolders = IsYes(L"u");
+    if (HasVal(L"l"))
+        m_options.includeSymLinks = IsYes(L"l");
+    if (HasVal(L"b"))
+        m_options.includeBinary = IsYes(L"b");
+    if (HasVal(L"datelimit") && HasVal(L"date1"))
+    {
+        if (!ParseDate(GetVal(L"date1"), m_options.date1) ||
+            (HasVal(L"date2") && !ParseDate(GetVal(L"date2"), m_options.date2)))
+        {
+            error = L"invalid date, the format is yyyy:mm:dd";
+            return false;
+        }
+        m_options.dateLimit = static_cast<DateLimit>(std::clamp(_wtoi(GetVal(L"datelimit").c_str()), 0, 3));
+    }
+
+    if (HasKey(L"executereplace"))
+    {
+        m_options.replace       = true;
+        m_options.replaceString = GetVal(L"replacewith");
+    }
+    else if (HasKey(L"executecapture"))
+    {
+        m_options.captureSearch = true;
+        m_options.replaceString = GetVal(L"replacewith");
+    }
+    m_bShowContent = HasKey(L"content");
+
+    if (HasVal(L"format"))
+    {
+        if (_wcsicmp(GetVal(L"format").c_str(), L"json") == 0)
+            m_format = HeadlessFormat::Json;
+        else if (_wcsicmp(GetVal(L"format").c_str(), L"csv") == 0)
+            m_format = HeadlessFormat::Csv;
+        else if (_wcsicmp(GetVal(L"format").c_str(), L"binary") == 0)
+            m_format = HeadlessFormat::Binary;
+        else if (_wcsicmp(GetVal(L"format").c_str(), L"text") != 0)
+        {
+            error = L"unknown output format: " + GetVal(L"format");
+            return false;
+        }
+    }
+    if (HasVal(L"output"))
+        m_outputPath = AbsolutePath(GetVal(L"output"), baseDir);
+    if (m_format == HeadlessFormat::Binary && m_outputPath.empty())
+    {
+        error = L"/format:binary needs /output:<file>";
+        return false;
+    }
+    if (HasVal(L"save"))
+        m_savePath = AbsolutePath(GetVal(L"save"), baseDir);
+    if (HasVal(L"diff"))
+    {
+        m_diffPath = AbsolutePath(GetVal(L"diff"), baseDir);
+        if (m_options.replace || m_options.captureSearch || HasKey(L"watch"))
+        {
+            error = L"/diff can not be used with /executereplace, /executecapture or /watch";
+            return false;
+        }
+    }
+    if (HasVal(L"load"))
+    {
+        m_loadPath = AbsolutePath(GetVal(L"load"), baseDir);
+        if (m_options.replace || m_options.captureSearch || HasKey(L"watch") || !m_savePath.empty())
+        {
+            error = L"/load can not be used with /executereplace, /executecapture, /watch or /save";
+            return false;
+        }
+    }
+    if (HasVal(L"regexengine"))
+    {
+        if (_wcsicmp(GetVal(L"regexengine").c_str(), L"linear") == 0)
+            m_options.linearRegex = true;
+        else if (_wcsicmp(GetVal(L"regexengine").c_str(), L"boost") != 0)
+        {
+            error = L"unknown regex engine: " + GetVal(L"regexengine");
+            return false;
+        }
+    }
+    // the text output without /content only needs to know which files
+    // match, unless their lines are saved or compared
+    m_options.listOnly = HasKey(L"listonly") || (m_format == HeadlessFormat::Text && !m_bShowContent && m_savePath.empty() && m_diffPath.empty());
+    if (HasVal(L"maxcount"))
+        m_options.maxMatchesPerFile = static_cast<unsigned int>(std::max(_wtoi(GetVal(L"maxcount").c_str()), 0));
+    if (HasVal(L"context"))
+        m_options.contextLines = static_cast<unsigned int>(std::max(_wtoi(GetVal(L"context").c_str()), 0));
+    if (HasVal(L"maxresults"))
+        m_options.maxResults = static_cast<uint64_t>(std::max(_wtoi(GetVal(L"maxresults").c_str()), 0));
+    if (HasVal(L"regextimeout"))
+        m_options.regexTimeout = static_cast<unsigned int>(std::max(_wtoi(GetVal(L"regextimeout").c_str()), 0));
+    if (HasVal(L"threads"))
+        m_options.threadCount = static_cast<unsigned int>(std::max(_wtoi(GetVal(L"threads").c_str()), 0));
+    m_options.forceFullWalk = HasKey(L"fullwalk");
+    if (HasKey(L"dircache"))
+        m_dirCacheDir = HasVal(L"dircache") ? AbsolutePath(GetVal(L"dircache"), baseDir) : CSearchCache::DefaultPersistentDirectory();
+    if (!m_options.searchPatterns.empty() && (m_options.replace || m_options.captureSearch))
+    {
+        error = L"/patternfile can only be used to search";
+        return false;
+    }
+    if (HasKey(L"watch") && m_options.replace)
+    {
+        error = L"/watch can not be used to replace";
+        return false;
+    }
+    return true;
+}
+
+int CHeadlessSearch::Run(IHeadlessOutput& output, const CCancellationToken& cancelToken, CSearchCache* cache)
+{
+    // /output: the results are written to the file in large blocks
+    CExportFile                        outputFile;
+    std::unique_ptr<CExportFileOutput> fileOutput;
+    if (!m_outputPath.empty())
+    {
+        if (!outputFile.Open(m_outputPath))
+        {
+            output.WriteErr("grepWin: the output file can not be written\n");
+            return HeadlessExitError;
+        }
+        fileOutput = std::make_unique<CExportFileOutput>(outputFile, output);
+    }
+
+    CStreamResultSink    sink(fileOutput ? *fileOutput : output, m_format, m_bShowContent);
+    CResultArchiveWriter archive;
+    sink.SetPatterns(m_options.searchPatterns);
+    if (!m_savePath.empty())
+    {
+        if (!archive.Open(m_savePath))
+        {
+            output.WriteErr("grepWin: the results file can not be written\n");
+            return HeadlessExitError;
+        }
+        sink.SetArchive(&archive);
+    }
+    if (!m_diffPath.empty())
+    {
+        CResultArchive           diffArchive;
+        std::vector<CSearchInfo> before;
+        if (!diffArchive.Open(m_diffPath) || !diffArchive.ReadAll(before, cancelToken))
+        {
+            output.WriteErr("grepWin: the results file to compare with can not be read\n");
+            return HeadlessExitError;
+        }
+        sink.SetDiffBase(std::move(before));
+    }
+
+    bool bDone = m_loadPath.empty() ? Search(sink, output, cancelToken, cache) : Load(sink, output, cancelToken);
+    if (!m_savePath.empty())
+    {
+        SavedSearchInfo info;
+        for (const auto& path : m_options.searchPaths)
+            info.searchPath += (info.searchPath.empty() ? L"" : L"|") + path;
+        info.searchString = m_options.searchString;
+        info.useRegex     = m_options.useRegex;
+        if (!archive.Close(info))
+        {
+            output.WriteErr("grepWin: the results file can not be written\n");
+            return HeadlessExitError;
+        }
+    }
+    if (fileOutput && !outputFile.Close())
+    {
+        output.WriteErr("grepWin: the output file can not be written\n");
+        return HeadlessExitError;
+    }
+    if (!bDone || sink.Errors())
+        return HeadlessExitError;
+    return sink.FilesMatched() ? HeadlessExitMatches : HeadlessExitNoMatches;
+}
+
+bool CHeadlessSearch::Load(CStreamResultSink& sink, IHeadlessOutput& output, const CCancellationToken& cancelToken) const
+{
+    CResultArchive archive;
+    if (!archive.Open(m_loadPath))
+    {
+        output.WriteErr("grepWin: the results file can not be read\n");
+        return false;
+    }
+    if (!archive.Replay(sink, cancelToken))
+    {
+        output.WriteErr("grepWin: the results file is damaged\n");
+        return false;
+    }
+    return true;
+}
+
+bool CHeadlessSearch::Search(CStreamResultSink& sink, IHeadlessOutput& output, const CCancellationToken& cancelToken, CSearchCache* cache)
+{
+    // /dircache: the folder listings of the search paths are kept on disk,
+    // so only the folders which changed since the last search are listed
+    std::unique_ptr<CSearchCache> diskCache;
+    CSearchCache*                 dirCache = cache;
+    if (!m_dirCacheDir.empty())
+    {
+        if (!dirCache)
+        {
+            diskCache = std::make_unique<CSearchCache>();
+            dirCache  = diskCache.get();
+        }
+        // a full walk lists every folder again anyway
+        if (!m_options.forceFullWalk)
+        {
+            for (const auto& path : m_options.searchPaths)
+            {
+                if (PathIsDirectory(path.c_str()))
+                    dirCache->Load(m_dirCacheDir, path);
+            }
+        }
+    }
+
+    CSearchEngine engine(m_options, sink, cancelToken, dirCache);
+
+    // the server keeps the results of every search, so that a later
+    // /refresh of it only has to search the files changed since
+    std::shared_ptr<CSearchSnapshot> snapshot;
+    std::wstring                     snapshotKey;
+    if (cache && !m_options.replace)
+    {
+        snapshot    = std::make_shared<CSearchSnapshot>(m_options);
+        snapshotKey = snapshot->QueryKey();
+        for (const auto& path : m_options.searchPaths)
+        {
+            snapshotKey += L'\0';
+            snapshotKey += path;
+        }
+        auto previous = HasKey(L"refresh") ? cache->GetSnapshot(snapshotKey) : nullptr;
+        engine.SetSnapshots(previous.get(), snapshot.get());
+    }
+    engine.Run();
+    if (snapshot && !cancelToken.IsCancelled())
+        cache->StoreSnapshot(snapshotKey, snapshot);
+    if (!m_dirCacheDir.empty() && !cancelToken.IsCancelled())
+    {
+        for (const auto& path : m_options.searchPaths)
+        {
+            if (PathIsDirectory(path.c_str()))
+                dirCache->Save(m_dirCacheDir, path);
+        }
+    }
+
+    if (HasKey(L"watch") && !cancelToken.IsCancelled())
+    {
+        // runs until the process is ended
+        sink.SetReportRemoved(true);
+        CDirectoryWatcher watcher([&](const std::vector<std::wstring>& paths) {
+            engine.SearchChangedFiles(paths);
+        });
+        if (!watcher.Start(m_options.searchPaths, m_options.includeSubfolders))
+        {
+            output.WriteErr("grepWin: the search paths can not be watched\n");
+            return false;
+        }
+        while (!cancelToken.IsCancelled())
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    return true;
+}
+
+const char* CHeadlessSearch::Usage()
+{
+    return "usage: grepWin /headless [switches] [path ...]\n"
+           "\n"
+           "searches without showing a window and writes the results to stdout\n"
+           "as soon as each file is done.\n"
+           "\n"
+           "  /searchpath:<paths>      '|' separated paths, in addition to the path arguments\n"
+           "  /searchfor:<text>        the text or regular expression to search for\n"
+           "  /regex:yes|no            whether /searchfor is a regular expression (default: yes)\n"
+           "  /patternfile:<file>      search for all the texts in a UTF-8 file (one per line)\n"
+           "                           at once, instead of /searchfor\n"
+           "  /replacewith:<text>      the replace text for /executereplace and /executecapture\n"
+           "  /filemask:<patterns>     '|' separated wildcard patterns, '-' prefix excludes\n"
+           "  /filemaskregex:<regex>   a regular expression for the file names\n"
+           "  /direxcluderegex:<regex> a regular expression for folders to skip\n"
+           "  /i /n /k /keepfiledate /wholewords /utf8 /binary /s /h /u /l /b\n"
+           "                           the options of the dialog, with :yes or :no\n"
+           "  /size:<kb> /sizecmp:0|1|2 /datelimit:<n> /date1:yyyy:mm:dd /date2:yyyy:mm:dd\n"
+           "  /executereplace          replace in the files instead of only searching\n"
+           "  /executecapture          output the /replacewith text for every match\n"
+           "  /content                 text format: output the matching lines, not just the files\n"
+           "  /format:<format>         text, json: one object per line for every file and a\n"
+           "                           summary, csv: a row per matching line, or binary\n"
+           "  /output:<file>           write the results to the file instead of stdout, in\n"
+           "                           large blocks (needed for /format:binary)\n"
+           "  /save:<file>             also save the results to a results file, which the\n"
+           "                           dialog and /load can read\n"
+           "  /load:<file>             output the results saved in a results file in the\n"
+           "                           /format, instead of searching\n"
+           "  /diff:<file>             only output the matches which were added, removed or\n"
+           "                           moved to another line since the results in the file\n"
+           "  /listonly                stop searching a file at its first match (always done\n"
+           "                           for the text format without /content)\n"
+           "  /maxcount:<n>            stop searching a file after n matches\n"
+           "  /context:<n>             also output n lines before and after every matching\n"
+           "                           line, with /content or /format:json\n"
+           "  /maxresults:<n>          stop the search after n matching files\n"
+           "  /regexengine:<name>      boost (the default), or linear: a DFA which never takes\n"
+           "                           more than linear time, for the expressions it supports\n"
+           "  /regextimeout:<seconds>  stop searching a file after that long (per 64 MB) and\n"
+           "                           report it as an error with the matches found until then\n"
+           "  /threads:<n>             the number of worker threads\n"
+           "  /watch                   keep running and output the changed files again; with\n"
+           "                           /format:json also those which don't match anymore\n"
+           "  /refresh                 with /useserver: only search the files which changed\n"
+           "                           since the last search of the same query and paths\n"
+           "  /dircache[:<folder>]     keep the folder listings on disk and only list the\n"
+           "                           folders which changed since the last search\n"
+           "  /fullwalk                with /dircache or /useserver: list every folder again\n"
+           "\n"
+           "  /server                  run as a search server which keeps directory listings\n"
+           "                           and compiled filters between searches\n"
+           "  /useserver               run the search on the server instead of in this process\n"
+           "  /stopserver              stop the server\n"
+           "  /endpoint:<name>         the pipe (Windows) or socket the server listens on\n"
+           "\n"
+           "exit code: 0 if something matched, 1 if nothing matched, 2 on errors\n";
+}
+
+bool CHeadlessSearch::HasKey(const std::wstring& key) const
+{
+    return m_switches.contains(key);
+}
+
+bool CHeadlessSearch::HasVal(const std::wstring& key) const
+{
+    auto it = m_switches.find(key);
+    return it != m_switches.end() && !it->second.empty();
+}
+
+const std::wstring& CHeadlessSearch::GetVal(const std::wstring& key) const
+{
+    static const std::wstring empty;
+    auto                      it = m_switches.find(key);
+    return it != m_switches.end() ? it->second : empty;
+}
+
+bool CHeadlessSearch::IsYes(const std::wstring& key) const
+{
+    return _wcsicmp(GetVal(key).c_str(), L"yes") == 0;
+}
+
+int RunHeadlessCommandLine(const std::vector<std::wstring>& args, FILE* out, FILE* err)
+{
+    bool         bHelp      = false;
+    bool         bServer    = false;
+    bool         bUseServer = false;
+    bool         bWatch     = false;
+    std::wstring endpoint   = CSearchServer::DefaultEndpoint();
+    for (const auto& arg : args)
+    {
+        std::wstring key;
+        std::wstring value;
+        if (!CHeadlessSearch::SplitSwitch(arg, key, value))
+            continue;
+        if (key == L"?" || key == L"help")
+            bHelp = true;
+        else if (key == L"server")
+            bServer = true;
+        else if (key == L"useserver" || key == L"stopserver")
+            bUseServer = true;
+        else if (key == L"watch")
+            bWatch = true;
+        else if (key == L"endpoint" && !value.empty())
+            endpoint = value;
+    }
+
+    CFileHeadlessOutput output(out, err);
+    std::wstring        error;
+    int                 ret = HeadlessExitError;
+    if (bHelp)
+    {
+        output.WriteOut(CHeadlessSearch::Usage());
+        return HeadlessExitMatches;
+    }
+    if (bServer)
+    {
+        CSearchServer server(endpoint);
+        if (server.Run(output, error))
+            return HeadlessExitMatches;
+    }
+    else if (bUseServer && bWatch)
+    {
+        error = L"/watch can not be used with the search server";
+    }
+    else if (bUseServer)
+    {
+        ret = RunSearchOnServer(endpoint, args, output, error);
+    }
+    else
+    {
+        CHeadlessSearch    search;
+        CCancellationToken cancelToken;
+        if (search.Parse(args, error))
+            ret = search.Run(output, cancelToken);
+    }
+    if (!error.empty())
+        output.WriteErr("grepWin: " + CUnicodeUtils::StdGetUTF8(error) + "\n");
+    return ret;
+}
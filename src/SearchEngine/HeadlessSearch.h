@@ -0,0 +1,203 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+#include "ResultArchive.h"
+#include "ResultExport.h"
+#include "SearchOptions.h"
+#include "SearchResultSink.h"
+
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// exit codes of a headless search, the same as grep uses
+enum HeadlessExitCode
+{
+    HeadlessExitMatches   = 0, // at least one file matched
+    HeadlessExitNoMatches = 1, // the search ran, but nothing matched
+    HeadlessExitError     = 2, // invalid arguments, or files could not be searched
+};
+
+enum class HeadlessFormat
+{
+    Text,   // grep like: one line per file, or per matching line with /content
+    Json,   // one JSON object per line and file, plus a summary at the end
+    Csv,    // ExportFormat::Csv
+    Binary, // ExportFormat::Binary
+};
+
+class CCancellationToken;
+class CSearchCache;
+
+// where the output of a headless search goes: the console, or the
+// connection to a client of the search server
+class IHeadlessOutput
+{
+public:
+    virtual ~IHeadlessOutput() = default;
+
+    virtual void WriteOut(const std::string& text) = 0;
+    virtual void WriteErr(const std::string& text) = 0;
+};
+
+class CFileHeadlessOutput : public IHeadlessOutput
+{
+public:
+    CFileHeadlessOutput(FILE* out, FILE* err);
+
+    void WriteOut(const std::string& text) override;
+    void WriteErr(const std::string& text) override;
+
+private:
+    FILE* m_out;
+    FILE* m_err;
+};
+
+// writes every result to the output as soon as its file is done.
+// Nothing is kept once a result is written, so the memory used does not
+// depend on the number of results.
+class CStreamResultSink : public ISearchResultSink
+{
+public:
+    CStreamResultSink(IHeadlessOutput& output, HeadlessFormat format, bool bShowContent);
+
+    void     OnSearchStart() override;
+    void     OnFileResult(const CSearchInfo& sInfo, bool bSearched, bool bAsResult) override;
+    void     OnFileSkipped() override;
+    void     OnSearchEnd() override;
+    void     OnFileRemoved(const std::wstring& path) override;
+
+    // json only: also report the files which were searched again and don't
+    // match anymore, or are gone
+    void     SetReportRemoved(bool bReport) { m_bReportRemoved = bReport; }
+    // json only: the patterns of SearchOptions::searchPatterns, to report
+    // which of them each line matched
+    void     SetPatterns(const std::vector<std::wstring>& patterns) { m_patterns = patterns; }
+    // also adds every result to archive, nullptr for none
+    void     SetArchive(CResultArchiveWriter* archive) { m_archive = archive; }
+    // only writes what changed from the results in before, once the search
+    // is done, see CResultDiff
+    void     SetDiffBase(std::vector<CSearchInfo> before);
+
+    uint64_t FilesMatched() const { return m_filesMatched; }
+    uint64_t Errors() const { return m_errors; }
+
+private:
+    void     FormatText(const CSearchInfo& sInfo, std::string& text) const;
+    void     WriteResult(const CSearchInfo& sInfo);
+    void     WriteRemoved(const std::wstring& path);
+
+    IHeadlessOutput&          m_output;
+    HeadlessFormat            m_format;
+    bool                      m_bShowContent;
+    bool                      m_bReportRemoved;
+    std::vector<std::wstring> m_patterns;
+    // formats the results for Csv and Binary
+    CResultExporter           m_exporter;
+    CResultArchiveWriter*     m_archive;
+    bool                      m_bDiff;
+    std::vector<CSearchInfo>  m_diffBefore;
+    std::vector<CSearchInfo>  m_diffAfter;
+    std::mutex                m_writeMutex;
+
+    std::atomic<uint64_t>     m_filesSearched = 0;
+    std::atomic<uint64_t>     m_filesMatched  = 0;
+    std::atomic<uint64_t>     m_filesSkipped  = 0;
+    std::atomic<uint64_t>     m_matches       = 0;
+    std::atomic<uint64_t>     m_errors        = 0;
+    std::atomic<uint64_t>     m_timeouts      = 0;
+    uint64_t                  m_added         = 0;
+    uint64_t                  m_removed       = 0;
+    uint64_t                  m_moved         = 0;
+};
+
+// runs a search without any window, configured with the same command line
+// switches the dialog understands (/searchpath:, /searchfor:, /regex:yes, ...)
+// plus:
+//   /format:<format>    text (the default), json, csv or binary
+//   /output:<file>      write the results to the file instead of the output
+//   /save:<file>        also save the results to a results file, see CResultArchive
+//   /load:<file>        output the results saved in a results file instead of searching
+//   /diff:<file>        only output what changed from the results saved in the file
+//   /patternfile:<file> search for all the texts in the file at once
+//   /listonly           stop searching a file at its first match
+//   /maxcount:<n>       stop searching a file after n matches
+//   /context:<n>        also output n lines before and after every match line
+//   /maxresults:<n>     stop the search after n matching files
+//   /regexengine:linear search with CLinearRegex where it supports the expression
+//   /regextimeout:<s>   stop searching a file which takes longer, see SearchOptions::regexTimeout
+//   /threads:<n>        the number of worker threads
+//   /watch              keep running and search changed files again
+//   /dircache           keep the folder listings on disk between runs
+//   /fullwalk           list every folder again instead of using cached listings
+// Arguments which are not switches are search paths.
+class CHeadlessSearch
+{
+public:
+    CHeadlessSearch();
+
+    // args: the command line arguments, without the program name.
+    // Relative search paths are relative to baseDir, or to the current
+    // directory if it is empty.
+    // Returns false and sets error if they do not describe a valid search.
+    bool                Parse(const std::vector<std::wstring>& args, std::wstring& error, const std::wstring& baseDir = {});
+
+    // runs the search and returns one of the HeadlessExitCode values
+    int                 Run(IHeadlessOutput& output, const CCancellationToken& cancelToken, CSearchCache* cache = nullptr);
+
+    static const char*  Usage();
+
+    // splits "/key:value", "-key=value" or "--key" into the lower case key
+    // and the value. Returns false if arg is not a switch.
+    static bool         SplitSwitch(const std::wstring& arg, std::wstring& key, std::wstring& value);
+
+private:
+    // the two ways Run() gets its results. Both return false after they
+    // wrote an error to output.
+    bool                Search(CStreamResultSink& sink, IHeadlessOutput& output, const CCancellationToken& cancelToken, CSearchCache* cache);
+    bool                Load(CStreamResultSink& sink, IHeadlessOutput& output, const CCancellationToken& cancelToken) const;
+
+    bool                HasKey(const std::wstring& key) const;
+    bool                HasVal(const std::wstring& key) const;
+    const std::wstring& GetVal(const std::wstring& key) const;
+    bool                IsYes(const std::wstring& key) const;
+
+    std::map<std::wstring, std::wstring> m_switches;
+    std::vector<std::wstring>            m_paths;
+    SearchOptions                        m_options;
+    // where /dircache keeps the folder listings, empty without it
+    std::wstring                         m_dirCacheDir;
+    // /output, empty without it
+    std::wstring                         m_outputPath;
+    // /save, /load and /diff, empty without them
+    std::wstring                         m_savePath;
+    std::wstring                         m_loadPath;
+    std::wstring                         m_diffPath;
+    HeadlessFormat                       m_format;
+    bool                                 m_bShowContent;
+};
+
+// the whole headless command line of grepWin.exe /headless and grepWinCli:
+// a search, or with /server, /useserver and /stopserver the search server
+// and its client. Returns the exit code.
+int RunHeadlessCommandLine(const std::vector<std::wstring>& args, FILE* out, FILE* err);
@@ -0,0 +1,960 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "LinearRegex.h"
+
+#include <algorithm>
+
+#include <boost/regex.hpp>
+
+namespace
+{
+// bigger expressions are left to boost
+constexpr size_t   maxProgramSize   = 20000;
+constexpr int      maxRepeat        = 1000;
+// the transition tables of the DFA are dropped when they grow beyond that
+constexpr size_t   maxTransitions   = 4 * 1024 * 1024;
+// the code units above the table of a wide regex (with a 32-bit wchar_t)
+// all get the class of this one
+constexpr uint32_t highRepresentive = 0x1F600;
+
+enum Assertion : uint8_t
+{
+    AssertLineStart,
+    AssertLineEnd,
+    AssertWordBoundary,
+    AssertNotWordBoundary,
+    AssertWordStart,
+    AssertWordEnd,
+    AssertBufferStart,
+    AssertBufferEnd,
+};
+
+// a set of code units as the expression describes it
+template <typename CharT>
+struct SetSpec
+{
+    using ClassType = typename boost::regex_traits<CharT>::char_class_type;
+
+    enum class Type
+    {
+        Literal,
+        Dot,
+        Bracket,
+    };
+    Type                                      type     = Type::Literal;
+    uint32_t                                  literal  = 0;
+    bool                                      bNegated = false;
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    std::vector<ClassType>                    classes;
+    std::vector<ClassType>                    negatedClasses;
+};
+
+struct Node
+{
+    enum class Type
+    {
+        Empty,
+        Set,
+        Assert,
+        Concat,
+        Alternate,
+        Repeat,
+    };
+    Type                               type   = Type::Empty;
+    uint32_t                           value  = 0; // the set or the assertion
+    int                                min    = 0;
+    int                                max    = 0; // -1 for no limit
+    bool                               greedy = true;
+    std::vector<std::unique_ptr<Node>> children;
+};
+
+// whether node can match without consuming anything
+bool IsNullable(const Node& node)
+{
+    switch (node.type)
+    {
+        case Node::Type::Set:
+            return false;
+        case Node::Type::Concat:
+            return std::all_of(node.children.begin(), node.children.end(), [](const auto& child) { return IsNullable(*child); });
+        case Node::Type::Alternate:
+            return std::any_of(node.children.begin(), node.children.end(), [](const auto& child) { return IsNullable(*child); });
+        case Node::Type::Repeat:
+            return node.min == 0 || IsNullable(*node.children.front());
+        default:
+            return true;
+    }
+}
+
+// whether the first thing node matches is a lazy repeat with an upper
+// bound: boost skips positions when it starts a new attempt after those
+bool StartsWithLazyRepeat(const Node& node)
+{
+    switch (node.type)
+    {
+        case Node::Type::Concat:
+            return !node.children.empty() && StartsWithLazyRepeat(*node.children.front());
+        case Node::Type::Alternate:
+            return std::any_of(node.children.begin(), node.children.end(), [](const auto& child) { return StartsWithLazyRepeat(*child); });
+        case Node::Type::Repeat:
+            return (!node.greedy && node.max >= 0) || StartsWithLazyRepeat(*node.children.front());
+        default:
+            return false;
+    }
+}
+
+// parses the expression the way boost does with the perl syntax, and
+// compiles it to the program of the Pike VM
+template <typename CharT>
+class CCompiler
+{
+public:
+    using Traits    = boost::regex_traits<CharT>;
+    using ClassType = typename Traits::char_class_type;
+
+    CCompiler(const std::wstring& expression, bool bCaseSensitive, bool bDotMatchesNewline)
+        : m_expr(expression)
+        , m_pos(0)
+        , m_bIcase(!bCaseSensitive)
+        , m_bDotAll(bDotMatchesNewline)
+        , m_bFailed(false)
+    {
+    }
+
+    std::unique_ptr<Node> Parse()
+    {
+        auto node = ParseAlternation();
+        if (m_bFailed || m_pos != m_expr.size() || StartsWithLazyRepeat(*node))
+            return nullptr;
+        return node;
+    }
+
+    std::vector<SetSpec<CharT>> m_sets;
+
+    // whether c is in the set, the way boost tests it
+    bool Contains(const SetSpec<CharT>& set, uint32_t c) const
+    {
+        switch (set.type)
+        {
+            case SetSpec<CharT>::Type::Literal:
+                return Translate(c) == set.literal;
+            case SetSpec<CharT>::Type::Dot:
+                return m_bDotAll || !IsSeparator(c);
+            default:
+                break;
+        }
+        uint32_t col = Translate(c);
+        bool     in  = false;
+        for (const auto& [lo, hi] : set.ranges)
+            in = in || (col >= lo && col <= hi);
+        for (const auto& cls : set.classes)
+            in = in || m_traits.isctype(static_cast<CharT>(col), cls);
+        for (const auto& cls : set.negatedClasses)
+            in = in || !m_traits.isctype(static_cast<CharT>(col), cls);
+        return set.bNegated ? !in : in;
+    }
+
+    static bool IsSeparator(uint32_t c)
+    {
+        if (c == '\n' || c == '\r' || c == '\f')
+            return true;
+        return sizeof(CharT) > 1 && (c == 0x2028 || c == 0x2029 || c == 0x85);
+    }
+
+    bool IsWord(uint32_t c) const { return m_traits.isctype(static_cast<CharT>(c), m_wordClass); }
+
+private:
+    uint32_t Translate(uint32_t c) const
+    {
+        if (!m_bIcase)
+            return c;
+        return static_cast<std::make_unsigned_t<CharT>>(m_traits.translate_nocase(static_cast<CharT>(c)));
+    }
+
+    bool     AtEnd() const { return m_pos >= m_expr.size(); }
+    wchar_t  Peek(size_t ahead = 0) const { return m_pos + ahead < m_expr.size() ? m_expr[m_pos + ahead] : 0; }
+
+    std::unique_ptr<Node> Fail()
+    {
+        m_bFailed = true;
+        return nullptr;
+    }
+
+    std::unique_ptr<Node> MakeNode(Node::Type type, uint32_t value = 0)
+    {
+        auto node   = std::make_unique<Node>();
+        node->type  = type;
+        node->value = value;
+        return node;
+    }
+
+    uint32_t AddSet(SetSpec<CharT>&& set)
+    {
+        m_sets.push_back(std::move(set));
+        return static_cast<uint32_t>(m_sets.size() - 1);
+    }
+
+    uint32_t LiteralSet(uint32_t c)
+    {
+        uint32_t translated = Translate(c);
+        auto     it         = m_literalSets.find(translated);
+        if (it != m_literalSets.end())
+            return it->second;
+        SetSpec<CharT> set;
+        set.literal                 = translated;
+        uint32_t index              = AddSet(std::move(set));
+        m_literalSets[translated]   = index;
+        return index;
+    }
+
+    bool LookupClass(const std::wstring& name, ClassType& cls) const
+    {
+        // boost changes those with icase
+        if (m_bIcase && (name == L"upper" || name == L"lower" || name == L"u" || name == L"l"))
+            return false;
+        std::basic_string<CharT> n(name.begin(), name.end());
+        cls = m_traits.lookup_classname(n.data(), n.data() + n.size());
+        return cls != 0;
+    }
+
+    std::unique_ptr<Node> ParseAlternation()
+    {
+        auto first = ParseSequence();
+        if (m_bFailed || Peek() != '|')
+            return first;
+        auto node = MakeNode(Node::Type::Alternate);
+        node->children.push_back(std::move(first));
+        while (!m_bFailed && !AtEnd() && Peek() == '|')
+        {
+            ++m_pos;
+            node->children.push_back(ParseSequence());
+        }
+        if (m_bFailed)
+            return nullptr;
+        return node;
+    }
+
+    std::unique_ptr<Node> ParseSequence()
+    {
+        auto node = MakeNode(Node::Type::Concat);
+        while (!m_bFailed && !AtEnd() && Peek() != '|' && Peek() != ')')
+        {
+            auto atom = ParseAtom();
+            if (!atom)
+                return Fail();
+            if (IsQuantifier())
+            {
+                if (atom->type == Node::Type::Assert)
+                    return Fail();
+                int min = 0;
+                int max = 0;
+                if (!ParseQuantifier(min, max))
+                    return Fail();
+                bool greedy = true;
+                if (Peek() == '?')
+                {
+                    greedy = false;
+                    ++m_pos;
+                }
+                else if (Peek() == '+') // possessive
+                    return Fail();
+                // a repeat of a repeat is an error for boost
+                if (IsQuantifier())
+                    return Fail();
+                // boost ends a repeat when an iteration matched nothing,
+                // which the NFA can't do
+                if (max != 1 && IsNullable(*atom))
+                    return Fail();
+                auto repeat    = MakeNode(Node::Type::Repeat);
+                repeat->min    = min;
+                repeat->max    = max;
+                repeat->greedy = greedy;
+                repeat->children.push_back(std::move(atom));
+                atom = std::move(repeat);
+            }
+            node->children.push_back(std::move(atom));
+        }
+        if (m_bFailed)
+            return nullptr;
+        return node;
+    }
+
+    bool IsQuantifier() const
+    {
+        wchar_t c = Peek();
+        return c == '*' || c == '+' || c == '?' || c == '{';
+    }
+
+    bool ParseNumber(int& value)
+    {
+        if (!iswdigit(Peek()))
+            return false;
+        value = 0;
+        while (iswdigit(Peek()))
+        {
+            value = value * 10 + (Peek() - '0');
+            if (value > maxRepeat)
+                return false;
+            ++m_pos;
+        }
+        return true;
+    }
+
+    bool ParseQuantifier(int& min, int& max)
+    {
+        wchar_t c = m_expr[m_pos++];
+        switch (c)
+        {
+            case '*':
+                min = 0;
+                max = -1;
+                return true;
+            case '+':
+                min = 1;
+                max = -1;
+                return true;
+            case '?':
+                min = 0;
+                max = 1;
+                return true;
+            default:
+                break;
+        }
+        // {n}, {n,} or {n,m}
+        if (!ParseNumber(min))
+            return false;
+        max = min;
+        if (Peek() == ',')
+        {
+            ++m_pos;
+            max = -1;
+            if (Peek() != '}' && !ParseNumber(max))
+                return false;
+        }
+        if (Peek() != '}' || (max >= 0 && max < min))
+            return false;
+        ++m_pos;
+        return true;
+    }
+
+    std::unique_ptr<Node> ParseAtom()
+    {
+        wchar_t c = m_expr[m_pos++];
+        switch (c)
+        {
+            case '(':
+            {
+                if (Peek() == '?')
+                {
+                    // only non-capturing groups, the captures are not needed
+                    if (Peek(1) != ':')
+                        return Fail();
+                    m_pos += 2;
+                }
+                auto node = ParseAlternation();
+                if (m_bFailed || Peek() != ')')
+                    return Fail();
+                ++m_pos;
+                return node;
+            }
+            case '[':
+                return ParseBracket();
+            case '.':
+            {
+                SetSpec<CharT> set;
+                set.type = SetSpec<CharT>::Type::Dot;
+                return MakeNode(Node::Type::Set, AddSet(std::move(set)));
+            }
+            case '^':
+                return MakeNode(Node::Type::Assert, AssertLineStart);
+            case '$':
+                return MakeNode(Node::Type::Assert, AssertLineEnd);
+            case '\\':
+                return ParseEscape();
+            case '*':
+            case '+':
+            case '?':
+            case '{':
+            case ')':
+                return Fail();
+            default:
+                return MakeNode(Node::Type::Set, LiteralSet(c));
+        }
+    }
+
+    std::unique_ptr<Node> ParseEscape()
+    {
+        if (AtEnd())
+            return Fail();
+        wchar_t c = m_expr[m_pos];
+        switch (c)
+        {
+            case 'd':
+            case 'D':
+            case 'w':
+            case 'W':
+            case 's':
+            case 'S':
+            {
+                ++m_pos;
+                SetSpec<CharT> set;
+                set.type = SetSpec<CharT>::Type::Bracket;
+                if (!AddEscapeClass(set, c))
+                    return Fail();
+                return MakeNode(Node::Type::Set, AddSet(std::move(set)));
+            }
+            case 'b':
+                ++m_pos;
+                return MakeNode(Node::Type::Assert, AssertWordBoundary);
+            case 'B':
+                ++m_pos;
+                return MakeNode(Node::Type::Assert, AssertNotWordBoundary);
+            case '<':
+                ++m_pos;
+                return MakeNode(Node::Type::Assert, AssertWordStart);
+            case '>':
+                ++m_pos;
+                return MakeNode(Node::Type::Assert, AssertWordEnd);
+            case 'A':
+            case '`':
+                ++m_pos;
+                return MakeNode(Node::Type::Assert, AssertBufferStart);
+            case 'z':
+            case '\'':
+                ++m_pos;
+                return MakeNode(Node::Type::Assert, AssertBufferEnd);
+            default:
+                break;
+        }
+        uint32_t value = 0;
+        if (!ParseCharEscape(value))
+            return Fail();
+        return MakeNode(Node::Type::Set, LiteralSet(value));
+    }
+
+    // \d, \w, \s and their negations
+    bool AddEscapeClass(SetSpec<CharT>& set, wchar_t c)
+    {
+        ClassType cls{};
+        if (!LookupClass(std::wstring(1, static_cast<wchar_t>(towlower(c))), cls))
+            return false;
+        if (iswupper(c))
+            set.negatedClasses.push_back(cls);
+        else
+            set.classes.push_back(cls);
+        return true;
+    }
+
+    // the escapes of a single code unit, after the backslash
+    bool ParseCharEscape(uint32_t& value)
+    {
+        wchar_t c = m_expr[m_pos++];
+        switch (c)
+        {
+            case 'n':
+                value = '\n';
+                return true;
+            case 'r':
+                value = '\r';
+                return true;
+            case 't':
+                value = '\t';
+                return true;
+            case 'f':
+                value = '\f';
+                return true;
+            case 'a':
+                value = 0x07;
+                return true;
+            case 'e':
+                value = 0x1B;
+                return true;
+            case 'x':
+                return ParseHex(value);
+            case '0':
+                value = 0;
+                for (int i = 0; i < 3 && Peek() >= '0' && Peek() <= '7'; ++i)
+                    value = value * 8 + (m_expr[m_pos++] - '0');
+                return true;
+            default:
+                break;
+        }
+        // back references, \v, \h, \Q, \G and all the others boost knows
+        if (iswalnum(c) || c >= 0x80)
+            return false;
+        value = c;
+        return true;
+    }
+
+    bool ParseHex(uint32_t& value)
+    {
+        const uint32_t maxValue = sizeof(CharT) > 1 ? 0x10FFFF : 0xFF;
+        bool           bBraces  = Peek() == '{';
+        if (bBraces)
+            ++m_pos;
+        value      = 0;
+        int digits = 0;
+        while ((bBraces || digits < 2) && iswxdigit(Peek()))
+        {
+            wchar_t c = m_expr[m_pos++];
+            value     = value * 16 + (iswdigit(c) ? c - '0' : (towlower(c) - 'a' + 10));
+            if (value > maxValue)
+                return false;
+            ++digits;
+        }
+        if (bBraces)
+        {
+            if (Peek() != '}')
+                return false;
+            ++m_pos;
+        }
+        return digits > 0;
+    }
+
+    std::unique_ptr<Node> ParseBracket()
+    {
+        SetSpec<CharT> set;
+        set.type = SetSpec<CharT>::Type::Bracket;
+        if (Peek() == '^')
+        {
+            set.bNegated = true;
+            ++m_pos;
+        }
+        bool bFirst = true;
+        for (;;)
+        {
+            if (AtEnd())
+                return Fail();
+            wchar_t c = Peek();
+            if (c == ']' && !bFirst)
+            {
+                ++m_pos;
+                break;
+            }
+            bFirst = false;
+            if (c == '[' && (Peek(1) == '=' || Peek(1) == '.'))
+                return Fail();
+            if (c == '[' && Peek(1) == ':')
+            {
+                size_t end = m_expr.find(L":]", m_pos + 2);
+                if (end == std::wstring::npos || Peek(2) == '^')
+                    return Fail();
+                ClassType cls{};
+                if (!LookupClass(m_expr.substr(m_pos + 2, end - m_pos - 2), cls))
+                    return Fail();
+                set.classes.push_back(cls);
+                m_pos = end + 2;
+                continue;
+            }
+            uint32_t lo = 0;
+            if (!ParseBracketChar(set, lo))
+                return Fail();
+            if (lo == UINT32_MAX) // a class
+            {
+                if (Peek() == '-' && Peek(1) != ']')
+                    return Fail();
+                continue;
+            }
+            uint32_t hi = lo;
+            if (Peek() == '-' && Peek(1) != ']' && m_pos + 1 < m_expr.size())
+            {
+                ++m_pos;
+                if (Peek() == '[' || !ParseBracketChar(set, hi) || hi == UINT32_MAX || hi < lo)
+                    return Fail();
+                if (Peek() == '-' && Peek(1) != ']')
+                    return Fail();
+            }
+            // boost compares the translated code unit with the translated bounds
+            set.ranges.emplace_back(Translate(lo), Translate(hi));
+        }
+        return MakeNode(Node::Type::Set, AddSet(std::move(set)));
+    }
+
+    // a code unit in a bracket expression, UINT32_MAX if it was \d, \w or \s
+    bool ParseBracketChar(SetSpec<CharT>& set, uint32_t& value)
+    {
+        wchar_t c = m_expr[m_pos++];
+        if (c != '\\')
+        {
+            value = c;
+            return true;
+        }
+        if (AtEnd())
+            return false;
+        c = Peek();
+        if (c == 'd' || c == 'D' || c == 'w' || c == 'W' || c == 's' || c == 'S')
+        {
+            ++m_pos;
+            value = UINT32_MAX;
+            return AddEscapeClass(set, c);
+        }
+        if (c == 'b') // a backspace in a bracket expression
+        {
+            ++m_pos;
+            value = 0x08;
+            return true;
+        }
+        return ParseCharEscape(value);
+    }
+
+    const std::wstring&          m_expr;
+    size_t                       m_pos;
+    bool                         m_bIcase;
+    bool                         m_bDotAll;
+    bool                         m_bFailed;
+    Traits                       m_traits;
+    ClassType                    m_wordClass = m_traits.lookup_classname(s_word, s_word + 1);
+    std::map<uint32_t, uint32_t> m_literalSets;
+
+    static constexpr CharT       s_word[] = {'w', 0};
+};
+
+// an instruction of the program, with the operations in the order of CLinearRegex::Op
+struct Instruction
+{
+    enum Op : uint8_t
+    {
+        Char,
+        Split,
+        Jump,
+        Assert,
+        Match,
+    };
+    uint8_t  op;
+    uint8_t  assertion;
+    uint32_t x;
+    uint32_t y;
+};
+
+// emits the program for node. The alternatives and repeats are split in the
+// order in which boost tries them.
+bool Emit(const Node& node, std::vector<Instruction>& program)
+{
+    if (program.size() > maxProgramSize)
+        return false;
+    auto emit = [&](uint8_t op, uint8_t assertion, uint32_t x, uint32_t y) {
+        program.push_back({op, assertion, x, y});
+        return static_cast<uint32_t>(program.size() - 1);
+    };
+    auto here = [&]() { return static_cast<uint32_t>(program.size()); };
+    auto sub  = [&](const Node& child) { return Emit(child, program); };
+    const uint8_t opChar   = Instruction::Char;
+    const uint8_t opSplit  = Instruction::Split;
+    const uint8_t opJump   = Instruction::Jump;
+    const uint8_t opAssert = Instruction::Assert;
+    switch (node.type)
+    {
+        case Node::Type::Empty:
+            return true;
+        case Node::Type::Set:
+            emit(opChar, 0, node.value, 0);
+            return true;
+        case Node::Type::Assert:
+            emit(opAssert, static_cast<uint8_t>(node.value), 0, 0);
+            return true;
+        case Node::Type::Concat:
+            for (const auto& child : node.children)
+            {
+                if (!sub(*child))
+                    return false;
+            }
+            return true;
+        case Node::Type::Alternate:
+        {
+            std::vector<uint32_t> jumps;
+            for (size_t i = 0; i + 1 < node.children.size(); ++i)
+            {
+                uint32_t split = emit(opSplit, 0, here() + 1, 0);
+                if (!sub(*node.children[i]))
+                    return false;
+                jumps.push_back(emit(opJump, 0, 0, 0));
+                program[split].y = here();
+            }
+            if (!sub(*node.children.back()))
+                return false;
+            for (auto jump : jumps)
+                program[jump].x = here();
+            return true;
+        }
+        case Node::Type::Repeat:
+        {
+            const Node& child = *node.children.front();
+            for (int i = 0; i < node.min; ++i)
+            {
+                if (!sub(child))
+                    return false;
+            }
+            if (node.max < 0)
+            {
+                uint32_t split = emit(opSplit, 0, 0, 0);
+                if (!sub(child))
+                    return false;
+                emit(opJump, 0, split, 0);
+                program[split].x = node.greedy ? split + 1 : here();
+                program[split].y = node.greedy ? here() : split + 1;
+                return true;
+            }
+            // the optional repeats are nested: x(x(x)?)?
+            std::vector<uint32_t> splits;
+            for (int i = node.min; i < node.max; ++i)
+            {
+                splits.push_back(emit(opSplit, 0, 0, 0));
+                if (!sub(child))
+                    return false;
+            }
+            for (auto split : splits)
+            {
+                program[split].x = node.greedy ? split + 1 : here();
+                program[split].y = node.greedy ? here() : split + 1;
+            }
+            return program.size() <= maxProgramSize;
+        }
+    }
+    return false;
+}
+} // namespace
+
+std::unique_ptr<CLinearRegex> CLinearRegex::Compile(const std::wstring& expression, bool bCaseSensitive, bool bDotMatchesNewline, bool bWide)
+{
+    auto regex = std::unique_ptr<CLinearRegex>(new CLinearRegex());
+    auto build = [&](auto& compiler, uint32_t tableSize, bool bHigh) {
+        auto root = compiler.Parse();
+        if (!root)
+            return false;
+        std::vector<Instruction> program;
+        if (!Emit(*root, program))
+            return false;
+        program.push_back({Instruction::Match, 0, 0, 0});
+        for (const auto& inst : program)
+            regex->m_program.push_back({static_cast<Op>(inst.op), inst.assertion, inst.x, inst.y});
+
+        // the code units which are in the same sets and of the same kind
+        // get the same class. The classes are split set by set.
+        std::vector<uint32_t> units(tableSize);
+        for (uint32_t c = 0; c < tableSize; ++c)
+            units[c] = c;
+        if (bHigh)
+            units.push_back(highRepresentive);
+        auto kindOf = [&](uint32_t c) -> uint8_t {
+            if (c == '\r')
+                return KindCR;
+            if (c == '\n')
+                return KindLF;
+            if (compiler.IsSeparator(c))
+                return KindSeparator;
+            return compiler.IsWord(c) ? KindWord : KindOther;
+        };
+        std::vector<uint32_t> classes(units.size());
+        uint32_t              classCount = KindOther + 1;
+        for (size_t i = 0; i < units.size(); ++i)
+            classes[i] = kindOf(units[i]);
+        std::vector<int32_t> split;
+        for (const auto& set : compiler.m_sets)
+        {
+            split.assign(static_cast<size_t>(classCount) * 2, -1);
+            uint32_t newCount = 0;
+            for (size_t i = 0; i < units.size(); ++i)
+            {
+                auto& target = split[classes[i] * 2 + (compiler.Contains(set, units[i]) ? 1 : 0)];
+                if (target < 0)
+                    target = static_cast<int32_t>(newCount++);
+                classes[i] = static_cast<uint32_t>(target);
+            }
+            classCount = newCount;
+            if (classCount > 0xFFFF)
+                return false;
+        }
+
+        regex->m_classCount = classCount;
+        regex->m_classOf.assign(classes.begin(), classes.begin() + tableSize);
+        regex->m_highClass = bHigh ? classes.back() : 0;
+        std::vector<uint32_t> representatives(classCount, UINT32_MAX);
+        for (size_t i = 0; i < units.size(); ++i)
+        {
+            if (representatives[classes[i]] == UINT32_MAX)
+                representatives[classes[i]] = units[i];
+        }
+        regex->m_classKind.resize(classCount);
+        regex->m_setMembers.resize(compiler.m_sets.size() * classCount);
+        for (uint32_t cls = 0; cls < classCount; ++cls)
+        {
+            regex->m_classKind[cls] = kindOf(representatives[cls]);
+            for (size_t set = 0; set < compiler.m_sets.size(); ++set)
+                regex->m_setMembers[set * classCount + cls] = compiler.Contains(compiler.m_sets[set], representatives[cls]) ? 1 : 0;
+        }
+        return true;
+    };
+
+    bool bBuilt = false;
+    if (bWide)
+    {
+        CCompiler<wchar_t> compiler(expression, bCaseSensitive, bDotMatchesNewline);
+        bBuilt = build(compiler, 0x10000, sizeof(wchar_t) > 2);
+    }
+    else
+    {
+        // a narrow expression must be bytes already
+        if (std::any_of(expression.begin(), expression.end(), [](wchar_t c) { return static_cast<uint32_t>(c) > 0xFF; }))
+            return nullptr;
+        CCompiler<char> compiler(expression, bCaseSensitive, bDotMatchesNewline);
+        bBuilt = build(compiler, 0x100, false);
+    }
+    if (!bBuilt)
+        return nullptr;
+    regex->m_visited.assign(regex->m_program.size(), 0);
+    return regex;
+}
+
+bool CLinearRegex::AssertionHolds(uint8_t assertion, uint8_t prevKind, uint8_t nextKind) const
+{
+    auto isSeparator = [](uint8_t kind) { return kind == KindCR || kind == KindLF || kind == KindSeparator; };
+    bool bInCrLf     = prevKind == KindCR && nextKind == KindLF;
+    switch (assertion)
+    {
+        case AssertLineStart:
+            return prevKind == KindNone || (isSeparator(prevKind) && !bInCrLf);
+        case AssertLineEnd:
+            return nextKind == KindNone || (isSeparator(nextKind) && !bInCrLf);
+        case AssertWordBoundary:
+            return (prevKind == KindWord) != (nextKind == KindWord);
+        case AssertNotWordBoundary:
+            return prevKind != KindNone && nextKind != KindNone && (prevKind == KindWord) == (nextKind == KindWord);
+        case AssertWordStart:
+            return prevKind != KindWord && nextKind == KindWord;
+        case AssertWordEnd:
+            return prevKind == KindWord && nextKind != KindWord;
+        case AssertBufferStart:
+            return prevKind == KindNone;
+        case AssertBufferEnd:
+            return nextKind == KindNone;
+        default:
+            return false;
+    }
+}
+
+int32_t CLinearRegex::StateFor(const std::vector<uint32_t>& kernel, uint8_t prevKind)
+{
+    std::vector<uint32_t> key = kernel;
+    key.push_back(prevKind);
+    auto it = m_stateIds.find(key);
+    if (it != m_stateIds.end())
+        return it->second;
+    auto id = static_cast<int32_t>(m_states.size());
+    m_states.push_back({kernel, prevKind});
+    m_stateEmpty.push_back(kernel.empty() ? 1 : 0);
+    m_transitions.resize(m_transitions.size() + m_classCount + 1, -1);
+    m_stateIds.emplace(std::move(key), id);
+    return id;
+}
+
+int32_t CLinearRegex::ComputeTransition(int32_t& state, uint32_t cls)
+{
+    const size_t columns = static_cast<size_t>(m_classCount) + 1;
+    if (m_transitions.size() + columns > maxTransitions)
+    {
+        // rebuilding states costs time, but it is still linear
+        State current = m_states[state];
+        m_states.clear();
+        m_stateEmpty.clear();
+        m_transitions.clear();
+        m_stateIds.clear();
+        state = StateFor(current.kernel, current.prevKind);
+    }
+
+    // all instructions the kernel and a new match lead to before cls
+    uint8_t prevKind = m_states[state].prevKind;
+    uint8_t nextKind = cls < m_classCount ? m_classKind[cls] : static_cast<uint8_t>(KindNone);
+    bool    bMatch   = false;
+    ++m_generation;
+    m_nextKernel.clear();
+    m_stack.assign(m_states[state].kernel.rbegin(), m_states[state].kernel.rend());
+    m_stack.push_back(0);
+    while (!m_stack.empty())
+    {
+        uint32_t pc = m_stack.back();
+        m_stack.pop_back();
+        if (m_visited[pc] == m_generation)
+            continue;
+        m_visited[pc]     = m_generation;
+        const Inst& inst  = m_program[pc];
+        switch (inst.op)
+        {
+            case Op::Char:
+                if (cls < m_classCount && IsMember(inst.x, cls))
+                    m_nextKernel.push_back(pc + 1);
+                break;
+            case Op::Split:
+                m_stack.push_back(inst.y);
+                m_stack.push_back(inst.x);
+                break;
+            case Op::Jump:
+                m_stack.push_back(inst.x);
+                break;
+            case Op::Assert:
+                if (AssertionHolds(inst.assertion, prevKind, nextKind))
+                    m_stack.push_back(pc + 1);
+                break;
+            case Op::Match:
+                bMatch = true;
+                break;
+        }
+    }
+    std::sort(m_nextKernel.begin(), m_nextKernel.end());
+    int32_t next       = cls < m_classCount ? StateFor(m_nextKernel, m_classKind[cls]) : 0;
+    int32_t transition = (next << 1) | (bMatch ? 1 : 0);
+    m_transitions[static_cast<size_t>(state) * columns + cls] = transition;
+    return transition;
+}
+
+bool CLinearRegex::AddThread(uint32_t pc, size_t start, uint32_t cls, uint8_t prevKind, uint8_t nextKind)
+{
+    m_stack.clear();
+    m_stack.push_back(pc);
+    while (!m_stack.empty())
+    {
+        pc = m_stack.back();
+        m_stack.pop_back();
+        if (m_visited[pc] == m_generation)
+            continue;
+        m_visited[pc]    = m_generation;
+        const Inst& inst = m_program[pc];
+        switch (inst.op)
+        {
+            case Op::Char:
+                if (cls < m_classCount && IsMember(inst.x, cls))
+                    m_nextThreads.push_back({pc + 1, start});
+                break;
+            case Op::Split:
+                m_stack.push_back(inst.y);
+                m_stack.push_back(inst.x);
+                break;
+            case Op::Jump:
+                m_stack.push_back(inst.x);
+                break;
+            case Op::Assert:
+                if (AssertionHolds(inst.assertion, prevKind, nextKind))
+                    m_stack.push_back(pc + 1);
+                break;
+            case Op::Match:
+                return true;
+        }
+    }
+    return false;
+}
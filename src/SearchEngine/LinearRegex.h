@@ -0,0 +1,222 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// a regex engine for the expressions which need no backtracking. It finds
+// the same matches as boost::regex, but in time linear in the length of the
+// text, where boost can take exponential time on some expressions and texts.
+//
+// A DFA, built lazily from the NFA of the expression while the text is
+// scanned, finds where the first match ends. An NFA simulation (a Pike VM,
+// which follows all alternatives at once, in the order boost tries them)
+// then finds the bounds of that match, from the last position where no
+// match was in progress.
+//
+// Back references, look-ahead and look-behind, independent sub-expressions,
+// possessive repeats, recursion, inline options like (?i), named groups,
+// \Q..\E, \G, \Z, \K and \p are not supported: Compile() returns nullptr
+// for them and boost has to search.
+//
+// The DFA states are kept in the object for the next search, so it must
+// only be used by one thread at a time.
+class CLinearRegex
+{
+public:
+    // bWide: the text is wchar_t, with the classes and the case folding of
+    // boost::wregex, else bytes as boost::regex sees them.
+    // Returns nullptr if the expression uses anything the engine does not
+    // support, or if it is too big.
+    static std::unique_ptr<CLinearRegex> Compile(const std::wstring& expression, bool bCaseSensitive, bool bDotMatchesNewline, bool bWide);
+
+    // finds the first match in [first, last) like boost::regex_search(first,
+    // last, what, expression, flags, base) does with the flags the search
+    // engine uses: last is the end of the text for $ and \b, and the text
+    // between base and first is there for ^ and \b.
+    template <typename CharT>
+    bool Search(const CharT* first, const CharT* last, const CharT* base, const CharT*& matchFirst, const CharT*& matchLast);
+
+private:
+    enum class Op : uint8_t
+    {
+        Char,   // consumes a code unit of set x
+        Split,  // goes on at x, and with less priority at y
+        Jump,   // goes on at x
+        Assert, // goes on if the assertion holds
+        Match,
+    };
+    struct Inst
+    {
+        Op       op;
+        uint8_t  assertion;
+        uint32_t x;
+        uint32_t y;
+    };
+    // what the assertions need to know of the code units around a position
+    enum Kind : uint8_t
+    {
+        KindNone, // the start or the end of the text
+        KindCR,
+        KindLF,
+        KindSeparator, // the other line separators
+        KindWord,
+        KindOther,
+    };
+    struct State
+    {
+        // the instructions which follow a consumed code unit
+        std::vector<uint32_t> kernel;
+        uint8_t               prevKind;
+    };
+    // a thread of the Pike VM: where it is, and where its match started
+    struct Thread
+    {
+        uint32_t pc;
+        size_t   start;
+    };
+
+    CLinearRegex() = default;
+
+    uint32_t ClassOf(uint32_t codeUnit) const { return codeUnit < m_classOf.size() ? m_classOf[codeUnit] : m_highClass; }
+    bool     IsMember(uint32_t set, uint32_t cls) const { return m_setMembers[static_cast<size_t>(set) * m_classCount + cls] != 0; }
+    bool     AssertionHolds(uint8_t assertion, uint8_t prevKind, uint8_t nextKind) const;
+
+    int32_t  StateFor(const std::vector<uint32_t>& kernel, uint8_t prevKind);
+    // computes and stores the transition of state on cls, m_classCount for
+    // the end of the text. If the cache is full, it is emptied first and
+    // state is changed to the same state in the new cache.
+    int32_t  ComputeTransition(int32_t& state, uint32_t cls);
+    // adds the threads which pc leads to without consuming a code unit to
+    // m_nextThreads, in the order of their priority. Returns true if one of
+    // them is a match: the threads with less priority are not needed then.
+    bool     AddThread(uint32_t pc, size_t start, uint32_t cls, uint8_t prevKind, uint8_t nextKind);
+
+    template <typename CharT>
+    bool                                     RunPikeVm(const CharT* from, const CharT* last, const CharT* base, const CharT*& matchFirst, const CharT*& matchLast);
+
+    std::vector<Inst>                        m_program;
+    // the class of each code unit in the table, m_highClass for the others
+    std::vector<uint16_t>                    m_classOf;
+    uint32_t                                 m_highClass  = 0;
+    uint32_t                                 m_classCount = 0;
+    std::vector<uint8_t>                     m_classKind;
+    // per set and class: whether the code units of the class are in the set
+    std::vector<uint8_t>                     m_setMembers;
+
+    // the DFA states found so far. Per state and class (plus one column for
+    // the end of the text): the next state << 1 | 1 if a match ends before
+    // the code unit, -1 if not computed yet
+    std::vector<State>                       m_states;
+    std::vector<uint8_t>                     m_stateEmpty;
+    std::vector<int32_t>                     m_transitions;
+    std::map<std::vector<uint32_t>, int32_t> m_stateIds;
+
+    // the Pike VM threads, and which instructions were already visited at
+    // the current position
+    std::vector<Thread>                      m_threads;
+    std::vector<Thread>                      m_nextThreads;
+    std::vector<uint32_t>                    m_stack;
+    std::vector<uint32_t>                    m_nextKernel;
+    std::vector<size_t>                      m_visited;
+    size_t                                   m_generation = 0;
+};
+
+template <typename CharT>
+bool CLinearRegex::Search(const CharT* first, const CharT* last, const CharT* base, const CharT*& matchFirst, const CharT*& matchLast)
+{
+    using UnitT             = std::make_unsigned_t<CharT>;
+    const size_t columns    = static_cast<size_t>(m_classCount) + 1;
+    uint8_t      prevKind   = first > base ? m_classKind[ClassOf(static_cast<UnitT>(first[-1]))] : static_cast<uint8_t>(KindNone);
+    int32_t      state      = StateFor({}, prevKind);
+    // no match which starts before this position is in progress
+    const CharT* restart    = first;
+    int32_t      transition = 0;
+    const CharT* pos        = first;
+    for (; pos < last; ++pos)
+    {
+        if (m_stateEmpty[state])
+            restart = pos;
+        uint32_t cls = ClassOf(static_cast<UnitT>(*pos));
+        transition   = m_transitions[static_cast<size_t>(state) * columns + cls];
+        if (transition < 0)
+            transition = ComputeTransition(state, cls);
+        if (transition & 1)
+            break;
+        state = transition >> 1;
+    }
+    if (pos == last)
+    {
+        if (m_stateEmpty[state])
+            restart = last;
+        transition = m_transitions[static_cast<size_t>(state) * columns + m_classCount];
+        if (transition < 0)
+            transition = ComputeTransition(state, m_classCount);
+        if ((transition & 1) == 0)
+            return false;
+    }
+    return RunPikeVm(restart, last, base, matchFirst, matchLast);
+}
+
+template <typename CharT>
+bool CLinearRegex::RunPikeVm(const CharT* from, const CharT* last, const CharT* base, const CharT*& matchFirst, const CharT*& matchLast)
+{
+    using UnitT   = std::make_unsigned_t<CharT>;
+    bool bMatched = false;
+    m_threads.clear();
+    for (const CharT* pos = from;; ++pos)
+    {
+        uint8_t  prevKind = pos > base ? m_classKind[ClassOf(static_cast<UnitT>(pos[-1]))] : static_cast<uint8_t>(KindNone);
+        uint32_t cls      = pos < last ? ClassOf(static_cast<UnitT>(*pos)) : m_classCount;
+        uint8_t  nextKind = pos < last ? m_classKind[cls] : static_cast<uint8_t>(KindNone);
+        size_t   offset   = static_cast<size_t>(pos - from);
+
+        // the threads go on in the order of their priority. A match cuts off
+        // all threads with less priority, and no new match may start then
+        ++m_generation;
+        m_nextThreads.clear();
+        bool bCut = false;
+        for (const auto& thread : m_threads)
+        {
+            if (AddThread(thread.pc, thread.start, cls, prevKind, nextKind))
+            {
+                bMatched   = true;
+                matchFirst = from + thread.start;
+                matchLast  = pos;
+                bCut       = true;
+                break;
+            }
+        }
+        if (!bCut && !bMatched && AddThread(0, offset, cls, prevKind, nextKind))
+        {
+            bMatched   = true;
+            matchFirst = pos;
+            matchLast  = pos;
+        }
+        if (pos == last || m_nextThreads.empty())
+            return bMatched;
+        m_threads.swap(m_nextThreads);
+    }
+}
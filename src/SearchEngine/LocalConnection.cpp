@@ -0,0 +1,297 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "LocalConnection.h"
+#include "UnicodeUtils.h"
+
+#include <algorithm>
+#include <utility>
+
+#ifndef _WIN32
+#    include <cerrno>
+#    include <cstring>
+#    include <sys/socket.h>
+#    include <sys/stat.h>
+#    include <sys/un.h>
+#    include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+constexpr DWORD pipeBufferSize = 64 * 1024;
+
+HANDLE          CreatePipeInstance(const std::wstring& endpoint, bool bFirst)
+{
+    DWORD openMode = PIPE_ACCESS_DUPLEX;
+    if (bFirst)
+        openMode |= FILE_FLAG_FIRST_PIPE_INSTANCE;
+    return CreateNamedPipeW(endpoint.c_str(), openMode,
+                            PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                            PIPE_UNLIMITED_INSTANCES, pipeBufferSize, pipeBufferSize, 0, nullptr);
+}
+#else
+bool MakeSocketAddress(const std::wstring& endpoint, sockaddr_un& address)
+{
+    auto path = CUnicodeUtils::StdGetUTF8(endpoint);
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+        return false;
+    address            = {};
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+#endif
+} // namespace
+
+CLocalConnection::CLocalConnection()
+    : m_handle(invalidLocalHandle)
+{
+}
+
+CLocalConnection::CLocalConnection(LocalHandle handle)
+    : m_handle(handle)
+{
+}
+
+CLocalConnection::~CLocalConnection()
+{
+    Close();
+}
+
+CLocalConnection::CLocalConnection(CLocalConnection&& other) noexcept
+    : m_handle(std::exchange(other.m_handle, invalidLocalHandle))
+{
+}
+
+CLocalConnection& CLocalConnection::operator=(CLocalConnection&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        m_handle = std::exchange(other.m_handle, invalidLocalHandle);
+    }
+    return *this;
+}
+
+CLocalConnection CLocalConnection::Connect(const std::wstring& endpoint)
+{
+#ifdef _WIN32
+    for (int retry = 0; retry < 50; ++retry)
+    {
+        HANDLE hPipe = CreateFileW(endpoint.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (hPipe != INVALID_HANDLE_VALUE)
+            return CLocalConnection(hPipe);
+        // all instances are busy: the server creates a new one right after
+        // it accepted a client
+        if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeW(endpoint.c_str(), 100))
+            break;
+    }
+    return {};
+#else
+    sockaddr_un address;
+    if (!MakeSocketAddress(endpoint, address))
+        return {};
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return {};
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        close(fd);
+        return {};
+    }
+    return CLocalConnection(fd);
+#endif
+}
+
+bool CLocalConnection::Read(void* buffer, size_t size)
+{
+    auto* pBuffer = static_cast<char*>(buffer);
+    while (size > 0 && IsValid())
+    {
+#ifdef _WIN32
+        DWORD read = 0;
+        if (!ReadFile(m_handle, pBuffer, static_cast<DWORD>(std::min<size_t>(size, pipeBufferSize)), &read, nullptr) || read == 0)
+            return false;
+#else
+        ssize_t read = recv(m_handle, pBuffer, size, 0);
+        if (read < 0 && errno == EINTR)
+            continue;
+        if (read <= 0)
+            return false;
+#endif
+        pBuffer += read;
+        size -= static_cast<size_t>(read);
+    }
+    return size == 0;
+}
+
+bool CLocalConnection::Write(const void* buffer, size_t size)
+{
+    const auto* pBuffer = static_cast<const char*>(buffer);
+    while (size > 0 && IsValid())
+    {
+#ifdef _WIN32
+        DWORD written = 0;
+        if (!WriteFile(m_handle, pBuffer, static_cast<DWORD>(std::min<size_t>(size, pipeBufferSize)), &written, nullptr))
+            return false;
+#else
+        // no SIGPIPE if the other side is gone, just an error
+        ssize_t written = send(m_handle, pBuffer, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+#endif
+        pBuffer += written;
+        size -= static_cast<size_t>(written);
+    }
+    return size == 0;
+}
+
+void CLocalConnection::Close()
+{
+    if (!IsValid())
+        return;
+#ifdef _WIN32
+    // let the other side read everything before the pipe goes away
+    FlushFileBuffers(m_handle);
+    CloseHandle(m_handle);
+#else
+    close(m_handle);
+#endif
+    m_handle = invalidLocalHandle;
+}
+
+CLocalListener::CLocalListener()
+    : m_handle(invalidLocalHandle)
+    , m_stopped(false)
+{
+}
+
+CLocalListener::~CLocalListener()
+{
+    Stop();
+#ifdef _WIN32
+    if (m_handle != INVALID_HANDLE_VALUE)
+        CloseHandle(m_handle);
+#else
+    if (m_handle >= 0)
+    {
+        close(m_handle);
+        unlink(CUnicodeUtils::StdGetUTF8(m_endpoint).c_str());
+    }
+#endif
+}
+
+bool CLocalListener::Listen(const std::wstring& endpoint, std::wstring& error)
+{
+    m_endpoint = endpoint;
+#ifdef _WIN32
+    // the first instance fails if another server owns the name already
+    m_handle = CreatePipeInstance(endpoint, true);
+    if (m_handle == INVALID_HANDLE_VALUE)
+    {
+        error = L"can not listen on " + endpoint + L": another server is running or the name is invalid";
+        return false;
+    }
+#else
+    sockaddr_un address;
+    if (!MakeSocketAddress(endpoint, address))
+    {
+        error = L"invalid socket path: " + endpoint;
+        return false;
+    }
+    if (CLocalConnection::Connect(endpoint).IsValid())
+    {
+        error = L"another server is already listening on " + endpoint;
+        return false;
+    }
+    // a socket file left over by a server that did not stop cleanly
+    unlink(address.sun_path);
+
+    m_handle = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    // only the user running the server may connect
+    auto oldMask = umask(0077);
+    bool bOk     = m_handle >= 0 &&
+               bind(m_handle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0 &&
+               listen(m_handle, SOMAXCONN) == 0;
+    umask(oldMask);
+    if (!bOk)
+    {
+        error = L"can not listen on " + endpoint + L": " + CUnicodeUtils::StdGetUnicode(strerror(errno));
+        if (m_handle >= 0)
+            close(m_handle);
+        m_handle = invalidLocalHandle;
+        return false;
+    }
+#endif
+    return true;
+}
+
+CLocalConnection CLocalListener::Accept()
+{
+    if (m_stopped)
+        return {};
+#ifdef _WIN32
+    while (!m_stopped)
+    {
+        HANDLE hPipe = std::exchange(m_handle, invalidLocalHandle);
+        if (hPipe == INVALID_HANDLE_VALUE)
+            hPipe = CreatePipeInstance(m_endpoint, false);
+        if (hPipe == INVALID_HANDLE_VALUE)
+            return {};
+        bool bConnected = ConnectNamedPipe(hPipe, nullptr) || GetLastError() == ERROR_PIPE_CONNECTED;
+        if (bConnected && !m_stopped)
+            return CLocalConnection(hPipe);
+        // the client went away before it was accepted
+        CloseHandle(hPipe);
+    }
+    return {};
+#else
+    for (;;)
+    {
+        int fd = accept4(m_handle, nullptr, nullptr, SOCK_CLOEXEC);
+        if (m_stopped)
+        {
+            if (fd >= 0)
+                close(fd);
+            return {};
+        }
+        if (fd >= 0)
+            return CLocalConnection(fd);
+        if (errno != EINTR && errno != ECONNABORTED)
+            return {};
+    }
+#endif
+}
+
+void CLocalListener::Stop()
+{
+    if (m_stopped.exchange(true))
+        return;
+    // wake up a waiting Accept(), the handles are closed in the destructor
+#ifdef _WIN32
+    if (!m_endpoint.empty())
+        CLocalConnection::Connect(m_endpoint);
+#else
+    if (m_handle >= 0)
+        shutdown(m_handle, SHUT_RDWR);
+#endif
+}
@@ -0,0 +1,83 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+// the local transport between the search server and its clients:
+// a named pipe on Windows, a unix domain socket everywhere else.
+// Neither accepts connections from other machines.
+#ifdef _WIN32
+using LocalHandle                           = HANDLE;
+// not constexpr: INVALID_HANDLE_VALUE is a cast
+inline const LocalHandle invalidLocalHandle = INVALID_HANDLE_VALUE;
+#else
+using LocalHandle                        = int;
+constexpr LocalHandle invalidLocalHandle = -1;
+#endif
+
+class CLocalConnection
+{
+public:
+    CLocalConnection();
+    explicit CLocalConnection(LocalHandle handle);
+    ~CLocalConnection();
+
+    CLocalConnection(CLocalConnection&& other) noexcept;
+    CLocalConnection& operator=(CLocalConnection&& other) noexcept;
+    CLocalConnection(const CLocalConnection&)            = delete;
+    CLocalConnection& operator=(const CLocalConnection&) = delete;
+
+    // connects to a listening server, returns an invalid connection on failure
+    static CLocalConnection Connect(const std::wstring& endpoint);
+
+    bool                    IsValid() const { return m_handle != invalidLocalHandle; }
+    // both block until all of the data is transferred
+    bool                    Read(void* buffer, size_t size);
+    bool                    Write(const void* buffer, size_t size);
+    void                    Close();
+
+private:
+    LocalHandle m_handle;
+};
+
+class CLocalListener
+{
+public:
+    CLocalListener();
+    ~CLocalListener();
+
+    CLocalListener(const CLocalListener&)            = delete;
+    CLocalListener& operator=(const CLocalListener&) = delete;
+
+    // fails if another server already listens on the endpoint
+    bool                Listen(const std::wstring& endpoint, std::wstring& error);
+    // blocks until a client connects; an invalid connection after Stop()
+    CLocalConnection    Accept();
+    // may be called from any thread
+    void                Stop();
+
+private:
+    std::wstring        m_endpoint;
+    LocalHandle         m_handle;
+    std::atomic_bool    m_stopped;
+};
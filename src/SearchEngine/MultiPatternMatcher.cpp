@@ -0,0 +1,182 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "MultiPatternMatcher.h"
+#include "UnicodeUtils.h"
+
+#include <cwctype>
+#include <deque>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+uint32_t FoldCase(uint32_t codeUnit, bool bWide)
+{
+    if (bWide)
+        return static_cast<uint32_t>(towlower(static_cast<wint_t>(codeUnit)));
+    return (codeUnit >= 'A' && codeUnit <= 'Z') ? codeUnit + ('a' - 'A') : codeUnit;
+}
+
+uint32_t UpperCase(uint32_t codeUnit, bool bWide)
+{
+    if (bWide)
+        return static_cast<uint32_t>(towupper(static_cast<wint_t>(codeUnit)));
+    return (codeUnit >= 'a' && codeUnit <= 'z') ? codeUnit - ('a' - 'A') : codeUnit;
+}
+} // namespace
+
+CMultiPatternMatcher::CMultiPatternMatcher(const std::vector<std::wstring>& patterns, bool bCaseSensitive, bool bWholeWords)
+    : m_patterns(patterns)
+    , m_bWholeWords(bWholeWords)
+{
+    std::vector<std::u32string> narrowPatterns;
+    std::vector<std::u32string> widePatterns;
+    for (const auto& pattern : m_patterns)
+    {
+        std::string utf8 = CUnicodeUtils::StdGetUTF8(pattern);
+        narrowPatterns.emplace_back(utf8.begin(), utf8.end());
+        for (auto& c : narrowPatterns.back())
+            c &= 0xFF;
+        widePatterns.emplace_back(pattern.begin(), pattern.end());
+    }
+    m_narrow.Build(narrowPatterns, bCaseSensitive, false);
+    m_wide.Build(widePatterns, bCaseSensitive, true);
+}
+
+void CMultiPatternMatcher::CAutomaton::SetClass(uint32_t codeUnit, uint32_t cls)
+{
+    if (codeUnit < m_classes.size())
+        m_classes[codeUnit] = cls;
+    else
+        m_highClasses[codeUnit] = cls;
+}
+
+void CMultiPatternMatcher::CAutomaton::Build(const std::vector<std::u32string>& patterns, bool bCaseSensitive, bool bWide)
+{
+    // the code units of the patterns get a class each, both cases of a
+    // letter the same one. All others share class 0.
+    m_classes.assign(bWide ? 0x10000 : 0x100, 0);
+    m_highClasses.clear();
+    m_classCount = 1;
+    for (const auto& pattern : patterns)
+    {
+        for (auto c : pattern)
+        {
+            uint32_t folded = bCaseSensitive ? c : FoldCase(c, bWide);
+            if (ClassOf(folded) != 0)
+                continue;
+            uint32_t cls = m_classCount++;
+            SetClass(folded, cls);
+            if (!bCaseSensitive && UpperCase(folded, bWide) != folded)
+                SetClass(UpperCase(folded, bWide), cls);
+        }
+    }
+
+    // the trie of the patterns
+    m_transitions.assign(m_classCount, -1);
+    m_depth.assign(1, 0);
+    m_output.assign(1, -1);
+    m_lengths.assign(patterns.size(), 0);
+    for (size_t i = 0; i < patterns.size(); ++i)
+    {
+        if (patterns[i].empty())
+            continue;
+        int32_t state = 0;
+        for (auto c : patterns[i])
+        {
+            size_t  slot = static_cast<size_t>(state) * m_classCount + ClassOf(bCaseSensitive ? c : FoldCase(c, bWide));
+            int32_t next = m_transitions[slot];
+            if (next < 0)
+            {
+                next = static_cast<int32_t>(m_depth.size());
+                m_transitions[slot] = next;
+                m_transitions.resize(m_transitions.size() + m_classCount, -1);
+                m_depth.push_back(m_depth[state] + 1);
+                m_output.push_back(-1);
+            }
+            state = next;
+        }
+        // of two equal patterns, the first one is reported
+        if (m_output[state] < 0)
+            m_output[state] = static_cast<int32_t>(i);
+        m_lengths[i] = static_cast<uint32_t>(patterns[i].size());
+    }
+
+    // the failure links, breadth first, turned into complete transitions so
+    // that the search never has to follow them
+    std::vector<int32_t> failure(m_depth.size(), 0);
+    m_outputLink.assign(m_depth.size(), -1);
+    std::deque<int32_t> queue;
+    for (uint32_t cls = 0; cls < m_classCount; ++cls)
+    {
+        int32_t& next = m_transitions[cls];
+        if (next < 0)
+            next = 0;
+        else
+            queue.push_back(next);
+    }
+    while (!queue.empty())
+    {
+        int32_t state = queue.front();
+        queue.pop_front();
+        size_t row     = static_cast<size_t>(state) * m_classCount;
+        size_t failRow = static_cast<size_t>(failure[state]) * m_classCount;
+        for (uint32_t cls = 0; cls < m_classCount; ++cls)
+        {
+            int32_t next = m_transitions[row + cls];
+            if (next < 0)
+            {
+                m_transitions[row + cls] = m_transitions[failRow + cls];
+                continue;
+            }
+            int32_t nextFailure = m_transitions[failRow + cls];
+            failure[next]       = nextFailure;
+            m_outputLink[next]  = m_output[nextFailure] >= 0 ? nextFailure : m_outputLink[nextFailure];
+            queue.push_back(next);
+        }
+    }
+}
+
+bool CMultiPatternMatcher::ReadPatternFile(const std::wstring& path, std::vector<std::wstring>& patterns)
+{
+    std::ifstream file(PlatformPath(path), std::ios::binary);
+    if (!file.is_open())
+        return false;
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (file.bad())
+        return false;
+    if (content.starts_with("\xEF\xBB\xBF"))
+        content.erase(0, 3);
+
+    size_t lineStart = 0;
+    while (lineStart < content.size())
+    {
+        size_t lineEnd = content.find('\n', lineStart);
+        if (lineEnd == std::string::npos)
+            lineEnd = content.size();
+        size_t end = lineEnd;
+        if (end > lineStart && content[end - 1] == '\r')
+            --end;
+        if (end > lineStart)
+            patterns.push_back(CUnicodeUtils::StdGetUnicode(content.substr(lineStart, end - lineStart)));
+        lineStart = lineEnd + 1;
+    }
+    return true;
+}
@@ -0,0 +1,167 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+
+#include <cstdint>
+#include <cwctype>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// finds any of a list of literal patterns in one pass over a text, with an
+// Aho-Corasick automaton. The time does not depend on the number of
+// patterns, unlike a regex alternation which tries them one after the other.
+//
+// Matches do not overlap. Of the matches which start at the same position
+// the longest wins, like a regex alternation with the longer patterns first.
+// Without bCaseSensitive the case of letters is ignored; the narrow
+// automaton (for 8-bit text) only knows the case of ASCII letters.
+class CMultiPatternMatcher
+{
+public:
+    struct Match
+    {
+        size_t position; // in code units of the text
+        size_t length;
+        size_t pattern; // the index in the pattern list
+    };
+
+    // empty patterns are ignored
+    CMultiPatternMatcher(const std::vector<std::wstring>& patterns, bool bCaseSensitive, bool bWholeWords);
+
+    // calls onMatch(const Match&) for every match in order, until it returns
+    // false. char text is taken as UTF-8, wchar_t text as the patterns are.
+    template <typename CharT, typename Fn>
+    void                       Find(const CharT* text, size_t size, Fn onMatch) const;
+
+    size_t                     PatternCount() const { return m_patterns.size(); }
+    const std::wstring&        Pattern(size_t index) const { return m_patterns[index]; }
+
+    // one pattern per line of a UTF-8 text file, empty lines are skipped.
+    // Returns false if the file can't be read.
+    static bool                ReadPatternFile(const std::wstring& path, std::vector<std::wstring>& patterns);
+
+private:
+    // the automaton for one kind of code unit: the transitions of every
+    // state for every class of code units which appears in the patterns
+    class CAutomaton
+    {
+    public:
+        // bWide: the code units are wchar_t, else bytes
+        void     Build(const std::vector<std::u32string>& patterns, bool bCaseSensitive, bool bWide);
+
+        uint32_t ClassOf(uint32_t codeUnit) const
+        {
+            if (codeUnit < m_classes.size())
+                return m_classes[codeUnit];
+            auto it = m_highClasses.find(codeUnit);
+            return it == m_highClasses.end() ? 0 : it->second;
+        }
+        int32_t Next(int32_t state, uint32_t codeUnit) const { return m_transitions[static_cast<size_t>(state) * m_classCount + ClassOf(codeUnit)]; }
+
+        // per state: the number of code units from the root
+        std::vector<uint32_t> m_depth;
+        // per state: the pattern which ends here, -1 if none
+        std::vector<int32_t>  m_output;
+        // per state: the next state on the failure chain which has an output, -1 if none
+        std::vector<int32_t>  m_outputLink;
+        // per pattern: its length in code units
+        std::vector<uint32_t> m_lengths;
+
+    private:
+        void                                   SetClass(uint32_t codeUnit, uint32_t cls);
+
+        std::vector<uint32_t>                  m_classes;
+        std::unordered_map<uint32_t, uint32_t> m_highClasses;
+        uint32_t                               m_classCount = 1; // class 0: not in any pattern
+        std::vector<int32_t>                   m_transitions;
+    };
+
+    template <typename CharT, typename Fn>
+    void                      Find(const CAutomaton& automaton, const CharT* text, size_t size, Fn onMatch) const;
+
+    std::vector<std::wstring> m_patterns;
+    bool                      m_bWholeWords;
+    CAutomaton                m_narrow;
+    CAutomaton                m_wide;
+};
+
+template <typename CharT, typename Fn>
+void CMultiPatternMatcher::Find(const CharT* text, size_t size, Fn onMatch) const
+{
+    if constexpr (sizeof(CharT) == 1)
+        Find(m_narrow, text, size, onMatch);
+    else
+        Find(m_wide, text, size, onMatch);
+}
+
+template <typename CharT, typename Fn>
+void CMultiPatternMatcher::Find(const CAutomaton& automaton, const CharT* text, size_t size, Fn onMatch) const
+{
+    using UnitT     = std::make_unsigned_t<CharT>;
+    auto isWordChar = [](UnitT c) {
+        if constexpr (sizeof(CharT) == 1)
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c >= 0x80;
+        else
+            return c == L'_' || iswalnum(static_cast<wint_t>(c)) != 0;
+    };
+    auto isWholeWord = [&](size_t start, size_t end) {
+        return (start == 0 || !isWordChar(static_cast<UnitT>(text[start - 1]))) &&
+               (end == size || !isWordChar(static_cast<UnitT>(text[end])));
+    };
+
+    // the leftmost (and then longest) match found so far. It is reported as
+    // soon as no match which starts before or at it can follow anymore.
+    bool    bHaveBest = false;
+    Match   best      = {};
+    int32_t state     = 0;
+    size_t  pos       = 0;
+    while (pos < size || bHaveBest)
+    {
+        if (pos < size)
+        {
+            state = automaton.Next(state, static_cast<UnitT>(text[pos]));
+            ++pos;
+            for (int32_t s = automaton.m_output[state] >= 0 ? state : automaton.m_outputLink[state]; s >= 0; s = automaton.m_outputLink[s])
+            {
+                auto   pattern = static_cast<size_t>(automaton.m_output[s]);
+                size_t length  = automaton.m_lengths[pattern];
+                size_t start   = pos - length;
+                if (bHaveBest && (start > best.position || (start == best.position && length <= best.length)))
+                    continue;
+                if (m_bWholeWords && !isWholeWord(start, pos))
+                    continue;
+                best      = {start, length, pattern};
+                bHaveBest = true;
+            }
+        }
+        // a match that could still follow starts after the best one
+        if (bHaveBest && (pos >= size || pos - automaton.m_depth[state] > best.position))
+        {
+            if (!onMatch(best))
+                return;
+            // the matches that end after it were only looked at for this one
+            pos       = best.position + best.length;
+            state     = 0;
+            bHaveBest = false;
+        }
+    }
+}
@@ -0,0 +1,90 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "ReadAhead.h"
+
+#include <algorithm>
+
+#ifndef _WIN32
+#    include <sys/mman.h>
+#endif
+
+namespace
+{
+// smaller data is read at the first touch anyway, or is not mapped at all
+constexpr size_t minReadAheadSize = 1024 * 1024;
+// how far the reads run ahead of the scan, and the size of each of them.
+// A window of two search blocks keeps the next block coming in while the
+// current one is searched.
+constexpr size_t readAheadWindow  = 2 * static_cast<size_t>(SEARCHBLOCKSIZE);
+constexpr size_t readAheadChunk   = 8 * 1024 * 1024;
+
+#ifdef _WIN32
+using PrefetchVirtualMemoryFn = BOOL(WINAPI*)(HANDLE, ULONG_PTR, PWIN32_MEMORY_RANGE_ENTRY, ULONG);
+
+// not available before Windows 8
+PrefetchVirtualMemoryFn GetPrefetchVirtualMemory()
+{
+    static PrefetchVirtualMemoryFn prefetch = reinterpret_cast<PrefetchVirtualMemoryFn>(GetProcAddress(GetModuleHandle(L"kernel32.dll"), "PrefetchVirtualMemory"));
+    return prefetch;
+}
+#endif
+} // namespace
+
+CReadAhead::CReadAhead(const char* data, size_t size)
+    : m_data(data)
+    , m_size(size)
+    , m_requested(0)
+{
+    if (m_size < minReadAheadSize)
+    {
+        m_requested = m_size;
+        return;
+    }
+    Advance(m_data);
+}
+
+void CReadAhead::Advance(const char* position)
+{
+    size_t offset = static_cast<size_t>(std::max(position, m_data) - m_data);
+    size_t target = std::min(m_size, offset + readAheadWindow);
+    while (m_requested < target)
+    {
+        size_t length = std::min(readAheadChunk, m_size - m_requested);
+        Request(m_requested, length);
+        m_requested += length;
+    }
+}
+
+void CReadAhead::Request(size_t offset, size_t length) const
+{
+#ifdef _WIN32
+    auto prefetch = GetPrefetchVirtualMemory();
+    if (prefetch == nullptr)
+        return;
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<char*>(m_data + offset);
+    range.NumberOfBytes  = length;
+    prefetch(GetCurrentProcess(), 1, &range, 0);
+#else
+    // the data of a mapping starts on a page, and every chunk but the last
+    // is a multiple of a page
+    madvise(const_cast<char*>(m_data + offset), length, MADV_WILLNEED);
+#endif
+}
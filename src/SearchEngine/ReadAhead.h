@@ -0,0 +1,46 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+
+#include <cstddef>
+
+// keeps the part of a mapped file just ahead of a sequential scan being
+// read in the background, so that the scan does not wait for a page fault
+// every few KB on a cold cache or a network drive.
+// The reads are issued asynchronously by the system: PrefetchVirtualMemory
+// on Windows, madvise(MADV_WILLNEED) elsewhere. Pages that are already in
+// memory cost nothing, so the mapping stays the fast path for warm caches.
+class CReadAhead
+{
+public:
+    // requests the first window of data right away
+    CReadAhead(const char* data, size_t size);
+
+    // the scan reached position: requests everything up to a window ahead
+    void Advance(const char* position);
+
+private:
+    void Request(size_t offset, size_t length) const;
+
+    const char* m_data;
+    size_t      m_size;
+    // everything before that was requested already
+    size_t      m_requested;
+};
@@ -19,13 +19,20 @@
 #pragma once
 #include <string>
 #include <stdio.h>
+#include <stdarg.h>
+#include <wchar.h>
 #include <algorithm>
+#include <iterator>
 #include <map>
-#include "StringUtils.h"
-#pragma warning(push)
-#pragma warning(disable : 4996) // warning STL4010: Various members of std::allocator are deprecated in C++17
+#include <vector>
+#ifdef _MSC_VER
+#    pragma warning(push)
+#    pragma warning(disable : 4996) // warning STL4010: Various members of std::allocator are deprecated in C++17
+#endif
 #include <boost/regex.hpp>
-#pragma warning(pop)
+#ifdef _MSC_VER
+#    pragma warning(pop)
+#endif
 
 template<typename CharT>
 class NumberReplacer
@@ -47,7 +54,7 @@ public:
 };
 
 // Iter is the same as the BidirectionalIterator in which `regex_replace` it is used
-template<typename CharT, typename Iter = std::basic_string<CharT>::const_iterator>
+template<typename CharT, typename Iter = typename std::basic_string<CharT>::const_iterator>
 class RegexReplaceFormatter
 {
 public:
@@ -79,7 +86,7 @@ public:
             '\\', '}', 0
         };
         boost::basic_regex<CharT>                                      regEx = boost::basic_regex<CharT>(expr, boost::regex::normal);
-        boost::match_results<std::basic_string<CharT>::const_iterator> whatC;
+        boost::match_results<typename std::basic_string<CharT>::const_iterator> whatC;
         typename std::basic_string<CharT>::const_iterator              start = m_sReplace.begin();
         typename std::basic_string<CharT>::const_iterator              end   = m_sReplace.end();
         boost::match_flag_type                                         flags = boost::match_default | boost::format_all;
@@ -169,7 +176,7 @@ public:
                                 fmt = fmt1;
                             else
                                 fmt = fmt2;
-                            t_stprintf_s(format, _countof(format), fmt, it->padding);
+                            t_stprintf_s(format, std::size(format), fmt, it->padding);
                         }
                         else
                         {
@@ -180,13 +187,14 @@ public:
                         {
                             // for small strings, reserve space on the stack
                             CharT buf[128] = {0};
-                            t_stprintf_s(buf, _countof(buf), format, it->start);
+                            t_stprintf_s(buf, std::size(buf), format, it->start);
                             sReplace.replace(itBegin, itEnd, buf);
                         }
                         else
                         {
-                            auto s = CStringUtils::Format(format, it->start);
-                            sReplace.replace(itBegin, itEnd, s);
+                            std::vector<CharT> buf(it->padding + 16);
+                            t_stprintf_s(buf.data(), buf.size(), format, it->start);
+                            sReplace.replace(itBegin, itEnd, buf.data());
                         }
                         it->start += it->increment;
                     }
@@ -202,9 +210,11 @@ public:
     }
 
 private:
+    // only standard C functions are used here, so that the engine also builds
+    // outside of the MS CRT (benchmarks, headless builds)
     int t_ttoi(const wchar_t *str)
     {
-        return _wtoi(str);
+        return static_cast<int>(wcstol(str, nullptr, 10));
     }
 
     int t_ttoi(const char *str)
@@ -214,34 +224,31 @@ private:
 
     int t_stprintf_s(wchar_t *buffer, size_t sizeOfBuffer, const wchar_t *format, ...)
     {
-        int _Result;
-        va_list _ArgList;
-        __crt_va_start(_ArgList, format);
-        _Result = _vswprintf_s_l(buffer, sizeOfBuffer, format, NULL, _ArgList);
-        __crt_va_end(_ArgList);
-        return _Result;
+        int     result;
+        va_list argList;
+        va_start(argList, format);
+        result = vswprintf(buffer, sizeOfBuffer, format, argList);
+        va_end(argList);
+        return result;
     }
 
     int t_stprintf_s(char *buffer, size_t sizeOfBuffer, const char *format, ...)
     {
-        int _Result;
-        va_list _ArgList;
-        __crt_va_start(_ArgList, format);
-        _Result = _vsprintf_s_l(buffer, sizeOfBuffer, format, NULL, _ArgList);
-        __crt_va_end(_ArgList);
-        return _Result;
+        int     result;
+        va_list argList;
+        va_start(argList, format);
+        result = vsnprintf(buffer, sizeOfBuffer, format, argList);
+        va_end(argList);
+        return result;
     }
 
     template <size_t size>
-    errno_t t_tcscpy_s(wchar_t (&dest)[size], const wchar_t *src)
+    void t_tcscpy_s(CharT (&dest)[size], const CharT *src)
     {
-        return wcscpy_s(dest, size, src);
-    }
-
-    template <size_t size>
-    errno_t t_tcscpy_s(char (&dest)[size], const char *src)
-    {
-        return strcpy_s(dest, size, src);
+        const CharT *srcEnd = src;
+        while (*srcEnd && (srcEnd - src) < static_cast<ptrdiff_t>(size - 1))
+            ++srcEnd;
+        *std::copy(src, srcEnd, dest) = 0;
     }
 
 private:
@@ -0,0 +1,566 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "ResultArchive.h"
+#include "UnicodeUtils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <system_error>
+
+namespace
+{
+// a results file. The fixed size numbers are little endian.
+//   magic, version (4 bytes)
+//   the records, one per result
+//   the string data: the UTF-8 strings one after the other
+//   the string index: where each string starts in the string data, and
+//   where the last one ends (8 bytes each)
+//   the record index: where each record starts in the file (8 bytes each)
+//   the info: the ids of the search path and the search string, flags
+//   (1: regex), as varints
+//   the trailer: the number of records, the offset of the record index,
+//   the number of strings, the offsets of the string data, the string
+//   index and the info (8 bytes each), and the magic again
+// A record is made of varints (see AppendVarint()):
+//   the ids of the folder (with its trailing separator) and of the name,
+//   size, last-write time, match count (signed), encoding, flags (1: folder,
+//   2: read error, 4: timed out, 8: backed up, 16: the lines have patterns,
+//   32: the lines have changes, 64: the result has context lines, 128: the
+//   lines have excerpt starts), the id of the exception, the number of
+//   match lines,
+//   per match line: the line number as the difference to the one before
+//   (signed), column, length, the id of the text, the pattern with flag 16,
+//   the change with flag 32, the excerpt start with flag 128.
+//   With flag 32 and no match lines: the change of the whole result.
+//   With flag 64: the number of context ranges, per range its first line as
+//   the difference to the end of the range before, the number of lines and
+//   the id of the text of each line.
+// String 0 is the empty string. Strings used more than once, like the
+// folders, are only stored once.
+constexpr char     archiveMagic[]       = {'G', 'W', 'R', 'S'};
+constexpr uint32_t archiveVersion       = 1;
+constexpr size_t   archiveHeaderSize    = 8;
+constexpr size_t   archiveTrailerSize   = 6 * 8 + sizeof(archiveMagic);
+constexpr uint64_t archiveFolder        = 1;
+constexpr uint64_t archiveReadError     = 2;
+constexpr uint64_t archiveTimedOut      = 4;
+constexpr uint64_t archiveBackedUp      = 8;
+constexpr uint64_t archivePatterns      = 16;
+constexpr uint64_t archiveChanges       = 32;
+constexpr uint64_t archiveContext       = 64;
+constexpr uint64_t archiveExcerpts      = 128;
+constexpr uint64_t archiveRegex         = 1;
+// how many results are saved between two progress calls
+constexpr size_t   progressInterval     = 4096;
+// how many results a replay reports at once
+constexpr size_t   replayBatchSize      = 1024;
+
+void AppendFixed(std::string& out, uint64_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; ++i)
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+uint64_t ReadFixed(const char* data, size_t bytes)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i)
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    return value;
+}
+
+// reads the varints of a record or of the info, and remembers if any of
+// them was past the end
+class CVarintReader
+{
+public:
+    CVarintReader(const char* begin, const char* end)
+        : m_pos(begin)
+        , m_end(end)
+        , m_bValid(begin <= end)
+    {
+    }
+
+    uint64_t Read()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (m_pos >= m_end)
+                break;
+            auto byte = static_cast<unsigned char>(*m_pos++);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        m_bValid = false;
+        return 0;
+    }
+
+    int64_t  ReadSigned()
+    {
+        uint64_t value = Read();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    size_t   Left() const { return m_pos < m_end ? static_cast<size_t>(m_end - m_pos) : 0; }
+    bool     IsValid() const { return m_bValid; }
+
+private:
+    const char* m_pos;
+    const char* m_end;
+    bool        m_bValid;
+};
+
+MatchChange ReadChange(CVarintReader& reader)
+{
+    uint64_t change = reader.Read();
+    return change <= static_cast<uint64_t>(MatchChange::Moved) ? static_cast<MatchChange>(change) : MatchChange::Added;
+}
+} // namespace
+
+CResultArchiveWriter::CResultArchiveWriter()
+    : m_bOpen(false)
+    , m_offset(0)
+{
+}
+
+bool CResultArchiveWriter::Open(const std::wstring& path)
+{
+    m_bOpen = m_file.Open(path);
+    if (!m_bOpen)
+        return false;
+    m_recordOffsets.clear();
+    m_stringIds.clear();
+    m_strings.clear();
+    StringId(std::string());
+
+    std::string header(archiveMagic, sizeof(archiveMagic));
+    AppendFixed(header, archiveVersion, 4);
+    m_offset = header.size();
+    return m_file.Write(header);
+}
+
+uint64_t CResultArchiveWriter::StringId(const std::string& text)
+{
+    auto [it, bInserted] = m_stringIds.try_emplace(text, m_strings.size());
+    if (bInserted)
+        m_strings.push_back(&it->first);
+    return it->second;
+}
+
+uint64_t CResultArchiveWriter::StringId(const std::wstring& text)
+{
+    return text.empty() ? 0 : StringId(CUnicodeUtils::StdGetUTF8(text));
+}
+
+bool CResultArchiveWriter::Add(const CSearchInfo& sInfo)
+{
+    if (!m_bOpen)
+        return false;
+    // the folders are shared by many results, the names mostly are not
+    auto separator = sInfo.filePath.find_last_of(PathSeparator);
+    auto nameStart = separator == std::wstring::npos ? 0 : separator + 1;
+    m_record.clear();
+    AppendVarint(m_record, StringId(sInfo.filePath.substr(0, nameStart)));
+    AppendVarint(m_record, StringId(sInfo.filePath.substr(nameStart)));
+    AppendVarint(m_record, static_cast<uint64_t>(std::max<__int64>(sInfo.fileSize, 0)));
+    AppendVarint(m_record, (static_cast<uint64_t>(sInfo.modifiedTime.dwHighDateTime) << 32) | sInfo.modifiedTime.dwLowDateTime);
+    AppendSignedVarint(m_record, sInfo.matchCount);
+    AppendVarint(m_record, static_cast<uint64_t>(sInfo.encoding));
+    bool     bPatterns = !sInfo.matchPatterns.empty();
+    bool     bChanges  = !sInfo.matchChanges.empty();
+    bool     bContext  = !sInfo.contextRanges.empty();
+    bool     bExcerpts = !sInfo.matchExcerptStarts.empty();
+    uint64_t flags     = 0;
+    if (sInfo.folder)
+        flags |= archiveFolder;
+    if (sInfo.readError)
+        flags |= archiveReadError;
+    if (sInfo.timedOut)
+        flags |= archiveTimedOut;
+    if (sInfo.hasBackedup)
+        flags |= archiveBackedUp;
+    if (bPatterns)
+        flags |= archivePatterns;
+    if (bChanges)
+        flags |= archiveChanges;
+    if (bContext)
+        flags |= archiveContext;
+    if (bExcerpts)
+        flags |= archiveExcerpts;
+    AppendVarint(m_record, flags);
+    AppendVarint(m_record, StringId(sInfo.exception));
+    AppendVarint(m_record, sInfo.matchLines.size());
+    int64_t previousLine = 0;
+    for (size_t i = 0; i < sInfo.matchLines.size(); ++i)
+    {
+        int64_t line = i < sInfo.matchLinesNumbers.size() ? sInfo.matchLinesNumbers[i] : 0;
+        AppendSignedVarint(m_record, line - previousLine);
+        previousLine = line;
+        AppendVarint(m_record, i < sInfo.matchColumnsNumbers.size() ? sInfo.matchColumnsNumbers[i] : 0);
+        AppendVarint(m_record, i < sInfo.matchLengths.size() ? sInfo.matchLengths[i] : 0);
+        AppendVarint(m_record, StringId(sInfo.matchLines[i]));
+        if (bPatterns)
+            AppendVarint(m_record, i < sInfo.matchPatterns.size() ? sInfo.matchPatterns[i] : 0);
+        if (bChanges)
+            AppendVarint(m_record, static_cast<uint64_t>(i < sInfo.matchChanges.size() ? sInfo.matchChanges[i] : MatchChange::Added));
+        if (bExcerpts)
+            AppendVarint(m_record, i < sInfo.matchExcerptStarts.size() ? sInfo.matchExcerptStarts[i] : 1);
+    }
+    if (bChanges && sInfo.matchLines.empty())
+        AppendVarint(m_record, static_cast<uint64_t>(sInfo.matchChanges.front()));
+    if (bContext)
+    {
+        AppendVarint(m_record, sInfo.contextRanges.size());
+        DWORD        rangeEnd = 0;
+        std::wstring text;
+        for (const auto& range : sInfo.contextRanges)
+        {
+            AppendVarint(m_record, range.firstLine - rangeEnd);
+            AppendVarint(m_record, range.lineCount);
+            for (DWORD i = 0; i < range.lineCount; ++i)
+            {
+                size_t start = range.firstIndex + i ? sInfo.contextLineEnds[range.firstIndex + i - 1] : 0;
+                text.assign(sInfo.contextText, start, sInfo.contextLineEnds[range.firstIndex + i] - start);
+                AppendVarint(m_record, StringId(text));
+            }
+            rangeEnd = range.firstLine + range.lineCount;
+        }
+    }
+    m_recordOffsets.push_back(m_offset);
+    m_offset += m_record.size();
+    return m_file.Write(m_record);
+}
+
+bool CResultArchiveWriter::Close(const SavedSearchInfo& info)
+{
+    if (!m_bOpen)
+        return false;
+    m_bOpen = false;
+
+    uint64_t infoSearchPath   = StringId(info.searchPath);
+    uint64_t infoSearchString = StringId(info.searchString);
+
+    uint64_t    stringDataOffset = m_offset;
+    std::string text;
+    text.reserve(8 * (m_strings.size() + 1));
+    uint64_t stringOffset = 0;
+    for (const auto* str : m_strings)
+    {
+        AppendFixed(text, stringOffset, 8);
+        stringOffset += str->size();
+        m_file.Write(*str);
+    }
+    AppendFixed(text, stringOffset, 8);
+    uint64_t stringIndexOffset = stringDataOffset + stringOffset;
+    uint64_t recordIndexOffset = stringIndexOffset + text.size();
+    for (auto offset : m_recordOffsets)
+        AppendFixed(text, offset, 8);
+    uint64_t infoOffset = stringIndexOffset + text.size();
+    AppendVarint(text, infoSearchPath);
+    AppendVarint(text, infoSearchString);
+    AppendVarint(text, info.useRegex ? archiveRegex : 0);
+
+    AppendFixed(text, m_recordOffsets.size(), 8);
+    AppendFixed(text, recordIndexOffset, 8);
+    AppendFixed(text, m_strings.size(), 8);
+    AppendFixed(text, stringDataOffset, 8);
+    AppendFixed(text, stringIndexOffset, 8);
+    AppendFixed(text, infoOffset, 8);
+    text.append(archiveMagic, sizeof(archiveMagic));
+    m_file.Write(text);
+
+    m_recordOffsets.clear();
+    m_strings.clear();
+    m_stringIds.clear();
+    return m_file.Close();
+}
+
+bool CResultArchive::Open(const std::wstring& path)
+{
+    Close();
+    try
+    {
+        m_mappedFile.open(PlatformPath(path));
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+    if (!m_mappedFile.is_open())
+        return false;
+    m_data = m_mappedFile.data();
+    m_size = m_mappedFile.size();
+
+    // every offset is checked here, Read() then only checks the records
+    if (m_size < archiveHeaderSize + archiveTrailerSize ||
+        memcmp(m_data, archiveMagic, sizeof(archiveMagic)) != 0 ||
+        memcmp(m_data + m_size - sizeof(archiveMagic), archiveMagic, sizeof(archiveMagic)) != 0 ||
+        ReadFixed(m_data + sizeof(archiveMagic), 4) > archiveVersion)
+    {
+        Close();
+        return false;
+    }
+    const size_t contentEnd        = m_size - archiveTrailerSize;
+    const char*  trailer           = m_data + contentEnd;
+    uint64_t     recordCount       = ReadFixed(trailer, 8);
+    uint64_t     recordIndexOffset = ReadFixed(trailer + 8, 8);
+    uint64_t     stringCount       = ReadFixed(trailer + 16, 8);
+    uint64_t     stringDataOffset  = ReadFixed(trailer + 24, 8);
+    uint64_t     stringIndexOffset = ReadFixed(trailer + 32, 8);
+    uint64_t     infoOffset        = ReadFixed(trailer + 40, 8);
+    // in the order they are in the file, so none of the sums can overflow
+    if (infoOffset > contentEnd || recordIndexOffset > infoOffset || stringIndexOffset > recordIndexOffset ||
+        stringDataOffset > stringIndexOffset || stringDataOffset < archiveHeaderSize ||
+        stringCount == 0 || stringCount >= contentEnd / 8 || recordCount > contentEnd / 8 ||
+        stringIndexOffset + 8 * (stringCount + 1) > recordIndexOffset ||
+        recordIndexOffset + 8 * recordCount > infoOffset)
+    {
+        Close();
+        return false;
+    }
+    m_stringIndex = m_data + stringIndexOffset;
+    m_stringData  = m_data + stringDataOffset;
+    m_stringSize  = stringIndexOffset - stringDataOffset;
+    m_stringCount = stringCount;
+    if (ReadFixed(m_stringIndex + 8 * stringCount, 8) > m_stringSize)
+    {
+        Close();
+        return false;
+    }
+    m_recordIndex = m_data + recordIndexOffset;
+    m_recordCount = recordCount;
+
+    CVarintReader reader(m_data + infoOffset, trailer);
+    uint64_t      searchPathId   = reader.Read();
+    uint64_t      searchStringId = reader.Read();
+    uint64_t      flags          = reader.Read();
+    if (!reader.IsValid() || !String(searchPathId, m_info.searchPath) || !String(searchStringId, m_info.searchString))
+    {
+        Close();
+        return false;
+    }
+    m_info.useRegex = (flags & archiveRegex) != 0;
+    return true;
+}
+
+void CResultArchive::Close()
+{
+    if (m_mappedFile.is_open())
+        m_mappedFile.close();
+    m_data        = nullptr;
+    m_size        = 0;
+    m_recordCount = 0;
+    m_recordIndex = nullptr;
+    m_stringCount = 0;
+    m_stringIndex = nullptr;
+    m_stringData  = nullptr;
+    m_stringSize  = 0;
+    m_info        = SavedSearchInfo();
+}
+
+bool CResultArchive::String(uint64_t id, std::string_view& text) const
+{
+    if (id >= m_stringCount)
+        return false;
+    uint64_t begin = ReadFixed(m_stringIndex + 8 * id, 8);
+    uint64_t end   = ReadFixed(m_stringIndex + 8 * (id + 1), 8);
+    if (begin > end || end > m_stringSize)
+        return false;
+    text = std::string_view(m_stringData + begin, static_cast<size_t>(end - begin));
+    return true;
+}
+
+bool CResultArchive::String(uint64_t id, std::wstring& text) const
+{
+    std::string_view utf8;
+    if (!String(id, utf8))
+        return false;
+    text = CUnicodeUtils::StdGetUnicode(std::string(utf8));
+    return true;
+}
+
+bool CResultArchive::Read(size_t index, CSearchInfo& sInfo) const
+{
+    if (index >= m_recordCount)
+        return false;
+    // a record ends where the next one starts, the last one at the strings
+    uint64_t begin = ReadFixed(m_recordIndex + 8 * index, 8);
+    uint64_t end   = index + 1 < m_recordCount ? ReadFixed(m_recordIndex + 8 * (index + 1), 8) : static_cast<uint64_t>(m_stringData - m_data);
+    if (begin < archiveHeaderSize || begin > end || end > static_cast<uint64_t>(m_stringData - m_data))
+        return false;
+
+    CVarintReader    reader(m_data + begin, m_data + end);
+    std::string_view folder;
+    std::string_view name;
+    if (!String(reader.Read(), folder) || !String(reader.Read(), name))
+        return false;
+    sInfo          = CSearchInfo(CUnicodeUtils::StdGetUnicode(std::string(folder) + std::string(name)));
+    sInfo.fileSize = static_cast<__int64>(reader.Read());
+
+    uint64_t time                     = reader.Read();
+    sInfo.modifiedTime.dwHighDateTime = static_cast<DWORD>(time >> 32);
+    sInfo.modifiedTime.dwLowDateTime  = static_cast<DWORD>(time & 0xFFFFFFFF);
+
+    sInfo.matchCount  = reader.ReadSigned();
+    sInfo.encoding    = static_cast<CTextFile::UnicodeType>(reader.Read());
+    uint64_t flags    = reader.Read();
+    sInfo.folder      = (flags & archiveFolder) != 0;
+    sInfo.readError   = (flags & archiveReadError) != 0;
+    sInfo.timedOut    = (flags & archiveTimedOut) != 0;
+    sInfo.hasBackedup = (flags & archiveBackedUp) != 0;
+    bool bPatterns    = (flags & archivePatterns) != 0;
+    bool bChanges     = (flags & archiveChanges) != 0;
+    bool bContext     = (flags & archiveContext) != 0;
+    bool bExcerpts    = (flags & archiveExcerpts) != 0;
+    if (!String(reader.Read(), sInfo.exception))
+        return false;
+    uint64_t lineCount = reader.Read();
+    // a line takes at least four bytes
+    if (!reader.IsValid() || lineCount > reader.Left() / 4)
+        return false;
+    sInfo.matchLinesNumbers.reserve(lineCount);
+    sInfo.matchColumnsNumbers.reserve(lineCount);
+    sInfo.matchLengths.reserve(lineCount);
+    sInfo.matchLines.resize(lineCount);
+    if (bPatterns)
+        sInfo.matchPatterns.reserve(lineCount);
+    if (bChanges)
+        sInfo.matchChanges.reserve(std::max<uint64_t>(lineCount, 1));
+    if (bExcerpts)
+        sInfo.matchExcerptStarts.reserve(lineCount);
+    int64_t line = 0;
+    for (size_t i = 0; i < lineCount; ++i)
+    {
+        line += reader.ReadSigned();
+        sInfo.matchLinesNumbers.push_back(static_cast<DWORD>(line));
+        sInfo.matchColumnsNumbers.push_back(static_cast<DWORD>(reader.Read()));
+        sInfo.matchLengths.push_back(static_cast<DWORD>(reader.Read()));
+        if (!String(reader.Read(), sInfo.matchLines[i]))
+            return false;
+        if (bPatterns)
+            sInfo.matchPatterns.push_back(static_cast<DWORD>(reader.Read()));
+        if (bChanges)
+            sInfo.matchChanges.push_back(ReadChange(reader));
+        if (bExcerpts)
+            sInfo.matchExcerptStarts.push_back(static_cast<DWORD>(reader.Read()));
+    }
+    if (bChanges && lineCount == 0)
+        sInfo.matchChanges.push_back(ReadChange(reader));
+    if (bContext)
+    {
+        uint64_t rangeCount = reader.Read();
+        // a range takes at least three bytes, a line one
+        if (!reader.IsValid() || rangeCount > reader.Left() / 3)
+            return false;
+        sInfo.contextRanges.reserve(rangeCount);
+        uint64_t     rangeEnd = 0;
+        std::wstring text;
+        for (size_t r = 0; r < rangeCount; ++r)
+        {
+            uint64_t firstLine = rangeEnd + reader.Read();
+            uint64_t count     = reader.Read();
+            if (!reader.IsValid() || count > reader.Left() || firstLine + count > std::numeric_limits<DWORD>::max())
+                return false;
+            for (uint64_t l = firstLine; l < firstLine + count; ++l)
+            {
+                if (!String(reader.Read(), text))
+                    return false;
+                sInfo.AddContextLine(static_cast<DWORD>(l), text);
+            }
+            rangeEnd = firstLine + count;
+        }
+    }
+    return reader.IsValid();
+}
+
+bool CResultArchive::ReadAll(std::vector<CSearchInfo>& items, const CCancellationToken& cancelToken) const
+{
+    items.reserve(items.size() + m_recordCount);
+    for (size_t i = 0; i < m_recordCount; ++i)
+    {
+        if (cancelToken.IsCancelled())
+            return false;
+        CSearchInfo sInfo;
+        if (!Read(i, sInfo))
+            return false;
+        items.push_back(std::move(sInfo));
+    }
+    return true;
+}
+
+bool CResultArchive::Replay(ISearchResultSink& sink, const CCancellationToken& cancelToken) const
+{
+    bool                          bValid = true;
+    std::vector<SearchFileResult> batch;
+    batch.reserve(replayBatchSize);
+    sink.OnSearchStart();
+    for (size_t i = 0; i < m_recordCount && !cancelToken.IsCancelled(); ++i)
+    {
+        SearchFileResult result;
+        if (!Read(i, result.sInfo))
+        {
+            bValid = false;
+            break;
+        }
+        result.bSearched = true;
+        result.bAsResult = true;
+        batch.push_back(std::move(result));
+        if (batch.size() >= replayBatchSize)
+        {
+            sink.OnFileResults(batch);
+            batch.clear();
+        }
+    }
+    if (!batch.empty())
+        sink.OnFileResults(batch);
+    sink.OnSearchEnd();
+    return bValid;
+}
+
+bool CResultArchive::Save(const SavedSearchInfo& info, const std::vector<CSearchInfo>& items, const std::vector<int>& order, const std::wstring& path, const CCancellationToken& cancelToken, const std::function<void(size_t)>& progress)
+{
+    CResultArchiveWriter writer;
+    bool                 bWritten = writer.Open(path);
+    for (size_t i = 0; i < order.size() && bWritten; ++i)
+    {
+        if (cancelToken.IsCancelled())
+        {
+            bWritten = false;
+            break;
+        }
+        bWritten = writer.Add(items[order[i]]);
+        if (progress && ((i + 1) % progressInterval) == 0)
+            progress(i + 1);
+    }
+    bWritten = writer.Close(info) && bWritten;
+    if (!bWritten)
+    {
+        std::error_code ec;
+        std::filesystem::remove(PlatformPath(path), ec);
+        return false;
+    }
+    if (progress)
+        progress(order.size());
+    return true;
+}
@@ -0,0 +1,118 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+#include "CancellationToken.h"
+#include "ResultExport.h"
+#include "SearchInfo.h"
+#include "SearchResultSink.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+// what a results file tells about the search its results are from
+struct SavedSearchInfo
+{
+    // the search paths, '|' separated
+    std::wstring searchPath;
+    std::wstring searchString;
+    bool         useRegex = false;
+};
+
+// writes the results of a search to a results file, which CResultArchive
+// reads back. See ResultArchive.cpp for the format.
+// The results are written as they are added, the strings they share are
+// kept until Close() and only written once.
+class CResultArchiveWriter
+{
+public:
+    CResultArchiveWriter();
+
+    bool                                      Open(const std::wstring& path);
+    // not thread safe, the caller has to serialize the calls
+    bool                                      Add(const CSearchInfo& sInfo);
+    // writes the strings, the index and info. Returns false if any write failed.
+    bool                                      Close(const SavedSearchInfo& info);
+
+private:
+    uint64_t                                  StringId(const std::string& text);
+    uint64_t                                  StringId(const std::wstring& text);
+
+    CExportFile                               m_file;
+    bool                                      m_bOpen;
+    uint64_t                                  m_offset;
+    std::vector<uint64_t>                     m_recordOffsets;
+    // the id of every string, and the strings in the order of their ids
+    std::unordered_map<std::string, uint64_t> m_stringIds;
+    std::vector<const std::string*>           m_strings;
+    std::string                               m_record;
+};
+
+// a results file, mapped into memory. Opening it only reads the index: a
+// result is decoded when it is read, so a file with millions of results
+// opens at once.
+class CResultArchive
+{
+public:
+    CResultArchive()                                 = default;
+    CResultArchive(const CResultArchive&)            = delete;
+    CResultArchive& operator=(const CResultArchive&) = delete;
+
+    // false if the file can not be read or is not a results file
+    bool                   Open(const std::wstring& path);
+    void                   Close();
+
+    size_t                 Size() const { return m_recordCount; }
+    const SavedSearchInfo& Info() const { return m_info; }
+
+    // decodes the result at index. Returns false if it is damaged.
+    bool                   Read(size_t index, CSearchInfo& sInfo) const;
+    // appends all results to items. Returns false if one is damaged or
+    // cancelToken is cancelled.
+    bool                   ReadAll(std::vector<CSearchInfo>& items, const CCancellationToken& cancelToken) const;
+
+    // reports all results to sink the way a search reports them, in
+    // batches. Stops at the first damaged result, returns false then.
+    bool                   Replay(ISearchResultSink& sink, const CCancellationToken& cancelToken) const;
+
+    // writes items to a results file in the order of order, in the way
+    // CResultExporter::Export() does
+    static bool            Save(const SavedSearchInfo& info, const std::vector<CSearchInfo>& items, const std::vector<int>& order, const std::wstring& path, const CCancellationToken& cancelToken, const std::function<void(size_t)>& progress);
+
+private:
+    bool                   String(uint64_t id, std::string_view& text) const;
+    bool                   String(uint64_t id, std::wstring& text) const;
+
+    boost::iostreams::mapped_file_source m_mappedFile;
+    const char*                          m_data        = nullptr;
+    size_t                               m_size        = 0;
+    uint64_t                             m_recordCount = 0;
+    const char*                          m_recordIndex = nullptr;
+    uint64_t                             m_stringCount = 0;
+    const char*                          m_stringIndex = nullptr;
+    const char*                          m_stringData  = nullptr;
+    uint64_t                             m_stringSize  = 0;
+    SavedSearchInfo                      m_info;
+};
@@ -0,0 +1,241 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "ResultDiff.h"
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+namespace
+{
+constexpr uint32_t noLine          = UINT32_MAX;
+constexpr uint32_t noPath          = UINT32_MAX;
+// how many matches are taken between two checks for a cancel
+constexpr size_t   cancelInterval  = 65536;
+
+// a line's text without its line break. The lowest bit is always set, so a
+// line never has the key of a result without lines.
+uint64_t LineHash(std::wstring_view line)
+{
+    while (!line.empty() && (line.back() == '\r' || line.back() == '\n'))
+        line.remove_suffix(1);
+    return static_cast<uint64_t>(std::hash<std::wstring_view>()(line)) | 1;
+}
+
+template <typename T>
+T ValueAt(const std::vector<T>& values, size_t index)
+{
+    return index < values.size() ? values[index] : T();
+}
+} // namespace
+
+CResultDiff::CResultDiff()
+    : m_before(nullptr)
+    , m_after(nullptr)
+    , m_pathId(noPath)
+    , m_fileBefore(nullptr)
+    , m_fileAfter(nullptr)
+    , m_added(0)
+    , m_removed(0)
+    , m_moved(0)
+{
+}
+
+bool CResultDiff::AddMatches(const std::vector<CSearchInfo>& items, std::vector<Match>& matches, const CCancellationToken& cancelToken)
+{
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        if ((i % cancelInterval) == 0 && cancelToken.IsCancelled())
+            return false;
+        const auto& sInfo  = items[i];
+        auto        pathId = m_pathIds.try_emplace(sInfo.filePath, static_cast<uint32_t>(m_pathIds.size())).first->second;
+        if (sInfo.matchLines.empty())
+        {
+            matches.push_back({0, pathId, 0, static_cast<uint32_t>(i), noLine});
+            continue;
+        }
+        for (size_t line = 0; line < sInfo.matchLines.size(); ++line)
+            matches.push_back({LineHash(sInfo.matchLines[line]), pathId, ValueAt(sInfo.matchLinesNumbers, line), static_cast<uint32_t>(i), static_cast<uint32_t>(line)});
+    }
+    return true;
+}
+
+bool CResultDiff::Compare(const std::vector<CSearchInfo>& before, const std::vector<CSearchInfo>& after, const CCancellationToken& cancelToken)
+{
+    m_before = &before;
+    m_after  = &after;
+    m_pathIds.clear();
+    m_changes.clear();
+    m_pathId  = noPath;
+    m_added   = 0;
+    m_removed = 0;
+    m_moved   = 0;
+
+    std::vector<Match> beforeMatches;
+    std::vector<Match> afterMatches;
+    if (!AddMatches(before, beforeMatches, cancelToken) || !AddMatches(after, afterMatches, cancelToken))
+        return false;
+
+    // the matches of a file are next to each other, those with the same
+    // text ordered by their line number
+    auto lessKey = [](const Match& m1, const Match& m2) {
+        return std::tie(m1.pathId, m1.lineHash) < std::tie(m2.pathId, m2.lineHash);
+    };
+    auto less    = [](const Match& m1, const Match& m2) {
+        return std::tie(m1.pathId, m1.lineHash, m1.lineNumber) < std::tie(m2.pathId, m2.lineHash, m2.lineNumber);
+    };
+    std::ranges::sort(beforeMatches, less);
+    if (cancelToken.IsCancelled())
+        return false;
+    std::ranges::sort(afterMatches, less);
+
+    // merges the two sorted lists, a group of matches with the same key at a time
+    const Match* b    = beforeMatches.data();
+    const Match* bEnd = b + beforeMatches.size();
+    const Match* a    = afterMatches.data();
+    const Match* aEnd = a + afterMatches.size();
+    size_t       done = 0;
+    while (b != bEnd || a != aEnd)
+    {
+        if (++done % cancelInterval == 0 && cancelToken.IsCancelled())
+            return false;
+        const Match& key      = (a == aEnd || (b != bEnd && lessKey(*b, *a))) ? *b : *a;
+        const Match* bGroup   = b;
+        const Match* aGroup   = a;
+        while (b != bEnd && !lessKey(key, *b))
+            ++b;
+        while (a != aEnd && !lessKey(key, *a))
+            ++a;
+        CompareGroup(bGroup, b, aGroup, a);
+    }
+    FinishFile();
+    return true;
+}
+
+void CResultDiff::CompareGroup(const Match* beforeBegin, const Match* beforeEnd, const Match* afterBegin, const Match* afterEnd)
+{
+    uint32_t pathId = beforeBegin != beforeEnd ? beforeBegin->pathId : afterBegin->pathId;
+    if (pathId != m_pathId)
+    {
+        FinishFile();
+        m_pathId     = pathId;
+        m_fileBefore = nullptr;
+        m_fileAfter  = nullptr;
+    }
+    if (beforeBegin != beforeEnd)
+        m_fileBefore = &(*m_before)[beforeBegin->item];
+    if (afterBegin != afterEnd)
+        m_fileAfter = &(*m_after)[afterBegin->item];
+
+    // the lines which are at the same line number in both are unchanged
+    m_onlyBefore.clear();
+    m_onlyAfter.clear();
+    while (beforeBegin != beforeEnd && afterBegin != afterEnd)
+    {
+        if (beforeBegin->lineNumber == afterBegin->lineNumber)
+        {
+            ++beforeBegin;
+            ++afterBegin;
+        }
+        else if (beforeBegin->lineNumber < afterBegin->lineNumber)
+            m_onlyBefore.push_back(beforeBegin++);
+        else
+            m_onlyAfter.push_back(afterBegin++);
+    }
+    for (; beforeBegin != beforeEnd; ++beforeBegin)
+        m_onlyBefore.push_back(beforeBegin);
+    for (; afterBegin != afterEnd; ++afterBegin)
+        m_onlyAfter.push_back(afterBegin);
+
+    // the others moved, as far as both have some left
+    size_t moved = std::min(m_onlyBefore.size(), m_onlyAfter.size());
+    for (size_t i = 0; i < moved; ++i)
+        AddChange(*m_onlyAfter[i], MatchChange::Moved);
+    for (size_t i = moved; i < m_onlyAfter.size(); ++i)
+        AddChange(*m_onlyAfter[i], MatchChange::Added);
+    for (size_t i = moved; i < m_onlyBefore.size(); ++i)
+        AddChange(*m_onlyBefore[i], MatchChange::Removed);
+}
+
+void CResultDiff::AddChange(const Match& match, MatchChange change)
+{
+    const auto& items = change == MatchChange::Removed ? *m_before : *m_after;
+    m_fileChanges.push_back({&items[match.item], match.line, change});
+}
+
+void CResultDiff::FinishFile()
+{
+    if (m_fileChanges.empty())
+        return;
+    const CSearchInfo& base = m_fileAfter ? *m_fileAfter : *m_fileBefore;
+    CSearchInfo        result(base.filePath);
+    result.fileSize     = base.fileSize;
+    result.modifiedTime = base.modifiedTime;
+    result.encoding     = base.encoding;
+    result.folder       = base.folder;
+    result.readError    = base.readError;
+    result.timedOut     = base.timedOut;
+    result.exception    = base.exception;
+
+    std::ranges::stable_sort(m_fileChanges, [](const Change& c1, const Change& c2) {
+        auto line1 = c1.line == noLine ? 0 : ValueAt(c1.sInfo->matchLinesNumbers, c1.line);
+        auto line2 = c2.line == noLine ? 0 : ValueAt(c2.sInfo->matchLinesNumbers, c2.line);
+        return line1 < line2;
+    });
+    bool bPatterns = std::ranges::any_of(m_fileChanges, [](const Change& c) { return !c.sInfo->matchPatterns.empty(); });
+    bool bExcerpts = std::ranges::any_of(m_fileChanges, [](const Change& c) { return !c.sInfo->matchExcerptStarts.empty(); });
+    for (const auto& change : m_fileChanges)
+    {
+        if (change.line == noLine)
+            continue;
+        const auto& sInfo = *change.sInfo;
+        result.matchLinesNumbers.push_back(ValueAt(sInfo.matchLinesNumbers, change.line));
+        result.matchColumnsNumbers.push_back(ValueAt(sInfo.matchColumnsNumbers, change.line));
+        result.matchLengths.push_back(ValueAt(sInfo.matchLengths, change.line));
+        result.matchLines.push_back(sInfo.matchLines[change.line]);
+        if (bPatterns)
+            result.matchPatterns.push_back(ValueAt(sInfo.matchPatterns, change.line));
+        if (bExcerpts)
+            result.matchExcerptStarts.push_back(change.line < sInfo.matchExcerptStarts.size() ? sInfo.matchExcerptStarts[change.line] : 1);
+        result.matchChanges.push_back(change.change);
+    }
+    // a result without lines on one side and with lines on the other is
+    // described by the lines
+    if (result.matchLines.empty())
+        result.matchChanges.push_back(m_fileChanges.front().change);
+    result.matchCount = static_cast<__int64>(result.matchChanges.size());
+    for (auto change : result.matchChanges)
+    {
+        switch (change)
+        {
+            case MatchChange::Added:
+                ++m_added;
+                break;
+            case MatchChange::Removed:
+                ++m_removed;
+                break;
+            case MatchChange::Moved:
+                ++m_moved;
+                break;
+        }
+    }
+    m_changes.push_back(std::move(result));
+    m_fileChanges.clear();
+}
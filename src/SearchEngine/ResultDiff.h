@@ -0,0 +1,101 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+#include "CancellationToken.h"
+#include "SearchInfo.h"
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// the changes between two results of the same search, e.g. of yesterday's
+// and today's run.
+//
+// A match is identified by the path of its file and a hash of the text of
+// its line, not by its line number: a line which is still there, but at
+// another line number because lines above it were added or removed, is
+// reported as moved instead of as removed and added. Results without match
+// lines are compared as a whole.
+// Both sides are turned into keys which are sorted and then merged, so the
+// comparison takes O(n log n) for millions of matches.
+class CResultDiff
+{
+public:
+    CResultDiff();
+
+    // compares before with after, which may be in any order. Returns false
+    // if it was cancelled.
+    bool                            Compare(const std::vector<CSearchInfo>& before, const std::vector<CSearchInfo>& after, const CCancellationToken& cancelToken);
+
+    // the results with changes, one per file in the order the paths first
+    // appear in before and then in after. Each has the changed lines,
+    // ordered by line number, with CSearchInfo::matchChanges set and
+    // matchCount the number of them. The rest is from the result in after,
+    // or in before if the file is not in after anymore.
+    std::vector<CSearchInfo>&       Changes() { return m_changes; }
+
+    uint64_t                        Added() const { return m_added; }
+    uint64_t                        Removed() const { return m_removed; }
+    uint64_t                        Moved() const { return m_moved; }
+
+private:
+    struct Match
+    {
+        uint64_t lineHash;
+        uint32_t pathId;
+        DWORD    lineNumber;
+        uint32_t item;
+        // the index of the line in the result, noLine for a result without lines
+        uint32_t line;
+    };
+
+    struct Change
+    {
+        const CSearchInfo* sInfo;
+        uint32_t           line;
+        MatchChange        change;
+    };
+
+    // adds the matches of every line of items, and a match for each result without lines
+    bool                            AddMatches(const std::vector<CSearchInfo>& items, std::vector<Match>& matches, const CCancellationToken& cancelToken);
+    // compares the matches of before and after with the same key
+    void                            CompareGroup(const Match* beforeBegin, const Match* beforeEnd, const Match* afterBegin, const Match* afterEnd);
+    void                            AddChange(const Match& match, MatchChange change);
+    void                            FinishFile();
+
+    const std::vector<CSearchInfo>*                 m_before;
+    const std::vector<CSearchInfo>*                 m_after;
+    // the paths of both results, numbered in the order they first appear
+    std::unordered_map<std::wstring_view, uint32_t> m_pathIds;
+    std::vector<CSearchInfo>                        m_changes;
+    // the file the merge is at: its results, nullptr for the side it is
+    // not in, and its changes
+    uint32_t                                        m_pathId;
+    const CSearchInfo*                              m_fileBefore;
+    const CSearchInfo*                              m_fileAfter;
+    std::vector<Change>                             m_fileChanges;
+    // the matches of a group which are only in one of the results
+    std::vector<const Match*>                       m_onlyBefore;
+    std::vector<const Match*>                       m_onlyAfter;
+    uint64_t                                        m_added;
+    uint64_t                                        m_removed;
+    uint64_t                                        m_moved;
+};
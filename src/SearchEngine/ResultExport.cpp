@@ -0,0 +1,511 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "ResultExport.h"
+#include "UnicodeUtils.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+namespace
+{
+// the size of the blocks an export is written in
+constexpr size_t exportBlockSize    = 4 * 1024 * 1024;
+// how many results are exported between two progress calls
+constexpr size_t progressInterval   = 4096;
+
+// the binary format, for tools which read the results back. All numbers are
+// unsigned LEB128 varints, signed ones zigzag encoded first. Strings are
+// UTF-8 with their length in front.
+//   magic, version,
+//   per result: path, size, last-write time, match count (signed),
+//   encoding, flags (1: folder, 2: read error, 4: timed out), exception,
+//   number of match lines,
+//   per match line: line number, column, length, text
+// A missing column or length is written as 0.
+constexpr char     binaryMagic[]    = {'G', 'W', 'R', 'X'};
+constexpr uint64_t binaryVersion    = 1;
+constexpr uint64_t binaryFolder     = 1;
+constexpr uint64_t binaryReadError  = 2;
+constexpr uint64_t binaryTimedOut   = 4;
+
+// the text format and CSV use the line breaks of the platform, like a file
+// written in text mode
+#ifdef _WIN32
+constexpr char     lineBreak[]      = "\r\n";
+#else
+constexpr char     lineBreak[]      = "\n";
+#endif
+
+void AppendBinaryString(std::string& out, const std::wstring& text)
+{
+    std::string utf8 = CUnicodeUtils::StdGetUTF8(text);
+    AppendVarint(out, utf8.size());
+    out += utf8;
+}
+
+// a CSV field, quoted if it has to be
+void AppendCsvField(std::string& out, const std::string& field)
+{
+    if (field.find_first_of(",\"\r\n") == std::string::npos)
+    {
+        out += field;
+        return;
+    }
+    out += '"';
+    for (char c : field)
+    {
+        if (c == '"')
+            out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+template <typename T>
+DWORD ValueAt(const std::vector<T>& values, size_t index)
+{
+    return index < values.size() ? values[index] : 0;
+}
+
+const char* EncodingName(CTextFile::UnicodeType encoding)
+{
+    switch (encoding)
+    {
+        case CTextFile::Ansi:
+            return "ansi";
+        case CTextFile::UTF8:
+            return "utf8";
+        case CTextFile::Unicode_Le:
+            return "utf16le";
+        case CTextFile::Unicode_Be:
+            return "utf16be";
+        case CTextFile::Binary:
+            return "binary";
+        default:
+            return "unknown";
+    }
+}
+
+const char* ChangeName(MatchChange change)
+{
+    switch (change)
+    {
+        case MatchChange::Added:
+            return "added";
+        case MatchChange::Removed:
+            return "removed";
+        case MatchChange::Moved:
+            return "moved";
+    }
+    return "unknown";
+}
+} // namespace
+
+CResultExporter::CResultExporter(ExportFormat format, const ExportColumns& columns)
+    : m_format(format)
+    , m_columns(columns)
+{
+    if (!m_columns.paths && !m_columns.lineNumbers && !m_columns.lineTexts)
+        m_columns.paths = true;
+}
+
+void CResultExporter::AppendBegin(std::string& out) const
+{
+    switch (m_format)
+    {
+        case ExportFormat::Csv:
+            // the byte order mark tells spreadsheets it's UTF-8
+            out += "\xEF\xBB\xBFpath,line,column,length,text";
+            out += lineBreak;
+            break;
+        case ExportFormat::Binary:
+            out.append(binaryMagic, sizeof(binaryMagic));
+            AppendVarint(out, binaryVersion);
+            break;
+        default:
+            break;
+    }
+}
+
+void CResultExporter::Append(const CSearchInfo& sInfo, std::string& out) const
+{
+    switch (m_format)
+    {
+        case ExportFormat::Text:
+            AppendText(sInfo, out);
+            break;
+        case ExportFormat::Csv:
+            AppendCsv(sInfo, out);
+            break;
+        case ExportFormat::JsonLines:
+            AppendJsonResult(out, sInfo, {});
+            break;
+        case ExportFormat::Binary:
+            AppendBinary(sInfo, out);
+            break;
+    }
+}
+
+void CResultExporter::AppendText(const CSearchInfo& sInfo, std::string& out) const
+{
+    if (!m_columns.lineNumbers && !m_columns.lineTexts)
+    {
+        out += CUnicodeUtils::StdGetUTF8(sInfo.filePath);
+        out += lineBreak;
+        return;
+    }
+    // the context lines are separated by '-' instead, like grep does
+    constexpr char separator        = '*';
+    constexpr char contextSeparator = '-';
+    std::string    path             = m_columns.paths ? CUnicodeUtils::StdGetUTF8(sInfo.filePath) : std::string();
+    auto           appendLine       = [&](char sep, DWORD lineNumber, const std::wstring& text) {
+        bool needSeparator = m_columns.paths;
+        out += path;
+        if (m_columns.lineNumbers)
+        {
+            if (needSeparator)
+                out += sep;
+            out += std::to_string(lineNumber);
+            needSeparator = true;
+        }
+        if (m_columns.lineTexts)
+        {
+            if (needSeparator)
+                out += sep;
+            std::string line = CUnicodeUtils::StdGetUTF8(text);
+            while (!line.empty() && (line.back() == '\r' || line.back() == '\n'))
+                line.pop_back();
+            out += line;
+        }
+        out += lineBreak;
+    };
+    auto           appendMatch      = [&](size_t i) {
+        appendLine(separator, sInfo.matchLinesNumbers[i], i < sInfo.matchLines.size() ? sInfo.matchLines[i] : std::wstring());
+    };
+    auto           appendContext    = [&](DWORD lineNumber, std::wstring_view text) {
+        appendLine(contextSeparator, lineNumber, std::wstring(text));
+    };
+    auto           appendGap        = [&]() {
+        out += "--";
+        out += lineBreak;
+    };
+    if (!m_columns.lineTexts)
+    {
+        for (size_t i = 0; i < sInfo.matchLinesNumbers.size(); ++i)
+            appendMatch(i);
+        return;
+    }
+    ForEachResultLine(sInfo, appendMatch, appendContext, appendGap);
+}
+
+void CResultExporter::AppendCsv(const CSearchInfo& sInfo, std::string& out) const
+{
+    std::string path = CUnicodeUtils::StdGetUTF8(sInfo.filePath);
+    if (sInfo.matchLines.empty())
+    {
+        AppendCsvField(out, path);
+        out += ",,,,";
+        out += lineBreak;
+        return;
+    }
+    for (size_t i = 0; i < sInfo.matchLines.size(); ++i)
+    {
+        AppendCsvField(out, path);
+        out += ',' + std::to_string(ValueAt(sInfo.matchLinesNumbers, i));
+        out += ',' + std::to_string(ValueAt(sInfo.matchColumnsNumbers, i));
+        out += ',' + std::to_string(ValueAt(sInfo.matchLengths, i));
+        out += ',';
+        AppendCsvField(out, CUnicodeUtils::StdGetUTF8(sInfo.matchLines[i]));
+        out += lineBreak;
+    }
+}
+
+void CResultExporter::AppendBinary(const CSearchInfo& sInfo, std::string& out) const
+{
+    AppendBinaryString(out, sInfo.filePath);
+    AppendVarint(out, static_cast<uint64_t>(std::max<__int64>(sInfo.fileSize, 0)));
+    AppendVarint(out, (static_cast<uint64_t>(sInfo.modifiedTime.dwHighDateTime) << 32) | sInfo.modifiedTime.dwLowDateTime);
+    AppendSignedVarint(out, sInfo.matchCount);
+    AppendVarint(out, static_cast<uint64_t>(sInfo.encoding));
+    uint64_t flags = 0;
+    if (sInfo.folder)
+        flags |= binaryFolder;
+    if (sInfo.readError)
+        flags |= binaryReadError;
+    if (sInfo.timedOut)
+        flags |= binaryTimedOut;
+    AppendVarint(out, flags);
+    AppendBinaryString(out, sInfo.exception);
+    AppendVarint(out, sInfo.matchLines.size());
+    for (size_t i = 0; i < sInfo.matchLines.size(); ++i)
+    {
+        AppendVarint(out, ValueAt(sInfo.matchLinesNumbers, i));
+        AppendVarint(out, ValueAt(sInfo.matchColumnsNumbers, i));
+        AppendVarint(out, ValueAt(sInfo.matchLengths, i));
+        AppendBinaryString(out, sInfo.matchLines[i]);
+    }
+}
+
+bool CResultExporter::Export(const std::vector<CSearchInfo>& items, const std::vector<int>& order, const std::wstring& path, const CCancellationToken& cancelToken, const std::function<void(size_t)>& progress) const
+{
+    CExportFile file;
+    if (!file.Open(path))
+        return false;
+
+    std::string text;
+    AppendBegin(text);
+    bool bWritten = file.Write(text);
+    for (size_t i = 0; i < order.size() && bWritten; ++i)
+    {
+        if (cancelToken.IsCancelled())
+        {
+            bWritten = false;
+            break;
+        }
+        text.clear();
+        Append(items[order[i]], text);
+        bWritten = file.Write(text);
+        if (progress && ((i + 1) % progressInterval) == 0)
+            progress(i + 1);
+    }
+    bWritten = file.Close() && bWritten;
+    if (!bWritten)
+    {
+        std::error_code ec;
+        std::filesystem::remove(PlatformPath(path), ec);
+        return false;
+    }
+    if (progress)
+        progress(order.size());
+    return true;
+}
+
+bool CResultExporter::ParseFormat(const std::wstring& name, ExportFormat& format)
+{
+    if (_wcsicmp(name.c_str(), L"text") == 0)
+        format = ExportFormat::Text;
+    else if (_wcsicmp(name.c_str(), L"csv") == 0)
+        format = ExportFormat::Csv;
+    else if (_wcsicmp(name.c_str(), L"jsonl") == 0 || _wcsicmp(name.c_str(), L"json") == 0)
+        format = ExportFormat::JsonLines;
+    else if (_wcsicmp(name.c_str(), L"binary") == 0)
+        format = ExportFormat::Binary;
+    else
+        return false;
+    return true;
+}
+
+CExportFile::CExportFile()
+    : m_bFailed(false)
+{
+}
+
+bool CExportFile::Open(const std::wstring& path)
+{
+    m_stream.open(PlatformPath(path), std::ios::binary | std::ios::trunc);
+    m_buffer.reserve(exportBlockSize);
+    m_bFailed = !m_stream.is_open();
+    return !m_bFailed;
+}
+
+bool CExportFile::Write(std::string_view text)
+{
+    m_buffer += text;
+    if (m_buffer.size() >= exportBlockSize)
+        return Flush();
+    return !m_bFailed;
+}
+
+bool CExportFile::Flush()
+{
+    if (!m_bFailed && !m_buffer.empty())
+    {
+        m_stream.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        m_bFailed = m_stream.fail();
+    }
+    m_buffer.clear();
+    return !m_bFailed;
+}
+
+bool CExportFile::Close()
+{
+    Flush();
+    if (m_stream.is_open())
+    {
+        m_stream.close();
+        m_bFailed = m_bFailed || m_stream.fail();
+    }
+    return !m_bFailed;
+}
+
+void AppendVarint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void AppendSignedVarint(std::string& out, int64_t value)
+{
+    AppendVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void AppendJsonString(std::string& text, const std::wstring& str)
+{
+    text += '"';
+    for (char c : CUnicodeUtils::StdGetUTF8(str))
+    {
+        switch (c)
+        {
+            case '"':
+                text += "\\\"";
+                break;
+            case '\\':
+                text += "\\\\";
+                break;
+            case '\n':
+                text += "\\n";
+                break;
+            case '\r':
+                text += "\\r";
+                break;
+            case '\t':
+                text += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                    text += buf;
+                }
+                else
+                    text += c;
+                break;
+        }
+    }
+    text += '"';
+}
+
+void AppendJsonResult(std::string& text, const CSearchInfo& sInfo, const std::vector<std::wstring>& patterns)
+{
+    text += "{\"type\":\"file\",\"path\":";
+    AppendJsonString(text, sInfo.filePath);
+    if (sInfo.folder)
+        text += ",\"folder\":true";
+    text += ",\"size\":" + std::to_string(sInfo.fileSize);
+    text += ",\"matches\":" + std::to_string(sInfo.matchCount);
+    if (sInfo.matchLines.empty() && !sInfo.matchChanges.empty())
+    {
+        text += ",\"change\":\"";
+        text += ChangeName(sInfo.matchChanges.front());
+        text += '"';
+    }
+    text += ",\"encoding\":\"";
+    text += EncodingName(sInfo.encoding);
+    text += "\",\"lines\":[";
+    for (size_t i = 0; i < sInfo.matchLines.size(); ++i)
+    {
+        if (i)
+            text += ',';
+        text += '{';
+        if (i < sInfo.matchLinesNumbers.size())
+            text += "\"line\":" + std::to_string(sInfo.matchLinesNumbers[i]) + ',';
+        if (i < sInfo.matchColumnsNumbers.size())
+            text += "\"column\":" + std::to_string(sInfo.matchColumnsNumbers[i]) + ',';
+        if (i < sInfo.matchLengths.size())
+            text += "\"length\":" + std::to_string(sInfo.matchLengths[i]) + ',';
+        // the text is only an excerpt of the line, from that column on
+        if (i < sInfo.matchExcerptStarts.size() && sInfo.matchExcerptStarts[i] > 1)
+            text += "\"excerpt\":" + std::to_string(sInfo.matchExcerptStarts[i]) + ',';
+        if (i < sInfo.matchPatterns.size() && sInfo.matchPatterns[i] < patterns.size())
+        {
+            text += "\"pattern\":";
+            AppendJsonString(text, patterns[sInfo.matchPatterns[i]]);
+            text += ',';
+        }
+        if (i < sInfo.matchChanges.size())
+        {
+            text += "\"change\":\"";
+            text += ChangeName(sInfo.matchChanges[i]);
+            text += "\",";
+        }
+        text += "\"text\":";
+        AppendJsonString(text, sInfo.matchLines[i]);
+        text += '}';
+    }
+    text += ']';
+    if (!sInfo.contextRanges.empty())
+    {
+        text += ",\"context\":[";
+        for (const auto& range : sInfo.contextRanges)
+        {
+            if (&range != &sInfo.contextRanges.front())
+                text += ',';
+            text += "{\"line\":" + std::to_string(range.firstLine) + ",\"lines\":[";
+            for (DWORD l = 0; l < range.lineCount; ++l)
+            {
+                std::wstring_view line;
+                sInfo.ContextLine(range.firstLine + l, line);
+                if (l)
+                    text += ',';
+                AppendJsonString(text, std::wstring(line));
+            }
+            text += "]}";
+        }
+        text += ']';
+    }
+    text += "}\n";
+}
+
+void ForEachResultLine(const CSearchInfo& sInfo, const std::function<void(size_t)>& matchLine, const std::function<void(DWORD, std::wstring_view)>& contextLine, const std::function<void()>& gap)
+{
+    const auto& numbers = sInfo.matchLinesNumbers;
+    size_t      i       = 0;
+    for (const auto& range : sInfo.contextRanges)
+    {
+        if (&range != &sInfo.contextRanges.front())
+            gap();
+        for (DWORD l = 0; l < range.lineCount; ++l)
+        {
+            DWORD line = range.firstLine + l;
+            while (i < numbers.size() && numbers[i] < line)
+                matchLine(i++);
+            bool bMatch = false;
+            while (i < numbers.size() && numbers[i] == line)
+            {
+                matchLine(i++);
+                bMatch = true;
+            }
+            if (!bMatch)
+            {
+                size_t index = range.firstIndex + l;
+                size_t start = index ? sInfo.contextLineEnds[index - 1] : 0;
+                contextLine(line, std::wstring_view(sInfo.contextText).substr(start, sInfo.contextLineEnds[index] - start));
+            }
+        }
+    }
+    while (i < numbers.size())
+        matchLine(i++);
+}
@@ -0,0 +1,114 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+#include "CancellationToken.h"
+#include "SearchInfo.h"
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class ExportFormat
+{
+    Text,      // the path of every result, or a line per match line with the columns chosen
+    Csv,       // a header and a row per match line: path, line, column, length, text
+    JsonLines, // one JSON object per result, the same as the headless /format:json
+    Binary,    // see ResultExport.cpp
+};
+
+// what the text format writes. Without line numbers and line texts, it
+// writes the path of every result, else a line per match line with the
+// chosen parts separated by '*'.
+struct ExportColumns
+{
+    bool paths       = true;
+    bool lineNumbers = false;
+    bool lineTexts   = false;
+};
+
+// formats results for an export. Every result is formatted on its own, so
+// the results can be written as they come from a running search.
+class CResultExporter
+{
+public:
+    explicit CResultExporter(ExportFormat format, const ExportColumns& columns = {});
+
+    // appends what the output starts with: the CSV header, or the magic and
+    // version of the binary format
+    void                AppendBegin(std::string& out) const;
+    void                Append(const CSearchInfo& sInfo, std::string& out) const;
+
+    // writes the results items[order[0]], items[order[1]], ... to path, in
+    // the order the list shows them. progress is called after every block
+    // written with the number of results done. Returns false if the file
+    // can not be written or cancelToken is cancelled, the file is removed then.
+    bool                Export(const std::vector<CSearchInfo>& items, const std::vector<int>& order, const std::wstring& path, const CCancellationToken& cancelToken, const std::function<void(size_t)>& progress) const;
+
+    // "text", "csv", "jsonl" (or "json") and "binary"
+    static bool         ParseFormat(const std::wstring& name, ExportFormat& format);
+
+private:
+    void                AppendText(const CSearchInfo& sInfo, std::string& out) const;
+    void                AppendCsv(const CSearchInfo& sInfo, std::string& out) const;
+    void                AppendBinary(const CSearchInfo& sInfo, std::string& out) const;
+
+    ExportFormat        m_format;
+    ExportColumns       m_columns;
+};
+
+// a file which is written in large blocks: the text is collected and only
+// written once there is enough of it. Close() writes the rest.
+class CExportFile
+{
+public:
+    CExportFile();
+
+    bool                Open(const std::wstring& path);
+    // false if a write failed
+    bool                Write(std::string_view text);
+    // writes what is left, returns false if any write failed
+    bool                Close();
+
+private:
+    bool                Flush();
+
+    std::ofstream       m_stream;
+    std::string         m_buffer;
+    bool                m_bFailed;
+};
+
+// appends value as an unsigned LEB128 varint, the numbers of the binary formats
+void AppendVarint(std::string& out, uint64_t value);
+// appends value zigzag encoded, so that small negative values stay short
+void AppendSignedVarint(std::string& out, int64_t value);
+// appends str as a JSON string, in quotes and escaped
+void AppendJsonString(std::string& text, const std::wstring& str);
+// appends the JSON object for a result, and a line break. patterns are the
+// texts of SearchOptions::searchPatterns, to name the pattern of each line.
+// The context lines are an array of their ranges: the first line and the
+// texts of the lines.
+void AppendJsonResult(std::string& text, const CSearchInfo& sInfo, const std::vector<std::wstring>& patterns);
+// calls matchLine() with the index of every match line and contextLine()
+// for every context line which is not a match line, in the order of the
+// lines. gap() is called between two ranges of context lines.
+void ForEachResultLine(const CSearchInfo& sInfo, const std::function<void(size_t)>& matchLine, const std::function<void(DWORD, std::wstring_view)>& contextLine, const std::function<void()>& gap);
@@ -0,0 +1,95 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "ResultFilter.h"
+
+#include <algorithm>
+#include <cwctype>
+
+namespace
+{
+wchar_t Fold(wchar_t c)
+{
+    if (c < 0x80)
+        return (c >= 'A' && c <= 'Z') ? static_cast<wchar_t>(c + ('a' - 'A')) : c;
+    return static_cast<wchar_t>(std::towlower(c));
+}
+} // namespace
+
+CResultFilter::CResultFilter(const std::wstring& text)
+    : m_text(text)
+{
+    std::ranges::transform(m_text, m_text.begin(), Fold);
+    m_skip.fill(m_text.size());
+    for (size_t i = 0; i + 1 < m_text.size(); ++i)
+        m_skip[m_text[i] & 0xFF] = m_text.size() - 1 - i;
+}
+
+bool CResultFilter::Matches(std::wstring_view text) const
+{
+    const size_t length = m_text.size();
+    if (length == 0)
+        return true;
+    for (size_t pos = 0; pos + length <= text.size();)
+    {
+        wchar_t last = Fold(text[pos + length - 1]);
+        if (last == m_text[length - 1])
+        {
+            size_t i = 0;
+            while (i + 1 < length && Fold(text[pos + i]) == m_text[i])
+                ++i;
+            if (i + 1 >= length)
+                return true;
+        }
+        pos += m_skip[last & 0xFF];
+    }
+    return false;
+}
+
+void CResultFilter::AddRows(const std::vector<CSearchInfo>& items, const std::vector<int>& order, size_t first, size_t last, std::vector<int>& fileRows, std::vector<std::tuple<int, int>>& lineRows) const
+{
+    for (size_t position = first; position < last; ++position)
+    {
+        int         index      = order[position];
+        const auto& item       = items[index];
+        bool        pathPasses = Matches(item.filePath);
+        bool        filePasses = pathPasses;
+        for (size_t subIndex = 0; subIndex < item.matchLinesNumbers.size(); ++subIndex)
+        {
+            if (pathPasses || (subIndex < item.matchLines.size() && Matches(item.matchLines[subIndex])))
+            {
+                lineRows.push_back(std::make_tuple(index, static_cast<int>(subIndex)));
+                filePasses = true;
+            }
+        }
+        if (filePasses)
+            fileRows.push_back(index);
+    }
+}
+
+void CResultFilter::AddAllRows(const std::vector<CSearchInfo>& items, const std::vector<int>& order, size_t first, size_t last, std::vector<int>& fileRows, std::vector<std::tuple<int, int>>& lineRows)
+{
+    for (size_t position = first; position < last; ++position)
+    {
+        int index = order[position];
+        fileRows.push_back(index);
+        for (size_t subIndex = 0; subIndex < items[index].matchLinesNumbers.size(); ++subIndex)
+            lineRows.push_back(std::make_tuple(index, static_cast<int>(subIndex)));
+    }
+}
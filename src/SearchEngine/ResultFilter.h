@@ -0,0 +1,57 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+#include "SearchInfo.h"
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+// the quick filter over the results of a search: which results and match
+// lines contain a text, ignoring the case.
+// The text is prepared once, after that a filter can be used from several
+// threads at the same time.
+class CResultFilter
+{
+public:
+    explicit CResultFilter(const std::wstring& text);
+
+    bool                 Matches(std::wstring_view text) const;
+
+    // adds the rows of the results items[order[first]] to items[order[last - 1]]
+    // which pass the filter: to fileRows the index of every result whose path
+    // or one of its lines contains the text, to lineRows the result and line
+    // index of every line which does.
+    // All the lines of a result whose path contains the text pass.
+    void                 AddRows(const std::vector<CSearchInfo>& items, const std::vector<int>& order, size_t first, size_t last, std::vector<int>& fileRows, std::vector<std::tuple<int, int>>& lineRows) const;
+
+    // the same without a filter: every result and every line
+    static void          AddAllRows(const std::vector<CSearchInfo>& items, const std::vector<int>& order, size_t first, size_t last, std::vector<int>& fileRows, std::vector<std::tuple<int, int>>& lineRows);
+
+private:
+    // the text in lower case
+    std::wstring            m_text;
+    // Horspool: how far the text can move on after a mismatch, by the low
+    // byte of the lower case character at the end of the window. Characters
+    // which share the low byte share the shortest distance.
+    std::array<size_t, 256> m_skip;
+};
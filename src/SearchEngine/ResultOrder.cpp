@@ -0,0 +1,157 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "ResultOrder.h"
+
+#include <algorithm>
+#include <string_view>
+#include <thread>
+
+namespace
+{
+// below that many results per thread, starting a thread costs more than it saves
+constexpr size_t MinResultsPerThread = 16 * 1024;
+} // namespace
+
+CResultOrder::CResultOrder(const std::vector<CSearchInfo>& items, const std::vector<int>& order, ResultSortColumn column, bool bAscending)
+    : m_items(items)
+    , m_column(column)
+    , m_bAscending(bAscending)
+    , m_order(order)
+{
+}
+
+bool CResultOrder::Less(const Key& key1, const Key& key2) const
+{
+    const Key& first  = m_bAscending ? key1 : key2;
+    const Key& second = m_bAscending ? key2 : key1;
+    switch (m_column)
+    {
+        case ResultSortColumn::Name:
+        case ResultSortColumn::Extension:
+            return StrCmpLogicalW(first.text.data(), second.text.data()) < 0;
+        case ResultSortColumn::Path:
+        {
+            // the folders as they are, then the names like the name column does
+            std::wstring_view folder1 = first.text.substr(0, first.nameOffset ? first.nameOffset - 1 : 0);
+            std::wstring_view folder2 = second.text.substr(0, second.nameOffset ? second.nameOffset - 1 : 0);
+            int               cmp     = folder1.compare(folder2);
+            if (cmp != 0)
+                return cmp < 0;
+            return StrCmpLogicalW(first.text.data() + first.nameOffset, second.text.data() + second.nameOffset) < 0;
+        }
+        default:
+            return first.number < second.number;
+    }
+}
+
+void CResultOrder::Sort(unsigned int threadCount)
+{
+    m_keys.resize(m_items.size());
+    for (int index : m_order)
+    {
+        const auto& item = m_items[index];
+        auto&       key  = m_keys[index];
+        switch (m_column)
+        {
+            case ResultSortColumn::Name:
+                key.text = item.Name();
+                break;
+            case ResultSortColumn::Path:
+                key.text       = item.filePath;
+                key.nameOffset = item.nameOffset;
+                break;
+            case ResultSortColumn::Extension:
+                // like the extension column shows it
+                key.text = item.Extension();
+                break;
+            case ResultSortColumn::Size:
+                key.number = item.fileSize;
+                break;
+            case ResultSortColumn::Matches:
+                key.number = item.matchCount;
+                break;
+            case ResultSortColumn::Encoding:
+                key.number = static_cast<int64_t>(item.encoding);
+                break;
+            case ResultSortColumn::ModifiedTime:
+                key.number = static_cast<int64_t>((static_cast<uint64_t>(item.modifiedTime.dwHighDateTime) << 32) | item.modifiedTime.dwLowDateTime);
+                break;
+        }
+    }
+
+    auto less = [this](int index1, int index2) { return Less(m_keys[index1], m_keys[index2]); };
+
+    // every thread sorts a part, then neighboring parts are merged in pairs,
+    // again on several threads, until one part is left
+    size_t parts = std::clamp<size_t>(m_order.size() / MinResultsPerThread, 1, std::max(threadCount, 1u));
+    std::vector<size_t> bounds(parts + 1);
+    for (size_t i = 0; i <= parts; ++i)
+        bounds[i] = m_order.size() * i / parts;
+
+    auto runParts = [&](size_t count, auto&& work) {
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < count; ++i)
+            threads.emplace_back(work, i);
+        work(size_t(0));
+        for (auto& thread : threads)
+            thread.join();
+    };
+    runParts(parts, [&](size_t part) { std::stable_sort(m_order.begin() + bounds[part], m_order.begin() + bounds[part + 1], less); });
+    while (bounds.size() > 2)
+    {
+        size_t pairs = (bounds.size() - 1) / 2;
+        runParts(pairs, [&](size_t pair) {
+            std::inplace_merge(m_order.begin() + bounds[2 * pair], m_order.begin() + bounds[2 * pair + 1], m_order.begin() + bounds[2 * pair + 2], less);
+        });
+        std::vector<size_t> merged;
+        for (size_t i = 0; i < bounds.size(); i += 2)
+            merged.push_back(bounds[i]);
+        if (merged.back() != bounds.back())
+            merged.push_back(bounds.back());
+        bounds.swap(merged);
+    }
+}
+
+void CResultOrder::SortRows(const std::vector<int>& fileRows, const std::vector<std::tuple<int, int>>& lineRows, std::vector<int>& sortedFileRows, std::vector<std::tuple<int, int>>& sortedLineRows) const
+{
+    // where the rows of every result are, then the rows in the order of the results
+    std::vector<uint8_t> listed(m_items.size());
+    for (int index : fileRows)
+        listed[index] = 1;
+    std::vector<size_t> firstLine(m_items.size());
+    std::vector<size_t> lineCount(m_items.size());
+    for (size_t row = 0; row < lineRows.size(); ++row)
+    {
+        int index = std::get<0>(lineRows[row]);
+        if (lineCount[index]++ == 0)
+            firstLine[index] = row;
+    }
+
+    sortedFileRows.clear();
+    sortedFileRows.reserve(fileRows.size());
+    sortedLineRows.clear();
+    sortedLineRows.reserve(lineRows.size());
+    for (int index : m_order)
+    {
+        if (listed[index])
+            sortedFileRows.push_back(index);
+        sortedLineRows.insert(sortedLineRows.end(), lineRows.begin() + firstLine[index], lineRows.begin() + firstLine[index] + lineCount[index]);
+    }
+}
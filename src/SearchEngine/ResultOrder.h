@@ -0,0 +1,84 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+#include "SearchInfo.h"
+
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+// the columns of the result list the results can be sorted by
+enum class ResultSortColumn
+{
+    Name,
+    Size,
+    Matches,
+    Path,
+    Extension,
+    Encoding,
+    ModifiedTime,
+};
+
+// the order of a list of results sorted by one column, as the indexes of
+// the results: the results themselves are not moved.
+//
+// The sort key of every result is taken once, from the name and extension
+// offsets of its path: a comparison then neither splits the paths again nor
+// allocates. The keys point into the paths, so the results must not change
+// until the order is done with. Results which compare equal keep the order
+// they had before, just like with std::stable_sort.
+class CResultOrder
+{
+public:
+    // order: the index of every result in items, in the order they have now
+    CResultOrder(const std::vector<CSearchInfo>& items, const std::vector<int>& order, ResultSortColumn column, bool bAscending);
+
+    // takes the keys and sorts them on up to threadCount threads
+    void                    Sort(unsigned int threadCount);
+
+    // the sorted indexes: items[Order()[0]] comes first
+    const std::vector<int>& Order() const { return m_order; }
+
+    // the rows of a result list in the sorted order. fileRows has the index
+    // of a result, lineRows the index of a result and of one of its lines,
+    // the lines of a result next to each other, like CResultFilter adds them.
+    void                    SortRows(const std::vector<int>& fileRows, const std::vector<std::tuple<int, int>>& lineRows, std::vector<int>& sortedFileRows, std::vector<std::tuple<int, int>>& sortedLineRows) const;
+
+private:
+    struct Key
+    {
+        // Name and Extension: the text compared, Path: the whole path.
+        // It ends where the path ends, at a terminating null.
+        std::wstring_view text;
+        // Path: where the name starts in text, 0 if it has no folder
+        size_t            nameOffset = 0;
+        // Size, Matches, Encoding and ModifiedTime
+        int64_t           number     = 0;
+    };
+
+    bool                            Less(const Key& key1, const Key& key2) const;
+
+    const std::vector<CSearchInfo>& m_items;
+    ResultSortColumn                m_column;
+    bool                            m_bAscending;
+    std::vector<Key>                m_keys;
+    std::vector<int>                m_order;
+};
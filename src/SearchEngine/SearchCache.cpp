@@ -0,0 +1,426 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "SearchCache.h"
+#include "DirFileEnum.h"
+#include "SearchSnapshot.h"
+#include "UnicodeUtils.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace
+{
+// compiled filters are small, but there's no need to keep every
+// pattern ever used
+constexpr size_t maxCachedRegexes   = 256;
+// a snapshot holds an entry for every searched file
+constexpr size_t maxCachedSnapshots = 8;
+
+// the file format of the saved listings, all numbers little endian:
+//   magic, version, root, number of directories,
+//   per directory: path, last-write time, number of entries,
+//   per entry: name, attributes, size, last-write time
+// Strings are UTF-8 with their length in front.
+constexpr uint32_t persistentMagic   = 0x43445747; // "GWDC"
+constexpr uint32_t persistentVersion = 1;
+
+class CBinaryWriter
+{
+public:
+    explicit CBinaryWriter(std::ofstream& stream)
+        : m_stream(stream)
+    {
+    }
+
+    void Write32(uint32_t value)
+    {
+        unsigned char bytes[4];
+        for (int i = 0; i < 4; ++i)
+            bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+        m_stream.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+    }
+
+    void Write64(uint64_t value)
+    {
+        Write32(static_cast<uint32_t>(value));
+        Write32(static_cast<uint32_t>(value >> 32));
+    }
+
+    void WriteTime(const FILETIME& time)
+    {
+        Write32(time.dwLowDateTime);
+        Write32(time.dwHighDateTime);
+    }
+
+    void WriteString(const std::wstring& text)
+    {
+        std::string utf8 = CUnicodeUtils::StdGetUTF8(text);
+        Write32(static_cast<uint32_t>(utf8.size()));
+        m_stream.write(utf8.data(), static_cast<std::streamsize>(utf8.size()));
+    }
+
+private:
+    std::ofstream& m_stream;
+};
+
+class CBinaryReader
+{
+public:
+    explicit CBinaryReader(std::ifstream& stream)
+        : m_stream(stream)
+    {
+    }
+
+    bool Read32(uint32_t& value)
+    {
+        unsigned char bytes[4];
+        if (!m_stream.read(reinterpret_cast<char*>(bytes), sizeof(bytes)))
+            return false;
+        value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+        return true;
+    }
+
+    bool Read64(uint64_t& value)
+    {
+        uint32_t low  = 0;
+        uint32_t high = 0;
+        if (!Read32(low) || !Read32(high))
+            return false;
+        value = (static_cast<uint64_t>(high) << 32) | low;
+        return true;
+    }
+
+    bool ReadTime(FILETIME& time)
+    {
+        uint32_t low  = 0;
+        uint32_t high = 0;
+        if (!Read32(low) || !Read32(high))
+            return false;
+        time.dwLowDateTime  = low;
+        time.dwHighDateTime = high;
+        return true;
+    }
+
+    bool ReadString(std::wstring& text)
+    {
+        uint32_t length = 0;
+        // no path or file name comes close to that: the file is damaged
+        if (!Read32(length) || length > 0x10000)
+            return false;
+        std::string utf8(length, '\0');
+        if (!m_stream.read(utf8.data(), length))
+            return false;
+        text = CUnicodeUtils::StdGetUnicode(utf8);
+        return true;
+    }
+
+private:
+    std::ifstream& m_stream;
+};
+
+bool IsPathBelow(const std::wstring& path, const std::wstring& root)
+{
+    if (path.size() < root.size() || path.compare(0, root.size(), root) != 0)
+        return false;
+    return path.size() == root.size() || root.back() == PathSeparator || path[root.size()] == PathSeparator;
+}
+
+std::wstring TrimSeparators(const std::wstring& path)
+{
+    // keep the separator of a root folder, like CCachedDirFileEnum does
+    std::wstring result = path;
+    while (result.size() > 1 && result.back() == PathSeparator && result[result.size() - 2] != L':')
+        result.pop_back();
+    return result;
+}
+} // namespace
+
+std::shared_ptr<const boost::wregex> CompilePathRegex(const std::wstring& pattern)
+{
+    try
+    {
+        return std::make_shared<const boost::wregex>(pattern, boost::regex::normal | boost::regbase::icase);
+    }
+    catch (const std::exception&)
+    {
+    }
+    return nullptr;
+}
+
+CSearchCache::CSearchCache(size_t maxEntries)
+    : m_maxEntries(maxEntries)
+    , m_entryCount(0)
+{
+}
+
+std::shared_ptr<const CachedDirListing> CSearchCache::GetListing(const std::wstring& dirPath, bool bForceList)
+{
+    WIN32_FILE_ATTRIBUTE_DATA dirData = {};
+    if (!GetFileAttributesEx(dirPath.c_str(), GetFileExInfoStandard, &dirData))
+        return nullptr;
+    if (!bForceList)
+    {
+        std::lock_guard lock(m_mutex);
+        auto            it = m_listings.find(dirPath);
+        if (it != m_listings.end() && CompareFileTime(&it->second->dirWriteTime, &dirData.ftLastWriteTime) == 0)
+        {
+            ++m_listingHits;
+            return it->second;
+        }
+    }
+
+    // list without holding the lock: other searches can use the cache meanwhile.
+    // The time was taken before the listing, so a change during the listing
+    // makes the next search list the directory again.
+    ++m_listingMisses;
+    std::shared_ptr<const CachedDirListing> listing = ReadListing(dirPath, dirData.ftLastWriteTime);
+
+    std::lock_guard lock(m_mutex);
+    StoreListing(dirPath, listing);
+    return listing;
+}
+
+std::shared_ptr<const boost::wregex> CSearchCache::GetPathRegex(const std::wstring& pattern)
+{
+    std::lock_guard lock(m_mutex);
+    auto            it = m_regexes.find(pattern);
+    if (it != m_regexes.end())
+        return it->second;
+    if (m_regexes.size() >= maxCachedRegexes)
+        m_regexes.clear();
+    auto regex         = CompilePathRegex(pattern);
+    m_regexes[pattern] = regex;
+    return regex;
+}
+
+std::shared_ptr<const CSearchSnapshot> CSearchCache::GetSnapshot(const std::wstring& key)
+{
+    std::lock_guard lock(m_mutex);
+    auto            it = m_snapshots.find(key);
+    return it != m_snapshots.end() ? it->second : nullptr;
+}
+
+void CSearchCache::StoreSnapshot(const std::wstring& key, std::shared_ptr<const CSearchSnapshot> snapshot)
+{
+    std::lock_guard lock(m_mutex);
+    if (m_snapshots.size() >= maxCachedSnapshots && !m_snapshots.contains(key))
+        m_snapshots.clear();
+    m_snapshots[key] = std::move(snapshot);
+}
+
+void CSearchCache::Clear()
+{
+    std::lock_guard lock(m_mutex);
+    m_listings.clear();
+    m_regexes.clear();
+    m_snapshots.clear();
+    m_entryCount = 0;
+}
+
+bool CSearchCache::Load(const std::wstring& cacheDir, const std::wstring& root)
+{
+    std::wstring  trimmedRoot = TrimSeparators(root);
+    std::ifstream stream(PlatformPath(PersistentFilePath(cacheDir, trimmedRoot)), std::ios::binary);
+    if (!stream)
+        return false;
+
+    CBinaryReader reader(stream);
+    uint32_t      magic    = 0;
+    uint32_t      version  = 0;
+    uint64_t      dirCount = 0;
+    std::wstring  fileRoot;
+    if (!reader.Read32(magic) || magic != persistentMagic || !reader.Read32(version) || version != persistentVersion)
+        return false;
+    // the file name is a hash of the root, which two roots can share
+    if (!reader.ReadString(fileRoot) || fileRoot != trimmedRoot || !reader.Read64(dirCount))
+        return false;
+
+    // everything is read before anything is used: a damaged file is ignored as a whole
+    std::vector<std::pair<std::wstring, std::shared_ptr<CachedDirListing>>> listings;
+    size_t                                                                  entryCount = 0;
+    for (uint64_t i = 0; i < dirCount; ++i)
+    {
+        auto         listing    = std::make_shared<CachedDirListing>();
+        uint32_t     dirEntries = 0;
+        std::wstring dirPath;
+        if (!reader.ReadString(dirPath) || !reader.ReadTime(listing->dirWriteTime) || !reader.Read32(dirEntries))
+            return false;
+        entryCount += dirEntries;
+        if (entryCount > m_maxEntries)
+            return false;
+        listing->entries.resize(dirEntries);
+        for (auto& entry : listing->entries)
+        {
+            uint32_t attributes = 0;
+            if (!reader.ReadString(entry.name) || !reader.Read32(attributes) || !reader.Read64(entry.size) || !reader.ReadTime(entry.lastWriteTime))
+                return false;
+            entry.attributes = attributes;
+        }
+        listings.emplace_back(std::move(dirPath), std::move(listing));
+    }
+
+    std::lock_guard lock(m_mutex);
+    for (auto& [dirPath, listing] : listings)
+    {
+        if (!m_listings.contains(dirPath))
+            StoreListing(dirPath, std::move(listing));
+    }
+    return true;
+}
+
+bool CSearchCache::Save(const std::wstring& cacheDir, const std::wstring& root)
+{
+    std::wstring                                                                  trimmedRoot = TrimSeparators(root);
+    std::vector<std::pair<std::wstring, std::shared_ptr<const CachedDirListing>>> listings;
+    {
+        std::lock_guard lock(m_mutex);
+        // the map is sorted, so all paths which start with root follow it
+        for (auto it = m_listings.lower_bound(trimmedRoot); it != m_listings.end() && it->first.starts_with(trimmedRoot); ++it)
+        {
+            if (IsPathBelow(it->first, trimmedRoot))
+                listings.emplace_back(*it);
+        }
+    }
+    if (listings.empty())
+        return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(PlatformPath(cacheDir), ec);
+    // written to a temporary file first, so a process which loads the cache
+    // meanwhile does not see a partial file
+    std::wstring filePath = PersistentFilePath(cacheDir, trimmedRoot);
+    std::wstring tempPath = filePath + L".tmp";
+    {
+        std::ofstream stream(PlatformPath(tempPath), std::ios::binary | std::ios::trunc);
+        if (!stream)
+            return false;
+        CBinaryWriter writer(stream);
+        writer.Write32(persistentMagic);
+        writer.Write32(persistentVersion);
+        writer.WriteString(trimmedRoot);
+        writer.Write64(listings.size());
+        for (const auto& [dirPath, listing] : listings)
+        {
+            writer.WriteString(dirPath);
+            writer.WriteTime(listing->dirWriteTime);
+            writer.Write32(static_cast<uint32_t>(listing->entries.size()));
+            for (const auto& entry : listing->entries)
+            {
+                writer.WriteString(entry.name);
+                writer.Write32(entry.attributes);
+                writer.Write64(entry.size);
+                writer.WriteTime(entry.lastWriteTime);
+            }
+        }
+        if (!stream.flush())
+        {
+            stream.close();
+            std::filesystem::remove(PlatformPath(tempPath), ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(PlatformPath(tempPath), PlatformPath(filePath), ec);
+    if (ec)
+    {
+        std::filesystem::remove(PlatformPath(tempPath), ec);
+        return false;
+    }
+    return true;
+}
+
+std::wstring CSearchCache::DefaultPersistentDirectory()
+{
+#ifdef _WIN32
+    wchar_t appData[MAX_PATH] = {0};
+    DWORD   len               = GetEnvironmentVariable(L"LOCALAPPDATA", appData, _countof(appData));
+    if (len == 0 || len >= _countof(appData))
+        return {};
+    return std::wstring(appData) + L"\\grepWin\\dircache";
+#else
+    const char* cacheHome = getenv("XDG_CACHE_HOME");
+    if (cacheHome && *cacheHome)
+        return CUnicodeUtils::StdGetUnicode(std::string(cacheHome) + "/grepWin/dircache");
+    const char* home = getenv("HOME");
+    if (home && *home)
+        return CUnicodeUtils::StdGetUnicode(std::string(home) + "/.cache/grepWin/dircache");
+    return {};
+#endif
+}
+
+std::wstring CSearchCache::PersistentFilePath(const std::wstring& cacheDir, const std::wstring& root)
+{
+    // FNV-1a of the root: short, and valid as a file name
+    uint64_t hash = 14695981039346656037ULL;
+    for (wchar_t c : root)
+    {
+        hash ^= static_cast<uint64_t>(c);
+        hash *= 1099511628211ULL;
+    }
+    const wchar_t* hexDigits = L"0123456789abcdef";
+    std::wstring   name(16, L'0');
+    for (int i = 15; i >= 0; --i, hash >>= 4)
+        name[i] = hexDigits[hash & 0xF];
+    std::wstring path = cacheDir;
+    if (!path.empty() && path.back() != PathSeparator)
+        path += PathSeparator;
+    return path + name + L".dircache";
+}
+
+void CSearchCache::StoreListing(const std::wstring& dirPath, std::shared_ptr<const CachedDirListing> listing)
+{
+    // the caller holds m_mutex
+    auto it = m_listings.find(dirPath);
+    if (it != m_listings.end())
+    {
+        m_entryCount -= it->second->entries.size();
+        m_listings.erase(it);
+    }
+    if (m_entryCount + listing->entries.size() > m_maxEntries)
+    {
+        m_listings.clear();
+        m_entryCount = 0;
+    }
+    m_entryCount += listing->entries.size();
+    m_listings[dirPath] = std::move(listing);
+}
+
+std::shared_ptr<CachedDirListing> CSearchCache::ReadListing(const std::wstring& dirPath, const FILETIME& dirWriteTime)
+{
+    auto listing          = std::make_shared<CachedDirListing>();
+    listing->dirWriteTime = dirWriteTime;
+
+    CDirFileEnum fileEnumerator(dirPath.c_str());
+    bool         bIsDirectory = false;
+    std::wstring sPath;
+    // no recursion: the sub directories are listed (and cached) on their own
+    while (fileEnumerator.NextFile(sPath, &bIsDirectory, false))
+    {
+        const WIN32_FIND_DATA* pFindData = fileEnumerator.GetFileInfo();
+        CachedDirEntry         entry;
+        entry.name          = pFindData->cFileName;
+        entry.attributes    = pFindData->dwFileAttributes;
+        entry.size          = (static_cast<uint64_t>(pFindData->nFileSizeHigh) << 32) | pFindData->nFileSizeLow;
+        entry.lastWriteTime = pFindData->ftLastWriteTime;
+        listing->entries.push_back(std::move(entry));
+    }
+    return listing;
+}
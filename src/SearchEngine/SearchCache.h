@@ -0,0 +1,111 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/regex.hpp>
+
+class CSearchSnapshot;
+
+struct CachedDirEntry
+{
+    std::wstring name;
+    DWORD        attributes;
+    uint64_t     size;
+    FILETIME     lastWriteTime;
+};
+
+struct CachedDirListing
+{
+    // the last-write time of the directory itself when it was listed
+    FILETIME                    dirWriteTime;
+    std::vector<CachedDirEntry> entries;
+};
+
+// what a long running process (the search server) keeps between searches:
+// directory listings, compiled path filters and the results of the last
+// searches. The listings can also be saved to disk, so that a new process
+// does not have to list a large tree again.
+//
+// A listing is reused as long as the last-write time of its directory is
+// unchanged, which is the case until an entry is added, removed or renamed.
+// The size and time of files that are modified in place are not refreshed
+// before that: the search engine gets them from the file itself before it
+// searches it. The file contents are always read again.
+// All methods are thread safe.
+class CSearchCache
+{
+public:
+    explicit CSearchCache(size_t maxEntries = 4 * 1024 * 1024);
+
+    // the entries of dirPath, listed again if the directory changed or
+    // bForceList is set. Returns nullptr if the directory can not be read.
+    std::shared_ptr<const CachedDirListing> GetListing(const std::wstring& dirPath, bool bForceList = false);
+
+    // the compiled case insensitive regex the path filters use,
+    // nullptr if the pattern is not a valid regex
+    std::shared_ptr<const boost::wregex>    GetPathRegex(const std::wstring& pattern);
+
+    // the results of the last search stored with key, nullptr if there is none
+    std::shared_ptr<const CSearchSnapshot>  GetSnapshot(const std::wstring& key);
+    void                                    StoreSnapshot(const std::wstring& key, std::shared_ptr<const CSearchSnapshot> snapshot);
+
+    void                                    Clear();
+
+    // the listings of root and the directories below it are stored in one
+    // file per root in cacheDir. Load() keeps the listings already in memory,
+    // and returns false if there is no valid file for root.
+    bool                                    Load(const std::wstring& cacheDir, const std::wstring& root);
+    bool                                    Save(const std::wstring& cacheDir, const std::wstring& root);
+
+    // %LOCALAPPDATA%\grepWin\dircache on Windows, the XDG cache directory
+    // elsewhere. Empty if there is none.
+    static std::wstring                     DefaultPersistentDirectory();
+
+    uint64_t                                ListingHits() const { return m_listingHits; }
+    uint64_t                                ListingMisses() const { return m_listingMisses; }
+
+private:
+    static std::shared_ptr<CachedDirListing> ReadListing(const std::wstring& dirPath, const FILETIME& dirWriteTime);
+    static std::wstring                      PersistentFilePath(const std::wstring& cacheDir, const std::wstring& root);
+    void                                     StoreListing(const std::wstring& dirPath, std::shared_ptr<const CachedDirListing> listing);
+
+    std::mutex                                                        m_mutex;
+    std::map<std::wstring, std::shared_ptr<const CachedDirListing>>   m_listings;
+    std::map<std::wstring, std::shared_ptr<const boost::wregex>>      m_regexes;
+    std::map<std::wstring, std::shared_ptr<const CSearchSnapshot>>    m_snapshots;
+    // the cache is dropped when it grows beyond that many entries
+    size_t                                                            m_maxEntries;
+    size_t                                                            m_entryCount;
+
+    std::atomic<uint64_t>                                             m_listingHits   = 0;
+    std::atomic<uint64_t>                                             m_listingMisses = 0;
+};
+
+// compiles a path filter the way grepWinMatchI() uses it,
+// nullptr if the pattern is not a valid regex
+std::shared_ptr<const boost::wregex> CompilePathRegex(const std::wstring& pattern);
@@ -0,0 +1,2387 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "SearchEngine.h"
+#include "BufferPool.h"
+#include "CachedDirFileEnum.h"
+#include "DebugOutput.h"
+#include "DirFileEnum.h"
+#include "FileView.h"
+#include "MultiPatternMatcher.h"
+#include "PathUtils.h"
+#include "ReadAhead.h"
+#include "RegexReplaceFormatter.h"
+#include "SearchSnapshot.h"
+#include "StringUtils.h"
+#include "TextOffset.h"
+#include "ThreadPool.h"
+#include "UnicodeUtils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cwctype>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+#ifndef _WIN32
+#    include <fcntl.h>
+#    include <sys/stat.h>
+#endif
+
+#ifdef _MSC_VER
+#    pragma warning(push)
+#    pragma warning(disable : 4996) // warning STL4010: Various members of std::allocator are deprecated in C++17
+#endif
+#include <boost/regex.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#ifdef _MSC_VER
+#    pragma warning(pop)
+#endif
+
+void escapeForRegexEx(std::wstring& str, int type)
+{
+    const wchar_t* specialChar[17] = {
+        // oringinal
+        L"\\",
+        // regex special chars, current and future
+        L"^", L"$", L".", L"?", L"*", L"+", L"[", L"]", L"(", L")", L"{", L"}", L"|",
+        // command line special chars
+        L"\"", L" ", L"\t"};
+    const wchar_t* specialEscaped[17] = {
+        L"\\x5c",
+        L"\\^", L"\\$", L"\\.", L"\\?", L"\\*", L"\\+", L"\\[", L"\\]", L"\\(", L"\\)", L"\\{", L"\\}", L"\\|",
+        L"\\x22", L"\\x20", L"\\x09"};
+    int count;
+    switch (type)
+    {
+        case 1: // one line string as process argv
+            count = static_cast<int>(std::size(specialChar));
+            break;
+        default: // regex safe as text
+            count = 14;
+            break;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        SearchReplace(str, specialChar[i], specialEscaped[i]);
+    }
+}
+
+void escapeForReplaceText(std::wstring& str)
+{
+    const wchar_t* specialChar[6]    = {L"\\", L"$", L"(", L")", L"?", L","};
+    const wchar_t* specialEscaped[6] = {L"\\x5c", L"\\$", L"\\(", L"\\)", L"\\?", L"\\,"};
+    for (size_t i = 0; i < std::size(specialChar); ++i)
+    {
+        SearchReplace(str, specialChar[i], specialEscaped[i]);
+    }
+}
+
+void replaceGrepWinFilePathVariables(std::wstring& str, const std::wstring& filePath)
+{
+    // those variables are for regex mode only
+    std::wstring fullPath = filePath;
+    escapeForRegexEx(fullPath, 0);
+
+    std::wstring fileNameFull = filePath.substr(filePath.find_last_of(PathSeparator) + 1);
+    escapeForRegexEx(fileNameFull, 0);
+    std::wstring filename;
+    std::wstring fileExt;
+    auto         dotPos = fileNameFull.find_last_of(L'.');
+    if (dotPos != std::string::npos)
+    {
+        filename = fileNameFull.substr(0, dotPos - 1);
+        if (fileNameFull.size() > dotPos)
+        {
+            fileExt = fileNameFull.substr(dotPos + 1);
+        }
+    }
+    else
+    {
+        filename = fileNameFull;
+    }
+    SearchReplace(str, L"${filepath}", fullPath);
+    SearchReplace(str, L"${filename}", filename);
+    SearchReplace(str, L"${fileext}", fileExt);
+}
+
+// matches the whole of the input
+bool grepWinMatchI(const std::wstring& theRegex, const wchar_t* pText)
+{
+    try
+    {
+        boost::wregex  expression = boost::wregex(theRegex, boost::regex::normal | boost::regbase::icase);
+        boost::wcmatch whatc;
+        if (boost::regex_match(pText, whatc, expression))
+        {
+            return true;
+        }
+    }
+    catch (const std::exception&)
+    {
+    }
+    return false;
+}
+
+namespace
+{
+// bigger files are left to CTextFile, which maps those it can not convert
+constexpr __int64 maxInPlaceSize = 64 * 1024 * 1024;
+// files up to that size are searched in batches, so that the cost of a task
+// and of reporting a result is paid once for many of them
+constexpr uint64_t maxBatchedFileSize = 4 * 1024;
+constexpr size_t   maxBatchFiles      = 64;
+
+// grepWinMatchI() with the regex compiled once per search
+bool MatchPathRegex(const std::shared_ptr<const boost::wregex>& expression, const wchar_t* pText)
+{
+    if (!expression)
+        return false;
+    try
+    {
+        boost::wcmatch whatc;
+        return boost::regex_match(pText, whatc, *expression);
+    }
+    catch (const std::exception&)
+    {
+    }
+    return false;
+}
+
+std::wstring utf16Swap(const std::wstring& str)
+{
+    std::wstring swapped = str;
+    for (size_t i = 0; i < swapped.length(); ++i)
+    {
+        swapped[i] = static_cast<wchar_t>(((swapped[i] << 8) & 0xff00) | ((swapped[i] >> 8) & 0xff));
+    }
+    return swapped;
+}
+
+// the UTF-16 code units of a string as bytes, independent of the size of wchar_t
+std::string utf16Bytes(const std::wstring& str, bool bigEndian)
+{
+    std::string bytes;
+    bytes.reserve(str.length() * 2);
+    auto putUnit = [&](unsigned int unit) {
+        bytes.push_back(static_cast<char>(bigEndian ? unit >> 8 : unit & 0xff));
+        bytes.push_back(static_cast<char>(bigEndian ? unit & 0xff : unit >> 8));
+    };
+    for (wchar_t c : str)
+    {
+        auto cp = static_cast<unsigned int>(c);
+        if (cp >= 0x10000)
+        {
+            cp -= 0x10000;
+            putUnit(0xD800 + (cp >> 10));
+            putUnit(0xDC00 + (cp & 0x3FF));
+        }
+        else
+            putUnit(cp & 0xffff);
+    }
+    return bytes;
+}
+
+std::wstring utf16FromBytes(const std::string& bytes, bool bigEndian)
+{
+    std::wstring str;
+    str.reserve(bytes.length() / 2);
+    for (size_t i = 0; i + 1 < bytes.length(); i += 2)
+    {
+        auto lo = static_cast<unsigned char>(bytes[i]);
+        auto hi = static_cast<unsigned char>(bytes[i + 1]);
+        auto unit = static_cast<unsigned int>(bigEndian ? (lo << 8 | hi) : (hi << 8 | lo));
+        if constexpr (sizeof(wchar_t) > 2)
+        {
+            if (unit >= 0xDC00 && unit < 0xE000 && !str.empty())
+            {
+                auto high = static_cast<unsigned int>(str.back());
+                if (high >= 0xD800 && high < 0xDC00)
+                {
+                    str.back() = static_cast<wchar_t>(0x10000 + ((high - 0xD800) << 10) + (unit - 0xDC00));
+                    continue;
+                }
+            }
+        }
+        str.push_back(static_cast<wchar_t>(unit));
+    }
+    return str;
+}
+
+std::wstring ConvertToWstring(const std::string& str, CTextFile::UnicodeType encoding)
+{
+    std::wstring strW;
+    switch (encoding)
+    {
+        case CTextFile::Ansi:
+            strW = MultibyteToWide(str);
+            break;
+        case CTextFile::UTF8:
+            strW = UTF8ToWide(str);
+            break;
+        default:
+            strW = utf16FromBytes(str, encoding == CTextFile::Unicode_Be);
+            break;
+    }
+    return strW;
+}
+
+template <typename CharT = char>
+std::basic_string<CharT> ConvertToString(const std::wstring& /*str*/, CTextFile::UnicodeType /*encoding*/, CharT* /*dummy*/ = nullptr)
+{
+    return {};
+}
+
+template <>
+std::basic_string<char> ConvertToString<char>(const std::wstring& str, CTextFile::UnicodeType encoding, char*)
+{
+    switch (encoding)
+    {
+        case CTextFile::Unicode_Le:
+            return utf16Bytes(str, false);
+        case CTextFile::Unicode_Be:
+            return utf16Bytes(str, true);
+        case CTextFile::Ansi:
+            return CUnicodeUtils::StdGetANSI(str);
+        case CTextFile::UTF8:
+            return CUnicodeUtils::StdGetUTF8(str);
+        default:
+            return "";
+    }
+}
+
+#ifdef _WIN32
+// for the UTF-16 search, which only Windows builds
+template <>
+std::basic_string<wchar_t> ConvertToString<wchar_t>(const std::wstring& str, CTextFile::UnicodeType encoding, wchar_t*)
+{
+    if (encoding == CTextFile::Unicode_Be)
+        return utf16Swap(str);
+    return str;
+}
+#endif
+
+struct FileTimes
+{
+    FILETIME creationTime{};
+    FILETIME lastAccessTime{};
+    FILETIME lastWriteTime{};
+};
+
+bool GetFileTimes(const std::wstring& path, FileTimes& times)
+{
+#ifdef _WIN32
+    HANDLE hFile = CreateFile(path.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    bool bOk = GetFileTime(hFile, &times.creationTime, &times.lastAccessTime, &times.lastWriteTime);
+    CloseHandle(hFile);
+    return bOk;
+#else
+    struct stat st{};
+    if (stat(PlatformPath(path).c_str(), &st) != 0)
+        return false;
+    times.lastAccessTime = UnixTimeToFileTime(st.st_atim.tv_sec, st.st_atim.tv_nsec);
+    times.lastWriteTime  = UnixTimeToFileTime(st.st_mtim.tv_sec, st.st_mtim.tv_nsec);
+    return true;
+#endif
+}
+
+bool SetFileTimes(const std::wstring& path, const FileTimes& times)
+{
+#ifdef _WIN32
+    HANDLE hFile = CreateFile(path.c_str(), FILE_WRITE_ATTRIBUTES, FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
+    bool   bOk   = hFile != INVALID_HANDLE_VALUE;
+    if (bOk)
+    {
+        // The NTFS file system delays updates to the last access time for a file by up to 1 hour after the last access.
+        bOk = SetFileTime(hFile, &times.creationTime, &times.lastAccessTime, &times.lastWriteTime);
+        CloseHandle(hFile);
+    }
+    return bOk;
+#else
+    struct timespec ts[2];
+    int64_t         sec  = 0;
+    int64_t         nsec = 0;
+    FileTimeToUnixTime(times.lastAccessTime, sec, nsec);
+    ts[0].tv_sec  = sec;
+    ts[0].tv_nsec = nsec;
+    FileTimeToUnixTime(times.lastWriteTime, sec, nsec);
+    ts[1].tv_sec  = sec;
+    ts[1].tv_nsec = nsec;
+    return utimensat(AT_FDCWD, PlatformPath(path).c_str(), ts, 0) == 0;
+#endif
+}
+
+// text with neither null bytes nor bytes >= 0x80 reads the same in every
+// encoding CTextFile detects for it, and is searched without converting it
+bool IsSevenBitText(const char* data, size_t size)
+{
+    constexpr uint64_t highBits = 0x8080808080808080ULL;
+    constexpr uint64_t lowBits  = 0x0101010101010101ULL;
+    size_t             i        = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        // a high bit set, or a null byte
+        if ((word & highBits) || ((word - lowBits) & ~word & highBits))
+            return false;
+    }
+    for (; i < size; ++i)
+    {
+        if (data[i] == 0 || (data[i] & 0x80))
+            return false;
+    }
+    return true;
+}
+
+// whether a file found to have that encoding before can be 7-bit text:
+// 7-bit text is never found to be UTF-16 or binary
+bool MayBeSevenBitText(CTextFile::UnicodeType encoding)
+{
+    return encoding == CTextFile::AutoType || encoding == CTextFile::Ansi || encoding == CTextFile::UTF8;
+}
+
+bool IsSevenBitString(const std::wstring& text)
+{
+    return std::ranges::all_of(text, [](wchar_t c) { return c > 0 && c < 0x80; });
+}
+
+std::string SevenBitToString(const std::wstring& text)
+{
+    std::string result(text.size(), '\0');
+    std::ranges::transform(text, result.begin(), [](wchar_t c) { return static_cast<char>(c); });
+    return result;
+}
+
+std::wstring SevenBitToWstring(const char* begin, const char* end)
+{
+    std::wstring result(end - begin, L'\0');
+    std::transform(begin, end, result.begin(), [](char c) { return static_cast<wchar_t>(c); });
+    return result;
+}
+
+// the line starts of a text, found only as far as the matches need them.
+// Lines end like CTextFile ends them: at "\r\n", "\n" or "\r".
+// lineStarts is only borrowed, to reuse its memory for the next file.
+class CLazyLineIndex
+{
+public:
+    CLazyLineIndex(const char* text, size_t size, std::vector<size_t>& lineStarts)
+        : m_text(text)
+        , m_size(size)
+        , m_scanned(0)
+        , m_lineStarts(lineStarts)
+    {
+        m_lineStarts.assign(1, 0);
+    }
+
+    // 1-based, like CTextFile::LineFromPosition()
+    long LineFromPosition(size_t pos)
+    {
+        ScanUntil([&]() { return m_scanned >= pos; });
+        auto it = std::upper_bound(m_lineStarts.begin(), m_lineStarts.end(), pos);
+        return static_cast<long>(std::distance(m_lineStarts.begin(), it));
+    }
+
+    long ColumnFromPosition(size_t pos, long line) const
+    {
+        return static_cast<long>(pos - m_lineStarts[line - 1]) + 1;
+    }
+
+    // whether the text has the line. A line ending at the end of the text
+    // does not start another line.
+    bool HasLine(long line)
+    {
+        ScanUntil([&]() { return m_lineStarts.size() >= static_cast<size_t>(line); });
+        return line >= 1 && static_cast<size_t>(line) <= m_lineStarts.size() && (line == 1 || m_lineStarts[line - 1] < m_size);
+    }
+
+    // the line without its line ending, as the wide string CTextFile::GetLineString() returns
+    std::wstring GetLineString(long line)
+    {
+        ScanUntil([&]() { return m_lineStarts.size() > static_cast<size_t>(line); });
+        size_t start = m_lineStarts[line - 1];
+        size_t end   = static_cast<size_t>(line) < m_lineStarts.size() ? m_lineStarts[line] : m_size;
+        while (end > start && (m_text[end - 1] == '\n' || m_text[end - 1] == '\r'))
+            --end;
+        return SevenBitToWstring(m_text + start, m_text + end);
+    }
+
+private:
+    template <typename Pred>
+    void ScanUntil(Pred done)
+    {
+        while (m_scanned < m_size && !done())
+        {
+            char c = m_text[m_scanned++];
+            if (c == '\r')
+            {
+                if (m_scanned < m_size && m_text[m_scanned] == '\n')
+                    ++m_scanned;
+                m_lineStarts.push_back(m_scanned);
+            }
+            else if (c == '\n')
+                m_lineStarts.push_back(m_scanned);
+        }
+    }
+
+    const char*          m_text;
+    size_t               m_size;
+    size_t               m_scanned;
+    std::vector<size_t>& m_lineStarts;
+};
+
+// the current size and last-write time of a file, false if it is gone
+bool ReadFileData(const std::wstring& path, uint64_t& fileSize, FILETIME& lastWriteTime)
+{
+    WIN32_FILE_ATTRIBUTE_DATA fileData = {};
+    if (!GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &fileData))
+        return false;
+    fileSize      = (static_cast<uint64_t>(fileData.nFileSizeHigh) << 32) | fileData.nFileSizeLow;
+    lastWriteTime = fileData.ftLastWriteTime;
+    return true;
+}
+
+// when the search of the file the thread is busy with has to stop,
+// see SearchOptions::regexTimeout
+thread_local std::chrono::steady_clock::time_point fileDeadline = std::chrono::steady_clock::time_point::max();
+
+class CSearchTimeout : public std::runtime_error
+{
+public:
+    CSearchTimeout()
+        : std::runtime_error("timeout: searching the file took too long")
+    {
+    }
+};
+
+// the characters boost searches at once while a file has a deadline
+constexpr std::ptrdiff_t deadlineWindowSize = 1024 * 1024;
+
+bool HasDeadline()
+{
+    return fileDeadline != std::chrono::steady_clock::time_point::max();
+}
+
+// called before every search for the next match
+void CheckDeadline()
+{
+    if (HasDeadline() && std::chrono::steady_clock::now() > fileDeadline)
+        throw CSearchTimeout();
+}
+
+// boost::regex_search(), which can't be interrupted. While the file has a
+// deadline, [first, last) is searched in windows of whole lines with the
+// deadline checked between them, so that a search which finds nothing
+// can't take longer than about one window. The windows find the same match
+// as a search of all of [first, last):
+// - a start where a match would need the text after the window is found
+//   as a partial match, and the next window begins there
+// - a match found in a window is matched again at its start in all of the
+//   text, as it could be cut by the window or only match because of its end
+template <typename Iter, typename Regex>
+bool RegexSearchWithDeadline(Iter first, Iter last, boost::match_results<Iter>& what, const Regex& regEx, boost::match_flag_type flags, Iter base)
+{
+    CheckDeadline();
+    std::ptrdiff_t windowSize = deadlineWindowSize;
+    while (HasDeadline() && last - first > windowSize)
+    {
+        Iter limit     = first + std::min<std::ptrdiff_t>(last - first, 2 * windowSize);
+        Iter windowEnd = std::find(first + windowSize, limit, '\n');
+        if (windowEnd != limit)
+            ++windowEnd;
+        if (windowEnd == last)
+            break;
+        // the text after the window is not the end of a line
+        Iter next = windowEnd;
+        if (boost::regex_search(first, windowEnd, what, regEx, flags | boost::match_not_eol | boost::match_partial, base))
+        {
+            next = what[0].first;
+            if (what[0].matched)
+            {
+                auto startFlags = next == first ? flags : flags | boost::match_prev_avail | boost::match_not_bob;
+                if (boost::regex_search(next, last, what, regEx, startFlags | boost::match_continuous, base))
+                    return true;
+                // no match there in all of the text
+                ++next;
+            }
+        }
+        // a partial match at the start of the window needs a bigger one
+        windowSize = next == first ? 2 * windowSize : deadlineWindowSize;
+        if (next != first)
+        {
+            first = next;
+            flags |= boost::match_prev_avail;
+            flags |= boost::match_not_bob;
+        }
+        CheckDeadline();
+    }
+    return boost::regex_search(first, last, what, regEx, flags, base);
+}
+
+// boost giving up after too many steps. It throws a plain runtime_error
+// with the message of the error code then, not a regex_error.
+bool IsTooComplex(const std::exception& ex)
+{
+    static const std::string complexity = boost::regex_traits<char>().error_string(boost::regex_constants::error_complexity);
+    static const std::string stack      = boost::regex_traits<char>().error_string(boost::regex_constants::error_stack);
+    return dynamic_cast<const boost::regex_error*>(&ex) == nullptr && (ex.what() == complexity || ex.what() == stack);
+}
+
+bool IsTimeout(const std::exception& ex)
+{
+    return dynamic_cast<const CSearchTimeout*>(&ex) != nullptr || IsTooComplex(ex);
+}
+
+// records why the search of a file failed. Running out of time and boost
+// giving up after too many steps are both reported as a timeout.
+void RecordException(CSearchInfo& sInfo, const std::exception& ex)
+{
+    sInfo.timedOut  = IsTimeout(ex);
+    sInfo.exception = IsTooComplex(ex) ? std::wstring(L"timeout: the regular expression took too many steps") : CUnicodeUtils::StdGetUnicode(ex.what());
+}
+
+// whether the text of textFile has the line
+bool HasLine(const CTextFile& textFile, long line)
+{
+    const auto& text = textFile.GetFileString();
+    return line >= 1 && !text.empty() && line <= textFile.LineFromPosition(static_cast<long>(text.size()) - 1);
+}
+
+bool HasLine(CLazyLineIndex& lineIndex, long line)
+{
+    return lineIndex.HasLine(line);
+}
+
+// context lines are cut to that many characters
+constexpr size_t maxContextLineLength = 4096;
+
+// adds the lines around the match lines to sInfo, SearchOptions::contextLines
+// before and after each. Once for every line, also where the windows of two
+// matches overlap. getLine(line, text) sets the text of a line and returns
+// false after the last line.
+template <typename GetLine>
+void AddContextLines(CSearchInfo& sInfo, const SearchOptions& options, GetLine getLine)
+{
+    if (options.contextLines == 0 || options.captureSearch || sInfo.matchLinesNumbers.empty())
+        return;
+    std::vector<DWORD>        sortedLines;
+    const std::vector<DWORD>* lines = &sInfo.matchLinesNumbers;
+    if (!std::ranges::is_sorted(*lines))
+    {
+        sortedLines = *lines;
+        std::ranges::sort(sortedLines);
+        lines = &sortedLines;
+    }
+    DWORD        next = 1; // the first line which may still be added
+    std::wstring text;
+    for (DWORD line : *lines)
+    {
+        DWORD first = std::max(next, line > options.contextLines ? line - options.contextLines : 1);
+        DWORD last  = line + options.contextLines;
+        for (DWORD l = first; l <= last; ++l)
+        {
+            if (!getLine(static_cast<long>(l), text))
+                return; // so are the lines of the matches after it
+            if (text.size() > maxContextLineLength)
+                text.resize(maxContextLineLength);
+            sInfo.AddContextLine(l, text);
+        }
+        next = std::max(next, last + 1);
+    }
+}
+
+// AddContextLines() for the lines of CTextFile and CLazyLineIndex
+template <typename Lines>
+void AddContextLinesOf(CSearchInfo& sInfo, const SearchOptions& options, Lines& lines)
+{
+    AddContextLines(sInfo, options, [&](long line, std::wstring& text) {
+        if (!HasLine(lines, line))
+            return false;
+        text = lines.GetLineString(line);
+        return true;
+    });
+}
+
+// match lines up to that many characters are kept whole. Of a longer line
+// only an excerpt is kept: excerptBefore characters before the match, up to
+// excerptMatch of the match and excerptAfter after it.
+constexpr size_t maxMatchLineLength = 4096;
+constexpr size_t excerptBefore      = 100;
+constexpr size_t excerptMatch       = 1024;
+constexpr size_t excerptAfter       = 100;
+
+// bBigEndian: text is UTF-16 in the other byte order
+template <typename CharT>
+bool IsLineBreak(CharT c, bool bBigEndian)
+{
+    if constexpr (sizeof(CharT) > 1)
+    {
+        if (bBigEndian)
+            return c == 0x0d00 || c == 0x0a00;
+    }
+    return c == '\r' || c == '\n';
+}
+
+// whether c continues a character and an excerpt must not start or end before it
+template <typename CharT>
+bool IsTrailUnit(CharT c, bool bBigEndian)
+{
+    if constexpr (sizeof(CharT) == 1)
+        return (static_cast<unsigned char>(c) & 0xC0) == 0x80; // UTF-8
+    else
+        return ((bBigEndian ? ((c >> 8) | ((c & 0xFF) << 8)) : c) & 0xFC00) == 0xDC00; // a low surrogate
+}
+
+// the length of the part of a match of matchLength at matchPos which is in its line
+template <typename CharT>
+size_t MatchLengthInLine(const CharT* text, size_t size, size_t matchPos, size_t matchLength, bool bBigEndian)
+{
+    size_t matchEnd = std::min(size, matchPos + matchLength);
+    size_t pos      = matchPos;
+    while (pos < matchEnd && !IsLineBreak(text[pos], bBigEndian))
+        ++pos;
+    return pos - matchPos;
+}
+
+// sets line to the text of the match line for CSearchInfo::matchLines: the
+// line which starts at lineBegin in text, and has a match of matchLength at
+// matchPos. A long line is cut to an excerpt around the match, with
+// CSearchInfo::excerptMark where it goes on. Only reads as much of the
+// text as it keeps, however long the line is.
+// convert(begin, end) converts the characters of text to a wide string.
+// Returns where the kept text starts, lineBegin for a line kept from its start.
+template <typename CharT, typename Convert>
+size_t MatchLineExcerpt(const CharT* text, size_t size, size_t lineBegin, size_t matchPos, size_t matchLength, bool bBigEndian, std::wstring& line, Convert convert)
+{
+    size_t shownEnd  = std::min(size, matchPos + std::min(matchLength, excerptMatch) + excerptAfter);
+    size_t scanLimit = std::min(size, std::max(lineBegin + maxMatchLineLength, shownEnd));
+    size_t lineEnd   = matchPos;
+    while (lineEnd < scanLimit && !IsLineBreak(text[lineEnd], bBigEndian))
+        ++lineEnd;
+    bool bLongLine = lineEnd == scanLimit && scanLimit < size && !IsLineBreak(text[scanLimit], bBigEndian);
+    if (!bLongLine && lineEnd - lineBegin <= maxMatchLineLength)
+    {
+        line = convert(text + lineBegin, text + lineEnd);
+        return lineBegin;
+    }
+    size_t begin = matchPos - lineBegin > excerptBefore ? matchPos - excerptBefore : lineBegin;
+    size_t end   = std::min(lineEnd, shownEnd);
+    // not in the middle of a character: at most three units to skip
+    for (int i = 0; i < 3 && begin > lineBegin && begin < matchPos && IsTrailUnit(text[begin], bBigEndian); ++i)
+        ++begin;
+    for (int i = 0; i < 3 && end < lineEnd && end > matchPos && IsTrailUnit(text[end], bBigEndian); ++i)
+        --end;
+    line.clear();
+    if (begin > lineBegin)
+        line += CSearchInfo::excerptMark;
+    line += convert(text + begin, text + end);
+    if (end < lineEnd || bLongLine)
+        line += CSearchInfo::excerptMark;
+    return begin;
+}
+
+// adds the lines of a match which starts at matchPos in text, in column
+// colMatch of line lineStart and ends in line lineEnd, with its length
+// split over them. Long lines are kept as excerpts, see MatchLineExcerpt().
+template <typename CharT, typename Convert>
+void AddMatchLines(CSearchInfo& sInfo, const CharT* text, size_t size, size_t matchPos, long lineStart, long lineEnd, long colMatch, long lenMatch, Convert convert)
+{
+    size_t       lineBegin = matchPos - (colMatch - 1);
+    size_t       pos       = matchPos;
+    std::wstring line;
+    for (long l = lineStart; l <= lineEnd; ++l)
+    {
+        long   lenLineMatch = static_cast<long>(MatchLengthInLine(text, size, pos, std::max(lenMatch, 0L), false));
+        size_t begin        = MatchLineExcerpt(text, size, lineBegin, pos, lenLineMatch, false, line, convert);
+        sInfo.matchLines.push_back(line);
+        sInfo.matchLinesNumbers.push_back(l);
+        sInfo.matchColumnsNumbers.push_back(colMatch);
+        sInfo.matchLengths.push_back(lenLineMatch);
+        if (begin > lineBegin)
+            sInfo.SetExcerptStart(static_cast<DWORD>(colMatch - (pos - begin)));
+        if (lenMatch > lenLineMatch)
+        {
+            colMatch = 1;
+            lenMatch -= lenLineMatch;
+        }
+        if (l == lineEnd)
+            break;
+        // the match goes on after the line break
+        pos += lenLineMatch;
+        if (pos < size && text[pos] == '\r')
+            ++pos;
+        if (pos < size && text[pos] == '\n')
+            ++pos;
+        lineBegin = pos;
+    }
+}
+} // namespace
+
+CSearchEngine::CSearchEngine(const SearchOptions& options, ISearchResultSink& sink, const CCancellationToken& cancelToken, CSearchCache* cache)
+    : m_options(options)
+    , m_sink(sink)
+    , m_cancelToken(cancelToken)
+    , m_cancelled(cancelToken.Flag())
+    , m_cache(cache)
+    , m_previousSnapshot(nullptr)
+    , m_nextSnapshot(nullptr)
+    , m_resultCount(0)
+    , m_quotaReached(false)
+{
+    // a replace has to find every match
+    if (m_options.replace)
+    {
+        m_options.listOnly          = false;
+        m_options.maxMatchesPerFile = 0;
+        m_options.maxResults        = 0;
+    }
+    if (!m_options.searchPatterns.empty())
+        m_patternMatcher = std::make_shared<const CMultiPatternMatcher>(m_options.searchPatterns, m_options.caseSensitive, m_options.wholeWords);
+    // the path filters are matched against every enumerated entry
+    if (m_options.useRegexForPaths && !m_options.fileNameRegex.empty())
+        m_fileNameRegex = m_cache ? m_cache->GetPathRegex(m_options.fileNameRegex) : CompilePathRegex(m_options.fileNameRegex);
+    if (!m_options.excludeDirsRegex.empty())
+        m_excludeDirsRegex = m_cache ? m_cache->GetPathRegex(m_options.excludeDirsRegex) : CompilePathRegex(m_options.excludeDirsRegex);
+    if (!m_options.useRegex)
+    {
+        if (!m_options.searchString.empty())
+        {
+            escapeForRegexEx(m_options.searchString, 0);
+            SearchReplace(m_options.searchString, L"\r\n", L"(?:\\n|\\r|\\r\\n)"); // multi-line
+        }
+        if (m_options.replace && !m_options.replaceString.empty())
+        {
+            escapeForReplaceText(m_options.replaceString);
+        }
+    }
+}
+
+void CSearchEngine::SetSnapshots(const CSearchSnapshot* previous, CSearchSnapshot* next)
+{
+    // a replace changes the files, and with keepFileDate
+    // not even their time
+    if (m_options.replace)
+        return;
+    m_nextSnapshot     = next;
+    m_previousSnapshot = (previous && next && previous->QueryKey() == next->QueryKey()) ? previous : nullptr;
+}
+
+std::vector<std::wstring> CSearchEngine::SplitFilePatterns(const std::wstring& mask)
+{
+    // split the pattern string into single patterns and
+    // add them to an array
+    std::vector<std::wstring> patterns;
+    if (mask.empty())
+        return patterns;
+    const auto*               pBuf = mask.c_str();
+    size_t                    pos  = 0;
+    do
+    {
+        pos            = wcscspn(pBuf, L"|");
+        std::wstring s = std::wstring(pBuf, pos);
+        if (!s.empty())
+        {
+            std::ranges::transform(s, s.begin(), ::towlower);
+            patterns.push_back(s);
+            auto endPart = s.rbegin();
+            if (*endPart == '*' && s.size() > 2)
+            {
+                ++endPart;
+                if (*endPart == '.')
+                {
+                    patterns.push_back(s.substr(0, s.size() - 2));
+                }
+            }
+        }
+        pBuf += pos;
+        pBuf++;
+    } while (*pBuf && (*(pBuf - 1)));
+    return patterns;
+}
+
+/* rules:
+    1. treat dir as special file
+    2. no limits on user specified files
+    3. search empty means counting only mode
+    4. real search/replace does not check dir size nor date
+*/
+void CSearchEngine::Run()
+{
+    ProfileTimer profile(L"SearchThread");
+
+    m_sink.OnSearchStart();
+
+    ThreadPool tp(ThreadCount());
+    bool       bCountingOnly = m_options.searchString.empty() && m_options.searchPatterns.empty();
+
+    for (const auto& cSearchPath : m_options.searchPaths)
+    {
+        // pre-cleaned for history
+        if (cSearchPath.empty() || !PathFileExists(cSearchPath.c_str()))
+            continue;
+
+        bool         bHasLimits;
+        std::wstring searchRoot;
+        if (PathIsDirectory(cSearchPath.c_str()))
+        {
+            bHasLimits = true;
+            searchRoot = cSearchPath;
+        }
+        else
+        {
+            bHasLimits = false;
+            searchRoot = cSearchPath.substr(0, cSearchPath.find_last_of(PathSeparator));
+        }
+
+        // the cache only holds directory listings
+        if (m_cache && bHasLimits)
+        {
+            CCachedDirFileEnum fileEnumerator(*m_cache, cSearchPath, m_options.forceFullWalk);
+            EnumerateSearchPath(fileEnumerator, cSearchPath, searchRoot, bHasLimits, bCountingOnly, tp);
+        }
+        else
+        {
+            CDirFileEnum fileEnumerator(cSearchPath.c_str());
+            EnumerateSearchPath(fileEnumerator, cSearchPath, searchRoot, bHasLimits, bCountingOnly, tp);
+        }
+    }
+
+    tp.waitFinished();
+    m_sink.OnSearchEnd();
+}
+
+template <typename DirEnum>
+void CSearchEngine::EnumerateSearchPath(DirEnum& fileEnumerator, const std::wstring& cSearchPath, const std::wstring& searchRoot, bool bHasLimits, bool bCountingOnly, ThreadPool& tp)
+{
+    if (!m_options.includeSymLinks)
+        fileEnumerator.SetAttributesToIgnore(FILE_ATTRIBUTE_REPARSE_POINT);
+    bool                          bRecurse     = bHasLimits && m_options.includeSubfolders;
+    bool                          bIsDirectory = false;
+    std::wstring                  sPath;
+    std::vector<SearchFileResult> batch;
+
+    auto                          flushBatch = [&]() {
+        if (batch.empty())
+            return;
+        auto batchFn = [this, batch, searchRoot]() mutable {
+            SearchBatch(batch, searchRoot);
+        };
+        tp.enqueueWait(std::move(batchFn));
+        batch.clear();
+    };
+
+    while ((fileEnumerator.NextFile(sPath, &bIsDirectory, bRecurse)) && !m_cancelled && !m_quotaReached)
+    {
+        if (IsBackupOrTempFile(sPath))
+            continue;
+
+        const WIN32_FIND_DATA* pFindData    = fileEnumerator.GetFileInfo();
+        FILETIME               fileTime     = pFindData->ftLastWriteTime;
+        uint64_t               fullFileSize = (static_cast<uint64_t>(pFindData->nFileSizeHigh) << 32) | pFindData->nFileSizeLow;
+
+        bool                   bSearch      = true;
+
+        if (bHasLimits)
+        {
+            bSearch = HasIncludedAttributes(pFindData->dwFileAttributes);
+            if (bSearch)
+            {
+                if (bIsDirectory)
+                {
+                    if (m_options.includeSubfolders)
+                    {
+                        // dir not excluded
+                        bSearch = !IsExcludedDir(sPath, pFindData->cFileName, cSearchPath);
+                    }
+                    else
+                    {
+                        bSearch = false;
+                    }
+                    bRecurse = bSearch;
+                    if (bSearch && !m_options.fileNameRegex.empty())
+                    {
+                        bSearch = false;
+                    }
+                }
+                else
+                {
+                    // name match
+                    bSearch  = MatchPath(sPath.c_str());
+                    bRecurse = false;
+                    if constexpr (std::is_same_v<DirEnum, CCachedDirFileEnum>)
+                    {
+                        // a cached listing still has the size and time the file
+                        // had when its folder last changed
+                        if (bSearch)
+                            bSearch = ReadFileData(sPath, fullFileSize, fileTime);
+                    }
+                }
+
+                if (bSearch && (!bIsDirectory || bCountingOnly))
+                {
+                    bSearch = IsInLimits(fullFileSize, fileTime);
+                }
+            }
+        }
+
+        if (bSearch)
+        {
+            CSearchInfo sInfo(sPath);
+            sInfo.modifiedTime = fileTime;
+            sInfo.folder       = bIsDirectory;
+            sInfo.fileSize     = fullFileSize;
+            if (bCountingOnly)
+            {
+                m_sink.OnFileResult(sInfo, true, true);
+            }
+            else if (!bIsDirectory)
+            {
+                int nCount = 0;
+                if (m_previousSnapshot && m_previousSnapshot->Find(sPath, fullFileSize, fileTime, sInfo, nCount))
+                {
+                    SendResult(sInfo, nCount);
+                    continue;
+                }
+                if (fullFileSize <= maxBatchedFileSize)
+                {
+                    batch.push_back({std::move(sInfo)});
+                    if (batch.size() >= maxBatchFiles)
+                        flushBatch();
+                    continue;
+                }
+                auto searchFn = [=, this]() {
+                    SearchFile(sInfo, searchRoot);
+                };
+                tp.enqueueWait(searchFn);
+            }
+        }
+        else if (!bIsDirectory || (bCountingOnly && m_options.fileNameRegex.empty()))
+        {
+            m_sink.OnFileSkipped();
+        }
+    }
+    flushBatch();
+}
+
+void CSearchEngine::SearchChangedFiles(const std::vector<std::wstring>& paths)
+{
+    // files are never replaced in just because they changed
+    if (m_options.replace)
+        return;
+
+    ThreadPool tp(ThreadCount());
+    bool       bCountingOnly = m_options.searchString.empty() && m_options.searchPatterns.empty();
+    // SearchOptions::maxResults applies to each round of changes
+    m_resultCount  = 0;
+    m_quotaReached = false;
+
+    for (const auto& path : paths)
+    {
+        if (m_cancelled)
+            break;
+        std::wstring cSearchPath;
+        bool         bHasLimits = false;
+        if (!FindSearchPath(path, cSearchPath, bHasLimits))
+            continue;
+
+        WIN32_FILE_ATTRIBUTE_DATA fileData = {};
+        if (!GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &fileData))
+        {
+            m_sink.OnFileRemoved(path);
+            continue;
+        }
+        if (fileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            // a new or renamed folder: the files in it were not reported on their own
+            if (!IsSearchedDir(path, cSearchPath))
+            {
+                m_sink.OnFileRemoved(path);
+                continue;
+            }
+            CDirFileEnum fileEnumerator(path.c_str());
+            EnumerateSearchPath(fileEnumerator, cSearchPath, cSearchPath, bHasLimits, bCountingOnly, tp);
+            continue;
+        }
+        if (IsBackupOrTempFile(path))
+            continue;
+
+        uint64_t fullFileSize = (static_cast<uint64_t>(fileData.nFileSizeHigh) << 32) | fileData.nFileSizeLow;
+        bool     bSearch      = true;
+        if (bHasLimits)
+        {
+            bSearch = IsSearchedDir(path.substr(0, path.find_last_of(PathSeparator)), cSearchPath) &&
+                      HasIncludedAttributes(fileData.dwFileAttributes) &&
+                      (m_options.includeSymLinks || (fileData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) == 0) &&
+                      MatchPath(path.c_str()) &&
+                      IsInLimits(fullFileSize, fileData.ftLastWriteTime);
+        }
+        if (!bSearch)
+        {
+            m_sink.OnFileRemoved(path);
+            continue;
+        }
+
+        CSearchInfo sInfo(path);
+        sInfo.modifiedTime = fileData.ftLastWriteTime;
+        sInfo.fileSize     = fullFileSize;
+        if (bCountingOnly)
+        {
+            m_sink.OnFileResult(sInfo, true, true);
+        }
+        else
+        {
+            std::wstring searchRoot = bHasLimits ? cSearchPath : cSearchPath.substr(0, cSearchPath.find_last_of(PathSeparator));
+            auto         searchFn   = [=, this]() {
+                SearchFile(sInfo, searchRoot);
+            };
+            tp.enqueueWait(searchFn);
+        }
+    }
+
+    tp.waitFinished();
+}
+
+void CSearchEngine::SearchFiles(const std::vector<CSearchInfo>& files)
+{
+    ProfileTimer profile(L"SearchFiles");
+
+    m_sink.OnSearchStart();
+
+    ThreadPool                    tp(ThreadCount());
+    bool                          bCountingOnly = m_options.searchString.empty() && m_options.searchPatterns.empty();
+    std::vector<SearchFileResult> batch;
+    std::wstring                  batchRoot;
+
+    auto                          flushBatch = [&]() {
+        if (batch.empty())
+            return;
+        auto batchFn = [this, batch, batchRoot]() mutable {
+            SearchBatch(batch, batchRoot);
+        };
+        tp.enqueueWait(std::move(batchFn));
+        batch.clear();
+    };
+
+    for (const auto& file : files)
+    {
+        if (m_cancelled || m_quotaReached)
+            break;
+        // folders are only results of a search for names
+        if (file.folder && !bCountingOnly)
+            continue;
+
+        WIN32_FILE_ATTRIBUTE_DATA fileData = {};
+        if (!GetFileAttributesEx(file.filePath.c_str(), GetFileExInfoStandard, &fileData))
+            continue;
+
+        FILETIME    fileTime     = fileData.ftLastWriteTime;
+        uint64_t    fullFileSize = (static_cast<uint64_t>(fileData.nFileSizeHigh) << 32) | fileData.nFileSizeLow;
+        CSearchInfo sInfo(file.filePath);
+        sInfo.modifiedTime = fileTime;
+        sInfo.fileSize     = fullFileSize;
+        sInfo.folder       = (fileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        if (bCountingOnly)
+        {
+            m_sink.OnFileResult(sInfo, true, true);
+            continue;
+        }
+        if (sInfo.folder)
+            continue;
+        // an unchanged file still has the encoding it was found with. Which of
+        // ANSI and UTF-8 it is depends on SearchOptions::utf8, and the check
+        // is quick, so only UTF-16 and binary files skip it.
+        bool bUnchanged = static_cast<uint64_t>(file.fileSize) == fullFileSize && CompareFileTime(&fileTime, &file.modifiedTime) == 0;
+        if (bUnchanged && !MayBeSevenBitText(file.encoding))
+            sInfo.encoding = file.encoding;
+
+        int nCount = 0;
+        if (m_previousSnapshot && m_previousSnapshot->Find(file.filePath, fullFileSize, fileTime, sInfo, nCount))
+        {
+            SendResult(sInfo, nCount);
+            continue;
+        }
+        // like a single file search path, the folder of the file is the root
+        std::wstring searchRoot = sInfo.filePath.substr(0, sInfo.filePath.find_last_of(PathSeparator));
+        if (fullFileSize <= maxBatchedFileSize)
+        {
+            if (searchRoot != batchRoot)
+            {
+                flushBatch();
+                batchRoot = searchRoot;
+            }
+            batch.push_back({std::move(sInfo)});
+            if (batch.size() >= maxBatchFiles)
+                flushBatch();
+            continue;
+        }
+        auto searchFn = [=, this]() {
+            SearchFile(sInfo, searchRoot);
+        };
+        tp.enqueueWait(searchFn);
+    }
+    flushBatch();
+
+    tp.waitFinished();
+    m_sink.OnSearchEnd();
+}
+
+unsigned int CSearchEngine::ThreadCount() const
+{
+    // use a thread pool:
+    // use 2 threads less than processors are available,
+    // because we already have two threads in use:
+    // the UI thread and this one.
+    unsigned int threadCount = m_options.threadCount;
+    if (threadCount == 0)
+        threadCount = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 2, 1);
+    return threadCount;
+}
+
+bool CSearchEngine::HasIncludedAttributes(DWORD attributes) const
+{
+    return (m_options.includeHidden || ((attributes & FILE_ATTRIBUTE_HIDDEN) == 0)) &&
+           (m_options.includeSystem || ((attributes & FILE_ATTRIBUTE_SYSTEM) == 0));
+}
+
+bool CSearchEngine::IsExcludedDir(const std::wstring& dirPath, const wchar_t* dirName, const std::wstring& cSearchPath) const
+{
+    if (m_options.excludeDirsRegex.empty())
+        return false;
+    bool bExcluded = MatchPathRegex(m_excludeDirsRegex, dirName) ||
+                     MatchPathRegex(m_excludeDirsRegex, dirPath.c_str());
+    if (!bExcluded)
+    {
+        std::wstring relPath = dirPath.substr(cSearchPath.size() + 1);
+        if (relPath.find(PathSeparator) != std::wstring::npos)
+        {
+            bExcluded = MatchPathRegex(m_excludeDirsRegex, relPath.c_str());
+        }
+    }
+    return bExcluded;
+}
+
+// true if the enumeration of cSearchPath gets into dirPath:
+// none of the folders between them is skipped
+bool CSearchEngine::IsSearchedDir(const std::wstring& dirPath, const std::wstring& cSearchPath) const
+{
+    std::wstring dir = dirPath;
+    while (dir.size() > cSearchPath.size())
+    {
+        if (!m_options.includeSubfolders)
+            return false;
+        DWORD attributes = GetFileAttributes(dir.c_str());
+        if (attributes == INVALID_FILE_ATTRIBUTES || !HasIncludedAttributes(attributes))
+            return false;
+        if (!m_options.includeSymLinks && (attributes & FILE_ATTRIBUTE_REPARSE_POINT))
+            return false;
+        auto pos = dir.find_last_of(PathSeparator);
+        if (IsExcludedDir(dir, dir.c_str() + pos + 1, cSearchPath))
+            return false;
+        dir.resize(pos);
+    }
+    return true;
+}
+
+bool CSearchEngine::IsInLimits(uint64_t fileSize, const FILETIME& fileTime) const
+{
+    bool bInLimits = true;
+    if (!m_options.allSize)
+    {
+        switch (m_options.sizeCmp)
+        {
+            case SizeCompare::Less:
+                bInLimits &= fileSize < m_options.size;
+                break;
+            case SizeCompare::Equal:
+                bInLimits &= fileSize == m_options.size;
+                break;
+            case SizeCompare::Greater:
+                bInLimits &= fileSize > m_options.size;
+                break;
+            default:
+                break;
+        }
+    }
+    if (bInLimits)
+    {
+        switch (m_options.dateLimit)
+        {
+            default:
+            case DateLimit::All:
+                break;
+            case DateLimit::Newer:
+                bInLimits &= CompareFileTime(&fileTime, &m_options.date1) >= 0;
+                break;
+            case DateLimit::Older:
+                bInLimits &= CompareFileTime(&fileTime, &m_options.date1) <= 0;
+                break;
+            case DateLimit::Between:
+                bInLimits &= CompareFileTime(&fileTime, &m_options.date1) >= 0 &&
+                             CompareFileTime(&fileTime, &m_options.date2) <= 0;
+                break;
+        }
+    }
+    return bInLimits;
+}
+
+// the search path path was found through. bHasLimits is false if the
+// search path is the file itself, which is searched without any filter.
+bool CSearchEngine::FindSearchPath(const std::wstring& path, std::wstring& cSearchPath, bool& bHasLimits) const
+{
+    for (const auto& searchPath : m_options.searchPaths)
+    {
+        if (searchPath.empty())
+            continue;
+        if (path == searchPath)
+        {
+            cSearchPath = searchPath;
+            bHasLimits  = PathIsDirectory(searchPath.c_str()) != FALSE;
+            return true;
+        }
+        if (path.size() > searchPath.size() && path.starts_with(searchPath) &&
+            (path[searchPath.size()] == PathSeparator || searchPath.back() == PathSeparator))
+        {
+            cSearchPath = searchPath;
+            bHasLimits  = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CSearchEngine::MatchPath(LPCTSTR pathBuf) const
+{
+    if (m_options.filePatterns.empty())
+        return true;
+
+    bool        bPattern = false;
+    // find start of pathname
+    const auto* pName    = wcsrchr(pathBuf, PathSeparator);
+    if (pName == nullptr)
+        pName = pathBuf;
+    else
+        pName++; // skip the last separator char
+    if (m_options.useRegexForPaths)
+    {
+        if (MatchPathRegex(m_fileNameRegex, pName))
+            bPattern = true;
+        // for a regex check, also test with the full path
+        else if (MatchPathRegex(m_fileNameRegex, pathBuf))
+            bPattern = true;
+    }
+    else
+    {
+        const auto& patterns = m_options.filePatterns;
+        if (patterns[0].size() && (patterns[0][0] == '-'))
+            bPattern = true;
+
+        std::wstring fName = pName;
+        std::ranges::transform(fName, fName.begin(), ::towlower);
+
+        for (const auto& pattern : patterns)
+        {
+            if (!pattern.empty() && pattern.at(0) == '-')
+                bPattern = bPattern && !wcswildcmp(&(pattern)[1], fName.c_str());
+            else
+                bPattern = bPattern || wcswildcmp(pattern.c_str(), fName.c_str());
+        }
+    }
+    return bPattern;
+}
+
+void CSearchEngine::AddBackupOrTempFile(const std::wstring& path)
+{
+    std::lock_guard lock(m_backupAndTempFilesMutex);
+    m_backupAndTempFiles.insert(path);
+}
+
+bool CSearchEngine::IsBackupOrTempFile(const std::wstring& path)
+{
+    std::lock_guard lock(m_backupAndTempFilesMutex);
+    return m_backupAndTempFiles.contains(path);
+}
+
+std::wstring CSearchEngine::BackupFile(const std::wstring& destParentDir, const std::wstring& filePath, bool bMove)
+{
+    std::wstring backupFile;
+    if (m_options.backupInFolder)
+    {
+        std::wstring backupFolder = destParentDir + PathSeparator + L"grepWin_backup" + PathSeparator;
+        backupFolder += filePath.substr(destParentDir.size() + 1);
+        backupFolder = CPathUtils::GetParentDirectory(backupFolder);
+        CPathUtils::CreateRecursiveDirectory(backupFolder);
+        backupFile = backupFolder + PathSeparator + CPathUtils::GetFileName(filePath);
+    }
+    else
+    {
+        backupFile = filePath + L".bak";
+    }
+    SetFileAttributes(backupFile.c_str(), 0);
+    bool bOk = false;
+    if (bMove)
+    {
+        bOk = MoveFileEx(filePath.c_str(), backupFile.c_str(), MOVEFILE_REPLACE_EXISTING);
+    }
+    else
+    {
+        bOk = CopyFile(filePath.c_str(), backupFile.c_str(), FALSE);
+    }
+    if (!bOk)
+    {
+        return L"";
+    }
+    AddBackupOrTempFile(backupFile);
+
+    return backupFile;
+}
+
+int CSearchEngine::AdoptTempResultFile(CSearchInfo& sInfo, const std::wstring& searchRoot, const std::wstring& tempFilePath)
+{
+    FileTimes fileTimes;
+    if (m_options.keepFileDate)
+    {
+        if (!GetFileTimes(sInfo.filePath, fileTimes))
+        {
+            return -1;
+        }
+    }
+    DWORD origAttributes = GetFileAttributes(sInfo.filePath.c_str());
+    bool  bIsShr         = (origAttributes & (FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_READONLY | FILE_ATTRIBUTE_SYSTEM)) != 0;
+    if (bIsShr)
+    {
+        SetFileAttributes(sInfo.filePath.c_str(), 0);
+    }
+    if (m_options.createBackup && !sInfo.hasBackedup)
+    {
+        if (BackupFile(searchRoot, sInfo.filePath, true).empty())
+        {
+            return -1;
+        }
+        sInfo.hasBackedup = true;
+    }
+    if (!MoveFileEx(tempFilePath.c_str(), sInfo.filePath.c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        return -1;
+    }
+    if (m_options.keepFileDate)
+    {
+        int countDown = 5;
+        do
+        {
+            if (SetFileTimes(sInfo.filePath, fileTimes))
+            {
+                break;
+            }
+            else
+            {
+                Sleep(50);
+            }
+            --countDown;
+        } while (countDown > 0);
+        // if (countDown <= 0), main change has been made, still return succeeded.
+    }
+    if (bIsShr)
+    {
+        SetFileAttributes(sInfo.filePath.c_str(), origAttributes);
+    }
+
+    return 1;
+}
+
+bool CSearchEngine::CanSearchInPlace(const CSearchInfo& sInfo, const std::wstring& searchExpression) const
+{
+    // only a replace needs the file converted to a wide string.
+    // A pattern or text outside of 7-bit could match differently on bytes
+    // than on the converted text, e.g. when ignoring case
+    return MayBeSevenBitText(sInfo.encoding) && !m_options.replace && !m_options.forceBinary && sInfo.fileSize <= maxInPlaceSize &&
+           IsSevenBitString(searchExpression) && (!m_options.captureSearch || IsSevenBitString(m_options.replaceString));
+}
+
+CLinearRegex* CSearchEngine::LinearRegexFor(const std::wstring& expression, bool bWide) const
+{
+    // a capture or a replace needs the groups, which only boost has
+    if (!m_options.linearRegex || m_options.captureSearch || m_options.replace)
+        return nullptr;
+    return CBufferPool::ForThisThread().LinearRegex(expression, m_options.caseSensitive, m_options.dotMatchesNewline, bWide);
+}
+
+bool CSearchEngine::SearchInPlace(CSearchInfo& sInfo, const char* fileBegin, const char* fileEnd, const std::wstring& searchExpression, UINT syntaxFlags, UINT matchFlags, int& nCount)
+{
+    if (!IsSevenBitText(fileBegin, static_cast<size_t>(fileEnd - fileBegin)))
+        return false;
+
+    CBufferPool& pool = CBufferPool::ForThisThread();
+
+    std::string expr = SevenBitToString(searchExpression);
+    if (!m_options.useRegex && m_options.wholeWords)
+    {
+        expr = "\\b" + expr + "\\b";
+    }
+    const boost::regex* regEx = nullptr;
+    try
+    {
+        regEx = &pool.Regex(expr, syntaxFlags);
+    }
+    catch (const std::exception&)
+    {
+        // the wide regex reports the error
+        return false;
+    }
+
+    // what CTextFile reports for 7-bit text
+#ifdef _WIN32
+    sInfo.encoding = m_options.utf8 ? CTextFile::UTF8 : CTextFile::Ansi;
+#else
+    sInfo.encoding = CTextFile::UTF8;
+#endif
+    nCount         = 0;
+
+    // the same blocks and the same results as SearchOnTextFile()
+    boost::match_results<const char*>& whatC      = pool.Matches();
+    boost::match_flag_type             mFlags     = static_cast<boost::match_flag_type>(matchFlags);
+    std::string                        captureFmt = m_options.captureSearch ? SevenBitToString(m_options.replaceString) : std::string();
+    CLazyLineIndex                     lineIndex(fileBegin, static_cast<size_t>(fileEnd - fileBegin), pool.LineBuffer());
+
+    size_t                             count     = static_cast<size_t>(fileEnd - fileBegin);
+    size_t                             remainder = count % (SEARCHBLOCKSIZE / 2);
+    const char*                        startIter = fileBegin;
+    const char*                        blockEnd  = fileBegin + remainder;
+    CReadAhead                         readAhead(fileBegin, count);
+    CLinearRegex*                      linearRegex = LinearRegexFor(std::wstring(expr.begin(), expr.end()), false);
+    const char*                        matchBegin  = nullptr;
+    const char*                        matchEnd    = nullptr;
+    auto                               findNext    = [&]() {
+        if (linearRegex)
+        {
+            CheckDeadline();
+            return linearRegex->Search(startIter, blockEnd, fileBegin, matchBegin, matchEnd);
+        }
+        if (!RegexSearchWithDeadline(startIter, blockEnd, whatC, *regEx, mFlags, fileBegin))
+            return false;
+        matchBegin = whatC[0].first;
+        matchEnd   = whatC[0].second;
+        return true;
+    };
+    try
+    {
+        do
+        {
+            readAhead.Advance(startIter);
+            while (!m_cancelled && (startIter < blockEnd) && !HasEnoughMatches(sInfo) && findNext())
+            {
+                nCount++;
+                if (m_options.notSearch)
+                    break;
+                if (m_options.listOnly)
+                {
+                    ++sInfo.matchCount;
+                    break;
+                }
+                //
+                mFlags |= boost::match_prev_avail;
+                mFlags |= boost::match_not_bob;
+                //
+                size_t posMatchHead = matchBegin - fileBegin;
+                size_t posMatchTail = matchEnd - fileBegin;
+                if (matchBegin < matchEnd) // matchEnd is not part of the match
+                    --posMatchTail;
+                long lineStart = lineIndex.LineFromPosition(posMatchHead);
+                long lineEnd   = lineIndex.LineFromPosition(posMatchTail);
+                long colMatch  = lineIndex.ColumnFromPosition(posMatchHead, lineStart);
+                long lenMatch  = static_cast<long>(matchEnd - matchBegin);
+                if (m_options.captureSearch)
+                {
+                    std::string out = whatC.format(captureFmt, mFlags);
+                    sInfo.matchLines.push_back(SevenBitToWstring(out.data(), out.data() + out.size()));
+                    sInfo.matchLinesNumbers.push_back(lineStart);
+                    sInfo.matchColumnsNumbers.push_back(colMatch);
+                    sInfo.matchLengths.push_back(static_cast<long>(out.length()));
+                }
+                else
+                {
+                    AddMatchLines(sInfo, fileBegin, fileEnd - fileBegin, posMatchHead, lineStart, lineEnd, colMatch, lenMatch, SevenBitToWstring);
+                }
+                ++sInfo.matchCount;
+                //
+                startIter = matchEnd;
+                if (startIter == matchBegin) // ^$
+                {
+                    if (startIter == blockEnd)
+                        break;
+                    ++startIter;
+                }
+            }
+            if (startIter < blockEnd) // not found
+                startIter = blockEnd;
+            if (blockEnd < fileEnd)
+                blockEnd += SEARCHBLOCKSIZE / 2;
+            else
+                break;
+        } while (!m_cancelled && !HasEnoughMatches(sInfo));
+        AddContextLinesOf(sInfo, m_options, lineIndex);
+    }
+    catch (const std::exception& ex)
+    {
+        RecordException(sInfo, ex);
+        nCount = 1;
+    }
+    return true;
+}
+
+int CSearchEngine::SearchOnTextFile(CSearchInfo& sInfo, const std::wstring& searchRoot, const std::wstring& searchExpression, const std::wstring& replaceExpression, UINT syntaxFlags, UINT matchFlags, CTextFile& textFile)
+{
+    int          nFound = 0;
+
+    std::wstring expr   = searchExpression;
+    if (!m_options.useRegex && m_options.wholeWords)
+    {
+        expr = L"\\b" + expr + L"\\b";
+    }
+
+    std::wstring::const_iterator start, end;
+    start = textFile.GetFileString().begin();
+    end   = textFile.GetFileString().end();
+    boost::match_results<std::wstring::const_iterator> whatC;
+    boost::wregex                                      wRegEx = boost::wregex(expr, syntaxFlags);
+    boost::match_flag_type                             mFlags = static_cast<boost::match_flag_type>(matchFlags);
+
+    size_t                       count     = textFile.GetFileString().size();
+    size_t                       remainder = count % (SEARCHBLOCKSIZE / 2);
+    std::wstring::const_iterator startIter = start;
+    std::wstring::const_iterator blockEnd  = start + remainder;
+
+    std::wstring                   filePathTemp = sInfo.filePath + L".grepwinreplaced";
+    RegexReplaceFormatter<wchar_t> replaceFmt(replaceExpression);
+    std::wstring                   replaced;
+    auto                           replacedIter = std::back_inserter(replaced);
+    if (m_options.replace) // synchronize Replace and Search for cancellation and reducing repetitive work on huge files
+    {
+        AddBackupOrTempFile(filePathTemp);
+    }
+    // the linear time engine searches the text as an array
+    CLinearRegex*                linearRegex = LinearRegexFor(expr, true);
+    const wchar_t*               textBegin   = textFile.GetFileString().data();
+    std::wstring::const_iterator matchBegin, matchEnd;
+    auto                         findNext = [&]() {
+        if (linearRegex)
+        {
+            CheckDeadline();
+            const wchar_t* first = nullptr;
+            const wchar_t* last  = nullptr;
+            if (!linearRegex->Search(textBegin + (startIter - start), textBegin + (blockEnd - start), textBegin, first, last))
+                return false;
+            matchBegin = start + (first - textBegin);
+            matchEnd   = start + (last - textBegin);
+            return true;
+        }
+        if (!RegexSearchWithDeadline(startIter, blockEnd, whatC, wRegEx, mFlags, start))
+            return false;
+        matchBegin = whatC[0].first;
+        matchEnd   = whatC[0].second;
+        return true;
+    };
+    do
+    {
+        while (!m_cancelled && (startIter < blockEnd) && !HasEnoughMatches(sInfo) && findNext())
+        {
+            nFound++;
+            if (m_options.notSearch)
+                break;
+            if (m_options.listOnly)
+            {
+                ++sInfo.matchCount;
+                break;
+            }
+            //
+            mFlags |= boost::match_prev_avail;
+            mFlags |= boost::match_not_bob;
+            //
+            long posMatchHead = static_cast<long>(matchBegin - textFile.GetFileString().begin());
+            long posMatchTail = static_cast<long>(matchEnd - textFile.GetFileString().begin());
+            if (matchBegin < matchEnd) // matchEnd is not part of the match
+                --posMatchTail;
+            long lineStart = textFile.LineFromPosition(posMatchHead);
+            long lineEnd   = textFile.LineFromPosition(posMatchTail);
+            long colMatch  = textFile.ColumnFromPosition(posMatchHead, lineStart);
+            long lenMatch  = static_cast<long>(matchEnd - matchBegin);
+            if (m_options.captureSearch)
+            {
+                auto out = whatC.format(m_options.replaceString, mFlags);
+                sInfo.matchLines.push_back(out);
+                sInfo.matchLinesNumbers.push_back(lineStart);
+                sInfo.matchColumnsNumbers.push_back(colMatch);
+                sInfo.matchLengths.push_back(static_cast<long>(out.length()));
+            }
+            else
+            {
+                const std::wstring& fileText = textFile.GetFileString();
+                AddMatchLines(sInfo, fileText.data(), fileText.size(), posMatchHead, lineStart, lineEnd, colMatch, lenMatch, [](const wchar_t* begin, const wchar_t* end) {
+                    return std::wstring(begin, end);
+                });
+            }
+            ++sInfo.matchCount;
+            if (m_options.replace)
+            {
+                std::copy(startIter, matchBegin, replacedIter);
+                regex_replace(replacedIter, matchBegin, matchEnd, wRegEx, replaceFmt, mFlags);
+            }
+            //
+            startIter = matchEnd;
+            if (startIter == matchBegin) // ^$
+            {
+                if (startIter == blockEnd)
+                    break;
+                if (m_options.replace)
+                    std::copy(startIter, startIter + 1, replacedIter);
+                ++startIter;
+            }
+        }
+        if (startIter < blockEnd) // not found
+        {
+            if (m_options.replace)
+                std::copy(startIter, blockEnd, replacedIter);
+            startIter = blockEnd;
+        }
+        if (blockEnd < end)
+            blockEnd += SEARCHBLOCKSIZE / 2;
+        else
+            break;
+    } while (!m_cancelled && !HasEnoughMatches(sInfo));
+    AddContextLinesOf(sInfo, m_options, textFile);
+
+    if (!m_options.replace || m_cancelled || nFound == 0)
+    {
+        return nFound;
+    }
+
+    textFile.SetFileContent(replaced);
+    if (!textFile.Save(filePathTemp.c_str(), false))
+    {
+        return -1;
+    }
+
+    if (AdoptTempResultFile(sInfo, searchRoot, filePathTemp) <= 0)
+    {
+        return -1;
+    }
+
+    return nFound;
+}
+
+template <typename CharT>
+int CSearchEngine::SearchByFilePath(CSearchInfo& sInfo, const std::wstring& searchRoot, const std::wstring& searchExpression, const std::wstring& replaceExpression, UINT syntaxFlags, UINT matchFlags, bool misaligned, CharT*)
+{
+    boost::iostreams::mapped_file_source inFile(PlatformPath(sInfo.filePath));
+    if (!inFile.is_open())
+        return -1;
+
+    const char*       inData   = inFile.data();
+    size_t            inSize   = inFile.size();
+    size_t            skipSize = 0;
+    size_t            workSize = inSize;
+    size_t            dropSize = 0;
+    const CharT*      fBeg     = reinterpret_cast<const CharT*>(inData);
+    const CharT*      start    = fBeg;
+    const CharT*      end      = fBeg + inSize / sizeof(CharT);
+
+    TextOffset<CharT> textOffset;
+    if ((sInfo.encoding == CTextFile::UTF8) || (sInfo.encoding == CTextFile::Unicode_Le) || (sInfo.encoding == CTextFile::Unicode_Be))
+    {
+        start = textOffset.SkipBOM(fBeg, end);
+    }
+    else
+        start = fBeg;
+
+    skipSize = reinterpret_cast<const char*>(start) - inData;
+    workSize = inSize - skipSize;
+    if (sizeof(CharT) > 1)
+    {
+        if (misaligned && skipSize < inSize)
+        {
+            ++skipSize;
+            --workSize;
+            const char* p = reinterpret_cast<const char*>(start);
+            ++p;
+            start = reinterpret_cast<const CharT*>(p);
+        }
+        dropSize = workSize % sizeof(CharT);
+        if (dropSize > 0)
+            workSize -= dropSize;
+    }
+    if (workSize == 0)
+    {
+        inFile.close();
+        return 0;
+    }
+    end                           = reinterpret_cast<const CharT*>(inData + skipSize + workSize);
+
+    std::basic_string<CharT> expr = ConvertToString<CharT>(searchExpression, sInfo.encoding);
+
+    if (!m_options.useRegex && m_options.wholeWords)
+    {
+        const CharT boundary[] = {'\\', 'b', 0};
+        expr                   = boundary + expr + boundary;
+    }
+
+    boost::match_results<const CharT*>         whatC;
+    boost::basic_regex<CharT>                  regEx        = boost::basic_regex<CharT>(expr, syntaxFlags);
+    boost::match_flag_type                     mFlags       = static_cast<boost::match_flag_type>(matchFlags);
+
+    size_t                                     count        = workSize / sizeof(CharT);
+    size_t                                     remainder    = count % (SEARCHBLOCKSIZE / sizeof(CharT));
+    const CharT*                               startIter    = start;
+    const CharT*                               blockEnd     = start + remainder;
+
+    int                                        nFound       = 0;
+    std::wstring                               filePathTemp = sInfo.filePath + L".grepwinreplaced";
+    std::basic_filebuf<char>                   outFileBufA;
+    std::basic_string<CharT>                   repl         = ConvertToString<CharT>(replaceExpression, sInfo.encoding);
+    RegexReplaceFormatter<CharT, const CharT*> replaceFmt(repl);
+    if (m_options.replace) // synchronize Replace and Search for cancellation and reducing repetitive work on huge files
+    {
+        AddBackupOrTempFile(filePathTemp);
+
+        outFileBufA.open(PlatformPath(filePathTemp), std::ios::out | std::ios::trunc | std::ios::binary); // overwrite
+        if (!outFileBufA.is_open())
+        {
+            inFile.close();
+            return -1;
+        }
+        outFileBufA.sputn(inData, skipSize);
+    }
+
+    // the linear time engine only knows the code units boost sees in
+    // 7-bit text, or in UTF-16 of this machine's byte order
+    CLinearRegex* linearRegex = nullptr;
+    if (sizeof(CharT) == 1 ? IsSevenBitString(searchExpression) : (sizeof(wchar_t) == 2 && sInfo.encoding != CTextFile::Unicode_Be))
+        linearRegex = LinearRegexFor(std::wstring(expr.begin(), expr.end()), sizeof(CharT) > 1);
+    const CharT* matchBegin = nullptr;
+    const CharT* matchEnd   = nullptr;
+    auto         findNext   = [&]() {
+        if (linearRegex)
+        {
+            CheckDeadline();
+            return linearRegex->Search(startIter, blockEnd, start, matchBegin, matchEnd);
+        }
+        if (!RegexSearchWithDeadline(startIter, blockEnd, whatC, regEx, mFlags, start))
+            return false;
+        matchBegin = whatC[0].first;
+        matchEnd   = whatC[0].second;
+        return true;
+    };
+
+    // the matches found until the search runs out of time are reported
+    // with their lines, as the offsets are only turned into lines below
+    size_t     firstMatch = sInfo.matchLinesNumbers.size();
+    auto       matchCount = sInfo.matchCount;
+    CReadAhead readAhead(inData, inSize);
+    try
+    {
+        do
+        {
+            readAhead.Advance(reinterpret_cast<const char*>(startIter));
+            while (!m_cancelled && (startIter < blockEnd) && !HasEnoughMatches(sInfo) && findNext())
+            {
+                nFound++;
+                if (m_options.notSearch)
+                    break;
+                if (m_options.listOnly)
+                {
+                    ++sInfo.matchCount;
+                    break;
+                }
+                //
+                mFlags |= boost::match_prev_avail;
+                mFlags |= boost::match_not_bob;
+                //
+                sInfo.matchLinesNumbers.push_back(static_cast<DWORD>(matchBegin - start));
+                sInfo.matchColumnsNumbers.push_back(static_cast<DWORD>(matchEnd - matchBegin));
+                ++sInfo.matchCount;
+                if (m_options.replace)
+                {
+                    if constexpr (sizeof(CharT) > 1)
+                    {
+                        std::wstring replaced;
+                        auto         replacedIter = std::back_inserter(replaced);
+                        outFileBufA.sputn(reinterpret_cast<const char*>(startIter), (matchBegin - startIter) * 2);
+                        regex_replace(replacedIter, matchBegin, matchEnd, regEx, replaceFmt, mFlags);
+                        outFileBufA.sputn(reinterpret_cast<const char*>(replaced.c_str()), replaced.length() * 2);
+                    }
+                    else
+                    {
+                        std::ostreambuf_iterator<char> outIter(&outFileBufA);
+                        outFileBufA.sputn(startIter, matchBegin - startIter);
+                        regex_replace(outIter, matchBegin, matchEnd, regEx, replaceFmt, mFlags);
+                    }
+                }
+                //
+                startIter = matchEnd;
+                if (startIter == matchBegin) // ^$
+                {
+                    if (startIter == blockEnd)
+                        break;
+                    if (m_options.replace)
+                    {
+                        if constexpr (sizeof(CharT) > 1)
+                            outFileBufA.sputn(reinterpret_cast<const char*>(startIter), 2);
+                        else
+                            outFileBufA.sputc(*startIter);
+                    }
+                    ++startIter;
+                }
+            }
+            if (startIter < blockEnd) // not found
+            {
+                if (m_options.replace)
+                {
+                    if constexpr (sizeof(CharT) > 1)
+                        outFileBufA.sputn(reinterpret_cast<const char*>(startIter), (blockEnd - startIter) * 2);
+                    else
+                        outFileBufA.sputn(startIter, blockEnd - startIter);
+                }
+                startIter = blockEnd;
+            }
+            if (blockEnd < end)
+                blockEnd += SEARCHBLOCKSIZE / sizeof(CharT);
+            else
+                break;
+        } while (!m_cancelled && !HasEnoughMatches(sInfo));
+    }
+    catch (const std::exception& ex)
+    {
+        // a replace can't stop halfway, and other errors report nothing:
+        // the offsets this search added must not be taken for lines
+        if (m_options.replace || !IsTimeout(ex))
+        {
+            sInfo.matchLinesNumbers.resize(firstMatch);
+            sInfo.matchColumnsNumbers.resize(firstMatch);
+            sInfo.matchCount = matchCount;
+            throw;
+        }
+        RecordException(sInfo, ex);
+    }
+
+    bool bAdopt = false;
+    if (m_options.replace)
+    {
+        if (nFound > 0)
+        {
+            bAdopt = true;
+            if (dropSize > 0 && !m_cancelled)
+            {
+                outFileBufA.sputc(inData[inSize - 2]);
+            }
+        }
+        outFileBufA.close(); // reduce memory ASAP for huge files
+        if (!bAdopt)
+        {
+            // if cancelled or failed but found any, keep `filePathTemp` to give some hints
+            DeleteFile(filePathTemp.c_str());
+        }
+    }
+    if (nFound > 0)
+    {
+        if ((sInfo.encoding != CTextFile::Binary) && !m_options.notSearch && !m_options.listOnly)
+        {
+            if (blockEnd - start < 4 * SEARCHBLOCKSIZE)
+                textOffset.CalculateLines(start, blockEnd, false);
+            else
+                textOffset.CalculateLines(start, blockEnd, m_cancelled);
+            size_t textSize   = blockEnd - start;
+            bool   bBigEndian = sizeof(CharT) > 1 && sInfo.encoding == CTextFile::Unicode_Be;
+            auto   convert    = [&](const CharT* begin, const CharT* end) {
+                if constexpr (std::is_same_v<CharT, wchar_t>)
+                    return bBigEndian ? utf16Swap(std::wstring(begin, end)) : std::wstring(begin, end);
+                else
+                    return ConvertToWstring(std::string(begin, end), sInfo.encoding);
+            };
+            for (size_t mp = 0; mp < sInfo.matchLinesNumbers.size(); ++mp)
+            {
+                // return the nearest position to give some hints when cancelled
+                size_t pos                  = sInfo.matchLinesNumbers[mp];
+                size_t lenMatchLength       = sInfo.matchColumnsNumbers[mp];
+                sInfo.matchLinesNumbers[mp] = textOffset.LineFromPosition(static_cast<long>(pos));
+                // the range of a line starts with the line ending of the line before
+                size_t lineBegin            = std::get<0>(textOffset.PositionsFromLine(sInfo.matchLinesNumbers[mp]));
+                if (lineBegin != static_cast<size_t>(-1) && sInfo.matchLinesNumbers[mp] > 1)
+                    ++lineBegin;
+                if (lineBegin > pos || pos >= textSize)
+                {
+                    sInfo.matchColumnsNumbers[mp] = 1;
+                    sInfo.matchLines.push_back(L"");
+                    sInfo.matchLengths.push_back(0);
+                    continue;
+                }
+                std::wstring sLine;
+                size_t       lenLineMatch     = MatchLengthInLine(start, textSize, pos, lenMatchLength, bBigEndian);
+                size_t       begin            = MatchLineExcerpt(start, textSize, lineBegin, pos, lenLineMatch, bBigEndian, sLine, convert);
+                sInfo.matchColumnsNumbers[mp] = static_cast<DWORD>(pos - lineBegin + 1);
+                sInfo.matchLines.push_back(std::move(sLine));
+                if constexpr (std::is_same_v<CharT, wchar_t>)
+                {
+                    sInfo.matchLengths.push_back(static_cast<DWORD>(lenLineMatch));
+                    if (begin > lineBegin)
+                        sInfo.SetExcerptStart(static_cast<DWORD>(begin - lineBegin + 1));
+                }
+                else
+                {
+                    // columns count characters, not bytes: only the kept text
+                    // is converted, so in an excerpt they count bytes up to
+                    // where it starts
+                    auto textColumn = static_cast<DWORD>(convert(start + begin, start + pos).length() + 1);
+                    sInfo.matchLengths.push_back(static_cast<DWORD>(convert(start + pos, start + pos + lenLineMatch).length()));
+                    if (begin > lineBegin)
+                        sInfo.SetExcerptStart(sInfo.matchColumnsNumbers[mp] - textColumn + 1);
+                    else
+                        sInfo.matchColumnsNumbers[mp] = textColumn;
+                }
+            }
+            AddContextLines(sInfo, m_options, [&](long line, std::wstring& text) {
+                auto [lineStart, lineEnd] = textOffset.PositionsFromLine(line);
+                if (lineStart == static_cast<size_t>(-1))
+                    return false;
+                // the range starts with the line ending of the line before
+                if (line > 1 && lineStart < lineEnd)
+                    ++lineStart;
+                auto p   = start + lineStart;
+                auto len = std::min(lineEnd - lineStart, maxContextLineLength);
+                if constexpr (std::is_same_v<CharT, wchar_t>)
+                {
+                    text.assign(p, len);
+                    if (sInfo.encoding == CTextFile::Unicode_Be)
+                        text = utf16Swap(text);
+                }
+                else
+                    text = ConvertToWstring(std::string(p, len), sInfo.encoding);
+                while (!text.empty() && (text.back() == '\r' || text.back() == '\n'))
+                    text.pop_back();
+                return true;
+            });
+        }
+    }
+
+    inFile.close();
+    if (bAdopt && !m_cancelled)
+    {
+        AdoptTempResultFile(sInfo, searchRoot, filePathTemp);
+    }
+
+    // a file which ran out of time is reported, even without matches
+    return sInfo.timedOut ? std::max(nFound, 1) : nFound;
+}
+
+bool CSearchEngine::RecordResult(const CSearchInfo& sInfo, const int nCount)
+{
+    // a file which could not be read completely is searched again next time,
+    // and so is one whose search stopped because the search had enough results
+    if (m_nextSnapshot && !m_cancelled && !m_quotaReached && !sInfo.readError && sInfo.exception.empty())
+        m_nextSnapshot->Add(sInfo, nCount);
+    return m_options.notSearch ? (nCount <= 0) : (nCount > 0);
+}
+
+bool CSearchEngine::TakeResultSlot()
+{
+    if (m_options.maxResults == 0)
+        return true;
+    auto count = ++m_resultCount;
+    if (count >= m_options.maxResults)
+        m_quotaReached = true;
+    return count <= m_options.maxResults;
+}
+
+bool CSearchEngine::HasEnoughMatches(const CSearchInfo& sInfo) const
+{
+    if (m_options.listOnly && sInfo.matchCount > 0)
+        return true;
+    if (m_options.maxMatchesPerFile > 0 && sInfo.matchCount >= m_options.maxMatchesPerFile)
+        return true;
+    return m_quotaReached;
+}
+
+void CSearchEngine::SendResult(const CSearchInfo& sInfo, const int nCount)
+{
+    bool bAsResult = RecordResult(sInfo, nCount);
+    if (bAsResult && !TakeResultSlot())
+        return;
+    m_sink.OnFileResult(sInfo, nCount >= 0, bAsResult);
+}
+
+void CSearchEngine::SearchFile(CSearchInfo sInfo, const std::wstring& searchRoot)
+{
+    // queued before the search had enough results
+    if (m_quotaReached)
+        return;
+    int nCount = SearchFileContent(sInfo, searchRoot, nullptr);
+    SendResult(sInfo, nCount);
+}
+
+void CSearchEngine::SearchBatch(std::vector<SearchFileResult>& batch, const std::wstring& searchRoot)
+{
+    // the files are read first, so the reads are not interleaved with the
+    // searches. A file which can't be read is left to SearchFileContent(),
+    // which reports the error.
+    std::vector<char>& arena = CBufferPool::ForThisThread().BatchBuffer();
+    arena.clear();
+    std::vector<size_t> offsets(batch.size() + 1, 0);
+    std::vector<bool>   bRead(batch.size(), false);
+    bool                bPreload = !m_options.replace && !m_options.forceBinary;
+    for (size_t i = 0; i < batch.size() && bPreload && !m_cancelled; ++i)
+    {
+        bRead[i]       = CFileView::ReadAll(batch[i].sInfo.filePath, arena);
+        offsets[i + 1] = arena.size();
+    }
+
+    size_t searched = 0;
+    size_t reported = 0;
+    for (; searched < batch.size() && !m_cancelled && !m_quotaReached; ++searched)
+    {
+        auto&            result = batch[searched];
+        std::string_view content(arena.data() + offsets[searched], offsets[searched + 1] - offsets[searched]);
+        int              nCount = SearchFileContent(result.sInfo, searchRoot, bRead[searched] ? &content : nullptr);
+        result.bSearched        = nCount >= 0;
+        result.bAsResult        = RecordResult(result.sInfo, nCount);
+        // results beyond SearchOptions::maxResults are dropped
+        if (result.bAsResult && !TakeResultSlot())
+            continue;
+        if (reported != searched)
+            batch[reported] = std::move(result);
+        ++reported;
+    }
+    // the files after a cancel are not reported, like those never enumerated
+    batch.resize(reported);
+    if (!batch.empty())
+        m_sink.OnFileResults(batch);
+}
+
+bool CSearchEngine::LoadTextFile(const CSearchInfo& sInfo, CTextFile& textFile, CTextFile::UnicodeType& type)
+{
+    if (m_options.forceBinary)
+    {
+        type = CTextFile::Binary;
+        return false;
+    }
+    ProfileTimer profile((L"file load and parse: " + sInfo.filePath).c_str());
+    if (m_options.nullBytes > 0)
+    {
+        constexpr __int64 oneMB = 1024 * 1024;
+        auto              megs  = sInfo.fileSize / oneMB;
+        textFile.SetNullbyteCountForBinary(m_options.nullBytes * (static_cast<int>(megs) + 1));
+    }
+    return textFile.Load(sInfo.filePath.c_str(), type, m_options.utf8, m_cancelled);
+}
+
+template <typename CharT, typename Lines>
+int CSearchEngine::FindPatterns(CSearchInfo& sInfo, const CharT* text, size_t size, Lines& lines)
+{
+    int  nCount  = 0;
+    auto convert = [](const CharT* begin, const CharT* end) {
+        if constexpr (std::is_same_v<CharT, wchar_t>)
+            return std::wstring(begin, end);
+        else
+            return SevenBitToWstring(begin, end);
+    };
+    m_patternMatcher->Find(text, size, [&](const CMultiPatternMatcher::Match& match) {
+        ++nCount;
+        if (m_options.notSearch)
+            return false;
+        if (m_options.listOnly)
+        {
+            ++sInfo.matchCount;
+            return false;
+        }
+        // a pattern is a single line, so is every match
+        long         line      = lines.LineFromPosition(static_cast<long>(match.position));
+        long         column    = lines.ColumnFromPosition(static_cast<long>(match.position), line);
+        size_t       lineBegin = match.position - (column - 1);
+        std::wstring sLine;
+        size_t       begin = MatchLineExcerpt(text, size, lineBegin, match.position, match.length, false, sLine, convert);
+        sInfo.matchLines.push_back(std::move(sLine));
+        sInfo.matchLinesNumbers.push_back(line);
+        sInfo.matchColumnsNumbers.push_back(column);
+        sInfo.matchLengths.push_back(static_cast<DWORD>(match.length));
+        sInfo.matchPatterns.push_back(static_cast<DWORD>(match.pattern));
+        if (begin > lineBegin)
+            sInfo.SetExcerptStart(static_cast<DWORD>(begin - lineBegin + 1));
+        ++sInfo.matchCount;
+        return !m_cancelled && !HasEnoughMatches(sInfo);
+    });
+    AddContextLinesOf(sInfo, m_options, lines);
+    return nCount;
+}
+
+int CSearchEngine::SearchPatterns(CSearchInfo& sInfo, const std::string_view* content)
+{
+    // 7-bit text is searched where it was read to, like SearchInPlace() does
+    CBufferPool& pool = CBufferPool::ForThisThread();
+    pool.Reset();
+    if (MayBeSevenBitText(sInfo.encoding) && !m_options.forceBinary && sInfo.fileSize <= maxInPlaceSize)
+    {
+        CFileView        fileView;
+        std::string_view data;
+        bool             bLoaded = true;
+        if (content)
+            data = *content;
+        else
+        {
+            bLoaded = fileView.Open(sInfo.filePath);
+            data    = std::string_view(fileView.Data(), fileView.Size());
+        }
+        if (bLoaded && IsSevenBitText(data.data(), data.size()))
+        {
+#ifdef _WIN32
+            sInfo.encoding = m_options.utf8 ? CTextFile::UTF8 : CTextFile::Ansi;
+#else
+            sInfo.encoding = CTextFile::UTF8;
+#endif
+            CLazyLineIndex lineIndex(data.data(), data.size(), pool.LineBuffer());
+            return FindPatterns(sInfo, data.data(), data.size(), lineIndex);
+        }
+    }
+
+    CTextFile              textFile;
+    CTextFile::UnicodeType type        = sInfo.encoding;
+    bool                   bLoadResult = LoadTextFile(sInfo, textFile, type);
+    sInfo.encoding                     = type;
+    if (m_cancelled)
+        return -1;
+    if (type == CTextFile::AutoType) // reading the file failed
+    {
+        sInfo.readError = true;
+        return -1;
+    }
+    if (bLoadResult && ((type != CTextFile::Binary) || m_options.includeBinary))
+    {
+        const std::wstring& text = textFile.GetFileString();
+        return FindPatterns(sInfo, text.data(), text.size(), textFile);
+    }
+    if ((type != CTextFile::Binary) || m_options.includeBinary || m_options.forceBinary)
+    {
+        // too big to convert, or binary: the bytes as they are, which finds
+        // the patterns in UTF-8 and 7-bit text
+        boost::iostreams::mapped_file_source inFile;
+        try
+        {
+            inFile.open(PlatformPath(sInfo.filePath));
+        }
+        catch (const std::exception&)
+        {
+            return -1;
+        }
+        if (!inFile.is_open())
+            return -1;
+        CLazyLineIndex lineIndex(inFile.data(), inFile.size(), pool.LineBuffer());
+        return FindPatterns(sInfo, inFile.data(), inFile.size(), lineIndex);
+    }
+    return -1;
+}
+
+int CSearchEngine::SearchFileContent(CSearchInfo& sInfo, const std::wstring& searchRoot, const std::string_view* content)
+{
+    if (m_patternMatcher)
+        return SearchPatterns(sInfo, content);
+
+    fileDeadline = std::chrono::steady_clock::time_point::max();
+    if (m_options.regexTimeout > 0 && !m_options.replace)
+    {
+        auto blocks  = 1 + static_cast<uint64_t>(std::max<__int64>(sInfo.fileSize, 0)) / SEARCHBLOCKSIZE;
+        fileDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(m_options.regexTimeout * blocks);
+    }
+
+    std::wstring searchExpression  = m_options.searchString;
+    std::wstring replaceExpression = m_options.replaceString;
+    if (m_options.useRegex)
+    {
+        replaceGrepWinFilePathVariables(searchExpression, sInfo.filePath);
+        if (m_options.replace)
+        {
+            replaceGrepWinFilePathVariables(replaceExpression, sInfo.filePath);
+        }
+    }
+
+    UINT syntaxFlags = boost::regex::normal;
+    if (!m_options.caseSensitive)
+        syntaxFlags |= boost::regbase::icase;
+    boost::match_flag_type matchFlags = boost::match_default | boost::format_all;
+    if (!m_options.dotMatchesNewline)
+        matchFlags |= boost::match_not_dot_newline;
+
+    if (CanSearchInPlace(sInfo, searchExpression))
+    {
+        CBufferPool::ForThisThread().Reset();
+        CFileView        fileView;
+        std::string_view data;
+        bool             bLoaded = true;
+        if (content)
+            data = *content;
+        else
+        {
+            bLoaded = fileView.Open(sInfo.filePath);
+            data    = std::string_view(fileView.Data(), fileView.Size());
+        }
+        int nCount = -1;
+        if (bLoaded && SearchInPlace(sInfo, data.data(), data.data() + data.size(), searchExpression, syntaxFlags, matchFlags, nCount))
+            return nCount;
+    }
+
+    // SearchFiles() passes the encoding the file had before, else it is detected
+    CTextFile              textFile;
+    CTextFile::UnicodeType type        = sInfo.encoding;
+    bool                   bLoadResult = LoadTextFile(sInfo, textFile, type);
+
+    sInfo.encoding = type;
+    int nCount     = -1; // >= 0: got results; -1: skipped
+    if (m_cancelled) // big file
+        return nCount;
+
+    if (type == CTextFile::AutoType) // reading the file failed
+    {
+        sInfo.readError = true;
+    }
+    else if (bLoadResult && ((type != CTextFile::Binary) || m_options.includeBinary)) // transcoded
+    {
+        // for unrecognized, only `Binary` returns true and treated as UTF-16LE, the same as app internal
+        try
+        {
+            nCount = SearchOnTextFile(sInfo, searchRoot, searchExpression, replaceExpression, syntaxFlags, matchFlags, textFile);
+        }
+        catch (const std::exception& ex)
+        {
+            RecordException(sInfo, ex);
+            nCount = 1;
+        }
+    }
+    else if ((type != CTextFile::Binary) || m_options.includeBinary || m_options.forceBinary)
+    {
+        // file is either too big or binary.
+        // types: Ansi, UTF8, Unicode_Le, Unicode_Be and Binary
+        std::vector<CTextFile::UnicodeType> encodingTries;
+        // the wchar_t search maps the file as UTF-16 code units,
+        // which only works where wchar_t is 16 bits wide
+        constexpr bool                      bWideMapped = sizeof(wchar_t) == 2;
+        if (!m_options.useRegex || type == CTextFile::Binary || !bWideMapped)
+        {
+            // Treating a multi-byte char as single byte chars:
+            //  yields part of it may be matched as a standalone char,
+            //  so requires it grouped for repeats to get accurate results.
+            //  Unicode_Le and Unicode_Be in Regex mode are turned into wchar_t branch. UTF8 is still here.
+            // Without transcoding the file, transcoding the input to other encoding is a trick, to get a bit more outcome.
+            // It only works for raw data, not escaped sequence, that is pure ASCII char!
+            switch (type)
+            {
+                case CTextFile::Binary:
+                {
+                    if (m_options.useRegex && bWideMapped)
+                        encodingTries = {CTextFile::Ansi, CTextFile::UTF8};
+                    else
+                        encodingTries = {CTextFile::Ansi, CTextFile::UTF8, CTextFile::Unicode_Le, CTextFile::Unicode_Be};
+                }
+                break;
+                case CTextFile::Ansi:
+                case CTextFile::UTF8:
+                case CTextFile::Unicode_Le:
+                case CTextFile::Unicode_Be:
+                default:
+                    encodingTries = {type};
+                    break;
+            }
+            for (auto assumption : encodingTries)
+            {
+                sInfo.encoding = assumption;
+                try
+                {
+                    nCount = SearchByFilePath<char>(sInfo, searchRoot, searchExpression, replaceExpression, syntaxFlags, matchFlags, false);
+                }
+                catch (const std::exception& ex)
+                {
+                    // a search which runs out of time reports that itself, a
+                    // replace doesn't. Other regex errors are not reported,
+                    // the file just doesn't match
+                    if (IsTimeout(ex))
+                    {
+                        RecordException(sInfo, ex);
+                        nCount = 1;
+                    }
+                }
+                catch (...)
+                {
+                    // regex error
+                }
+                if (nCount > 0)
+                {
+                    break; // try all is consuming
+                }
+            }
+        }
+        if constexpr (bWideMapped)
+        {
+            if (m_options.useRegex && nCount <= 0 && (type == CTextFile::Unicode_Le || type == CTextFile::Unicode_Be || type == CTextFile::Binary))
+            {
+                switch (type)
+                {
+                    case CTextFile::Binary:
+                        encodingTries = {CTextFile::Unicode_Le, CTextFile::Unicode_Be};
+                        break;
+                    case CTextFile::Unicode_Le:
+                    case CTextFile::Unicode_Be:
+                    default:
+                        encodingTries = {type};
+                        break;
+                }
+                for (auto assumption : encodingTries)
+                {
+                    sInfo.encoding = assumption;
+                    try
+                    {
+                        nCount += SearchByFilePath<wchar_t>(sInfo, searchRoot, searchExpression, replaceExpression, syntaxFlags, matchFlags, false);
+                        if (type == CTextFile::Binary && !sInfo.timedOut)
+                            nCount += SearchByFilePath<wchar_t>(sInfo, searchRoot, searchExpression, replaceExpression, syntaxFlags, matchFlags, true);
+                    }
+                    catch (const std::exception& ex)
+                    {
+                        if (IsTimeout(ex))
+                        {
+                            RecordException(sInfo, ex);
+                            nCount = std::max(nCount, 1);
+                        }
+                    }
+                    catch (...)
+                    {
+                        // regex error
+                    }
+                    if (nCount > 0)
+                    {
+                        break; // try all is consuming
+                    }
+                }
+            }
+        }
+        // sInfo.encoding = type; // show the matched encoding
+    }
+
+    return nCount;
+}
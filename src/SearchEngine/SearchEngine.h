@@ -0,0 +1,154 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+#include "CancellationToken.h"
+#include "SearchCache.h"
+#include "SearchInfo.h"
+#include "SearchOptions.h"
+#include "SearchResultSink.h"
+#include "TextFile.h"
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class CLinearRegex;
+class CMultiPatternMatcher;
+class CSearchSnapshot;
+class ThreadPool;
+
+// the search (and replace) over files and folders, without any UI.
+// A CSearchEngine performs one search run with fixed options and reports
+// the results to a sink. It can be cancelled at any time from another
+// thread with the cancellation token.
+// With a cache, directory listings and compiled path filters are shared
+// with the other searches that use the same cache.
+class CSearchEngine
+{
+public:
+    CSearchEngine(const SearchOptions& options, ISearchResultSink& sink, const CCancellationToken& cancelToken, CSearchCache* cache = nullptr);
+
+    // enumerates the search paths and searches all files that pass the
+    // filters, using a thread pool. Blocks until all files are done.
+    void                             Run();
+
+    // records the result of every searched file in next. Files which did
+    // not change since previous was recorded are not searched again, their
+    // previous result is reported instead. previous is only used if it was
+    // recorded for the same query as next, and neither is used for a replace.
+    void                             SetSnapshots(const CSearchSnapshot* previous, CSearchSnapshot* next);
+
+    // searches the given files again after they changed, and reports them
+    // like Run() does. For a folder, all files below it are searched.
+    // Paths which are gone or don't pass the filters anymore are reported
+    // with OnFileRemoved(), paths outside the search paths are ignored.
+    // Does nothing for a replace. Blocks until all files are done.
+    void                             SearchChangedFiles(const std::vector<std::wstring>& paths);
+
+    // searches exactly the given files, the results of an earlier search,
+    // without listing any folder and without the path filters. A file whose
+    // size and last-write time are unchanged and which that search found to
+    // be UTF-16 or binary is not checked again. Files which are gone are skipped.
+    // Reports like Run() and blocks until all files are done.
+    void                             SearchFiles(const std::vector<CSearchInfo>& files);
+
+    // searches (and replaces in) a single file and reports the result
+    void                             SearchFile(CSearchInfo sInfo, const std::wstring& searchRoot);
+
+    bool                             MatchPath(LPCTSTR pathBuf) const;
+
+    // splits a '|' separated file mask into the lower case patterns
+    // SearchOptions::filePatterns expects
+    static std::vector<std::wstring> SplitFilePatterns(const std::wstring& mask);
+
+private:
+    template <typename DirEnum>
+    void                             EnumerateSearchPath(DirEnum& fileEnumerator, const std::wstring& cSearchPath, const std::wstring& searchRoot, bool bHasLimits, bool bCountingOnly, ThreadPool& tp);
+    unsigned int                     ThreadCount() const;
+    bool                             HasIncludedAttributes(DWORD attributes) const;
+    bool                             IsExcludedDir(const std::wstring& dirPath, const wchar_t* dirName, const std::wstring& cSearchPath) const;
+    bool                             IsSearchedDir(const std::wstring& dirPath, const std::wstring& cSearchPath) const;
+    bool                             IsInLimits(uint64_t fileSize, const FILETIME& fileTime) const;
+    bool                             FindSearchPath(const std::wstring& path, std::wstring& cSearchPath, bool& bHasLimits) const;
+    // searches the small files of a batch one after the other, after reading
+    // them all into one buffer, and reports them together
+    void                             SearchBatch(std::vector<SearchFileResult>& batch, const std::wstring& searchRoot);
+    // searches (and replaces in) a single file. content: the bytes of the
+    // file if they were read already, nullptr otherwise.
+    // Returns the number of matches, -1 if the file was not searched.
+    int                              SearchFileContent(CSearchInfo& sInfo, const std::wstring& searchRoot, const std::string_view* content);
+    bool                             LoadTextFile(const CSearchInfo& sInfo, CTextFile& textFile, CTextFile::UnicodeType& type);
+    // the search for SearchOptions::searchPatterns, returns like SearchFileContent()
+    int                              SearchPatterns(CSearchInfo& sInfo, const std::string_view* content);
+    // lines: CTextFile, or the line index of the bytes
+    template <typename CharT, typename Lines>
+    int                              FindPatterns(CSearchInfo& sInfo, const CharT* text, size_t size, Lines& lines);
+    bool                             CanSearchInPlace(const CSearchInfo& sInfo, const std::wstring& searchExpression) const;
+    // the linear time engine for expression, if the options ask for it and
+    // it supports expression. nullptr if boost has to search.
+    CLinearRegex*                    LinearRegexFor(const std::wstring& expression, bool bWide) const;
+    // searches 7-bit text where it was read to, without converting it.
+    // Returns false if the file has to be searched with CTextFile instead.
+    bool                             SearchInPlace(CSearchInfo& sInfo, const char* fileBegin, const char* fileEnd, const std::wstring& searchExpression, UINT syntaxFlags, UINT matchFlags, int& nCount);
+    int                              SearchOnTextFile(CSearchInfo& sInfo, const std::wstring& searchRoot, const std::wstring& searchExpression, const std::wstring& replaceExpression, UINT syntaxFlags, UINT matchFlags, CTextFile& textFile);
+    template <typename CharT = char>
+    int                              SearchByFilePath(CSearchInfo& sInfo, const std::wstring& searchRoot, const std::wstring& searchExpression, const std::wstring& replaceExpression, UINT syntaxFlags, UINT matchFlags, bool misaligned, CharT* dummy = nullptr);
+    void                             SendResult(const CSearchInfo& sInfo, int nCount);
+    // adds the result to the next snapshot, returns whether it is a result
+    bool                             RecordResult(const CSearchInfo& sInfo, int nCount);
+    // counts a result against SearchOptions::maxResults. Returns false if
+    // the search already has enough results, the result is dropped then.
+    bool                             TakeResultSlot();
+    // whether the search of the file can stop before its end: it has as many
+    // matches as the options ask for, or the search has enough results
+    bool                             HasEnoughMatches(const CSearchInfo& sInfo) const;
+    int                              AdoptTempResultFile(CSearchInfo& sInfo, const std::wstring& searchRoot, const std::wstring& tempFilePath);
+    std::wstring                     BackupFile(const std::wstring& destParentDir, const std::wstring& filePath, bool bMove);
+
+    void                             AddBackupOrTempFile(const std::wstring& path);
+    bool                             IsBackupOrTempFile(const std::wstring& path);
+
+    SearchOptions                               m_options;
+    ISearchResultSink&                          m_sink;
+    const CCancellationToken&                   m_cancelToken;
+    std::atomic_bool&                           m_cancelled;
+    CSearchCache*                               m_cache;
+    std::shared_ptr<const boost::wregex>        m_fileNameRegex;
+    std::shared_ptr<const boost::wregex>        m_excludeDirsRegex;
+    std::shared_ptr<const CMultiPatternMatcher> m_patternMatcher;
+    const CSearchSnapshot*                      m_previousSnapshot;
+    CSearchSnapshot*                            m_nextSnapshot;
+    // the results reported so far, and whether they reached SearchOptions::maxResults
+    std::atomic<uint64_t>                       m_resultCount;
+    std::atomic_bool                            m_quotaReached;
+
+    // files created by the search itself, which must not be searched again
+    std::set<std::wstring>           m_backupAndTempFiles;
+    std::mutex                       m_backupAndTempFilesMutex;
+};
+
+void escapeForRegexEx(std::wstring& str, int type);
+void escapeForReplaceText(std::wstring& str);
+void replaceGrepWinFilePathVariables(std::wstring& str, const std::wstring& filePath);
+// matches the whole of the input
+bool grepWinMatchI(const std::wstring& theRegex, const wchar_t* pText);
@@ -0,0 +1,63 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+
+// the search engine does not use the precompiled header of the application,
+// so every engine file includes this one first.
+//
+// On Windows the engine is built on top of sktoolslib. Everywhere else the
+// headers in the posix folder provide the (small) subset of sktoolslib and
+// the Win32 API the engine needs, under the same names.
+
+// must match the settings in stdafx.h
+#ifndef BOOST_REGEX_BLOCKSIZE
+#    define BOOST_REGEX_BLOCKSIZE        4096
+#    define BOOST_REGEX_MAX_BLOCKS       (1024 * 32)
+#    define BOOST_REGEX_MAX_CACHE_BLOCKS (16 * 32)
+#endif
+
+#define SEARCHBLOCKSIZE (1 << 26) // 64MB
+
+#include <string>
+
+#ifdef _WIN32
+#    ifndef WIN32_LEAN_AND_MEAN
+#        define WIN32_LEAN_AND_MEAN
+#    endif
+#    include <windows.h>
+#    include <shlwapi.h>
+
+constexpr wchar_t PathSeparator = L'\\';
+
+// path as the C++ runtime and boost expect it for opening files
+inline const std::wstring& PlatformPath(const std::wstring& path)
+{
+    return path;
+}
+#else
+#    include "posix/Win32Compat.h"
+#    include "UnicodeUtils.h"
+
+constexpr wchar_t PathSeparator = L'/';
+
+inline std::string PlatformPath(const std::wstring& path)
+{
+    return CUnicodeUtils::StdGetUTF8(path);
+}
+#endif
@@ -0,0 +1,122 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2007-2008, 2012-2014, 2021-2024 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "SearchInfo.h"
+
+#include <algorithm>
+
+CSearchInfo::CSearchInfo()
+    : fileSize(0)
+    , matchCount(0)
+    , encoding(CTextFile::UnicodeType::AutoType)
+    , hasBackedup(false)
+    , readError(false)
+    , timedOut(false)
+    , folder(false)
+    , nameOffset(0)
+    , extOffset(0)
+{
+    modifiedTime.dwHighDateTime = 0;
+    modifiedTime.dwLowDateTime  = 0;
+}
+
+CSearchInfo::CSearchInfo(const std::wstring& path)
+    : filePath(path)
+    , fileSize(0)
+    , matchCount(0)
+    , encoding(CTextFile::UnicodeType::AutoType)
+    , hasBackedup(false)
+    , readError(false)
+    , timedOut(false)
+    , folder(false)
+    , nameOffset(0)
+    , extOffset(0)
+{
+    modifiedTime.dwHighDateTime = 0;
+    modifiedTime.dwLowDateTime  = 0;
+}
+
+void CSearchInfo::SetPathOffsets()
+{
+    auto separator = filePath.find_last_of(PathSeparator);
+    auto dotPos    = filePath.find_last_of('.');
+    nameOffset     = separator == std::wstring::npos ? 0 : static_cast<uint32_t>(separator + 1);
+    extOffset      = dotPos == std::wstring::npos || dotPos < nameOffset ? static_cast<uint32_t>(filePath.size()) : static_cast<uint32_t>(dotPos + 1);
+}
+
+void CSearchInfo::AddContextLine(DWORD line, std::wstring_view text)
+{
+    if (contextRanges.empty() || contextRanges.back().firstLine + contextRanges.back().lineCount != line)
+        contextRanges.push_back({line, 0, static_cast<uint32_t>(contextLineEnds.size())});
+    ++contextRanges.back().lineCount;
+    contextText.append(text);
+    contextLineEnds.push_back(static_cast<uint32_t>(contextText.size()));
+}
+
+bool CSearchInfo::ContextLine(DWORD line, std::wstring_view& text) const
+{
+    auto range = std::upper_bound(contextRanges.begin(), contextRanges.end(), line, [](DWORD l, const ContextRange& r) { return l < r.firstLine; });
+    if (range == contextRanges.begin())
+        return false;
+    --range;
+    if (line - range->firstLine >= range->lineCount)
+        return false;
+    size_t index = range->firstIndex + (line - range->firstLine);
+    size_t start = index ? contextLineEnds[index - 1] : 0;
+    text         = std::wstring_view(contextText).substr(start, contextLineEnds[index] - start);
+    return true;
+}
+
+void CSearchInfo::SetExcerptStart(DWORD column)
+{
+    matchExcerptStarts.resize(matchLines.size(), 1);
+    if (!matchExcerptStarts.empty())
+        matchExcerptStarts.back() = column;
+}
+
+DWORD CSearchInfo::MatchTextColumn(size_t i) const
+{
+    DWORD column = i < matchColumnsNumbers.size() ? matchColumnsNumbers[i] : 0;
+    if (i >= matchExcerptStarts.size() || matchExcerptStarts[i] <= 1 || column < matchExcerptStarts[i])
+        return column;
+    // the excerpt starts with the mark
+    return column - matchExcerptStarts[i] + 2;
+}
+
+bool CSearchInfo::operator<(const CSearchInfo& other) const
+{
+    auto res = _wcsicmp(filePath.c_str(), other.filePath.c_str());
+    if (res != 0)
+        return res < 0;
+    if (fileSize != other.fileSize)
+        return fileSize < other.fileSize;
+    if (matchCount != other.matchCount)
+        return matchCount < other.matchCount;
+    if (readError != other.readError)
+        return readError != other.readError;
+    if (folder != other.folder)
+        return folder != other.folder;
+    if (CompareFileTime(&modifiedTime, &other.modifiedTime) != 0)
+        return CompareFileTime(&modifiedTime, &other.modifiedTime) < 0;
+    if (matchLinesNumbers != other.matchLinesNumbers)
+        return matchLinesNumbers < other.matchLinesNumbers;
+    if (matchLines != other.matchLines)
+        return matchLines < other.matchLines;
+    return false;
+}
@@ -0,0 +1,110 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2007-2008, 2010, 2012-2013, 2021-2024 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+#include "TextFile.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// how a match line changed from one result to another, see CResultDiff
+enum class MatchChange : uint8_t
+{
+    Added,
+    Removed,
+    Moved, // the same text, at another line
+};
+
+// consecutive lines around the match lines, see CSearchInfo::contextRanges
+struct ContextRange
+{
+    DWORD    firstLine;
+    DWORD    lineCount;
+    // the index of the first line in CSearchInfo::contextLineEnds
+    uint32_t firstIndex;
+};
+
+class CSearchInfo
+{
+public:
+    CSearchInfo();
+    CSearchInfo(const std::wstring& path);
+
+    bool                      operator<(const CSearchInfo& other) const;
+
+    // sets nameOffset and extOffset from filePath
+    void                      SetPathOffsets();
+    // the parts of filePath the result list shows, once SetPathOffsets() was called
+    std::wstring_view         Name() const { return std::wstring_view(filePath).substr(nameOffset); }
+    std::wstring_view         Folder() const { return std::wstring_view(filePath).substr(0, nameOffset ? nameOffset - 1 : 0); }
+    std::wstring_view         Extension() const { return std::wstring_view(filePath).substr(extOffset); }
+
+    // adds the text of a context line, which must come after the lines
+    // added before: to the last range if it follows it, else to a new one
+    void                      AddContextLine(DWORD line, std::wstring_view text);
+    // the text of a context line, false if the line was not kept
+    bool                      ContextLine(DWORD line, std::wstring_view& text) const;
+    // marks the last of matchLines as an excerpt of a long line, which
+    // starts at column in the line of the file
+    void                      SetExcerptStart(DWORD column);
+    // where match line i starts in matchLines[i]: matchColumnsNumbers[i],
+    // or less for an excerpt
+    DWORD                     MatchTextColumn(size_t i) const;
+
+    // what an excerpt starts and ends with where the line goes on
+    static constexpr wchar_t  excerptMark = L'\u2026';
+
+    std::wstring              filePath;
+    __int64                   fileSize;
+    std::vector<DWORD>        matchLinesNumbers;
+    std::vector<DWORD>        matchColumnsNumbers;
+    std::vector<DWORD>        matchLengths;
+    std::vector<std::wstring> matchLines;
+    // for match lines which are too long to keep whole: the column of the
+    // line the excerpt in matchLines starts at, after the excerptMark.
+    // 1 for the lines kept from their start, empty if there are none.
+    std::vector<DWORD>        matchExcerptStarts;
+    // for SearchOptions::searchPatterns: the index of the pattern of each match line
+    std::vector<DWORD>        matchPatterns;
+    // for the changes between two results: how each match line changed, or
+    // with no match lines one entry for the whole result
+    std::vector<MatchChange>  matchChanges;
+    // the lines before and after the match lines, SearchOptions::contextLines.
+    // The windows of nearby matches are merged, so every line is kept once,
+    // its text in contextText up to its end in contextLineEnds.
+    std::vector<ContextRange> contextRanges;
+    std::vector<uint32_t>     contextLineEnds;
+    std::wstring              contextText;
+    __int64                   matchCount;
+    CTextFile::UnicodeType    encoding;
+    FILETIME                  modifiedTime;
+    bool                      hasBackedup;
+    bool                      readError;
+    // the search stopped before the end of the file because it took too
+    // long, see SearchOptions::regexTimeout. exception says why.
+    bool                      timedOut;
+    bool                      folder;
+    std::wstring              exception;
+    // where the name and its extension start in filePath. extOffset is the
+    // end of filePath if the name has no extension.
+    uint32_t                  nameOffset;
+    uint32_t                  extOffset;
+};
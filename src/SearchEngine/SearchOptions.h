@@ -0,0 +1,110 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class DateLimit
+{
+    All,
+    Newer,
+    Older,
+    Between,
+};
+
+enum class SizeCompare
+{
+    Less,
+    Equal,
+    Greater,
+};
+
+// everything a search run needs to know, independent of where the
+// settings come from (dialog, command line, ini file or registry)
+struct SearchOptions
+{
+    std::vector<std::wstring> searchPaths;
+    std::wstring              searchString;
+    // literal search terms which are all searched for at once, instead of
+    // searchString. Can not be used for a replace.
+    std::vector<std::wstring> searchPatterns;
+    std::wstring              replaceString;
+    // lower case wildcard patterns, a leading '-' excludes
+    std::vector<std::wstring> filePatterns;
+    std::wstring              fileNameRegex;
+    std::wstring              excludeDirsRegex;
+
+    bool                      useRegex          = false;
+    bool                      useRegexForPaths  = false;
+    bool                      caseSensitive     = false;
+    bool                      dotMatchesNewline = false;
+    bool                      wholeWords        = false;
+
+    bool                      allSize           = true;
+    uint64_t                  size              = 2000;
+    SizeCompare               sizeCmp           = SizeCompare::Less;
+    DateLimit                 dateLimit         = DateLimit::All;
+    FILETIME                  date1             = {};
+    FILETIME                  date2             = {};
+
+    bool                      includeSystem     = false;
+    bool                      includeHidden     = false;
+    bool                      includeSubfolders = true;
+    bool                      includeSymLinks   = false;
+    bool                      includeBinary     = false;
+
+    bool                      createBackup      = false;
+    bool                      backupInFolder    = false;
+    bool                      keepFileDate      = false;
+    bool                      utf8              = false;
+    bool                      forceBinary       = false;
+
+    bool                      notSearch         = false;
+    bool                      captureSearch     = false;
+    bool                      replace           = false;
+    // stop searching a file at its first match, without collecting the
+    // matching lines: for when only the list of matching files is needed
+    bool                      listOnly          = false;
+    // stop searching a file after that many matches, 0 for no limit
+    unsigned int              maxMatchesPerFile = 0;
+    // lines before and after every match line to keep with the result,
+    // like grep -C. Not for a capture search.
+    unsigned int              contextLines      = 0;
+    // stop the search once that many files were reported as results,
+    // 0 for no limit. None of these limits apply to a replace.
+    uint64_t                  maxResults        = 0;
+    // search with CLinearRegex instead of boost where it can: it finds the
+    // same matches, but never takes more than linear time
+    bool                      linearRegex       = false;
+    // seconds the regular expression may take to search a file, and the
+    // same again for every SEARCHBLOCKSIZE of it beyond the first. A file
+    // which takes longer is reported with CSearchInfo::timedOut and the
+    // matches found until then. 0 for no limit; a replace has none.
+    unsigned int              regexTimeout      = 0;
+
+    // null bytes per MB after which a file is treated as binary, 0 for the default
+    int                       nullBytes         = 0;
+    // worker threads, 0 to use all but two of the available processors
+    unsigned int              threadCount       = 0;
+    // list every folder again instead of using the cached listings
+    bool                      forceFullWalk     = false;
+};
@@ -0,0 +1,59 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchInfo.h"
+
+#include <string>
+#include <vector>
+
+// the result of one file of a batch, see ISearchResultSink::OnFileResults()
+struct SearchFileResult
+{
+    CSearchInfo sInfo;
+    bool        bSearched = false;
+    bool        bAsResult = false;
+};
+
+// receives the results of a search run.
+// OnFileResult(), OnFileResults() and OnFileSkipped() are called from the worker threads,
+// so implementations must be thread safe.
+class ISearchResultSink
+{
+public:
+    virtual ~ISearchResultSink() = default;
+
+    virtual void OnSearchStart() = 0;
+    // bSearched: the file was searched (or counted), not skipped
+    // bAsResult: the file is a result of the search, i.e. it matched
+    //            (or did not, for an inverse search)
+    virtual void OnFileResult(const CSearchInfo& sInfo, bool bSearched, bool bAsResult) = 0;
+    // the results of a batch of small files, which are searched together.
+    // Sinks which pay for every call can handle the whole batch at once.
+    virtual void OnFileResults(const std::vector<SearchFileResult>& results)
+    {
+        for (const auto& result : results)
+            OnFileResult(result.sInfo, result.bSearched, result.bAsResult);
+    }
+    // an enumerated file or folder did not pass the filters
+    virtual void OnFileSkipped() = 0;
+    virtual void OnSearchEnd() = 0;
+    // a file, or everything below a folder, is gone or does not pass the
+    // filters anymore. Only CSearchEngine::SearchChangedFiles() reports that.
+    virtual void OnFileRemoved(const std::wstring& /*path*/) {}
+};
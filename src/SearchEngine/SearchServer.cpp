@@ -0,0 +1,261 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "SearchServer.h"
+#include "CancellationToken.h"
+#include "HeadlessSearch.h"
+#include "UnicodeUtils.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <system_error>
+
+#ifndef _WIN32
+#    include <unistd.h>
+#endif
+
+namespace
+{
+// larger frames are not sent by a client of this protocol
+constexpr uint32_t maxFrameSize = 16 * 1024 * 1024;
+
+bool               WriteFrame(CLocalConnection& connection, char type, const std::string& payload)
+{
+    const auto    size      = static_cast<uint32_t>(payload.size());
+    unsigned char header[5] = {static_cast<unsigned char>(type),
+                               static_cast<unsigned char>(size & 0xFF),
+                               static_cast<unsigned char>((size >> 8) & 0xFF),
+                               static_cast<unsigned char>((size >> 16) & 0xFF),
+                               static_cast<unsigned char>((size >> 24) & 0xFF)};
+    return connection.Write(header, sizeof(header)) && (size == 0 || connection.Write(payload.data(), size));
+}
+
+bool ReadFrame(CLocalConnection& connection, char& type, std::string& payload)
+{
+    unsigned char header[5];
+    if (!connection.Read(header, sizeof(header)))
+        return false;
+    type          = static_cast<char>(header[0]);
+    uint32_t size = header[1] | (header[2] << 8) | (header[3] << 16) | (static_cast<uint32_t>(header[4]) << 24);
+    if (size > maxFrameSize)
+        return false;
+    payload.resize(size);
+    return size == 0 || connection.Read(payload.data(), size);
+}
+
+std::string CurrentDirectory()
+{
+    std::error_code ec;
+    auto            cwd = std::filesystem::current_path(ec);
+    if (ec)
+        return {};
+#ifdef _WIN32
+    return CUnicodeUtils::StdGetUTF8(cwd.wstring());
+#else
+    return cwd.string();
+#endif
+}
+
+// the output of a search on the server, sent to its client
+class CConnectionOutput : public IHeadlessOutput
+{
+public:
+    CConnectionOutput(CLocalConnection& connection, CCancellationToken& cancelToken)
+        : m_connection(connection)
+        , m_cancelToken(cancelToken)
+        , m_bFailed(false)
+    {
+    }
+
+    void WriteOut(const std::string& text) override { Send('o', text); }
+    void WriteErr(const std::string& text) override { Send('e', text); }
+
+    void SendExitCode(int exitCode)
+    {
+        const auto  code = static_cast<uint32_t>(exitCode);
+        std::string payload{static_cast<char>(code & 0xFF), static_cast<char>((code >> 8) & 0xFF),
+                            static_cast<char>((code >> 16) & 0xFF), static_cast<char>((code >> 24) & 0xFF)};
+        Send('x', payload);
+    }
+
+private:
+    void Send(char type, const std::string& text)
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_bFailed)
+            return;
+        if (!WriteFrame(m_connection, type, text))
+        {
+            // the client is gone: don't search any further for it
+            m_bFailed = true;
+            m_cancelToken.Cancel();
+        }
+    }
+
+    CLocalConnection&   m_connection;
+    CCancellationToken& m_cancelToken;
+    std::mutex          m_mutex;
+    bool                m_bFailed;
+};
+} // namespace
+
+CSearchServer::CSearchServer(const std::wstring& endpoint)
+    : m_endpoint(endpoint)
+{
+}
+
+CSearchServer::~CSearchServer()
+{
+    Stop();
+    ReapWorkers(true);
+}
+
+bool CSearchServer::Run(IHeadlessOutput& log, std::wstring& error)
+{
+    if (!m_listener.Listen(m_endpoint, error))
+        return false;
+    log.WriteErr("grepWin search server listening on " + CUnicodeUtils::StdGetUTF8(m_endpoint) + "\n");
+
+    for (;;)
+    {
+        CLocalConnection connection = m_listener.Accept();
+        if (!connection.IsValid())
+            break;
+        ReapWorkers(false);
+        auto            done = std::make_shared<std::atomic_bool>(false);
+        std::lock_guard lock(m_workersMutex);
+        m_workers.push_back({std::thread([this, done, client = std::move(connection)]() mutable {
+                                 HandleConnection(client);
+                                 *done = true;
+                             }),
+                             done});
+    }
+    ReapWorkers(true);
+    log.WriteErr("grepWin search server stopped\n");
+    return true;
+}
+
+void CSearchServer::Stop()
+{
+    m_listener.Stop();
+}
+
+void CSearchServer::ReapWorkers(bool bAll)
+{
+    std::lock_guard lock(m_workersMutex);
+    for (auto it = m_workers.begin(); it != m_workers.end();)
+    {
+        if (bAll || *it->done)
+        {
+            it->thread.join();
+            it = m_workers.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+void CSearchServer::HandleConnection(CLocalConnection& connection)
+{
+    std::wstring              baseDir;
+    std::vector<std::wstring> args;
+    char                      type = 0;
+    std::string               payload;
+    for (;;)
+    {
+        if (!ReadFrame(connection, type, payload))
+            return;
+        if (type == 'r')
+            break;
+        if (type == 'c')
+            baseDir = CUnicodeUtils::StdGetUnicode(payload);
+        else if (type == 'a')
+            args.push_back(CUnicodeUtils::StdGetUnicode(payload));
+        else
+            return; // not a client of this server
+    }
+
+    CCancellationToken cancelToken;
+    CConnectionOutput  output(connection, cancelToken);
+    for (const auto& arg : args)
+    {
+        std::wstring key;
+        std::wstring value;
+        if (CHeadlessSearch::SplitSwitch(arg, key, value) && key == L"stopserver")
+        {
+            output.SendExitCode(HeadlessExitMatches);
+            Stop();
+            return;
+        }
+    }
+
+    CHeadlessSearch search;
+    std::wstring    error;
+    int             ret = HeadlessExitError;
+    if (search.Parse(args, error, baseDir))
+        ret = search.Run(output, cancelToken, &m_cache);
+    else
+        output.WriteErr("grepWin: " + CUnicodeUtils::StdGetUTF8(error) + "\n");
+    output.SendExitCode(ret);
+}
+
+std::wstring CSearchServer::DefaultEndpoint()
+{
+#ifdef _WIN32
+    DWORD sessionId = 0;
+    ProcessIdToSessionId(GetCurrentProcessId(), &sessionId);
+    return L"\\\\.\\pipe\\grepWinSearchServer-" + std::to_wstring(sessionId);
+#else
+    const char* runtimeDir = getenv("XDG_RUNTIME_DIR");
+    std::string dir        = (runtimeDir && *runtimeDir) ? runtimeDir : "/tmp";
+    return CUnicodeUtils::StdGetUnicode(dir + "/grepWin-" + std::to_string(getuid()) + ".sock");
+#endif
+}
+
+int RunSearchOnServer(const std::wstring& endpoint, const std::vector<std::wstring>& args, IHeadlessOutput& output, std::wstring& error)
+{
+    CLocalConnection connection = CLocalConnection::Connect(endpoint);
+    if (!connection.IsValid())
+    {
+        error = L"no search server is listening on " + endpoint;
+        return HeadlessExitError;
+    }
+
+    bool bOk = WriteFrame(connection, 'c', CurrentDirectory());
+    for (const auto& arg : args)
+        bOk = bOk && WriteFrame(connection, 'a', CUnicodeUtils::StdGetUTF8(arg));
+    bOk = bOk && WriteFrame(connection, 'r', {});
+
+    char        type = 0;
+    std::string payload;
+    while (bOk && ReadFrame(connection, type, payload))
+    {
+        if (type == 'o')
+            output.WriteOut(payload);
+        else if (type == 'e')
+            output.WriteErr(payload);
+        else if (type == 'x' && payload.size() == 4)
+        {
+            return static_cast<int>(static_cast<unsigned char>(payload[0]) | (static_cast<unsigned char>(payload[1]) << 8) |
+                                    (static_cast<unsigned char>(payload[2]) << 16) | (static_cast<uint32_t>(static_cast<unsigned char>(payload[3])) << 24));
+        }
+    }
+    error = L"the connection to the search server was lost";
+    return HeadlessExitError;
+}
@@ -0,0 +1,78 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+#include "LocalConnection.h"
+#include "SearchCache.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class IHeadlessOutput;
+
+// a resident search server: runs the searches its clients send over a
+// local pipe or socket and streams the results back. Directory listings and
+// compiled filters are kept in a CSearchCache between the searches.
+//
+// A request is the command line of a headless search plus the working
+// directory of the client; the response is the output of the search,
+// followed by its exit code. Every message is a frame:
+//   1 byte type, 4 bytes little endian payload size, payload (UTF-8)
+// client -> server: 'c' working directory, 'a' argument (repeated), 'r' run
+// server -> client: 'o' stdout text, 'e' stderr text, 'x' exit code (4 bytes)
+class CSearchServer
+{
+public:
+    explicit CSearchServer(const std::wstring& endpoint);
+    ~CSearchServer();
+
+    // serves clients until a client sends /stopserver.
+    // Returns false if the server could not be started.
+    bool                Run(IHeadlessOutput& log, std::wstring& error);
+    void                Stop();
+
+    // per user (and session on Windows), so servers of different users
+    // do not get in each other's way
+    static std::wstring DefaultEndpoint();
+
+private:
+    struct Worker
+    {
+        std::thread                       thread;
+        std::shared_ptr<std::atomic_bool> done;
+    };
+
+    void                HandleConnection(CLocalConnection& connection);
+    void                ReapWorkers(bool bAll);
+
+    std::wstring        m_endpoint;
+    CLocalListener      m_listener;
+    CSearchCache        m_cache;
+    std::mutex          m_workersMutex;
+    std::vector<Worker> m_workers;
+};
+
+// sends a search to the server at endpoint and writes its output.
+// Returns the exit code of the search, or HeadlessExitError with error
+// set if there's no server.
+int RunSearchOnServer(const std::wstring& endpoint, const std::vector<std::wstring>& args, IHeadlessOutput& output, std::wstring& error);
@@ -0,0 +1,104 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SearchEnginePlatform.h"
+#include "SearchSnapshot.h"
+
+CSearchSnapshot::CSearchSnapshot(const SearchOptions& options)
+    : m_queryKey(MakeQueryKey(options))
+{
+}
+
+std::wstring CSearchSnapshot::MakeQueryKey(const SearchOptions& options)
+{
+    // everything SearchFile() depends on, besides the file itself.
+    // The replace string is only used by a capture search, a replace
+    // is never recorded.
+    std::wstring key = options.searchString;
+    key += L'\0';
+    for (const auto& pattern : options.searchPatterns)
+    {
+        key += pattern;
+        key += L'\n';
+    }
+    key += L'\0';
+    if (options.captureSearch)
+        key += options.replaceString;
+    key += L'\0';
+    key += options.useRegex ? L'r' : L'-';
+    key += options.caseSensitive ? L'c' : L'-';
+    key += options.dotMatchesNewline ? L'd' : L'-';
+    key += options.wholeWords ? L'w' : L'-';
+    key += options.includeBinary ? L'b' : L'-';
+    key += options.utf8 ? L'u' : L'-';
+    key += options.forceBinary ? L'f' : L'-';
+    key += options.notSearch ? L'n' : L'-';
+    key += options.captureSearch ? L'p' : L'-';
+    key += std::to_wstring(options.nullBytes);
+    key += L'\0';
+    key += options.listOnly ? L'l' : L'-';
+    key += std::to_wstring(options.maxMatchesPerFile);
+    key += L'\0';
+    key += std::to_wstring(options.contextLines);
+    return key;
+}
+
+void CSearchSnapshot::Add(const CSearchInfo& sInfo, int nCount)
+{
+    Entry entry;
+    entry.fileSize      = static_cast<uint64_t>(sInfo.fileSize);
+    entry.lastWriteTime = sInfo.modifiedTime;
+    entry.nCount        = nCount;
+    entry.encoding      = sInfo.encoding;
+    if (sInfo.matchCount > 0 || !sInfo.matchLinesNumbers.empty())
+        entry.info = std::make_unique<CSearchInfo>(sInfo);
+
+    std::lock_guard lock(m_mutex);
+    m_entries.insert_or_assign(sInfo.filePath, std::move(entry));
+}
+
+bool CSearchSnapshot::Find(const std::wstring& filePath, uint64_t fileSize, const FILETIME& lastWriteTime, CSearchInfo& sInfo, int& nCount) const
+{
+    std::lock_guard lock(m_mutex);
+    auto            it = m_entries.find(filePath);
+    if (it == m_entries.end())
+        return false;
+    const Entry& entry = it->second;
+    if (entry.fileSize != fileSize || CompareFileTime(&entry.lastWriteTime, &lastWriteTime) != 0)
+        return false;
+
+    if (entry.info)
+    {
+        sInfo = *entry.info;
+    }
+    else
+    {
+        sInfo              = CSearchInfo(filePath);
+        sInfo.fileSize     = static_cast<__int64>(fileSize);
+        sInfo.modifiedTime = lastWriteTime;
+        sInfo.encoding     = entry.encoding;
+    }
+    nCount = entry.nCount;
+    return true;
+}
+
+size_t CSearchSnapshot::Size() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+}
@@ -0,0 +1,75 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "SearchEnginePlatform.h"
+#include "SearchInfo.h"
+#include "SearchOptions.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// the results of a search run for every file it searched, together with
+// the size and last-write time each file had.
+//
+// A later run of the same query reuses the result of every file whose size
+// and time are unchanged instead of reading it again. Files which are new
+// or changed are searched, files which are gone are simply not enumerated
+// anymore, so the result is the same as that of a full search.
+// Add() is thread safe, Find() may be called concurrently once the run
+// which recorded the snapshot is done.
+class CSearchSnapshot
+{
+public:
+    explicit CSearchSnapshot(const SearchOptions& options);
+
+    // two snapshots with the same key hold the same result for a file.
+    // The search paths and filters are not part of it: they only decide
+    // which files are searched.
+    static std::wstring MakeQueryKey(const SearchOptions& options);
+    const std::wstring& QueryKey() const { return m_queryKey; }
+
+    // records the result of a searched file. nCount is what the search of
+    // the file returned: the number of matches, or -1 if it was skipped.
+    void                Add(const CSearchInfo& sInfo, int nCount);
+
+    // the recorded result of filePath if the file is unchanged.
+    // Returns false if the file has to be searched again.
+    bool                Find(const std::wstring& filePath, uint64_t fileSize, const FILETIME& lastWriteTime, CSearchInfo& sInfo, int& nCount) const;
+
+    size_t              Size() const;
+
+private:
+    struct Entry
+    {
+        uint64_t                     fileSize;
+        FILETIME                     lastWriteTime;
+        int                          nCount;
+        CTextFile::UnicodeType       encoding;
+        // only kept for files with matches: the others are fully described
+        // by the fields above
+        std::unique_ptr<CSearchInfo> info;
+    };
+
+    std::wstring                            m_queryKey;
+    mutable std::mutex                      m_mutex;
+    std::unordered_map<std::wstring, Entry> m_entries;
+};
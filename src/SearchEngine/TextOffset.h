@@ -1,5 +1,8 @@
 #pragma once
+#include <algorithm>
 #include <atomic>
+#include <cstring>
+#include <tuple>
 #include <vector>
 
 template <typename CharT = char>
@@ -28,8 +31,9 @@ public:
         }
         else if (end - start > 1)
         {
-            const wchar_t* startW = reinterpret_cast<const wchar_t*>(start);
-            if (*startW == 0xFEFF || (bBigEndian = *startW == 0xFFFE) == true)
+            // wchar_t is not 16 bits wide everywhere, so compose the code unit from its two bytes
+            const unsigned short startW = static_cast<unsigned char>(start[0]) | static_cast<unsigned char>(start[1]) << 8;
+            if (startW == 0xFEFF || (bBigEndian = startW == 0xFFFE) == true)
             {
                 lenBOM = 2;
                 return start + 2;
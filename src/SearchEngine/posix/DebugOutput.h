@@ -1,6 +1,6 @@
 // grepWin - regex search and replace for Windows
 
-// Copyright (C) 2011, 2015 - Stefan Kueng
+// Copyright (C) 2026 - Stefan Kueng
 
 // This program is free software; you can redistribute it and/or
 // modify it under the terms of the GNU General Public License
@@ -16,5 +16,13 @@
 // along with this program; if not, write to the Free Software Foundation,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 //
-#include "stdafx.h"
-#include "RegexReplaceFormatter.h"
+#pragma once
+
+// profiling is only done in the Windows debug builds
+class ProfileTimer
+{
+public:
+    explicit ProfileTimer(const wchar_t* /*text*/)
+    {
+    }
+};
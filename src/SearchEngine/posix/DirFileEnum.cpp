@@ -0,0 +1,129 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DirFileEnum.h"
+#include "UnicodeUtils.h"
+
+#include <cstring>
+#include <sys/stat.h>
+
+CDirFileEnum::CDirFileEnum(const std::wstring& dirPath)
+    : m_startPath(dirPath)
+    , m_findData{}
+    , m_attributesToIgnore(0)
+    , m_bStarted(false)
+    , m_bLastWasDirectory(false)
+{
+    while (m_startPath.size() > 1 && m_startPath.back() == L'/')
+        m_startPath.pop_back();
+}
+
+CDirFileEnum::~CDirFileEnum()
+{
+    for (auto& level : m_stack)
+        closedir(level.dir);
+}
+
+bool CDirFileEnum::FillFindData(const std::wstring& path, const std::wstring& name)
+{
+    struct stat linkStat{};
+    if (lstat(WideToUTF8(path).c_str(), &linkStat) != 0)
+        return false;
+    bool        bIsLink = S_ISLNK(linkStat.st_mode);
+    struct stat st      = linkStat;
+    if (bIsLink && stat(WideToUTF8(path).c_str(), &st) != 0)
+        st = linkStat; // dangling link
+
+    m_findData                  = {};
+    m_findData.dwFileAttributes = S_ISDIR(st.st_mode) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+    if (bIsLink)
+        m_findData.dwFileAttributes |= FILE_ATTRIBUTE_REPARSE_POINT;
+    if (!name.empty() && name[0] == L'.')
+        m_findData.dwFileAttributes |= FILE_ATTRIBUTE_HIDDEN;
+    if ((st.st_mode & S_IWUSR) == 0)
+        m_findData.dwFileAttributes |= FILE_ATTRIBUTE_READONLY;
+    if (!S_ISDIR(st.st_mode) && !S_ISREG(st.st_mode))
+        m_findData.dwFileAttributes |= FILE_ATTRIBUTE_SYSTEM; // devices, sockets, pipes
+    m_findData.ftCreationTime   = UnixTimeToFileTime(st.st_ctim.tv_sec, st.st_ctim.tv_nsec);
+    m_findData.ftLastAccessTime = UnixTimeToFileTime(st.st_atim.tv_sec, st.st_atim.tv_nsec);
+    m_findData.ftLastWriteTime  = UnixTimeToFileTime(st.st_mtim.tv_sec, st.st_mtim.tv_nsec);
+    auto size                   = S_ISDIR(st.st_mode) ? 0 : static_cast<uint64_t>(st.st_size);
+    m_findData.nFileSizeHigh    = static_cast<DWORD>(size >> 32);
+    m_findData.nFileSizeLow     = static_cast<DWORD>(size & 0xFFFFFFFF);
+    wcsncpy(m_findData.cFileName, name.c_str(), MAX_PATH - 1);
+    return true;
+}
+
+bool CDirFileEnum::NextFile(std::wstring& result, bool* pbIsDirectory, bool bRecurse)
+{
+    if (!m_bStarted)
+    {
+        m_bStarted = true;
+        if (!FillFindData(m_startPath, {}))
+            return false;
+        if ((m_findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+        {
+            // a single file: return just that one
+            auto pos = m_startPath.find_last_of(L'/');
+            FillFindData(m_startPath, pos == std::wstring::npos ? m_startPath : m_startPath.substr(pos + 1));
+            result = m_startPath;
+            if (pbIsDirectory)
+                *pbIsDirectory = false;
+            return true;
+        }
+        DIR* dir = opendir(WideToUTF8(m_startPath).c_str());
+        if (dir == nullptr)
+            return false;
+        m_stack.push_back({dir, m_startPath == L"/" ? std::wstring() : m_startPath});
+    }
+    else if (m_bLastWasDirectory && bRecurse)
+    {
+        DIR* dir = opendir(WideToUTF8(m_lastPath).c_str());
+        if (dir)
+            m_stack.push_back({dir, m_lastPath});
+    }
+    m_bLastWasDirectory = false;
+
+    while (!m_stack.empty())
+    {
+        auto&   level = m_stack.back();
+        dirent* entry = readdir(level.dir);
+        if (entry == nullptr)
+        {
+            closedir(level.dir);
+            m_stack.pop_back();
+            continue;
+        }
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+        std::wstring name = UTF8ToWide(entry->d_name);
+        std::wstring path = level.path + L'/' + name;
+        if (!FillFindData(path, name))
+            continue;
+        if (m_findData.dwFileAttributes & m_attributesToIgnore)
+            continue;
+        bool bIsDir         = (m_findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        m_bLastWasDirectory = bIsDir;
+        m_lastPath          = path;
+        result              = path;
+        if (pbIsDirectory)
+            *pbIsDirectory = bIsDir;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,59 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "Win32Compat.h"
+
+#include <dirent.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// enumerates a directory tree like the sktoolslib CDirFileEnum:
+// the bRecurse flag passed to NextFile() decides whether the directory
+// returned by the previous call is descended into.
+class CDirFileEnum
+{
+public:
+    explicit CDirFileEnum(const std::wstring& dirPath);
+    ~CDirFileEnum();
+
+    CDirFileEnum(const CDirFileEnum&)            = delete;
+    CDirFileEnum& operator=(const CDirFileEnum&) = delete;
+
+    bool                   NextFile(std::wstring& result, bool* pbIsDirectory, bool bRecurse = true);
+    const WIN32_FIND_DATA* GetFileInfo() const { return &m_findData; }
+    void                   SetAttributesToIgnore(DWORD attributes) { m_attributesToIgnore = attributes; }
+
+private:
+    struct Level
+    {
+        DIR*         dir;
+        std::wstring path;
+    };
+
+    bool               FillFindData(const std::wstring& path, const std::wstring& name);
+
+    std::wstring       m_startPath;
+    std::vector<Level> m_stack;
+    WIN32_FIND_DATA    m_findData;
+    DWORD              m_attributesToIgnore;
+    bool               m_bStarted;
+    bool               m_bLastWasDirectory;
+    std::wstring       m_lastPath;
+};
@@ -0,0 +1,57 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "PathUtils.h"
+#include "UnicodeUtils.h"
+
+#include <filesystem>
+#include <system_error>
+
+std::wstring CPathUtils::GetParentDirectory(const std::wstring& path)
+{
+    auto pos = path.find_last_of(L'/');
+    if (pos == std::wstring::npos)
+        return {};
+    if (pos == 0)
+        return L"/";
+    return path.substr(0, pos);
+}
+
+std::wstring CPathUtils::GetFileName(const std::wstring& path)
+{
+    auto pos = path.find_last_of(L'/');
+    if (pos == std::wstring::npos)
+        return path;
+    return path.substr(pos + 1);
+}
+
+std::wstring CPathUtils::GetFileExtension(const std::wstring& path)
+{
+    auto name = GetFileName(path);
+    auto pos  = name.find_last_of(L'.');
+    if (pos == std::wstring::npos)
+        return {};
+    return name.substr(pos + 1);
+}
+
+bool CPathUtils::CreateRecursiveDirectory(const std::wstring& path)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(WideToUTF8(path), ec);
+    return !ec;
+}
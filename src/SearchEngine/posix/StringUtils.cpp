@@ -0,0 +1,102 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "StringUtils.h"
+
+template <typename StringT>
+static void SearchReplaceT(StringT& str, const StringT& toReplace, const StringT& replaceWith)
+{
+    if (toReplace.empty())
+        return;
+    StringT                    result;
+    typename StringT::size_type pos = 0;
+    for (;;)
+    {
+        auto next = str.find(toReplace, pos);
+        result.append(str, pos, next - pos);
+        if (next == StringT::npos)
+            break;
+        result.append(replaceWith);
+        pos = next + toReplace.size();
+    }
+    str.swap(result);
+}
+
+void SearchReplace(std::wstring& str, const std::wstring& toReplace, const std::wstring& replaceWith)
+{
+    SearchReplaceT(str, toReplace, replaceWith);
+}
+
+void SearchReplace(std::string& str, const std::string& toReplace, const std::string& replaceWith)
+{
+    SearchReplaceT(str, toReplace, replaceWith);
+}
+
+int wcswildcmp(const wchar_t* wild, const wchar_t* string)
+{
+    const wchar_t* cp = nullptr;
+    const wchar_t* mp = nullptr;
+    while ((*string) && (*wild != '*'))
+    {
+        if ((*wild != *string) && (*wild != '?'))
+            return 0;
+        wild++;
+        string++;
+    }
+    while (*string)
+    {
+        if (*wild == '*')
+        {
+            if (!*++wild)
+                return 1;
+            mp = wild;
+            cp = string + 1;
+        }
+        else if ((*wild == *string) || (*wild == '?'))
+        {
+            wild++;
+            string++;
+        }
+        else
+        {
+            wild   = mp;
+            string = cp++;
+        }
+    }
+    while (*wild == '*')
+        wild++;
+    return !*wild;
+}
+
+std::wstring& CStringUtils::rtrim(std::wstring& s, const wchar_t* trimChars)
+{
+    auto pos = s.find_last_not_of(trimChars);
+    s.erase(pos == std::wstring::npos ? 0 : pos + 1);
+    return s;
+}
+
+std::wstring& CStringUtils::ltrim(std::wstring& s, const wchar_t* trimChars)
+{
+    s.erase(0, s.find_first_not_of(trimChars));
+    return s;
+}
+
+std::wstring& CStringUtils::trim(std::wstring& s, const wchar_t* trimChars)
+{
+    return ltrim(rtrim(s, trimChars), trimChars);
+}
@@ -0,0 +1,60 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include <string>
+
+// the sktoolslib string helpers the search engine uses
+
+void SearchReplace(std::wstring& str, const std::wstring& toReplace, const std::wstring& replaceWith);
+void SearchReplace(std::string& str, const std::string& toReplace, const std::string& replaceWith);
+
+// wildcard compare: '*' matches any sequence, '?' any single char
+int  wcswildcmp(const wchar_t* wild, const wchar_t* string);
+
+template <typename Container>
+void stringtok(Container& container, const std::wstring& in, bool trim, const wchar_t* const delimiters = L"|")
+{
+    const std::wstring::size_type len = in.length();
+    std::wstring::size_type       i   = 0;
+    while (i < len)
+    {
+        if (trim)
+        {
+            i = in.find_first_not_of(delimiters, i);
+            if (i == std::wstring::npos)
+                return;
+        }
+        auto j = in.find_first_of(delimiters, i);
+        if (j == std::wstring::npos)
+        {
+            container.push_back(in.substr(i));
+            return;
+        }
+        container.push_back(in.substr(i, j - i));
+        i = j + 1;
+    }
+}
+
+class CStringUtils
+{
+public:
+    static std::wstring& rtrim(std::wstring& s, const wchar_t* trimChars = L" \t\r\n");
+    static std::wstring& ltrim(std::wstring& s, const wchar_t* trimChars = L" \t\r\n");
+    static std::wstring& trim(std::wstring& s, const wchar_t* trimChars = L" \t\r\n");
+};
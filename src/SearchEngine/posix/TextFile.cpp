@@ -0,0 +1,307 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "TextFile.h"
+#include "UnicodeUtils.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+// files bigger than this are not converted, but searched mapped
+constexpr size_t maxLoadSize     = 64 * 1024 * 1024;
+// the part of a file used to detect its encoding
+constexpr size_t detectBlockSize = 1024 * 1024;
+
+void             AppendUtf16(std::wstring& out, const unsigned char* data, size_t length, bool bigEndian)
+{
+    out.reserve(out.size() + length / 2);
+    char32_t highSurrogate = 0;
+    for (size_t i = 0; i + 1 < length; i += 2)
+    {
+        char32_t unit = bigEndian ? (data[i] << 8 | data[i + 1]) : (data[i + 1] << 8 | data[i]);
+        if constexpr (sizeof(wchar_t) == 2)
+        {
+            out.push_back(static_cast<wchar_t>(unit));
+        }
+        else
+        {
+            if (unit >= 0xD800 && unit < 0xDC00)
+            {
+                if (highSurrogate)
+                    out.push_back(static_cast<wchar_t>(highSurrogate));
+                highSurrogate = unit;
+                continue;
+            }
+            if (unit >= 0xDC00 && unit < 0xE000 && highSurrogate)
+            {
+                out.push_back(static_cast<wchar_t>(0x10000 + ((highSurrogate - 0xD800) << 10) + (unit - 0xDC00)));
+                highSurrogate = 0;
+                continue;
+            }
+            if (highSurrogate)
+            {
+                out.push_back(static_cast<wchar_t>(highSurrogate));
+                highSurrogate = 0;
+            }
+            out.push_back(static_cast<wchar_t>(unit));
+        }
+    }
+    if (highSurrogate)
+        out.push_back(static_cast<wchar_t>(highSurrogate));
+}
+
+void AppendUtf16Bytes(std::string& out, const std::wstring& text, bool bigEndian)
+{
+    out.reserve(out.size() + text.size() * 2);
+    auto putUnit = [&](char32_t unit) {
+        if (bigEndian)
+        {
+            out.push_back(static_cast<char>(unit >> 8));
+            out.push_back(static_cast<char>(unit & 0xFF));
+        }
+        else
+        {
+            out.push_back(static_cast<char>(unit & 0xFF));
+            out.push_back(static_cast<char>(unit >> 8));
+        }
+    };
+    for (wchar_t wc : text)
+    {
+        auto cp = static_cast<char32_t>(wc);
+        if (cp >= 0x10000)
+        {
+            cp -= 0x10000;
+            putUnit(0xD800 + (cp >> 10));
+            putUnit(0xDC00 + (cp & 0x3FF));
+        }
+        else
+            putUnit(cp);
+    }
+}
+} // namespace
+
+CTextFile::CTextFile()
+    : m_encoding(AutoType)
+    , m_hasBOM(false)
+    , m_nullByteCount(2)
+{
+}
+
+CTextFile::UnicodeType CTextFile::CheckUnicodeType(const unsigned char* buffer, size_t length) const
+{
+    if (length >= 3 && buffer[0] == 0xEF && buffer[1] == 0xBB && buffer[2] == 0xBF)
+        return UTF8;
+    if (length >= 2 && buffer[0] == 0xFF && buffer[1] == 0xFE)
+        return Unicode_Le;
+    if (length >= 2 && buffer[0] == 0xFE && buffer[1] == 0xFF)
+        return Unicode_Be;
+
+    // UTF-16 text without a BOM: every other byte is null
+    size_t nullsEven = 0;
+    size_t nullsOdd  = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (buffer[i] == 0)
+            ++((i & 1) ? nullsOdd : nullsEven);
+    }
+    size_t pairs = length / 2;
+    if (pairs > 4)
+    {
+        if (nullsOdd > pairs * 9 / 10 && nullsEven == 0)
+            return Unicode_Le;
+        if (nullsEven > pairs * 9 / 10 && nullsOdd == 0)
+            return Unicode_Be;
+    }
+    if (nullsEven + nullsOdd >= static_cast<size_t>(std::max(m_nullByteCount, 1)))
+        return Binary;
+    return IsUTF8(reinterpret_cast<const char*>(buffer), length) ? UTF8 : Ansi;
+}
+
+bool CTextFile::Load(LPCWSTR path, UnicodeType& type, bool bUTF8, std::atomic_bool& bCancelled)
+{
+    m_textBuffer.clear();
+    m_lineStarts.clear();
+    m_hasBOM = false;
+
+    std::ifstream file(WideToUTF8(path), std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        type = AutoType;
+        return false;
+    }
+    auto fileSize = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+
+    std::string data(std::min(fileSize, std::max(maxLoadSize, detectBlockSize)), '\0');
+    file.read(data.data(), static_cast<std::streamsize>(std::min(fileSize, detectBlockSize)));
+    auto        detected = file.gcount();
+    const auto* bytes    = reinterpret_cast<const unsigned char*>(data.data());
+
+    if (type == AutoType)
+    {
+        type = CheckUnicodeType(bytes, static_cast<size_t>(detected));
+        if (bUTF8 && type == Ansi)
+            type = UTF8;
+    }
+    m_encoding = type;
+    // binary files are searched mapped, with several encodings tried
+    if (type == Binary || fileSize > maxLoadSize || bCancelled)
+        return false;
+
+    if (fileSize > static_cast<size_t>(detected))
+    {
+        file.read(data.data() + detected, static_cast<std::streamsize>(fileSize - detected));
+        if (static_cast<size_t>(file.gcount()) != fileSize - detected)
+        {
+            type = AutoType;
+            return false;
+        }
+    }
+    data.resize(fileSize);
+    bytes = reinterpret_cast<const unsigned char*>(data.data());
+
+    switch (type)
+    {
+        case UTF8:
+            m_hasBOM = fileSize >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF;
+            m_textBuffer = UTF8ToWide(m_hasBOM ? data.substr(3) : data);
+            break;
+        case Ansi:
+            m_textBuffer = MultibyteToWide(data);
+            break;
+        case Unicode_Le:
+        case Unicode_Be:
+        {
+            bool bigEndian = type == Unicode_Be;
+            m_hasBOM       = fileSize >= 2 && bytes[0] == (bigEndian ? 0xFE : 0xFF) && bytes[1] == (bigEndian ? 0xFF : 0xFE);
+            size_t skip    = m_hasBOM ? 2 : 0;
+            AppendUtf16(m_textBuffer, bytes + skip, fileSize - skip, bigEndian);
+        }
+        break;
+        default:
+            break;
+    }
+    CalculateLines(bCancelled);
+    return !bCancelled;
+}
+
+bool CTextFile::Save(LPCWSTR path, bool /*keepFileDate*/) const
+{
+    std::string out;
+    switch (m_encoding)
+    {
+        case UTF8:
+            if (m_hasBOM)
+                out = "\xEF\xBB\xBF";
+            out += WideToUTF8(m_textBuffer);
+            break;
+        case Ansi:
+            out = WideToMultibyte(m_textBuffer);
+            break;
+        case Unicode_Le:
+        case Unicode_Be:
+        {
+            bool bigEndian = m_encoding == Unicode_Be;
+            if (m_hasBOM)
+                out = bigEndian ? "\xFE\xFF" : "\xFF\xFE";
+            AppendUtf16Bytes(out, m_textBuffer, bigEndian);
+        }
+        break;
+        default:
+            return false;
+    }
+    std::ofstream file(WideToUTF8(path), std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return file.good();
+}
+
+void CTextFile::SetFileContent(const std::wstring& content)
+{
+    m_textBuffer = content;
+    std::atomic_bool bNotCancelled = false;
+    CalculateLines(bNotCancelled);
+}
+
+void CTextFile::CalculateLines(std::atomic_bool& bCancelled)
+{
+    m_lineStarts.clear();
+    m_lineStarts.push_back(0);
+    const auto size = m_textBuffer.size();
+    for (size_t i = 0; i < size; ++i)
+    {
+        if ((i & 0xFFFF) == 0 && bCancelled)
+            return;
+        wchar_t c = m_textBuffer[i];
+        if (c == L'\r')
+        {
+            if (i + 1 < size && m_textBuffer[i + 1] == L'\n')
+                ++i;
+            m_lineStarts.push_back(i + 1);
+        }
+        else if (c == L'\n')
+            m_lineStarts.push_back(i + 1);
+    }
+}
+
+long CTextFile::LineFromPosition(long pos) const
+{
+    auto it = std::upper_bound(m_lineStarts.begin(), m_lineStarts.end(), static_cast<size_t>(pos));
+    return static_cast<long>(std::distance(m_lineStarts.begin(), it));
+}
+
+long CTextFile::ColumnFromPosition(long pos, long line) const
+{
+    if (line < 1 || static_cast<size_t>(line) > m_lineStarts.size())
+        return 1;
+    return pos - static_cast<long>(m_lineStarts[line - 1]) + 1;
+}
+
+std::wstring CTextFile::GetLineString(long lineNumber) const
+{
+    if (lineNumber < 1 || static_cast<size_t>(lineNumber) > m_lineStarts.size())
+        return {};
+    size_t start = m_lineStarts[lineNumber - 1];
+    size_t end   = static_cast<size_t>(lineNumber) < m_lineStarts.size() ? m_lineStarts[lineNumber] : m_textBuffer.size();
+    while (end > start && (m_textBuffer[end - 1] == L'\n' || m_textBuffer[end - 1] == L'\r'))
+        --end;
+    return m_textBuffer.substr(start, end - start);
+}
+
+std::wstring CTextFile::GetEncodingString(UnicodeType type)
+{
+    switch (type)
+    {
+        case Ansi:
+            return L"ANSI";
+        case Unicode_Le:
+            return L"UTF-16-LE";
+        case Unicode_Be:
+            return L"UTF-16-BE";
+        case UTF8:
+            return L"UTF-8";
+        case Binary:
+            return L"Binary";
+        default:
+            return L"";
+    }
+}
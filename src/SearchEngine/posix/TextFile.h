@@ -0,0 +1,71 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include "Win32Compat.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+// the subset of the sktoolslib CTextFile the search engine uses:
+// loads a file, detects its encoding and converts it to a wide string,
+// and writes it back in the same encoding.
+class CTextFile
+{
+public:
+    enum UnicodeType
+    {
+        AutoType,
+        Binary,
+        Ansi,
+        Unicode_Le,
+        Unicode_Be,
+        UTF8,
+    };
+
+    CTextFile();
+
+    // loads the file. Returns false if the file can't be read, is binary or
+    // is too big to be converted: type is then still set to the detected
+    // encoding, or left as AutoType if the file couldn't be read at all.
+    bool                Load(LPCWSTR path, UnicodeType& type, bool bUTF8, std::atomic_bool& bCancelled);
+    bool                Save(LPCWSTR path, bool keepFileDate) const;
+
+    void                SetFileContent(const std::wstring& content);
+    const std::wstring& GetFileString() const { return m_textBuffer; }
+
+    long                LineFromPosition(long pos) const;
+    long                ColumnFromPosition(long pos, long line) const;
+    std::wstring        GetLineString(long lineNumber) const;
+
+    // number of null bytes after which a file is treated as binary
+    void                SetNullbyteCountForBinary(int count) { m_nullByteCount = count; }
+
+    static std::wstring GetEncodingString(UnicodeType type);
+
+private:
+    UnicodeType         CheckUnicodeType(const unsigned char* buffer, size_t length) const;
+    void                CalculateLines(std::atomic_bool& bCancelled);
+
+    std::wstring        m_textBuffer;
+    std::vector<size_t> m_lineStarts;
+    UnicodeType         m_encoding;
+    bool                m_hasBOM;
+    int                 m_nullByteCount;
+};
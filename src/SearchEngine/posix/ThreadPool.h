@@ -0,0 +1,106 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// the sktoolslib thread pool interface the search engine uses
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t threadCount)
+        : m_maxQueued(threadCount * 2)
+    {
+        if (threadCount == 0)
+            threadCount = 1;
+        for (size_t i = 0; i < threadCount; ++i)
+            m_threads.emplace_back([this]() { Worker(); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::unique_lock lock(m_mutex);
+            m_stop = true;
+        }
+        m_workAvailable.notify_all();
+        for (auto& t : m_threads)
+            t.join();
+    }
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // queues a task, but blocks while the queue is full so the
+    // producer can't race ahead of the workers
+    void        enqueueWait(std::function<void()> task)
+    {
+        std::unique_lock lock(m_mutex);
+        m_queueSpace.wait(lock, [this]() { return m_tasks.size() < m_maxQueued; });
+        m_tasks.push_back(std::move(task));
+        m_workAvailable.notify_one();
+    }
+
+    // blocks until all queued tasks have finished
+    void waitFinished()
+    {
+        std::unique_lock lock(m_mutex);
+        m_finished.wait(lock, [this]() { return m_tasks.empty() && m_busy == 0; });
+    }
+
+private:
+    void Worker()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(m_mutex);
+                m_workAvailable.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                    return;
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+                ++m_busy;
+            }
+            m_queueSpace.notify_one();
+            task();
+            {
+                std::unique_lock lock(m_mutex);
+                --m_busy;
+                if (m_tasks.empty() && m_busy == 0)
+                    m_finished.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread>          m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex                        m_mutex;
+    std::condition_variable           m_workAvailable;
+    std::condition_variable           m_queueSpace;
+    std::condition_variable           m_finished;
+    size_t                            m_maxQueued;
+    size_t                            m_busy = 0;
+    bool                              m_stop = false;
+};
@@ -0,0 +1,165 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "UnicodeUtils.h"
+
+std::string CUnicodeUtils::StdGetUTF8(const std::wstring& wide)
+{
+    return WideToUTF8(wide);
+}
+
+std::string CUnicodeUtils::StdGetANSI(const std::wstring& wide)
+{
+    return WideToMultibyte(wide);
+}
+
+std::wstring CUnicodeUtils::StdGetUnicode(const std::string& utf8)
+{
+    return UTF8ToWide(utf8);
+}
+
+std::wstring UTF8ToWide(const std::string& utf8)
+{
+    std::wstring wide;
+    wide.reserve(utf8.size());
+    const auto* p   = reinterpret_cast<const unsigned char*>(utf8.data());
+    const auto* end = p + utf8.size();
+    while (p < end)
+    {
+        unsigned char c     = *p++;
+        char32_t      cp    = c;
+        int           trail = 0;
+        if (c >= 0xF8)
+        {
+            wide.push_back(L'\xFFFD');
+            continue;
+        }
+        if (c >= 0xF0)
+        {
+            cp    = c & 0x07;
+            trail = 3;
+        }
+        else if (c >= 0xE0)
+        {
+            cp    = c & 0x0F;
+            trail = 2;
+        }
+        else if (c >= 0xC0)
+        {
+            cp    = c & 0x1F;
+            trail = 1;
+        }
+        else if (c >= 0x80)
+        {
+            wide.push_back(L'\xFFFD');
+            continue;
+        }
+        bool bValid = true;
+        for (; trail > 0; --trail)
+        {
+            if (p >= end || (*p & 0xC0) != 0x80)
+            {
+                bValid = false;
+                break;
+            }
+            cp = (cp << 6) | (*p++ & 0x3F);
+        }
+        wide.push_back(bValid ? static_cast<wchar_t>(cp) : L'\xFFFD');
+    }
+    return wide;
+}
+
+std::wstring MultibyteToWide(const std::string& multibyte)
+{
+    std::wstring wide;
+    wide.reserve(multibyte.size());
+    for (char c : multibyte)
+        wide.push_back(static_cast<unsigned char>(c));
+    return wide;
+}
+
+std::string WideToUTF8(const std::wstring& wide)
+{
+    std::string utf8;
+    utf8.reserve(wide.size());
+    for (wchar_t wc : wide)
+    {
+        auto cp = static_cast<char32_t>(wc);
+        if (cp < 0x80)
+            utf8.push_back(static_cast<char>(cp));
+        else if (cp < 0x800)
+        {
+            utf8.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+            utf8.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+        else if (cp < 0x10000)
+        {
+            utf8.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+            utf8.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            utf8.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+        else
+        {
+            utf8.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+            utf8.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            utf8.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            utf8.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+    }
+    return utf8;
+}
+
+std::string WideToMultibyte(const std::wstring& wide)
+{
+    std::string multibyte;
+    multibyte.reserve(wide.size());
+    for (wchar_t wc : wide)
+        multibyte.push_back(static_cast<char32_t>(wc) < 0x100 ? static_cast<char>(wc) : '?');
+    return multibyte;
+}
+
+bool IsUTF8(const char* buffer, size_t length)
+{
+    const auto* p   = reinterpret_cast<const unsigned char*>(buffer);
+    const auto* end = p + length;
+    while (p < end)
+    {
+        unsigned char c     = *p++;
+        int           trail = 0;
+        if (c < 0x80)
+            continue;
+        if (c >= 0xC2 && c < 0xE0)
+            trail = 1;
+        else if (c >= 0xE0 && c < 0xF0)
+            trail = 2;
+        else if (c >= 0xF0 && c < 0xF5)
+            trail = 3;
+        else
+            return false;
+        for (; trail > 0; --trail)
+        {
+            // a sequence cut off at the end of the buffer is fine:
+            // the buffer may only be the start of the file
+            if (p >= end)
+                return true;
+            if ((*p++ & 0xC0) != 0x80)
+                return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+#include <string>
+
+// the sktoolslib conversions the search engine uses.
+// "ANSI" is ISO-8859-1 here: there is no system code page to follow.
+class CUnicodeUtils
+{
+public:
+    static std::string  StdGetUTF8(const std::wstring& wide);
+    static std::string  StdGetANSI(const std::wstring& wide);
+    static std::wstring StdGetUnicode(const std::string& utf8);
+};
+
+std::wstring UTF8ToWide(const std::string& utf8);
+std::wstring MultibyteToWide(const std::string& multibyte);
+std::string  WideToUTF8(const std::wstring& wide);
+std::string  WideToMultibyte(const std::wstring& wide);
+
+// true if the buffer is valid UTF-8
+bool         IsUTF8(const char* buffer, size_t length);
@@ -0,0 +1,216 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Win32Compat.h"
+#include "UnicodeUtils.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <cwctype>
+#include <fcntl.h>
+#include <filesystem>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+// 100ns intervals between 1601-01-01 and 1970-01-01
+constexpr int64_t unixEpochOffset = 116444736000000000LL;
+
+std::string       Narrow(LPCWSTR path)
+{
+    return WideToUTF8(path);
+}
+} // namespace
+
+FILETIME UnixTimeToFileTime(int64_t seconds, int64_t nanoSeconds)
+{
+    auto     ticks = static_cast<uint64_t>(seconds * 10000000LL + nanoSeconds / 100 + unixEpochOffset);
+    FILETIME ft;
+    ft.dwLowDateTime  = static_cast<DWORD>(ticks & 0xFFFFFFFF);
+    ft.dwHighDateTime = static_cast<DWORD>(ticks >> 32);
+    return ft;
+}
+
+void FileTimeToUnixTime(const FILETIME& fileTime, int64_t& seconds, int64_t& nanoSeconds)
+{
+    auto ticks  = static_cast<int64_t>((static_cast<uint64_t>(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime) - unixEpochOffset;
+    seconds     = ticks / 10000000LL;
+    nanoSeconds = (ticks % 10000000LL) * 100;
+    if (nanoSeconds < 0)
+    {
+        --seconds;
+        nanoSeconds += 1000000000LL;
+    }
+}
+
+BOOL PathFileExists(LPCWSTR path)
+{
+    return access(Narrow(path).c_str(), F_OK) == 0;
+}
+
+BOOL PathIsDirectory(LPCWSTR path)
+{
+    struct stat st{};
+    return stat(Narrow(path).c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+long CompareFileTime(const FILETIME* fileTime1, const FILETIME* fileTime2)
+{
+    auto t1 = (static_cast<uint64_t>(fileTime1->dwHighDateTime) << 32) | fileTime1->dwLowDateTime;
+    auto t2 = (static_cast<uint64_t>(fileTime2->dwHighDateTime) << 32) | fileTime2->dwLowDateTime;
+    return t1 < t2 ? -1 : (t1 > t2 ? 1 : 0);
+}
+
+DWORD GetFileAttributes(LPCWSTR path)
+{
+    struct stat st{};
+    if (stat(Narrow(path).c_str(), &st) != 0)
+        return INVALID_FILE_ATTRIBUTES;
+    DWORD attributes = S_ISDIR(st.st_mode) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+    if ((st.st_mode & S_IWUSR) == 0)
+        attributes |= FILE_ATTRIBUTE_READONLY;
+    return attributes;
+}
+
+BOOL SetFileAttributes(LPCWSTR path, DWORD attributes)
+{
+    // only the read-only flag has an equivalent
+    struct stat st{};
+    auto        narrow = Narrow(path);
+    if (stat(narrow.c_str(), &st) != 0)
+        return FALSE;
+    mode_t mode = st.st_mode & 07777;
+    if (attributes & FILE_ATTRIBUTE_READONLY)
+        mode &= ~(S_IWUSR | S_IWGRP | S_IWOTH);
+    else
+        mode |= S_IWUSR;
+    return chmod(narrow.c_str(), mode) == 0;
+}
+
+BOOL GetFileAttributesEx(LPCWSTR path, GET_FILEEX_INFO_LEVELS /*infoLevel*/, LPVOID fileInformation)
+{
+    struct stat st{};
+    if (stat(Narrow(path).c_str(), &st) != 0)
+        return FALSE;
+    auto* data             = static_cast<WIN32_FILE_ATTRIBUTE_DATA*>(fileInformation);
+    data->dwFileAttributes = S_ISDIR(st.st_mode) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+    if ((st.st_mode & S_IWUSR) == 0)
+        data->dwFileAttributes |= FILE_ATTRIBUTE_READONLY;
+    data->ftCreationTime   = UnixTimeToFileTime(st.st_ctim.tv_sec, st.st_ctim.tv_nsec);
+    data->ftLastAccessTime = UnixTimeToFileTime(st.st_atim.tv_sec, st.st_atim.tv_nsec);
+    data->ftLastWriteTime  = UnixTimeToFileTime(st.st_mtim.tv_sec, st.st_mtim.tv_nsec);
+    auto size              = S_ISDIR(st.st_mode) ? 0 : static_cast<uint64_t>(st.st_size);
+    data->nFileSizeHigh    = static_cast<DWORD>(size >> 32);
+    data->nFileSizeLow     = static_cast<DWORD>(size & 0xFFFFFFFF);
+    return TRUE;
+}
+
+BOOL MoveFileEx(LPCWSTR existingPath, LPCWSTR newPath, DWORD flags)
+{
+    auto dest = Narrow(newPath);
+    if ((flags & MOVEFILE_REPLACE_EXISTING) == 0 && access(dest.c_str(), F_OK) == 0)
+        return FALSE;
+    return rename(Narrow(existingPath).c_str(), dest.c_str()) == 0;
+}
+
+BOOL CopyFile(LPCWSTR existingPath, LPCWSTR newPath, BOOL failIfExists)
+{
+    std::error_code ec;
+    auto            options = failIfExists ? std::filesystem::copy_options::none : std::filesystem::copy_options::overwrite_existing;
+    return std::filesystem::copy_file(Narrow(existingPath), Narrow(newPath), options, ec) && !ec;
+}
+
+BOOL DeleteFile(LPCWSTR path)
+{
+    return unlink(Narrow(path).c_str()) == 0;
+}
+
+void Sleep(DWORD milliseconds)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+int StrCmpLogicalW(LPCWSTR str1, LPCWSTR str2)
+{
+    // case insensitive, with runs of digits compared by their value
+    while (*str1 && *str2)
+    {
+        if (iswdigit(*str1) && iswdigit(*str2))
+        {
+            while (*str1 == L'0')
+                ++str1;
+            while (*str2 == L'0')
+                ++str2;
+            const wchar_t* end1 = str1;
+            const wchar_t* end2 = str2;
+            while (iswdigit(*end1))
+                ++end1;
+            while (iswdigit(*end2))
+                ++end2;
+            if (end1 - str1 != end2 - str2)
+                return (end1 - str1) < (end2 - str2) ? -1 : 1;
+            for (; str1 < end1; ++str1, ++str2)
+            {
+                if (*str1 != *str2)
+                    return *str1 < *str2 ? -1 : 1;
+            }
+            continue;
+        }
+        auto c1 = towlower(*str1);
+        auto c2 = towlower(*str2);
+        if (c1 != c2)
+            return c1 < c2 ? -1 : 1;
+        ++str1;
+        ++str2;
+    }
+    if (*str1)
+        return 1;
+    return *str2 ? -1 : 0;
+}
+
+ULONGLONG GetTickCount64()
+{
+    return static_cast<ULONGLONG>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+int wcscpy_s(wchar_t* dest, size_t size, const wchar_t* src)
+{
+    if (dest == nullptr || size == 0)
+        return EINVAL;
+    auto len = wcslen(src);
+    if (len >= size)
+    {
+        dest[0] = 0;
+        return ERANGE;
+    }
+    wmemcpy(dest, src, len + 1);
+    return 0;
+}
+
+int _wtoi(const wchar_t* str)
+{
+    return static_cast<int>(wcstol(str, nullptr, 10));
+}
+
+int _wcsicmp(const wchar_t* str1, const wchar_t* str2)
+{
+    return wcscasecmp(str1, str2);
+}
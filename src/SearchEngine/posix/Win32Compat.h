@@ -0,0 +1,105 @@
+// grepWin - regex search and replace for Windows
+
+// Copyright (C) 2026 - Stefan Kueng
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#pragma once
+
+// the Win32 types and functions used by the search engine, implemented on
+// top of POSIX. Only what the engine needs, with the semantics it relies on.
+
+#include <cstdint>
+#include <cwchar>
+#include <string>
+
+using DWORD     = uint32_t;
+using UINT      = unsigned int;
+using BOOL      = int;
+using WCHAR     = wchar_t;
+using LPCWSTR   = const wchar_t*;
+using LPCTSTR   = const wchar_t*;
+using LPVOID    = void*;
+using ULONGLONG = uint64_t;
+#define __int64 long long
+
+#ifndef TRUE
+#    define TRUE  1
+#    define FALSE 0
+#endif
+
+#define MAX_PATH                     260
+#define INVALID_FILE_ATTRIBUTES      (static_cast<DWORD>(-1))
+#define FILE_ATTRIBUTE_READONLY      0x00000001
+#define FILE_ATTRIBUTE_HIDDEN        0x00000002
+#define FILE_ATTRIBUTE_SYSTEM        0x00000004
+#define FILE_ATTRIBUTE_DIRECTORY     0x00000010
+#define FILE_ATTRIBUTE_NORMAL        0x00000080
+#define FILE_ATTRIBUTE_REPARSE_POINT 0x00000400
+#define MOVEFILE_REPLACE_EXISTING    0x00000001
+
+struct FILETIME
+{
+    DWORD dwLowDateTime;
+    DWORD dwHighDateTime;
+};
+
+struct WIN32_FIND_DATA
+{
+    DWORD    dwFileAttributes;
+    FILETIME ftCreationTime;
+    FILETIME ftLastAccessTime;
+    FILETIME ftLastWriteTime;
+    DWORD    nFileSizeHigh;
+    DWORD    nFileSizeLow;
+    wchar_t  cFileName[MAX_PATH];
+};
+
+struct WIN32_FILE_ATTRIBUTE_DATA
+{
+    DWORD    dwFileAttributes;
+    FILETIME ftCreationTime;
+    FILETIME ftLastAccessTime;
+    FILETIME ftLastWriteTime;
+    DWORD    nFileSizeHigh;
+    DWORD    nFileSizeLow;
+};
+
+enum GET_FILEEX_INFO_LEVELS
+{
+    GetFileExInfoStandard,
+};
+
+// converts a unix time stamp to the 100ns intervals since 1601 of a FILETIME
+FILETIME  UnixTimeToFileTime(int64_t seconds, int64_t nanoSeconds);
+void      FileTimeToUnixTime(const FILETIME& fileTime, int64_t& seconds, int64_t& nanoSeconds);
+
+BOOL      PathFileExists(LPCWSTR path);
+BOOL      PathIsDirectory(LPCWSTR path);
+long      CompareFileTime(const FILETIME* fileTime1, const FILETIME* fileTime2);
+DWORD     GetFileAttributes(LPCWSTR path);
+BOOL      SetFileAttributes(LPCWSTR path, DWORD attributes);
+BOOL      GetFileAttributesEx(LPCWSTR path, GET_FILEEX_INFO_LEVELS infoLevel, LPVOID fileInformation);
+BOOL      MoveFileEx(LPCWSTR existingPath, LPCWSTR newPath, DWORD flags);
+BOOL      CopyFile(LPCWSTR existingPath, LPCWSTR newPath, BOOL failIfExists);
+BOOL      DeleteFile(LPCWSTR path);
+void      Sleep(DWORD milliseconds);
+int       StrCmpLogicalW(LPCWSTR str1, LPCWSTR str2);
+ULONGLONG GetTickCount64();
+
+// the secure CRT functions the engine uses
+int       wcscpy_s(wchar_t* dest, size_t size, const wchar_t* src);
+int       _wtoi(const wchar_t* str);
+int       _wcsicmp(const wchar_t* str1, const wchar_t* str2);
@@ -55,6 +55,8 @@ LRESULT CSettingsDlg::DlgFunc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPa
 
             CLanguage::Instance().TranslateWindow(*this);
             AddToolTip(IDC_ONLYONE, TranslatedString(hResource, IDS_ONLYONE_TT).c_str());
+            AddToolTip(IDC_DIRCACHE, TranslatedString(hResource, IDS_DIRCACHE_TT).c_str());
+            AddToolTip(IDC_LINEARREGEX, TranslatedString(hResource, IDS_LINEARREGEX_TT).c_str());
 
             SetDlgItemText(hwndDlg, IDC_EDITORCMD, bPortable ? g_iniFile.GetValue(L"global", L"editorcmd", L"") : std::wstring(m_regEditorCmd).c_str());
 
@@ -100,10 +102,14 @@ LRESULT CSettingsDlg::DlgFunc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPa
             SendDlgItemMessage(hwndDlg, IDC_BACKUPINFOLDER, BM_SETCHECK, bPortable ? !!_wtoi(g_iniFile.GetValue(L"settings", L"backupinfolder", L"0")) : static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\backupinfolder", FALSE)) ? BST_CHECKED : BST_UNCHECKED, 0);
             SendDlgItemMessage(hwndDlg, IDC_NOWARNINGIFNOBACKUP, BM_SETCHECK, bPortable ? !!_wtoi(g_iniFile.GetValue(L"settings", L"nowarnifnobackup", L"0")) : static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\nowarnifnobackup", FALSE)) ? BST_CHECKED : BST_UNCHECKED, 0);
             SendDlgItemMessage(hwndDlg, IDC_ONLYONE, BM_SETCHECK, bPortable ? _wtoi(g_iniFile.GetValue(L"global", L"onlyone", L"0")) : static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\onlyone", FALSE)) ? BST_CHECKED : BST_UNCHECKED, 0);
+            SendDlgItemMessage(hwndDlg, IDC_DIRCACHE, BM_SETCHECK, bPortable ? _wtoi(g_iniFile.GetValue(L"settings", L"dircache", L"0")) : static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\dircache", FALSE)) ? BST_CHECKED : BST_UNCHECKED, 0);
+            SendDlgItemMessage(hwndDlg, IDC_LINEARREGEX, BM_SETCHECK, bPortable ? _wtoi(g_iniFile.GetValue(L"settings", L"linearregex", L"0")) : static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\linearregex", FALSE)) ? BST_CHECKED : BST_UNCHECKED, 0);
             SendDlgItemMessage(hwndDlg, IDC_DOUPDATECHECKS, BM_SETCHECK, bPortable ? _wtoi(g_iniFile.GetValue(L"global", L"CheckForUpdates", L"1")) : static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\CheckForUpdates", TRUE)) ? BST_CHECKED : BST_UNCHECKED, 0);
             SendDlgItemMessage(hwndDlg, IDC_DARKMODE, BM_SETCHECK, CTheme::Instance().IsDarkTheme() ? BST_CHECKED : BST_UNCHECKED, 0);
             EnableWindow(GetDlgItem(*this, IDC_DARKMODE), CTheme::Instance().IsDarkModeAllowed());
             SetDlgItemText(*this, IDC_NUMNULL, bPortable ? g_iniFile.GetValue(L"settings", L"nullbytes", L"0") : std::to_wstring(static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\nullbytes", 0))).c_str());
+            SetDlgItemText(*this, IDC_REGEXTIMEOUT, bPortable ? g_iniFile.GetValue(L"settings", L"regextimeout", L"0") : std::to_wstring(static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\regextimeout", 0))).c_str());
+            SetDlgItemText(*this, IDC_CONTEXTLINES, bPortable ? g_iniFile.GetValue(L"settings", L"contextlines", L"0") : std::to_wstring(static_cast<DWORD>(CRegStdDWORD(L"Software\\grepWin\\contextlines", 0))).c_str());
 
             AddToolTip(IDC_BACKUPINFOLDER, TranslatedString(hResource, IDS_BACKUPINFOLDER_TT).c_str());
             if (!CTheme::Instance().IsDarkModeAllowed())
@@ -119,11 +125,17 @@ LRESULT CSettingsDlg::DlgFunc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPa
             m_resizer.AddControl(hwndDlg, IDC_STATIC3, RESIZER_TOPLEFT);
             m_resizer.AddControl(hwndDlg, IDC_STATIC4, RESIZER_TOPLEFT);
             m_resizer.AddControl(hwndDlg, IDC_NUMNULL, RESIZER_TOPRIGHT);
+            m_resizer.AddControl(hwndDlg, IDC_STATIC5, RESIZER_TOPLEFT);
+            m_resizer.AddControl(hwndDlg, IDC_REGEXTIMEOUT, RESIZER_TOPRIGHT);
+            m_resizer.AddControl(hwndDlg, IDC_STATIC6, RESIZER_TOPLEFT);
+            m_resizer.AddControl(hwndDlg, IDC_CONTEXTLINES, RESIZER_TOPRIGHT);
             m_resizer.AddControl(hwndDlg, IDC_LANGUAGE, RESIZER_TOPRIGHT);
             m_resizer.AddControl(hwndDlg, IDC_ESCKEY, RESIZER_TOPLEFTRIGHT);
             m_resizer.AddControl(hwndDlg, IDC_BACKUPINFOLDER, RESIZER_TOPLEFTRIGHT);
             m_resizer.AddControl(hwndDlg, IDC_NOWARNINGIFNOBACKUP, RESIZER_TOPLEFTRIGHT);
             m_resizer.AddControl(hwndDlg, IDC_ONLYONE, RESIZER_TOPLEFTRIGHT);
+            m_resizer.AddControl(hwndDlg, IDC_DIRCACHE, RESIZER_TOPLEFTRIGHT);
+            m_resizer.AddControl(hwndDlg, IDC_LINEARREGEX, RESIZER_TOPLEFTRIGHT);
             m_resizer.AddControl(hwndDlg, IDC_DOUPDATECHECKS, RESIZER_TOPLEFTRIGHT);
             m_resizer.AddControl(hwndDlg, IDC_DARKMODE, RESIZER_TOPLEFT);
             m_resizer.AddControl(hwndDlg, IDC_DARKMODEINFO, RESIZER_TOPLEFTRIGHT);
@@ -184,7 +196,9 @@ LRESULT CSettingsDlg::DoCommand(int id, int /*msg*/)
             CLanguage::Instance().LoadFile(langPath);
             CLanguage::Instance().TranslateWindow(::GetParent(*this));
 
-            std::wstring sNumNull = GetDlgItemText(IDC_NUMNULL).get();
+            std::wstring sNumNull      = GetDlgItemText(IDC_NUMNULL).get();
+            std::wstring sRegexTimeout = GetDlgItemText(IDC_REGEXTIMEOUT).get();
+            std::wstring sContextLines = GetDlgItemText(IDC_CONTEXTLINES).get();
 
             if (bPortable)
             {
@@ -192,8 +206,12 @@ LRESULT CSettingsDlg::DoCommand(int id, int /*msg*/)
                 g_iniFile.SetValue(L"settings", L"backupinfolder", (IsDlgButtonChecked(*this, IDC_BACKUPINFOLDER) == BST_CHECKED) ? L"1" : L"0");
                 g_iniFile.SetValue(L"settings", L"nowarnifnobackup", (IsDlgButtonChecked(*this, IDC_NOWARNINGIFNOBACKUP) == BST_CHECKED) ? L"1" : L"0");
                 g_iniFile.SetValue(L"global", L"onlyone", IsDlgButtonChecked(*this, IDC_ONLYONE) == BST_CHECKED ? L"1" : L"0");
+                g_iniFile.SetValue(L"settings", L"dircache", IsDlgButtonChecked(*this, IDC_DIRCACHE) == BST_CHECKED ? L"1" : L"0");
+                g_iniFile.SetValue(L"settings", L"linearregex", IsDlgButtonChecked(*this, IDC_LINEARREGEX) == BST_CHECKED ? L"1" : L"0");
                 g_iniFile.SetValue(L"global", L"CheckForUpdates", IsDlgButtonChecked(*this, IDC_DOUPDATECHECKS) == BST_CHECKED ? L"1" : L"0");
                 g_iniFile.SetValue(L"settings", L"nullbytes", sNumNull.c_str());
+                g_iniFile.SetValue(L"settings", L"regextimeout", sRegexTimeout.c_str());
+                g_iniFile.SetValue(L"settings", L"contextlines", sContextLines.c_str());
             }
             else
             {
@@ -206,10 +224,18 @@ LRESULT CSettingsDlg::DoCommand(int id, int /*msg*/)
                 nowarn = (IsDlgButtonChecked(*this, IDC_NOWARNINGIFNOBACKUP) == BST_CHECKED);
                 CRegStdDWORD regOnlyOne(L"Software\\grepWin\\onlyone", FALSE);
                 regOnlyOne = (IsDlgButtonChecked(*this, IDC_ONLYONE) == BST_CHECKED);
+                CRegStdDWORD regDirCache(L"Software\\grepWin\\dircache", FALSE);
+                regDirCache = (IsDlgButtonChecked(*this, IDC_DIRCACHE) == BST_CHECKED);
+                CRegStdDWORD regLinearRegex(L"Software\\grepWin\\linearregex", FALSE);
+                regLinearRegex = (IsDlgButtonChecked(*this, IDC_LINEARREGEX) == BST_CHECKED);
                 CRegStdDWORD regCheckForUpdates(L"Software\\grepWin\\CheckForUpdates", TRUE);
                 regCheckForUpdates = (IsDlgButtonChecked(*this, IDC_DOUPDATECHECKS) == BST_CHECKED);
                 CRegStdDWORD regNumNull(L"Software\\grepWin\\nullbytes", FALSE);
                 regNumNull = _wtoi(sNumNull.c_str());
+                CRegStdDWORD regRegexTimeout(L"Software\\grepWin\\regextimeout", 0);
+                regRegexTimeout = _wtoi(sRegexTimeout.c_str());
+                CRegStdDWORD regContextLines(L"Software\\grepWin\\contextlines", 0);
+                regContextLines = _wtoi(sContextLines.c_str());
                 // ReSharper restore CppEntityAssignedButNoRead
             }
             CTheme::Instance().SetDarkTheme(IsDlgButtonChecked(*this, IDC_DARKMODE) == BST_CHECKED);
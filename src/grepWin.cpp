@@ -19,6 +19,7 @@
 #include "stdafx.h"
 #include "resource.h"
 #include "SearchDlg.h"
+#include "HeadlessSearch.h"
 #include "AboutDlg.h"
 #include "CmdLineParser.h"
 #include "Registry.h"
@@ -181,6 +182,34 @@ BOOL CALLBACK windowEnumerator(__in HWND hwnd, __in LPARAM lParam)
     return TRUE;
 }
 
+// searches without any window and writes the results to stdout,
+// for scheduled jobs and scripts. Also runs the search server and its client.
+static int RunHeadless()
+{
+    std::vector<std::wstring> args;
+    int                       nArgs     = 0;
+    LPWSTR*                   szArgList = CommandLineToArgvW(GetCommandLineW(), &nArgs);
+    if (szArgList)
+    {
+        OnOutOfScope(LocalFree(szArgList));
+        for (int i = 1; i < nArgs; ++i)
+            args.push_back(szArgList[i]);
+    }
+
+    // grepWin is not a console application: if the output is not
+    // redirected, write to the console of the parent process
+    if ((GetFileType(GetStdHandle(STD_OUTPUT_HANDLE)) == FILE_TYPE_UNKNOWN) && AttachConsole(ATTACH_PARENT_PROCESS))
+    {
+        FILE* pFile = nullptr;
+        _wfreopen_s(&pFile, L"CONOUT$", L"w", stdout);
+        _wfreopen_s(&pFile, L"CONOUT$", L"w", stderr);
+    }
+    SetConsoleOutputCP(CP_UTF8);
+    SetErrorMode(SEM_FAILCRITICALERRORS | SEM_NOOPENFILEERRORBOX);
+
+    return RunHeadlessCommandLine(args, stdout, stderr);
+}
+
 int APIENTRY wWinMain(HINSTANCE hInstance,
                       HINSTANCE hPrevInstance,
                       LPTSTR    lpCmdLine,
@@ -248,6 +277,17 @@ int APIENTRY wWinMain(HINSTANCE hInstance,
         RegisterContextMenu(false);
         return FALSE;
     }
+    if (parser.HasKey(L"headless"))
+    {
+        int ret = RunHeadless();
+        ::CoUninitialize();
+        ::OleUninitialize();
+        FreeLibrary(hRichEdt);
+        CloseHandle(hReloadProtection);
+        if (hInitProtection)
+            CloseHandle(hInitProtection);
+        return ret;
+    }
 
     bool bQuit   = false;
     HWND hWnd    = nullptr;
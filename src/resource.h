@@ -92,6 +92,21 @@
 #define IDS_COPY_COLUMN_SEL             178
 #define IDS_REGEXEXCEPTION              179
 #define IDS_COLUMN                      180
+#define IDS_WATCHRESULTS                181
+#define IDS_DIRCACHE_TT                 182
+#define IDS_LINEARREGEX_TT              183
+#define IDS_INFOLABELTIMEDOUT           184
+#define IDS_RESULTFILTER_CUE            185
+#define IDS_PREVIOUSRESULTS             186
+#define IDS_EXPORTTEXTFILES             187
+#define IDS_EXPORTCSVFILES              188
+#define IDS_EXPORTJSONLINESFILES        189
+#define IDS_EXPORTBINARYFILES           190
+#define IDS_EXPORTSAVEDRESULTS          191
+#define IDS_OPENRESULTS                 192
+#define IDS_ERR_RESULTSFILE             193
+#define IDS_COMPARERESULTS              194
+#define IDS_SURROUNDINGLINE             195
 #define IDC_SEARCHTEXT                  1000
 #define IDC_REGEXRADIO                  1001
 #define IDC_TEXTRADIO                   1002
@@ -193,6 +208,17 @@
 #define IDC_NUMNULL                     1090
 #define IDC_SYSLINK1                    1091
 #define IDC_INCLUDESYMLINK              1092
+#define IDC_WATCHRESULTS                1093
+#define IDC_DIRCACHE                    1094
+#define IDC_LINEARREGEX                 1095
+#define IDC_REGEXTIMEOUT                1096
+#define IDC_STATIC5                     1097
+#define IDC_RESULTFILTER                1098
+#define IDC_PREVIOUSRESULTS             1099
+#define IDC_OPENRESULTS                 1100
+#define IDC_COMPARERESULTS              1101
+#define IDC_CONTEXTLINES                1102
+#define IDC_STATIC6                     1103
 #define ID_REMOVEBOOKMARK               32771
 #define ID_DUMMY_RENAMEPRESET           32774
 #define ID_RENAMEBOOKMARK               32775
@@ -205,7 +231,7 @@
 #define _APS_NO_MFC                     1
 #define _APS_NEXT_RESOURCE_VALUE        140
 #define _APS_NEXT_COMMAND_VALUE         32776
-#define _APS_NEXT_CONTROL_VALUE         1093
+#define _APS_NEXT_CONTROL_VALUE         1104
 #define _APS_NEXT_SYMED_VALUE           110
 #endif
 #endif